@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// 二进制日志文件格式，由BinaryLogger写入、logdecode读取
+// 本文件不依赖Windows头文件，以便解码工具在其他平台上构建
+//
+// 文件由若干记录顺序组成，多字节整数均为小端序：
+//   会话头   [type][magic x8][version u32][utcOffsetMinutes i32]
+//   格式定义 [type][formatId u32][length u16][格式字符串]
+//   日志事件 [type][level u8][formatId u32][timestamp u64][payloadLength u16][参数...]
+// 每次打开日志文件都会写入新的会话头，格式ID仅在所属会话内有效
+// 时间戳为FILETIME（自1601-01-01起的100ns计数，UTC）
+//
+// 版本2起格式ID为格式字符串的FNV-1a哈希（编译期求值），哈希冲突时写入方顺延到下一个未使用的ID；
+// 版本1的格式ID为注册序号。两者记录布局相同
+namespace BinaryLogFormat {
+
+const char kMagic[8] = { 'W', 'L', 'M', 'B', 'L', 'O', 'G', '1' };
+const uint32_t kVersion = 2;
+const uint32_t kMinVersion = 1;
+
+// FILETIME纪元与Unix纪元之间的100ns计数差
+const uint64_t kUnixEpochInFileTime = 116444736000000000ULL;
+
+// 单条事件参数区的最大长度
+const size_t kMaxPayloadBytes = 1024;
+
+enum RecordType : uint8_t {
+    RecordSessionHeader = 1,
+    RecordFormatDef = 2,
+    RecordEvent = 3
+};
+
+// 32位FNV-1a哈希
+constexpr uint32_t HashFormat(const char* format) {
+    uint32_t hash = 2166136261u;
+    for (; *format; ++format) {
+        hash ^= static_cast<uint8_t>(*format);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 参数类型标记，后跟参数数据
+enum ArgType : uint8_t {
+    ArgInt64 = 1,    // i64
+    ArgUInt64 = 2,   // u64
+    ArgDouble = 3,   // f64
+    ArgString = 4,   // [length u16][UTF-8字节]
+    ArgWString = 5,  // [length u16][UTF-16码元]
+    ArgPointer = 6   // u64
+};
+
+} // namespace BinaryLogFormat
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "BinaryLogger.h"
+#include <ctime>
+#include <algorithm>
+
+std::mutex BinaryLogger::s_mutex;
+std::atomic<bool> BinaryLogger::s_open(false);
+LogFileSink BinaryLogger::s_sink;
+uint32_t BinaryLogger::s_session = 0;
+std::unordered_map<uint32_t, const char*> BinaryLogger::s_formats;
+
+bool BinaryLogger::Open(const String& filePath, const LogFlushPolicy& policy) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    
+    s_open = false;
+    if (!s_sink.Open(filePath, policy)) {
+        Logger::Log(LogLevel::Error, "Failed to open binary log file: %s", filePath.c_str());
+        return false;
+    }
+    
+    // 新会话中各调用点的格式定义在首次使用时重新写出
+    s_session++;
+    s_formats.clear();
+    WriteSessionHeader();
+    
+    s_open = true;
+    return true;
+}
+
+void BinaryLogger::Close() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_open = false;
+    s_sink.Close();
+}
+
+void BinaryLogger::Flush() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_sink.Commit();
+}
+
+void BinaryLogger::WriteSessionHeader() {
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_s(&local, &now);
+    int32_t utcOffsetMinutes = static_cast<int32_t>((_mkgmtime(&local) - now) / 60);
+    
+    char header[1 + sizeof(BinaryLogFormat::kMagic) + sizeof(uint32_t) + sizeof(int32_t)];
+    size_t offset = 0;
+    header[offset++] = static_cast<char>(BinaryLogFormat::RecordSessionHeader);
+    memcpy(header + offset, BinaryLogFormat::kMagic, sizeof(BinaryLogFormat::kMagic));
+    offset += sizeof(BinaryLogFormat::kMagic);
+    memcpy(header + offset, &BinaryLogFormat::kVersion, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    memcpy(header + offset, &utcOffsetMinutes, sizeof(int32_t));
+    offset += sizeof(int32_t);
+    
+    s_sink.Append(LogLevel::Info, header, offset);
+}
+
+void BinaryLogger::DefineFormat(const char* format, uint32_t formatHash, FormatSite& site) {
+    // 同一格式字符串可能出现在多个调用点，已写出时直接复用；
+    // 不同格式的哈希冲突时顺延到下一个未使用的ID
+    uint32_t formatId = formatHash;
+    auto it = s_formats.find(formatId);
+    while (it != s_formats.end() && strcmp(it->second, format) != 0) {
+        it = s_formats.find(++formatId);
+    }
+    
+    site.session = s_session;
+    site.formatId = formatId;
+    if (it != s_formats.end()) {
+        return;
+    }
+    s_formats[formatId] = format;
+    
+    uint16_t length = static_cast<uint16_t>(std::min<size_t>(strlen(format), 0xFFFF));
+    char header[1 + sizeof(uint32_t) + sizeof(uint16_t)];
+    header[0] = static_cast<char>(BinaryLogFormat::RecordFormatDef);
+    memcpy(header + 1, &formatId, sizeof(uint32_t));
+    memcpy(header + 1 + sizeof(uint32_t), &length, sizeof(uint16_t));
+    
+    s_sink.Append(LogLevel::Info, header, sizeof(header));
+    s_sink.Append(LogLevel::Info, format, length);
+}
+
+void BinaryLogger::WriteEvent(LogLevel level, const char* format, uint32_t formatHash, FormatSite& site,
+                              const char* payload, size_t size) {
+    FILETIME fileTime;
+    GetSystemTimeAsFileTime(&fileTime);
+    uint64_t timestamp = (static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+    
+    char record[1 + 1 + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint16_t) + BinaryLogFormat::kMaxPayloadBytes];
+    uint16_t payloadLength = static_cast<uint16_t>(size);
+    size_t offset = 0;
+    record[offset++] = static_cast<char>(BinaryLogFormat::RecordEvent);
+    record[offset++] = static_cast<char>(level);
+    const size_t formatIdOffset = offset;
+    offset += sizeof(uint32_t);
+    memcpy(record + offset, &timestamp, sizeof(uint64_t));
+    offset += sizeof(uint64_t);
+    memcpy(record + offset, &payloadLength, sizeof(uint16_t));
+    offset += sizeof(uint16_t);
+    memcpy(record + offset, payload, size);
+    offset += size;
+    
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_open) {
+        return;
+    }
+    
+    // 格式定义必须先于引用它的事件写出
+    if (site.session != s_session) {
+        DefineFormat(format, formatHash, site);
+    }
+    memcpy(record + formatIdOffset, &site.formatId, sizeof(uint32_t));
+    s_sink.Append(level, record, offset);
+}
+
+bool BinaryLogger::Reserve(ArgBuffer& buffer, size_t size) {
+    // 超出容量时丢弃当前及之后的参数，解码时按缺失参数处理
+    if (buffer.truncated || buffer.size + size > sizeof(buffer.data)) {
+        buffer.truncated = true;
+        return false;
+    }
+    return true;
+}
+
+void BinaryLogger::PackBytes(ArgBuffer& buffer, const void* data, size_t size) {
+    memcpy(buffer.data + buffer.size, data, size);
+    buffer.size += size;
+}
+
+void BinaryLogger::PackSigned(ArgBuffer& buffer, int64_t value) {
+    uint8_t type = BinaryLogFormat::ArgInt64;
+    if (Reserve(buffer, sizeof(type) + sizeof(value))) {
+        PackBytes(buffer, &type, sizeof(type));
+        PackBytes(buffer, &value, sizeof(value));
+    }
+}
+
+void BinaryLogger::PackUnsigned(ArgBuffer& buffer, uint64_t value) {
+    uint8_t type = BinaryLogFormat::ArgUInt64;
+    if (Reserve(buffer, sizeof(type) + sizeof(value))) {
+        PackBytes(buffer, &type, sizeof(type));
+        PackBytes(buffer, &value, sizeof(value));
+    }
+}
+
+void BinaryLogger::PackDouble(ArgBuffer& buffer, double value) {
+    uint8_t type = BinaryLogFormat::ArgDouble;
+    if (Reserve(buffer, sizeof(type) + sizeof(value))) {
+        PackBytes(buffer, &type, sizeof(type));
+        PackBytes(buffer, &value, sizeof(value));
+    }
+}
+
+void BinaryLogger::PackPointer(ArgBuffer& buffer, const void* value) {
+    uint8_t type = BinaryLogFormat::ArgPointer;
+    uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+    if (Reserve(buffer, sizeof(type) + sizeof(address))) {
+        PackBytes(buffer, &type, sizeof(type));
+        PackBytes(buffer, &address, sizeof(address));
+    }
+}
+
+void BinaryLogger::PackString(ArgBuffer& buffer, const char* value, size_t length) {
+    uint8_t type = BinaryLogFormat::ArgString;
+    const size_t headerSize = sizeof(type) + sizeof(uint16_t);
+    if (!Reserve(buffer, headerSize)) {
+        return;
+    }
+    
+    // 过长的字符串截断到剩余空间
+    uint16_t packedLength = static_cast<uint16_t>(std::min(length, sizeof(buffer.data) - buffer.size - headerSize));
+    PackBytes(buffer, &type, sizeof(type));
+    PackBytes(buffer, &packedLength, sizeof(packedLength));
+    PackBytes(buffer, value, packedLength);
+}
+
+void BinaryLogger::PackWString(ArgBuffer& buffer, const wchar_t* value, size_t length) {
+    uint8_t type = BinaryLogFormat::ArgWString;
+    const size_t headerSize = sizeof(type) + sizeof(uint16_t);
+    if (!Reserve(buffer, headerSize)) {
+        return;
+    }
+    
+    uint16_t packedLength = static_cast<uint16_t>(
+        std::min(length, (sizeof(buffer.data) - buffer.size - headerSize) / sizeof(uint16_t)));
+    PackBytes(buffer, &type, sizeof(type));
+    PackBytes(buffer, &packedLength, sizeof(packedLength));
+    
+    // Windows下wchar_t即UTF-16码元
+    for (uint16_t i = 0; i < packedLength; ++i) {
+        uint16_t unit = static_cast<uint16_t>(value[i]);
+        PackBytes(buffer, &unit, sizeof(unit));
+    }
+}
\ No newline at end of file
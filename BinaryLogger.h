@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Common.h"
+#include "Logger.h"
+#include "BinaryLogFormat.h"
+#include "LogFileSink.h"
+#include <type_traits>
+#include <cstring>
+#include <unordered_map>
+
+// 二进制日志：调用时只记录格式ID、原始时间戳和打包后的参数，
+// 格式化工作推迟到离线的logdecode工具中完成
+class BinaryLogger {
+public:
+    static bool Open(const String& filePath,
+                     const LogFlushPolicy& policy = LogFlushPolicy::EveryBytes(64 * 1024));
+    static void Close();
+    static void Flush();
+    static bool IsOpen() { return s_open; }
+    
+    // 每个LOG_BINARY调用点一份，记录格式定义已在哪个会话中写出，只在s_mutex下访问
+    struct FormatSite {
+        uint32_t session;   // 0表示尚未写出
+        uint32_t formatId;  // 本会话中实际使用的ID，通常等于格式字符串的哈希
+    };
+    
+    // formatHash为编译期计算的BinaryLogFormat::HashFormat(format)，
+    // 格式定义在每个会话中首次使用时才写出
+    template <typename... Args>
+    static void Write(LogLevel level, uint32_t formatHash, FormatSite& site, const char* format,
+                      const Args&... args) {
+        ArgBuffer buffer;
+        int expand[] = { 0, (PackArg(buffer, args), 0)... };
+        (void)expand;
+        WriteEvent(level, format, formatHash, site, buffer.data, buffer.size);
+    }
+
+private:
+    struct ArgBuffer {
+        char data[BinaryLogFormat::kMaxPayloadBytes];
+        size_t size;
+        bool truncated;
+        
+        ArgBuffer() : size(0), truncated(false) {}
+    };
+    
+    static std::mutex s_mutex;
+    static std::atomic<bool> s_open;
+    static LogFileSink s_sink;
+    static uint32_t s_session;
+    static std::unordered_map<uint32_t, const char*> s_formats;  // 本会话已写出的格式
+    
+    static void WriteSessionHeader();
+    static void DefineFormat(const char* format, uint32_t formatHash, FormatSite& site);
+    static void WriteEvent(LogLevel level, const char* format, uint32_t formatHash, FormatSite& site,
+                           const char* payload, size_t size);
+    
+    static bool Reserve(ArgBuffer& buffer, size_t size);
+    static void PackBytes(ArgBuffer& buffer, const void* data, size_t size);
+    static void PackSigned(ArgBuffer& buffer, int64_t value);
+    static void PackUnsigned(ArgBuffer& buffer, uint64_t value);
+    static void PackDouble(ArgBuffer& buffer, double value);
+    static void PackPointer(ArgBuffer& buffer, const void* value);
+    static void PackString(ArgBuffer& buffer, const char* value, size_t length);
+    static void PackWString(ArgBuffer& buffer, const wchar_t* value, size_t length);
+    
+    template <typename T>
+    static void PackArg(ArgBuffer& buffer, const T& value) {
+        using U = typename std::decay<T>::type;
+        if constexpr (std::is_same<U, String>::value) {
+            PackString(buffer, value.c_str(), value.length());
+        } else if constexpr (std::is_same<U, WString>::value) {
+            PackWString(buffer, value.c_str(), value.length());
+        } else if constexpr (std::is_same<U, char*>::value || std::is_same<U, const char*>::value) {
+            const char* str = value;
+            PackString(buffer, str, str ? strlen(str) : 0);
+        } else if constexpr (std::is_same<U, wchar_t*>::value || std::is_same<U, const wchar_t*>::value) {
+            const wchar_t* str = value;
+            PackWString(buffer, str, str ? wcslen(str) : 0);
+        } else if constexpr (std::is_floating_point<U>::value) {
+            PackDouble(buffer, static_cast<double>(value));
+        } else if constexpr (std::is_enum<U>::value) {
+            PackSigned(buffer, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral<U>::value && std::is_signed<U>::value) {
+            PackSigned(buffer, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral<U>::value) {
+            PackUnsigned(buffer, static_cast<uint64_t>(value));
+        } else {
+            static_assert(std::is_pointer<U>::value, "Unsupported binary log argument type");
+            PackPointer(buffer, static_cast<const void*>(value));
+        }
+    }
+};
+
+// 取可变参数中的第一个（格式字符串）。补一个占位参数，只有格式字符串时也不需要空的可变参数，
+// 不依赖GNU的", ##__VA_ARGS__"扩展或C++20的__VA_OPT__；WLM_EXPAND兼容MSVC的传统预处理器
+#define WLM_EXPAND(x) x
+#define WLM_FIRST_ARG(...) WLM_EXPAND(WLM_FIRST_ARG_(__VA_ARGS__, ~))
+#define WLM_FIRST_ARG_(first, ...) first
+
+// 二进制日志已打开时写入二进制记录，否则回退到文本日志。参数为格式字符串和格式参数。
+// 格式ID在编译期由格式字符串求得，调用点缓存是常量初始化的静态变量，没有初始化保护的开销
+#define LOG_BINARY(level, ...) \
+    do { \
+        if (Logger::IsEnabled(level)) { \
+            if (BinaryLogger::IsOpen()) { \
+                static BinaryLogger::FormatSite wlmFormatSite_ = { 0, 0 }; \
+                constexpr uint32_t wlmFormatHash_ = BinaryLogFormat::HashFormat(WLM_FIRST_ARG(__VA_ARGS__)); \
+                BinaryLogger::Write(level, wlmFormatHash_, wlmFormatSite_, __VA_ARGS__); \
+            } else { \
+                Logger::Log(level, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
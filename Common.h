@@ -1,6 +1,10 @@
 #pragma once
 
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include "PosixCompat.h"
+#endif
 #include <string>
 #include <vector>
 #include <memory>
@@ -25,6 +29,7 @@ enum class ErrorCode {
     ServiceNotFound = 3,
     ProcessNotFound = 4,
     IPCConnectionFailed = 5,
+    ServerBusy = 6,
     UnknownError = 999
 };
 
@@ -42,8 +47,9 @@ struct ProcessInfo {
     WString processName;
     DWORD threadCount;
     DWORD parentProcessId;
+    uint64_t startTime;  // 与PID一起唯一标识进程：Linux上为自系统启动起的时钟滴答数，Windows上为创建时间，0表示未知
     
-    ProcessInfo() : processId(0), threadCount(0), parentProcessId(0) {}
+    ProcessInfo() : processId(0), threadCount(0), parentProcessId(0), startTime(0) {}
 };
 
 // 日志级别
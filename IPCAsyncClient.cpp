@@ -0,0 +1,640 @@
+#include "IPCAsyncClient.h"
+
+#ifndef _WIN32
+#include "IPCSocket.h"
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#endif
+
+#ifdef _WIN32
+IPCAsyncClient::IPCAsyncClient()
+    : m_pipe(INVALID_HANDLE_VALUE)
+    , m_completionPort(NULL)
+    , m_reading(false)
+    , m_stopRequested(false)
+    , m_writing(false)
+    , m_broken(false)
+    , m_nextRequestId(1)
+    , m_lastError(ErrorCode::Success) {
+    ZeroMemory(&m_readOverlapped, sizeof(m_readOverlapped));
+    ZeroMemory(&m_writeOverlapped, sizeof(m_writeOverlapped));
+}
+#else
+IPCAsyncClient::IPCAsyncClient()
+    : m_socket(-1)
+    , m_epoll(-1)
+    , m_wakeEvent(-1)
+    , m_writeOffset(0)
+    , m_waitWritable(false)
+    , m_stopRequested(false)
+    , m_writing(false)
+    , m_broken(false)
+    , m_nextRequestId(1)
+    , m_lastError(ErrorCode::Success) {
+}
+#endif
+
+IPCAsyncClient::~IPCAsyncClient() {
+    Disconnect();
+}
+
+#ifdef _WIN32
+bool IPCAsyncClient::Connect(const WString& pipeName, DWORD timeoutMs) {
+    Disconnect();
+    
+    ULONGLONG deadline = GetTickCount64() + timeoutMs;
+    while (true) {
+        m_pipe = CreateFileW(
+            pipeName.c_str(),
+            GENERIC_READ | GENERIC_WRITE,
+            0,
+            NULL,
+            OPEN_EXISTING,
+            FILE_FLAG_OVERLAPPED,
+            NULL
+        );
+        
+        if (m_pipe != INVALID_HANDLE_VALUE) {
+            break;
+        }
+        
+        // 所有实例都在服务其他客户端时等待空闲实例
+        ULONGLONG now = GetTickCount64();
+        if (::GetLastError() != ERROR_PIPE_BUSY || now >= deadline ||
+            !WaitNamedPipeW(pipeName.c_str(), static_cast<DWORD>(deadline - now))) {
+            Logger::Log(LogLevel::Error, "Failed to connect to IPC server, error: %s", Utils::GetLastErrorString().c_str());
+            SetLastError(ErrorCode::IPCConnectionFailed);
+            return false;
+        }
+    }
+    
+    m_completionPort = CreateIoCompletionPort(m_pipe, NULL, KeyPipe, 1);
+    if (!m_completionPort) {
+        Logger::Log(LogLevel::Error, "Failed to create completion port, error: %s", Utils::GetLastErrorString().c_str());
+        SetLastError(ErrorCode::IPCConnectionFailed);
+        CloseHandle(m_pipe);
+        m_pipe = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    
+    m_broken = false;
+    m_stopRequested = false;
+    BeginRead();
+    return true;
+}
+
+void IPCAsyncClient::Disconnect() {
+    if (m_pipe != INVALID_HANDLE_VALUE) {
+        // 等待被取消的读写结束后才能释放缓冲
+        DWORD bytesTransferred;
+        CancelIoEx(m_pipe, NULL);
+        if (m_reading) {
+            GetOverlappedResult(m_pipe, &m_readOverlapped, &bytesTransferred, TRUE);
+        }
+        if (m_writing) {
+            GetOverlappedResult(m_pipe, &m_writeOverlapped, &bytesTransferred, TRUE);
+        }
+        CloseHandle(m_pipe);
+        m_pipe = INVALID_HANDLE_VALUE;
+    }
+    
+    if (m_completionPort) {
+        CloseHandle(m_completionPort);
+        m_completionPort = NULL;
+    }
+    
+    m_reading = false;
+    m_reader.Reset();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_writing = false;
+        IPCBufferPool::Release(m_writeBuffer);
+        IPCBufferPool::Release(m_pendingWrites);
+    }
+    
+    FailAll();
+}
+#else
+bool IPCAsyncClient::Connect(const WString& pipeName, DWORD timeoutMs) {
+    Disconnect();
+    
+    m_socket = IPCSocket::Connect(IPCSocket::GetSocketPath(pipeName), timeoutMs);
+    if (m_socket < 0) {
+        Logger::Log(LogLevel::Error, "Failed to connect to IPC server, error: %s", Utils::GetLastErrorString().c_str());
+        SetLastError(ErrorCode::IPCConnectionFailed);
+        return false;
+    }
+    
+    // 套接字一直监视可读，发送缓冲满时再加上可写；eventfd代替完成端口上的唤醒通知
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event socketEvent = {};
+    socketEvent.events = EPOLLIN;
+    socketEvent.data.fd = m_socket;
+    epoll_event wakeEvent = {};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.fd = m_wakeEvent;
+    if (m_epoll < 0 || m_wakeEvent < 0 || !IPCSocket::SetNonBlocking(m_socket) ||
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_socket, &socketEvent) != 0 ||
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeEvent, &wakeEvent) != 0) {
+        ::SetLastError(errno);
+        Logger::Log(LogLevel::Error, "Failed to create epoll instance, error: %s", Utils::GetLastErrorString().c_str());
+        Disconnect();
+        SetLastError(ErrorCode::IPCConnectionFailed);
+        return false;
+    }
+    
+    m_broken = false;
+    m_stopRequested = false;
+    return true;
+}
+
+void IPCAsyncClient::Disconnect() {
+    for (int* fd : { &m_socket, &m_epoll, &m_wakeEvent }) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    
+    m_reader.Reset();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_writing = false;
+        m_writeOffset = 0;
+        m_waitWritable = false;
+        IPCBufferPool::Release(m_writeBuffer);
+        IPCBufferPool::Release(m_pendingWrites);
+    }
+    
+    FailAll();
+}
+#endif
+
+uint32_t IPCAsyncClient::SendAsync(const String& command, DWORD deadlineMs, IPCReplyCallback callback) {
+    return Submit(IPCFrame::MessageCommand, command, deadlineMs,
+                  [callback](IPCAsyncStatus status, String& response) {
+        callback(status, response);
+    });
+}
+
+uint32_t IPCAsyncClient::CallAsync(const IPCRequest& request, DWORD deadlineMs, IPCResultCallback callback) {
+    String payload;
+    IPCProtocol::EncodeRequest(request, payload);
+    return Submit(IPCFrame::MessageBinary, payload, deadlineMs,
+                  [callback](IPCAsyncStatus status, String& response) {
+        IPCResult result;
+        if (status == IPCAsyncStatus::Completed && !IPCProtocol::DecodeResult(response, result)) {
+            result = IPCResult(IPCStatus::Failed, ErrorCode::UnknownError, "Invalid response");
+        }
+        callback(status, result);
+    });
+}
+
+std::future<IPCAsyncReply> IPCAsyncClient::Send(const String& command, DWORD deadlineMs, uint32_t* requestId) {
+    auto promise = std::make_shared<std::promise<IPCAsyncReply>>();
+    std::future<IPCAsyncReply> future = promise->get_future();
+    
+    uint32_t id = SendAsync(command, deadlineMs, [promise](IPCAsyncStatus status, const String& response) {
+        IPCAsyncReply reply;
+        reply.status = status;
+        reply.response = response;
+        promise->set_value(std::move(reply));
+    });
+    
+    // 发起失败时回调不会被调用，直接以Disconnected结束
+    if (id == 0) {
+        promise->set_value(IPCAsyncReply());
+    }
+    if (requestId) {
+        *requestId = id;
+    }
+    return future;
+}
+
+std::future<IPCAsyncResult> IPCAsyncClient::Call(const IPCRequest& request, DWORD deadlineMs, uint32_t* requestId) {
+    auto promise = std::make_shared<std::promise<IPCAsyncResult>>();
+    std::future<IPCAsyncResult> future = promise->get_future();
+    
+    uint32_t id = CallAsync(request, deadlineMs, [promise](IPCAsyncStatus status, const IPCResult& result) {
+        IPCAsyncResult reply;
+        reply.status = status;
+        reply.result = result;
+        promise->set_value(std::move(reply));
+    });
+    
+    if (id == 0) {
+        promise->set_value(IPCAsyncResult());
+    }
+    if (requestId) {
+        *requestId = id;
+    }
+    return future;
+}
+
+uint32_t IPCAsyncClient::Submit(uint16_t type, const String& payload, DWORD deadlineMs, Completion completion) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!IsConnected() || m_broken) {
+        SetLastError(ErrorCode::IPCConnectionFailed);
+        return 0;
+    }
+    
+    // 0表示发起失败
+    uint32_t requestId = m_nextRequestId++;
+    if (m_nextRequestId == 0) {
+        m_nextRequestId = 1;
+    }
+    
+    PendingRequest& pending = m_pending[requestId];
+    pending.completion = std::move(completion);
+    pending.deadline = deadlineMs == INFINITE ? 0 : GetTickCount64() + deadlineMs;
+    
+    // 新的截止时间早于事件循环当前的等待时间时同样需要唤醒
+    bool wake = !m_writing && m_pendingWrites.empty();
+    if (pending.deadline != 0) {
+        m_deadlines.emplace(pending.deadline, requestId);
+        wake = wake || m_deadlines.top().second == requestId;
+    }
+    
+    if (m_pendingWrites.empty()) {
+        m_pendingWrites = IPCBufferPool::Acquire();
+    }
+    IPCFrame::AppendMessage(m_pendingWrites, requestId, type, payload.c_str(), payload.length());
+    
+    if (wake) {
+        Wake();
+    }
+    return requestId;
+}
+
+bool IPCAsyncClient::Cancel(uint32_t requestId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_pending.find(requestId);
+    if (it == m_pending.end()) {
+        return false;
+    }
+    
+    // 回调交给事件循环线程调用，截止时间队列中的残留项在到期时跳过
+    m_cancelled.push_back(std::move(it->second.completion));
+    m_pending.erase(it);
+    Wake();
+    return true;
+}
+
+void IPCAsyncClient::Wake() {
+#ifdef _WIN32
+    PostQueuedCompletionStatus(m_completionPort, 0, KeyWake, NULL);
+#else
+    uint64_t value = 1;
+    if (write(m_wakeEvent, &value, sizeof(value)) < 0) {
+        // 计数已满时事件循环必然会被唤醒，无需处理
+    }
+#endif
+}
+
+void IPCAsyncClient::Run() {
+    while (!m_stopRequested && RunOnce(INFINITE)) {
+    }
+    m_stopRequested = false;
+}
+
+bool IPCAsyncClient::RunOnce(DWORD timeoutMs) {
+    if (!IsConnected()) {
+        return false;
+    }
+
+#ifdef _WIN32
+    DWORD bytesTransferred = 0;
+    ULONG_PTR completionKey = 0;
+    LPOVERLAPPED overlapped = NULL;
+    BOOL success = GetQueuedCompletionStatus(m_completionPort, &bytesTransferred, &completionKey,
+                                             &overlapped, GetWaitTimeout(timeoutMs));
+    
+    if (overlapped == &m_readOverlapped) {
+        OnReadCompleted(success, bytesTransferred);
+    } else if (overlapped == &m_writeOverlapped) {
+        OnWriteCompleted(success);
+    } else if (success && completionKey == KeyWake) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        BeginWrite();
+    } else if (success && completionKey == KeyStop) {
+        m_stopRequested = true;
+    }
+#else
+    DWORD waitMs = GetWaitTimeout(timeoutMs);
+    epoll_event events[2];
+    int count = epoll_wait(m_epoll, events, 2, waitMs == INFINITE ? -1 : static_cast<int>(waitMs));
+    for (int i = 0; i < count; ++i) {
+        if (events[i].data.fd == m_wakeEvent) {
+            uint64_t value;
+            while (read(m_wakeEvent, &value, sizeof(value)) > 0) {
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            BeginWrite();
+            continue;
+        }
+        
+        if (events[i].events & EPOLLOUT) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ContinueWrite();
+        }
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            OnSocketReadable();
+        }
+    }
+#endif
+    
+    DeliverCancelled();
+    ExpireRequests();
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_broken;
+}
+
+void IPCAsyncClient::Stop() {
+    m_stopRequested = true;
+#ifdef _WIN32
+    if (m_completionPort) {
+        PostQueuedCompletionStatus(m_completionPort, 0, KeyStop, NULL);
+    }
+#else
+    if (m_wakeEvent >= 0) {
+        Wake();
+    }
+#endif
+}
+
+size_t IPCAsyncClient::GetPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.size();
+}
+
+#ifdef _WIN32
+void IPCAsyncClient::BeginRead() {
+    ZeroMemory(&m_readOverlapped, sizeof(m_readOverlapped));
+    
+    // 同步完成时同样会投递完成包，统一在完成通知中处理
+    if (!ReadFile(m_pipe, m_buffer, sizeof(m_buffer), NULL, &m_readOverlapped) &&
+        ::GetLastError() != ERROR_IO_PENDING) {
+        Logger::Log(LogLevel::Error, "Failed to read response, error: %s", Utils::GetLastErrorString().c_str());
+        FailAll();
+        return;
+    }
+    m_reading = true;
+}
+
+void IPCAsyncClient::BeginWrite() {
+    // 调用时持有m_mutex
+    if (m_writing || m_broken || m_pendingWrites.empty()) {
+        return;
+    }
+    
+    m_writeBuffer.swap(m_pendingWrites);
+    ZeroMemory(&m_writeOverlapped, sizeof(m_writeOverlapped));
+    
+    if (!WriteFile(m_pipe, m_writeBuffer.c_str(), static_cast<DWORD>(m_writeBuffer.length()), NULL, &m_writeOverlapped) &&
+        ::GetLastError() != ERROR_IO_PENDING) {
+        Logger::Log(LogLevel::Error, "Failed to send command, error: %s", Utils::GetLastErrorString().c_str());
+        IPCBufferPool::Release(m_writeBuffer);
+        
+        // 在途请求由事件循环在本轮结束前统一失败
+        m_broken = true;
+        Wake();
+        return;
+    }
+    m_writing = true;
+}
+
+void IPCAsyncClient::OnReadCompleted(BOOL success, DWORD bytesTransferred) {
+    m_reading = false;
+    if (!success || bytesTransferred == 0) {
+        FailAll();
+        return;
+    }
+    
+    if (DeliverResponses(m_buffer, bytesTransferred)) {
+        BeginRead();
+    }
+}
+
+void IPCAsyncClient::OnWriteCompleted(BOOL success) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_writing = false;
+    IPCBufferPool::Release(m_writeBuffer);
+    
+    if (!success) {
+        m_broken = true;
+        return;
+    }
+    BeginWrite();
+}
+#else
+void IPCAsyncClient::BeginWrite() {
+    // 调用时持有m_mutex
+    if (m_writing || m_broken || m_pendingWrites.empty()) {
+        return;
+    }
+    
+    m_writeBuffer.swap(m_pendingWrites);
+    m_writeOffset = 0;
+    m_writing = true;
+    ContinueWrite();
+}
+
+void IPCAsyncClient::ContinueWrite() {
+    // 调用时持有m_mutex。非阻塞写出，发送缓冲满时等待EPOLLOUT后继续
+    while (m_writing) {
+        ssize_t written = send(m_socket, m_writeBuffer.data() + m_writeOffset, m_writeBuffer.length() - m_writeOffset,
+                               MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            
+            ::SetLastError(errno);
+            Logger::Log(LogLevel::Error, "Failed to send command, error: %s", Utils::GetLastErrorString().c_str());
+            IPCBufferPool::Release(m_writeBuffer);
+            m_writing = false;
+            
+            // 在途请求由事件循环在本轮结束前统一失败
+            m_broken = true;
+            return;
+        }
+        
+        m_writeOffset += static_cast<size_t>(written);
+        if (m_writeOffset == m_writeBuffer.length()) {
+            IPCBufferPool::Release(m_writeBuffer);
+            m_writing = false;
+            BeginWrite();
+        }
+    }
+    
+    bool waitWritable = m_writing;
+    if (waitWritable != m_waitWritable) {
+        epoll_event event = {};
+        event.events = waitWritable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.fd = m_socket;
+        epoll_ctl(m_epoll, EPOLL_CTL_MOD, m_socket, &event);
+        m_waitWritable = waitWritable;
+    }
+}
+
+void IPCAsyncClient::OnSocketReadable() {
+    while (true) {
+        ssize_t received = recv(m_socket, m_buffer, sizeof(m_buffer), MSG_DONTWAIT);
+        if (received > 0) {
+            if (!DeliverResponses(m_buffer, static_cast<size_t>(received))) {
+                return;
+            }
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        
+        // 服务器关闭连接或读取出错
+        FailAll();
+        return;
+    }
+}
+#endif
+
+bool IPCAsyncClient::DeliverResponses(const char* data, size_t size) {
+    m_reader.Append(data, size);
+    
+    uint32_t requestId;
+    uint16_t type;
+    String response;
+    while (m_reader.NextMessage(requestId, type, response)) {
+        // 已超时或取消的请求不在表中，其响应直接丢弃
+        Completion completion;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_pending.find(requestId);
+            if (it == m_pending.end()) {
+                continue;
+            }
+            completion = std::move(it->second.completion);
+            m_pending.erase(it);
+        }
+        completion(IPCAsyncStatus::Completed, response);
+    }
+    
+    if (m_reader.HasError()) {
+        Logger::Log(LogLevel::Error, "Invalid IPC frame received");
+        FailAll();
+        return false;
+    }
+    return true;
+}
+
+void IPCAsyncClient::DeliverCancelled() {
+    std::vector<Completion> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        cancelled.swap(m_cancelled);
+    }
+    
+    String empty;
+    for (Completion& completion : cancelled) {
+        completion(IPCAsyncStatus::Cancelled, empty);
+    }
+}
+
+void IPCAsyncClient::ExpireRequests() {
+    std::vector<Completion> expired;
+    bool broken;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        broken = m_broken;
+        
+        ULONGLONG now = GetTickCount64();
+        while (!m_deadlines.empty() && m_deadlines.top().first <= now) {
+            uint32_t requestId = m_deadlines.top().second;
+            ULONGLONG deadline = m_deadlines.top().first;
+            m_deadlines.pop();
+            
+            // 已结束的请求或ID被复用后的新请求都不受旧截止时间影响
+            auto it = m_pending.find(requestId);
+            if (it != m_pending.end() && it->second.deadline == deadline) {
+                expired.push_back(std::move(it->second.completion));
+                m_pending.erase(it);
+            }
+        }
+    }
+    
+    String empty;
+    for (Completion& completion : expired) {
+        completion(IPCAsyncStatus::TimedOut, empty);
+    }
+    
+    if (broken) {
+        FailAll();
+    }
+}
+
+DWORD IPCAsyncClient::GetWaitTimeout(DWORD timeoutMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    // 跳过已结束请求的截止时间
+    while (!m_deadlines.empty()) {
+        auto it = m_pending.find(m_deadlines.top().second);
+        if (it != m_pending.end() && it->second.deadline == m_deadlines.top().first) {
+            break;
+        }
+        m_deadlines.pop();
+    }
+    
+    if (m_deadlines.empty()) {
+        return timeoutMs;
+    }
+    
+    ULONGLONG now = GetTickCount64();
+    ULONGLONG deadline = m_deadlines.top().first;
+    DWORD untilDeadline = deadline > now ? static_cast<DWORD>(deadline - now) : 0;
+    return std::min(timeoutMs, untilDeadline);
+}
+
+void IPCAsyncClient::FailAll() {
+    std::unordered_map<uint32_t, PendingRequest> pending;
+    std::vector<Completion> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_broken = true;
+        pending.swap(m_pending);
+        cancelled.swap(m_cancelled);
+        m_deadlines = decltype(m_deadlines)();
+    }
+    
+    String empty;
+    for (Completion& completion : cancelled) {
+        completion(IPCAsyncStatus::Cancelled, empty);
+    }
+    for (auto& entry : pending) {
+        entry.second.completion(IPCAsyncStatus::Disconnected, empty);
+    }
+}
+
+String IPCAsyncClient::GetLastErrorString() const {
+    switch (m_lastError) {
+        case ErrorCode::Success: return "Success";
+        case ErrorCode::InvalidParameter: return "Invalid parameter";
+        case ErrorCode::IPCConnectionFailed: return "IPC connection failed";
+        case ErrorCode::ServerBusy: return "Server busy";
+        default: return "Unknown error";
+    }
+}
+
+void IPCAsyncClient::SetLastError(ErrorCode error) {
+    m_lastError = error;
+}
\ No newline at end of file
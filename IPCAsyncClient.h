@@ -0,0 +1,149 @@
+#pragma once
+
+#include "Common.h"
+#include "Logger.h"
+#include "IPCFrame.h"
+#include "IPCProtocol.h"
+#include "Utils.h"
+#include <future>
+#include <queue>
+#include <unordered_map>
+
+// 异步请求的结束方式
+enum class IPCAsyncStatus {
+    Completed = 0,     // 收到响应
+    TimedOut = 1,      // 截止时间前未收到响应
+    Cancelled = 2,     // 调用了Cancel
+    Disconnected = 3   // 连接断开或发送失败
+};
+
+struct IPCAsyncReply {
+    IPCAsyncStatus status;
+    String response;
+    
+    IPCAsyncReply() : status(IPCAsyncStatus::Disconnected) {}
+};
+
+struct IPCAsyncResult {
+    IPCAsyncStatus status;
+    IPCResult result;
+    
+    IPCAsyncResult() : status(IPCAsyncStatus::Disconnected) {}
+};
+
+using IPCReplyCallback = std::function<void(IPCAsyncStatus status, const String& response)>;
+using IPCResultCallback = std::function<void(IPCAsyncStatus status, const IPCResult& result)>;
+
+// 异步IPC客户端：同一连接上可以有任意数量的请求在途，全部读写和超时由一个事件循环线程驱动。
+// 请求可以在任意线程发起，回调总在运行事件循环的线程上调用，回调中可以继续发起请求。
+// Windows上为重叠I/O的命名管道加完成端口，Linux上为非阻塞Unix域套接字加epoll，以eventfd唤醒事件循环
+class IPCAsyncClient {
+public:
+    IPCAsyncClient();
+    ~IPCAsyncClient();
+    
+    // 禁用拷贝构造和赋值
+    IPCAsyncClient(const IPCAsyncClient&) = delete;
+    IPCAsyncClient& operator=(const IPCAsyncClient&) = delete;
+    
+    // 管道实例全忙时最多等待timeoutMs
+    bool Connect(const WString& pipeName, DWORD timeoutMs = 5000);
+    
+    // 须在事件循环退出后调用，未完成的请求以Disconnected结束
+    void Disconnect();
+#ifdef _WIN32
+    bool IsConnected() const { return m_pipe != INVALID_HANDLE_VALUE; }
+#else
+    bool IsConnected() const { return m_socket >= 0; }
+#endif
+    
+    // deadlineMs为从发起时起算的超时，INFINITE表示不设截止时间。
+    // 返回请求ID，失败时返回0，此时回调不会被调用
+    uint32_t SendAsync(const String& command, DWORD deadlineMs, IPCReplyCallback callback);
+    uint32_t CallAsync(const IPCRequest& request, DWORD deadlineMs, IPCResultCallback callback);
+    
+    // 以future形式返回结果，requestId非空时返回请求ID以便取消
+    std::future<IPCAsyncReply> Send(const String& command, DWORD deadlineMs = INFINITE, uint32_t* requestId = nullptr);
+    std::future<IPCAsyncResult> Call(const IPCRequest& request, DWORD deadlineMs = INFINITE, uint32_t* requestId = nullptr);
+    
+    // 取消在途请求，回调以Cancelled调用，之后到达的响应被丢弃；请求已结束时返回false
+    bool Cancel(uint32_t requestId);
+    
+    // 运行事件循环，直到调用Stop或连接断开
+    void Run();
+    
+    // 处理一个完成通知以及到期的请求，最多等待timeoutMs；连接已断开时返回false
+    bool RunOnce(DWORD timeoutMs);
+    
+    // 可在任意线程调用
+    void Stop();
+    
+    size_t GetPendingCount() const;
+    
+    // 错误处理
+    ErrorCode GetLastError() const { return m_lastError; }
+    String GetLastErrorString() const;
+
+private:
+    using Completion = std::function<void(IPCAsyncStatus status, String& response)>;
+    using Deadline = std::pair<ULONGLONG, uint32_t>;
+    
+    struct PendingRequest {
+        Completion completion;
+        ULONGLONG deadline;   // 0表示不设截止时间
+    };
+
+#ifdef _WIN32
+    enum CompletionKey : ULONG_PTR {
+        KeyPipe = 1,
+        KeyWake = 2,   // 有新的待写数据或需要重新计算等待时间
+        KeyStop = 3
+    };
+    
+    HANDLE m_pipe;
+    HANDLE m_completionPort;
+    OVERLAPPED m_readOverlapped;
+    OVERLAPPED m_writeOverlapped;
+    bool m_reading;
+#else
+    int m_socket;
+    int m_epoll;
+    int m_wakeEvent;       // eventfd，可读表示有新的待写数据或需要重新计算等待时间
+    size_t m_writeOffset;  // m_writeBuffer中已写出的字节数
+    bool m_waitWritable;   // 套接字发送缓冲已满，正在等待EPOLLOUT
+#endif
+    char m_buffer[IPCFrame::kMaxFrameBytes];
+    IPCFrameReader m_reader;
+    std::atomic<bool> m_stopRequested;
+    
+    // 以下成员由m_mutex保护
+    mutable std::mutex m_mutex;
+    String m_writeBuffer;
+    String m_pendingWrites;
+    bool m_writing;
+    bool m_broken;
+    uint32_t m_nextRequestId;
+    std::unordered_map<uint32_t, PendingRequest> m_pending;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> m_deadlines;
+    std::vector<Completion> m_cancelled;
+    
+    ErrorCode m_lastError;
+    
+    uint32_t Submit(uint16_t type, const String& payload, DWORD deadlineMs, Completion completion);
+    void Wake();
+    void BeginWrite();
+    bool DeliverResponses(const char* data, size_t size);
+#ifdef _WIN32
+    void BeginRead();
+    void OnReadCompleted(BOOL success, DWORD bytesTransferred);
+    void OnWriteCompleted(BOOL success);
+#else
+    void OnSocketReadable();
+    void ContinueWrite();
+#endif
+    void DeliverCancelled();
+    void ExpireRequests();
+    DWORD GetWaitTimeout(DWORD timeoutMs);
+    void FailAll();
+    void SetLastError(ErrorCode error);
+};
\ No newline at end of file
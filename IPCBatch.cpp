@@ -0,0 +1,117 @@
+#include "IPCBatch.h"
+
+namespace {
+
+void AppendUInt32(String& out, uint32_t value) {
+    char bytes[sizeof(value)];
+    memcpy(bytes, &value, sizeof(value));
+    out.append(bytes, sizeof(value));
+}
+
+void AppendString(String& out, const String& value) {
+    AppendUInt32(out, static_cast<uint32_t>(value.length()));
+    out += value;
+}
+
+class BatchReader {
+public:
+    explicit BatchReader(const String& data) : m_data(data), m_offset(0) {}
+    
+    bool AtEnd() const { return m_offset == m_data.size(); }
+    
+    bool ReadUInt8(uint8_t& value) {
+        if (m_data.size() - m_offset < sizeof(value)) {
+            return false;
+        }
+        value = static_cast<uint8_t>(m_data[m_offset++]);
+        return true;
+    }
+    
+    bool ReadUInt32(uint32_t& value) {
+        if (m_data.size() - m_offset < sizeof(value)) {
+            return false;
+        }
+        memcpy(&value, m_data.data() + m_offset, sizeof(value));
+        m_offset += sizeof(value);
+        return true;
+    }
+    
+    bool ReadString(String& value) {
+        uint32_t length;
+        if (!ReadUInt32(length) || m_data.size() - m_offset < length) {
+            return false;
+        }
+        value.assign(m_data.data() + m_offset, length);
+        m_offset += length;
+        return true;
+    }
+
+private:
+    const String& m_data;
+    size_t m_offset;
+};
+
+} // namespace
+
+void IPCBatch::EncodeRequest(const std::vector<String>& commands, IPCBatchMode mode, String& out) {
+    out.push_back(static_cast<char>(mode));
+    AppendUInt32(out, static_cast<uint32_t>(commands.size()));
+    for (const auto& command : commands) {
+        AppendString(out, command);
+    }
+}
+
+bool IPCBatch::DecodeRequest(const String& data, std::vector<String>& commands, IPCBatchMode& mode) {
+    BatchReader reader(data);
+    uint8_t modeValue;
+    uint32_t count;
+    if (!reader.ReadUInt8(modeValue) || !reader.ReadUInt32(count) ||
+        modeValue > static_cast<uint8_t>(IPCBatchMode::Parallel) || count > kMaxCommands) {
+        return false;
+    }
+    
+    mode = static_cast<IPCBatchMode>(modeValue);
+    commands.resize(count);
+    for (auto& command : commands) {
+        if (!reader.ReadString(command)) {
+            return false;
+        }
+    }
+    return reader.AtEnd();
+}
+
+size_t IPCBatch::GetCommandCount(const String& data) {
+    BatchReader reader(data);
+    uint8_t modeValue;
+    uint32_t count;
+    if (!reader.ReadUInt8(modeValue) || !reader.ReadUInt32(count)) {
+        return 0;
+    }
+    return count;
+}
+
+void IPCBatch::EncodeResponse(const std::vector<IPCBatchResult>& results, String& out) {
+    AppendUInt32(out, static_cast<uint32_t>(results.size()));
+    for (const auto& result : results) {
+        out.push_back(result.success ? 1 : 0);
+        AppendString(out, result.response);
+    }
+}
+
+bool IPCBatch::DecodeResponse(const String& data, std::vector<IPCBatchResult>& results) {
+    BatchReader reader(data);
+    uint32_t count;
+    if (!reader.ReadUInt32(count) || count > kMaxCommands) {
+        return false;
+    }
+    
+    results.resize(count);
+    for (auto& result : results) {
+        uint8_t success;
+        if (!reader.ReadUInt8(success) || !reader.ReadString(result.response)) {
+            return false;
+        }
+        result.success = success != 0;
+    }
+    return reader.AtEnd();
+}
\ No newline at end of file
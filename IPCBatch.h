@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Common.h"
+
+// 批量命令的执行方式
+enum class IPCBatchMode : uint8_t {
+    Sequential = 0,  // 按顺序逐条执行
+    Parallel = 1     // 分发到多个工作线程并行执行
+};
+
+struct IPCBatchResult {
+    bool success;
+    String response;
+    
+    IPCBatchResult() : success(false) {}
+};
+
+// 批量命令编码，作为MessageBatch类型的消息内容，整数均为小端序：
+//   请求 [mode u8][count u32] 后跟count个 [length u32][命令]
+//   响应 [count u32] 后跟count个 [success u8][length u32][响应]，顺序与请求一致
+namespace IPCBatch {
+
+const size_t kMaxCommands = 4096;
+
+void EncodeRequest(const std::vector<String>& commands, IPCBatchMode mode, String& out);
+bool DecodeRequest(const String& data, std::vector<String>& commands, IPCBatchMode& mode);
+
+// 只读取请求头中的命令数，用于准入检查；请求头不完整时返回0
+size_t GetCommandCount(const String& data);
+
+void EncodeResponse(const std::vector<IPCBatchResult>& results, String& out);
+bool DecodeResponse(const String& data, std::vector<IPCBatchResult>& results);
+
+} // namespace IPCBatch
\ No newline at end of file
@@ -0,0 +1,428 @@
+#include "IPCClient.h"
+#include <algorithm>
+
+#ifndef _WIN32
+#include "IPCSocket.h"
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+IPCClient::IPCClient()
+#ifdef _WIN32
+    : m_pipe(INVALID_HANDLE_VALUE)
+#else
+    : m_socket(-1)
+#endif
+    , m_timeoutMs(5000)
+    , m_serverProcess(kNoPeerProcess)
+    , m_nextRequestId(1)
+    , m_pendingCount(0)
+    , m_lastError(ErrorCode::Success) {
+}
+
+IPCClient::~IPCClient() {
+    Disconnect();
+}
+
+bool IPCClient::Connect(const WString& pipeName, DWORD timeoutMs) {
+    Disconnect();
+    
+    m_timeoutMs = timeoutMs;
+#ifdef _WIN32
+    ULONGLONG deadline = GetTickCount64() + timeoutMs;
+    while (true) {
+        m_pipe = CreateFileW(
+            pipeName.c_str(),
+            GENERIC_READ | GENERIC_WRITE,
+            0,
+            NULL,
+            OPEN_EXISTING,
+            0,
+            NULL
+        );
+        
+        if (m_pipe != INVALID_HANDLE_VALUE) {
+            return true;
+        }
+        
+        // 所有实例都在服务其他客户端时等待空闲实例
+        ULONGLONG now = GetTickCount64();
+        if (::GetLastError() != ERROR_PIPE_BUSY || now >= deadline ||
+            !WaitNamedPipeW(pipeName.c_str(), static_cast<DWORD>(deadline - now))) {
+            break;
+        }
+    }
+#else
+    m_socket = IPCSocket::Connect(IPCSocket::GetSocketPath(pipeName), timeoutMs);
+    if (m_socket >= 0) {
+        return true;
+    }
+#endif
+    
+    Logger::Log(LogLevel::Error, "Failed to connect to IPC server, error: %s", Utils::GetLastErrorString().c_str());
+    SetLastError(ErrorCode::IPCConnectionFailed);
+    return false;
+}
+
+void IPCClient::Disconnect() {
+    // 关闭通道会通知服务器结束对应的会话
+    if (m_channel) {
+        m_channel->Close();
+        m_channel.reset();
+    }
+    
+    IPCSharedChannel::ClosePeerProcess(m_serverProcess);
+
+#ifdef _WIN32
+    if (m_pipe != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_pipe);
+        m_pipe = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_socket >= 0) {
+        close(m_socket);
+        m_socket = -1;
+    }
+#endif
+    
+    m_reader.Reset();
+    m_responses.clear();
+    m_events.clear();
+    m_pendingCount = 0;
+}
+
+bool IPCClient::Send(const String& command, uint32_t& requestId) {
+    return SendPayload(IPCFrame::MessageCommand, command, requestId);
+}
+
+bool IPCClient::SendBatch(const std::vector<String>& commands, IPCBatchMode mode, uint32_t& requestId) {
+    if (commands.empty() || commands.size() > IPCBatch::kMaxCommands) {
+        SetLastError(ErrorCode::InvalidParameter);
+        return false;
+    }
+    
+    String payload;
+    IPCBatch::EncodeRequest(commands, mode, payload);
+    return SendPayload(IPCFrame::MessageBatch, payload, requestId);
+}
+
+bool IPCClient::SendPayload(uint16_t type, const String& payload, uint32_t& requestId) {
+    if (!IsConnected()) {
+        SetLastError(ErrorCode::IPCConnectionFailed);
+        return false;
+    }
+    
+    // 0保留给一次性请求
+    requestId = m_nextRequestId++;
+    if (m_nextRequestId == 0) {
+        m_nextRequestId = 1;
+    }
+    
+    String request = IPCBufferPool::Acquire();
+    IPCFrame::AppendMessage(request, requestId, payload, type);
+    
+    if (!WriteData(request)) {
+        IPCBufferPool::Release(request);
+        Disconnect();
+        return false;
+    }
+    
+    IPCBufferPool::Release(request);
+    m_pendingCount++;
+    return true;
+}
+
+bool IPCClient::Receive(uint32_t requestId, String& response) {
+    auto it = m_responses.find(requestId);
+    if (it != m_responses.end()) {
+        response.swap(it->second);
+        m_responses.erase(it);
+        return true;
+    }
+    
+    while (true) {
+        uint32_t receivedId;
+        String received;
+        if (!ReadResponse(receivedId, received)) {
+            return false;
+        }
+        
+        if (receivedId == requestId) {
+            response.swap(received);
+            return true;
+        }
+        m_responses[receivedId].swap(received);
+    }
+}
+
+bool IPCClient::Request(const String& command, String& response) {
+    uint32_t requestId;
+    return Send(command, requestId) && Receive(requestId, response);
+}
+
+bool IPCClient::ReceiveBatch(uint32_t requestId, std::vector<IPCBatchResult>& results) {
+    String response;
+    if (!Receive(requestId, response)) {
+        return false;
+    }
+    
+    if (!IPCBatch::DecodeResponse(response, results)) {
+        Logger::Log(LogLevel::Error, "Invalid batch response received");
+        SetLastError(ErrorCode::UnknownError);
+        return false;
+    }
+    return true;
+}
+
+bool IPCClient::RequestBatch(const std::vector<String>& commands, IPCBatchMode mode, std::vector<IPCBatchResult>& results) {
+    uint32_t requestId;
+    return SendBatch(commands, mode, requestId) && ReceiveBatch(requestId, results);
+}
+
+bool IPCClient::SendRequest(const IPCRequest& request, uint32_t& requestId) {
+    String payload;
+    IPCProtocol::EncodeRequest(request, payload);
+    return SendPayload(IPCFrame::MessageBinary, payload, requestId);
+}
+
+bool IPCClient::ReceiveResult(uint32_t requestId, IPCResult& result) {
+    String response;
+    if (!Receive(requestId, response)) {
+        return false;
+    }
+    
+    if (!IPCProtocol::DecodeResult(response, result)) {
+        Logger::Log(LogLevel::Error, "Invalid binary response received");
+        SetLastError(ErrorCode::UnknownError);
+        return false;
+    }
+    return true;
+}
+
+bool IPCClient::Call(const IPCRequest& request, IPCResult& result) {
+    uint32_t requestId;
+    return SendRequest(request, requestId) && ReceiveResult(requestId, result);
+}
+
+bool IPCClient::ReadResponse(uint32_t& requestId, String& response) {
+    // 响应类型与请求一致，由调用方按所发请求解析；推送的事件暂存到m_events
+    uint16_t type;
+    while (true) {
+        if (!ReadMessage(requestId, type, response)) {
+            return false;
+        }
+        if (type != IPCFrame::MessageEvent) {
+            break;
+        }
+        m_events.push_back(std::move(response));
+    }
+    
+    if (m_pendingCount > 0) {
+        m_pendingCount--;
+    }
+    return true;
+}
+
+bool IPCClient::ReadMessage(uint32_t& requestId, uint16_t& type, String& message) {
+    char buffer[16 * 1024];
+    while (!m_reader.NextMessage(requestId, type, message)) {
+        DWORD bytesRead;
+        if (m_reader.HasError() || !IsConnected() || !ReadData(buffer, sizeof(buffer), bytesRead)) {
+            Logger::Log(LogLevel::Error, "Failed to read response, error: %s", Utils::GetLastErrorString().c_str());
+            SetLastError(ErrorCode::IPCConnectionFailed);
+            Disconnect();
+            return false;
+        }
+        m_reader.Append(buffer, bytesRead);
+    }
+    return true;
+}
+
+bool IPCClient::Subscribe(uint32_t eventMask) {
+    if (m_channel) {
+        SetLastError(ErrorCode::InvalidParameter);
+        return false;
+    }
+    
+    String payload(reinterpret_cast<const char*>(&eventMask), sizeof(eventMask));
+    uint32_t requestId;
+    String response;
+    if (!SendPayload(IPCFrame::MessageSubscribe, payload, requestId) || !Receive(requestId, response)) {
+        return false;
+    }
+    
+    if (response != payload) {
+        Logger::Log(LogLevel::Error, "Invalid subscribe response received");
+        SetLastError(ErrorCode::UnknownError);
+        return false;
+    }
+    
+    // 取消订阅前已推送的事件不再有意义
+    if (eventMask == 0) {
+        m_events.clear();
+    }
+    return true;
+}
+
+bool IPCClient::WaitEvent(IPCEvent& event) {
+    String message;
+    while (m_events.empty()) {
+        uint32_t requestId;
+        uint16_t type;
+        if (!ReadMessage(requestId, type, message)) {
+            return false;
+        }
+        
+        if (type == IPCFrame::MessageEvent) {
+            m_events.push_back(std::move(message));
+        } else {
+            m_responses[requestId].swap(message);
+            if (m_pendingCount > 0) {
+                m_pendingCount--;
+            }
+        }
+    }
+    
+    message.swap(m_events.front());
+    m_events.pop_front();
+    if (!IPCProtocol::DecodeEvent(message, event)) {
+        Logger::Log(LogLevel::Error, "Invalid event received");
+        SetLastError(ErrorCode::UnknownError);
+        return false;
+    }
+    return true;
+}
+
+bool IPCClient::WriteData(const String& data) {
+    if (m_channel) {
+        if (!m_channel->GetRequestRing().Write(data.c_str(), data.length(), m_timeoutMs)) {
+            Logger::Log(LogLevel::Error, "Failed to send command over shared memory channel");
+            SetLastError(ErrorCode::IPCConnectionFailed);
+            return false;
+        }
+        return true;
+    }
+
+#ifdef _WIN32
+    size_t offset = 0;
+    while (offset < data.length()) {
+        DWORD bytesWritten;
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(data.length() - offset, IPCFrame::kMaxFrameBytes));
+        if (!WriteFile(m_pipe, data.c_str() + offset, chunk, &bytesWritten, NULL)) {
+            Logger::Log(LogLevel::Error, "Failed to send command, error: %s", Utils::GetLastErrorString().c_str());
+            SetLastError(::GetLastError());
+            return false;
+        }
+        offset += bytesWritten;
+    }
+    return true;
+#else
+    if (!IPCSocket::SendAll(m_socket, data.c_str(), data.length())) {
+        Logger::Log(LogLevel::Error, "Failed to send command, error: %s", Utils::GetLastErrorString().c_str());
+        SetLastError(::GetLastError());
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool IPCClient::ReadData(char* buffer, size_t size, DWORD& bytesRead) {
+    if (m_channel) {
+        bytesRead = static_cast<DWORD>(m_channel->GetResponseRing().Read(buffer, size, INFINITE, m_serverProcess));
+        return bytesRead > 0;
+    }
+
+#ifdef _WIN32
+    return ReadFile(m_pipe, buffer, static_cast<DWORD>(size), &bytesRead, NULL) && bytesRead > 0;
+#else
+    ssize_t received;
+    do {
+        received = recv(m_socket, buffer, size, 0);
+    } while (received < 0 && errno == EINTR);
+    
+    // 对端关闭时recv返回0
+    if (received <= 0) {
+        ::SetLastError(received == 0 ? static_cast<DWORD>(ERROR_BROKEN_PIPE) : static_cast<DWORD>(errno));
+        bytesRead = 0;
+        return false;
+    }
+    bytesRead = static_cast<DWORD>(received);
+    return true;
+#endif
+}
+
+bool IPCClient::EnableSharedMemory(size_t capacity) {
+    if (m_channel) {
+        return true;
+    }
+    
+    // 未完成请求的响应仍会从管道返回，不能在此时切换
+    if (m_pendingCount > 0 || capacity > IPCSharedChannel::kMaxCapacity) {
+        SetLastError(ErrorCode::InvalidParameter);
+        return false;
+    }
+    
+    uint32_t requested = static_cast<uint32_t>(capacity);
+    String payload(reinterpret_cast<const char*>(&requested), sizeof(requested));
+    uint32_t requestId;
+    String name;
+    if (!SendPayload(IPCFrame::MessageSharedMemory, payload, requestId) || !Receive(requestId, name)) {
+        return false;
+    }
+    
+    if (name.empty()) {
+        Logger::Log(LogLevel::Warning, "IPC server refused shared memory channel, using pipe");
+        SetLastError(ErrorCode::AccessDenied);
+        return false;
+    }
+    
+    auto channel = std::make_unique<IPCSharedChannel>();
+    if (!channel->Open(name)) {
+        Logger::Log(LogLevel::Error, "Failed to open shared memory channel, error: %s", Utils::GetLastErrorString().c_str());
+        SetLastError(::GetLastError());
+        return false;
+    }
+    
+    // 无法打开服务器进程时只依赖通道的关闭标志
+#ifdef _WIN32
+    ULONG serverProcessId = 0;
+    if (GetNamedPipeServerProcessId(m_pipe, &serverProcessId)) {
+        m_serverProcess = IPCSharedChannel::OpenPeerProcess(serverProcessId);
+    }
+#else
+    DWORD serverProcessId = IPCSocket::GetPeerProcessId(m_socket);
+    if (serverProcessId != 0) {
+        m_serverProcess = IPCSharedChannel::OpenPeerProcess(serverProcessId);
+    }
+#endif
+    
+    m_channel = std::move(channel);
+    LOG_DEBUG("Shared memory channel %s enabled", name.c_str());
+    return true;
+}
+
+String IPCClient::GetLastErrorString() const {
+    switch (m_lastError) {
+        case ErrorCode::Success: return "Success";
+        case ErrorCode::InvalidParameter: return "Invalid parameter";
+        case ErrorCode::AccessDenied: return "Access denied";
+        case ErrorCode::IPCConnectionFailed: return "IPC connection failed";
+        case ErrorCode::ServerBusy: return "Server busy";
+        default: return "Unknown error";
+    }
+}
+
+void IPCClient::SetLastError(ErrorCode error) {
+    m_lastError = error;
+}
+
+void IPCClient::SetLastError(DWORD win32Error) {
+    switch (win32Error) {
+        case ERROR_ACCESS_DENIED: m_lastError = ErrorCode::AccessDenied; break;
+        case ERROR_INVALID_PARAMETER: m_lastError = ErrorCode::InvalidParameter; break;
+        case ERROR_BROKEN_PIPE:
+        case ERROR_NO_DATA:
+        case ERROR_PIPE_NOT_CONNECTED: m_lastError = ErrorCode::IPCConnectionFailed; break;
+        default: m_lastError = ErrorCode::UnknownError; break;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Common.h"
+#include "Logger.h"
+#include "IPCFrame.h"
+#include "IPCBatch.h"
+#include "IPCProtocol.h"
+#include "IPCSharedChannel.h"
+#include "Utils.h"
+#include <unordered_map>
+#include <deque>
+
+// 持久IPC客户端会话：连接建立后可连续发送多个请求，
+// 通过请求ID关联响应，服务器可以乱序返回。同一会话只应由一个线程使用
+class IPCClient {
+public:
+    IPCClient();
+    ~IPCClient();
+    
+    // 禁用拷贝构造和赋值
+    IPCClient(const IPCClient&) = delete;
+    IPCClient& operator=(const IPCClient&) = delete;
+    
+    // 管道实例全忙时最多等待timeoutMs
+    bool Connect(const WString& pipeName, DWORD timeoutMs = 5000);
+    void Disconnect();
+#ifdef _WIN32
+    bool IsConnected() const { return m_pipe != INVALID_HANDLE_VALUE; }
+#else
+    bool IsConnected() const { return m_socket >= 0; }
+#endif
+    
+    // 发送请求但不等待响应，返回请求ID
+    bool Send(const String& command, uint32_t& requestId);
+    
+    // 等待指定请求的响应，期间收到的其他响应会暂存
+    bool Receive(uint32_t requestId, String& response);
+    
+    // 发送请求并等待响应
+    bool Request(const String& command, String& response);
+    
+    // 批量命令：一个请求携带多条命令，响应中按顺序给出每条命令的结果
+    bool SendBatch(const std::vector<String>& commands, IPCBatchMode mode, uint32_t& requestId);
+    bool ReceiveBatch(uint32_t requestId, std::vector<IPCBatchResult>& results);
+    bool RequestBatch(const std::vector<String>& commands, IPCBatchMode mode, std::vector<IPCBatchResult>& results);
+    
+    // 二进制命令：返回false表示通信失败，命令本身的执行结果见result.status
+    bool SendRequest(const IPCRequest& request, uint32_t& requestId);
+    bool ReceiveResult(uint32_t requestId, IPCResult& result);
+    bool Call(const IPCRequest& request, IPCResult& result);
+    
+    // 与服务器协商共享内存通道，成功后本会话的请求和响应都改由通道传输；
+    // 须在没有未完成请求时调用，服务器拒绝时会话继续使用管道
+    bool EnableSharedMemory(size_t capacity = IPCSharedChannel::kDefaultCapacity);
+    bool IsSharedMemoryEnabled() const { return m_channel != nullptr; }
+    
+    // 订阅服务器事件，eventMask为IPCEventMask的组合，0表示取消订阅。
+    // 事件只经由管道推送，启用共享内存通道后不能订阅
+    bool Subscribe(uint32_t eventMask);
+    
+    // 阻塞等待下一个事件，期间收到的响应会暂存
+    bool WaitEvent(IPCEvent& event);
+    
+    size_t GetPendingCount() const { return m_pendingCount; }
+    
+    // 错误处理
+    ErrorCode GetLastError() const { return m_lastError; }
+    String GetLastErrorString() const;
+
+private:
+#ifdef _WIN32
+    HANDLE m_pipe;
+#else
+    int m_socket;             // 服务器的Unix域套接字，见IPCSocket
+#endif
+    DWORD m_timeoutMs;
+    std::unique_ptr<IPCSharedChannel> m_channel;
+    IPCPeerProcess m_serverProcess;   // 服务器退出时结束对共享内存通道的等待
+    uint32_t m_nextRequestId;
+    size_t m_pendingCount;
+    IPCFrameReader m_reader;
+    std::unordered_map<uint32_t, String> m_responses;
+    std::deque<String> m_events;
+    ErrorCode m_lastError;
+    
+    bool SendPayload(uint16_t type, const String& payload, uint32_t& requestId);
+    bool ReadResponse(uint32_t& requestId, String& response);
+    bool ReadMessage(uint32_t& requestId, uint16_t& type, String& message);
+    bool WriteData(const String& data);
+    bool ReadData(char* buffer, size_t size, DWORD& bytesRead);
+    void SetLastError(ErrorCode error);
+    void SetLastError(DWORD win32Error);
+};
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "IPCCommandPool.h"
+#include "Logger.h"
+#include "Utils.h"
+
+thread_local IPCCommandPool::Worker* IPCCommandPool::t_worker = nullptr;
+
+IPCCommandPool::IPCCommandPool()
+    : m_accepting(false)
+    , m_queued(0)
+    , m_nextWorker(0)
+    , m_running{}
+    , m_stopping(false) {
+}
+
+IPCCommandPool::~IPCCommandPool() {
+    Stop();
+}
+
+bool IPCCommandPool::Start(const IPCCommandPoolConfig& config) {
+    Stop();
+    m_config = config;
+    
+    DWORD threadCount = config.threadCount;
+    if (threadCount == 0) {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        
+        // 受限类别全部占满时至少还留一个线程处理查询
+        DWORD reserved = 0;
+        for (size_t i = static_cast<size_t>(IPCCommandClass::ProcessControl); i < kClassCount; ++i) {
+            reserved += config.classLimits[i];
+        }
+        threadCount = std::max<DWORD>(systemInfo.dwNumberOfProcessors, reserved + 1);
+    }
+    
+    m_stopping = false;
+    for (DWORD i = 0; i < threadCount; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->pool = this;
+        worker->index = i;
+        m_workers.push_back(std::move(worker));
+    }
+    
+    m_accepting = true;
+    for (auto& worker : m_workers) {
+        worker->thread = CreateThread(NULL, 0, WorkerThreadProc, worker.get(), 0, NULL);
+        if (!worker->thread) {
+            Logger::Log(LogLevel::Error, "Failed to create command thread, error: %s", Utils::GetLastErrorString().c_str());
+            Stop();
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void IPCCommandPool::Stop() {
+    m_accepting = false;
+    if (m_workers.empty()) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeup.notify_all();
+    
+    for (auto& worker : m_workers) {
+        if (worker->thread) {
+            WaitForSingleObject(worker->thread, INFINITE);
+            CloseHandle(worker->thread);
+        }
+    }
+    m_workers.clear();
+}
+
+bool IPCCommandPool::Submit(IPCCommandClass commandClass, Task task) {
+    if (!m_accepting) {
+        return false;
+    }
+    
+    Worker* worker = t_worker;
+    if (!worker || worker->pool != this) {
+        worker = m_workers[m_nextWorker++ % m_workers.size()].get();
+    }
+    
+    Item item;
+    item.commandClass = commandClass;
+    item.task = std::move(task);
+    Enqueue(worker, std::move(item));
+    return true;
+}
+
+void IPCCommandPool::Enqueue(Worker* worker, Item&& item) {
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->lanes[static_cast<size_t>(item.commandClass)].push_back(std::move(item));
+    }
+    m_queued++;
+    
+    // 持有m_mutex通知，避免与检查m_queued后进入等待的线程错过唤醒
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wakeup.notify_one();
+}
+
+DWORD WINAPI IPCCommandPool::WorkerThreadProc(LPVOID lpParam) {
+    Worker* worker = static_cast<Worker*>(lpParam);
+    if (!worker) {
+        return 1;
+    }
+    
+    t_worker = worker;
+    worker->pool->RunWorker(worker);
+    t_worker = nullptr;
+    return 0;
+}
+
+void IPCCommandPool::RunWorker(Worker* worker) {
+    while (true) {
+        Item item;
+        if (!TakeTask(worker, item)) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stopping && IsFinished()) {
+                break;
+            }
+            m_wakeup.wait(lock, [this]() {
+                return m_queued > 0 || (m_stopping && IsFinished());
+            });
+            continue;
+        }
+        
+        if (!AcquireSlot(item)) {
+            continue;
+        }
+        
+        IPCCommandClass commandClass = item.commandClass;
+        item.task();
+        item.task = nullptr;
+        ReleaseSlot(worker, commandClass);
+    }
+}
+
+bool IPCCommandPool::TakeTask(Worker* worker, Item& item) {
+    // 按优先级逐个类别查找：先取自己队列的头部，再从其他线程队列的尾部窃取
+    for (size_t lane = 0; lane < kClassCount; ++lane) {
+        for (size_t i = 0; i < m_workers.size(); ++i) {
+            Worker* victim = m_workers[(worker->index + i) % m_workers.size()].get();
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            std::deque<Item>& queue = victim->lanes[lane];
+            if (queue.empty()) {
+                continue;
+            }
+            
+            if (victim == worker) {
+                item = std::move(queue.front());
+                queue.pop_front();
+            } else {
+                item = std::move(queue.back());
+                queue.pop_back();
+            }
+            m_queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IPCCommandPool::AcquireSlot(Item& item) {
+    size_t index = static_cast<size_t>(item.commandClass);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    DWORD limit = m_config.classLimits[index];
+    if (limit == 0 || m_running[index] < limit) {
+        m_running[index]++;
+        return true;
+    }
+    
+    // 同类任务完成时再放回队列
+    m_deferred[index].push_back(std::move(item));
+    return false;
+}
+
+void IPCCommandPool::ReleaseSlot(Worker* worker, IPCCommandClass commandClass) {
+    size_t index = static_cast<size_t>(commandClass);
+    Item deferred;
+    bool resubmit = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running[index]--;
+        if (!m_deferred[index].empty()) {
+            deferred = std::move(m_deferred[index].front());
+            m_deferred[index].pop_front();
+            resubmit = true;
+        } else if (m_stopping && IsFinished()) {
+            m_wakeup.notify_all();
+        }
+    }
+    
+    if (resubmit) {
+        Enqueue(worker, std::move(deferred));
+    }
+}
+
+bool IPCCommandPool::IsFinished() const {
+    // 调用时持有m_mutex
+    if (m_queued > 0) {
+        return false;
+    }
+    for (size_t i = 0; i < kClassCount; ++i) {
+        if (m_running[i] > 0 || !m_deferred[i].empty()) {
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
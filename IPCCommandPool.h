@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Common.h"
+#include <deque>
+#include <condition_variable>
+
+// 命令类别，数值越小优先级越高
+enum class IPCCommandClass : uint8_t {
+    Query = 0,           // 状态查询及其他快速操作
+    ProcessControl = 1,  // 挂起、恢复、终止进程
+    ServiceControl = 2   // 安装、启停服务，可能耗时数秒
+};
+
+struct IPCCommandPoolConfig {
+    static const size_t kClassCount = 3;
+    
+    DWORD threadCount;                // 0表示自动：不少于CPU核数，且受限类别占满时仍有线程处理查询
+    DWORD classLimits[kClassCount];   // 每类命令同时执行的上限，0表示不限，按IPCCommandClass索引
+    
+    IPCCommandPoolConfig() : threadCount(0), classLimits{ 0, 4, 1 } {}
+};
+
+// 命令执行线程池：每个工作线程按类别维护本地队列，空闲时从其他线程的队列尾部窃取任务，
+// 总是先处理优先级高的类别。达到并发上限的类别的任务暂存，同类任务完成后再放回队列，
+// 因此耗时的服务操作不会占满全部线程，查询命令无需排在其后
+class IPCCommandPool {
+public:
+    using Task = std::function<void()>;
+    
+    IPCCommandPool();
+    ~IPCCommandPool();
+    
+    // 禁用拷贝构造和赋值
+    IPCCommandPool(const IPCCommandPool&) = delete;
+    IPCCommandPool& operator=(const IPCCommandPool&) = delete;
+    
+    bool Start(const IPCCommandPoolConfig& config);
+    
+    // 不再接受新任务（包括执行中的任务所提交的），执行完已提交的任务后停止
+    void Stop();
+    
+    // 可在任意线程调用，工作线程提交的任务优先进入自己的队列
+    bool Submit(IPCCommandClass commandClass, Task task);
+    
+    size_t GetThreadCount() const { return m_workers.size(); }
+
+private:
+    static const size_t kClassCount = IPCCommandPoolConfig::kClassCount;
+    
+    struct Item {
+        IPCCommandClass commandClass;
+        Task task;
+    };
+    
+    struct Worker {
+        IPCCommandPool* pool;
+        size_t index;
+        HANDLE thread;
+        std::mutex mutex;
+        std::deque<Item> lanes[kClassCount];
+        
+        Worker() : pool(nullptr), index(0), thread(NULL) {}
+    };
+    
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    IPCCommandPoolConfig m_config;
+    std::atomic<bool> m_accepting;
+    std::atomic<size_t> m_queued;        // 所有本地队列中的任务数
+    std::atomic<size_t> m_nextWorker;
+    
+    // 以下成员由m_mutex保护
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::deque<Item> m_deferred[kClassCount];
+    unsigned m_running[kClassCount];
+    bool m_stopping;
+    
+    static thread_local Worker* t_worker;
+    
+    static DWORD WINAPI WorkerThreadProc(LPVOID lpParam);
+    void RunWorker(Worker* worker);
+    bool TakeTask(Worker* worker, Item& item);
+    bool AcquireSlot(Item& item);
+    void ReleaseSlot(Worker* worker, IPCCommandClass commandClass);
+    void Enqueue(Worker* worker, Item&& item);
+    bool IsFinished() const;
+};
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "IPCFrame.h"
+#include <algorithm>
+
+std::mutex IPCBufferPool::s_mutex;
+std::vector<String> IPCBufferPool::s_buffers;
+
+void IPCFrame::AppendMessage(String& out, uint32_t requestId, uint16_t type, const char* data, size_t size) {
+    size_t offset = 0;
+    do {
+        uint32_t length = static_cast<uint32_t>(std::min<size_t>(size - offset, kMaxFrameBytes));
+        uint16_t flags = offset + length < size ? FlagMore : 0;
+        
+        char header[kHeaderSize];
+        memcpy(header, &length, sizeof(length));
+        memcpy(header + 4, &flags, sizeof(flags));
+        memcpy(header + 6, &type, sizeof(type));
+        memcpy(header + 8, &requestId, sizeof(requestId));
+        
+        out.append(header, kHeaderSize);
+        out.append(data + offset, length);
+        offset += length;
+    } while (offset < size);
+}
+
+IPCFrameReader::IPCFrameReader() : m_offset(0), m_pooled(false), m_error(false) {
+}
+
+IPCFrameReader::~IPCFrameReader() {
+    Reset();
+}
+
+void IPCFrameReader::Append(const char* data, size_t size) {
+    if (!m_pooled) {
+        m_buffer = IPCBufferPool::Acquire();
+        m_pooled = true;
+    }
+    
+    // 已消费的数据超过一半时整体前移，避免缓冲无限增长
+    if (m_offset > 0 && m_offset * 2 >= m_buffer.size()) {
+        m_buffer.erase(0, m_offset);
+        m_offset = 0;
+    }
+    
+    m_buffer.append(data, size);
+}
+
+bool IPCFrameReader::NextMessage(uint32_t& requestId, uint16_t& type, String& message) {
+    while (!m_error && m_buffer.size() - m_offset >= IPCFrame::kHeaderSize) {
+        uint32_t length;
+        uint16_t flags;
+        memcpy(&length, m_buffer.data() + m_offset, sizeof(length));
+        memcpy(&flags, m_buffer.data() + m_offset + 4, sizeof(flags));
+        memcpy(&type, m_buffer.data() + m_offset + 6, sizeof(type));
+        memcpy(&requestId, m_buffer.data() + m_offset + 8, sizeof(requestId));
+        
+        if (length > IPCFrame::kMaxFrameBytes || m_message.size() + length > IPCFrame::kMaxMessageBytes) {
+            m_error = true;
+            return false;
+        }
+        
+        if (m_buffer.size() - m_offset - IPCFrame::kHeaderSize < length) {
+            return false;
+        }
+        
+        const char* payload = m_buffer.data() + m_offset + IPCFrame::kHeaderSize;
+        m_offset += IPCFrame::kHeaderSize + length;
+        
+        if (flags & IPCFrame::FlagMore) {
+            m_message.append(payload, length);
+            continue;
+        }
+        
+        // 单帧消息直接取出，多帧消息交换出拼接结果
+        if (m_message.empty()) {
+            message.assign(payload, length);
+        } else {
+            m_message.append(payload, length);
+            message.swap(m_message);
+            m_message.clear();
+        }
+        return true;
+    }
+    
+    return false;
+}
+
+void IPCFrameReader::Reset() {
+    if (m_pooled) {
+        IPCBufferPool::Release(m_buffer);
+        m_pooled = false;
+    }
+    m_message.clear();
+    m_message.shrink_to_fit();
+    m_offset = 0;
+    m_error = false;
+}
+
+String IPCBufferPool::Acquire() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_buffers.empty()) {
+        String buffer;
+        buffer.reserve(kInitialCapacity);
+        return buffer;
+    }
+    
+    String buffer = std::move(s_buffers.back());
+    s_buffers.pop_back();
+    return buffer;
+}
+
+void IPCBufferPool::Release(String& buffer) {
+    String released;
+    released.swap(buffer);
+    
+    // 过大的缓冲直接释放，避免一次大消息长期占用内存
+    if (released.capacity() < kInitialCapacity || released.capacity() > kMaxPooledCapacity) {
+        return;
+    }
+    
+    released.clear();
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_buffers.size() < kMaxPooledBuffers) {
+        s_buffers.push_back(std::move(released));
+    }
+}
\ No newline at end of file
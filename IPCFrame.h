@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Common.h"
+
+// IPC消息分帧：每帧为 [长度 u32][标志 u16][消息类型 u16][请求ID u32][数据]，
+// 超过单帧上限的消息拆分为多帧连续发送，除最后一帧外均带有FlagMore标志。
+// 响应携带与请求相同的ID，同一连接上的多个请求可以乱序返回
+namespace IPCFrame {
+
+const size_t kHeaderSize = 12;
+const uint32_t kMaxFrameBytes = 64 * 1024;
+const size_t kMaxMessageBytes = 64 * 1024 * 1024;
+
+enum Flags : uint16_t {
+    FlagMore = 0x0001  // 消息还有后续帧
+};
+
+// 消息内容的类型，响应与请求类型相同
+enum MessageType : uint16_t {
+    MessageCommand = 0,  // 单条文本命令
+    MessageBatch = 1,    // 批量命令，见IPCBatch
+    MessageBinary = 2,   // 二进制命令，见IPCProtocol
+    MessageSharedMemory = 3, // 协商共享内存通道，见IPCSharedChannel
+    MessageSubscribe = 4,    // 订阅事件，内容为 [掩码 u32]，0表示取消订阅
+    MessageEvent = 5         // 服务器推送的事件，请求ID与订阅请求相同，见IPCProtocol
+};
+
+// 分帧之前的旧版客户端直接发送"--status"这类文本命令并等待原始文本响应。帧的长度不超过kMaxFrameBytes，
+// 长度字段的第3字节不大于1，因此以"--"开头且第3字节大于1的数据不可能是帧
+inline bool IsUnframedText(const char* data, size_t size) {
+    return size >= 3 && data[0] == '-' && data[1] == '-' && static_cast<unsigned char>(data[2]) > 1;
+}
+
+// 将消息编码为一个或多个帧追加到out
+void AppendMessage(String& out, uint32_t requestId, uint16_t type, const char* data, size_t size);
+
+inline void AppendMessage(String& out, uint32_t requestId, const String& message, uint16_t type = MessageCommand) {
+    AppendMessage(out, requestId, type, message.c_str(), message.length());
+}
+
+} // namespace IPCFrame
+
+// 从字节流中解析帧并拼接出完整消息，接收缓冲按需增长
+class IPCFrameReader {
+public:
+    IPCFrameReader();
+    ~IPCFrameReader();
+    
+    // 禁用拷贝构造和赋值
+    IPCFrameReader(const IPCFrameReader&) = delete;
+    IPCFrameReader& operator=(const IPCFrameReader&) = delete;
+    
+    void Append(const char* data, size_t size);
+    
+    // 取出下一条完整消息及其请求ID和类型，数据不足时返回false
+    bool NextMessage(uint32_t& requestId, uint16_t& type, String& message);
+    
+    // 帧或消息长度超出上限，连接应被断开
+    bool HasError() const { return m_error; }
+    
+    // 清空状态并将缓冲归还缓冲池
+    void Reset();
+
+private:
+    String m_buffer;
+    size_t m_offset;
+    String m_message;
+    bool m_pooled;  // m_buffer取自缓冲池
+    bool m_error;
+};
+
+// 收发缓冲池：连接断开后归还缓冲，避免每个连接重新分配大块内存
+class IPCBufferPool {
+public:
+    static String Acquire();
+    
+    // 归还后buffer被置为空
+    static void Release(String& buffer);
+
+private:
+    static const size_t kInitialCapacity = 4096;
+    static const size_t kMaxPooledBuffers = 32;
+    static const size_t kMaxPooledCapacity = 1024 * 1024;
+    
+    static std::mutex s_mutex;
+    static std::vector<String> s_buffers;
+};
\ No newline at end of file
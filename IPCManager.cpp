@@ -1,45 +1,126 @@
 #include "IPCManager.h"
 
+#ifndef _WIN32
+#include "IPCSocket.h"
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#endif
+
+namespace {
+
+// 因队列已满拒绝请求时建议客户端等待的时间
+const DWORD kBusyRetryMs = 100;
+
+uint64_t GetEventTimestamp() {
+    FILETIME fileTime;
+    GetSystemTimeAsFileTime(&fileTime);
+    return (static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+}
+
+// 耗时的服务操作和进程操作各自受并发上限约束，其余命令按查询处理
+IPCCommandClass GetOpcodeClass(IPCOpcode opcode) {
+    switch (opcode) {
+        case IPCOpcode::InstallService:
+        case IPCOpcode::UninstallService:
+        case IPCOpcode::StartService:
+        case IPCOpcode::StopService:
+        case IPCOpcode::RestartService:
+            return IPCCommandClass::ServiceControl;
+        case IPCOpcode::SuspendWinlogon:
+        case IPCOpcode::ResumeWinlogon:
+        case IPCOpcode::SuspendProcess:
+        case IPCOpcode::ResumeProcess:
+        case IPCOpcode::TerminateProcess:
+            return IPCCommandClass::ProcessControl;
+        default:
+            return IPCCommandClass::Query;
+    }
+}
+
+// 可缓存的查询不带参数，结果只取决于服务器当前状态
+bool IsCacheableOpcode(IPCOpcode opcode) {
+    return opcode == IPCOpcode::QueryServiceStatus || opcode == IPCOpcode::QueryWinlogonStatus;
+}
+
+} // namespace
+
 IPCManager::IPCManager()
     : m_pipeName(L"\\\\.\\pipe\\WinlogonManagerService")
     , m_timeoutMs(5000)
-    , m_serverThread(INVALID_HANDLE_VALUE)
-    , m_stopEvent(INVALID_HANDLE_VALUE)
+#ifdef _WIN32
+    , m_completionPort(NULL)
+#else
+    , m_epoll(-1)
+    , m_listenSocket(-1)
+    , m_stopEvent(-1)
+    , m_acceptPaused(false)
+#endif
+    , m_stopping(false)
     , m_serverRunning(false)
+    , m_nextSessionId(0)
+    , m_eventSequence(0)
+    , m_nextConnectionKey(0)
+    , m_inflightCommands(0)
     , m_lastError(ErrorCode::Success) {
-    
-    m_stopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
-    if (!m_stopEvent) {
-        Logger::Log(LogLevel::Error, "Failed to create stop event, error: %s", Utils::GetLastErrorString().c_str());
-        SetLastError(GetLastError());
-    }
 }
 
 IPCManager::~IPCManager() {
     StopServer();
-    if (m_stopEvent != INVALID_HANDLE_VALUE) {
-        CloseHandle(m_stopEvent);
-    }
 }
 
-bool IPCManager::StartServer(CommandHandler handler) {
+bool IPCManager::StartServer(RequestHandler handler) {
     if (m_serverRunning) {
         Logger::Log(LogLevel::Warning, "IPC server is already running");
         return true;
     }
     
-    m_commandHandler = handler;
-    ResetEvent(m_stopEvent);
+    m_requestHandler = handler;
+    m_stopping = false;
+    
+    if (!OpenTransport()) {
+        return false;
+    }
     
-    m_serverThread = CreateThread(NULL, 0, ServerThreadProc, this, 0, NULL);
-    if (!m_serverThread) {
-        Logger::Log(LogLevel::Error, "Failed to create server thread, error: %s", Utils::GetLastErrorString().c_str());
-        SetLastError(GetLastError());
+    if (!m_commandPool.Start(m_serverConfig.commandPool)) {
+        SetLastError(::GetLastError());
+        ReleaseServerResources();
         return false;
     }
+    m_rateLimiter.Configure(m_serverConfig.clientRateLimit, m_serverConfig.globalRateLimit);
+    m_responseCache.Configure(m_serverConfig.responseCacheTtlMs);
+    
+    // 预先创建全部管道实例并开始等待连接
+    DWORD instanceCount = std::max<DWORD>(m_serverConfig.instanceCount, 1);
+    for (DWORD i = 0; i < instanceCount; ++i) {
+        if (!CreateInstance()) {
+            ReleaseServerResources();
+            return false;
+        }
+    }
+    
+    DWORD workerCount = m_serverConfig.workerCount;
+    if (workerCount == 0) {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        workerCount = std::max<DWORD>(systemInfo.dwNumberOfProcessors, 1);
+    }
+    
+    for (DWORD i = 0; i < workerCount; ++i) {
+        HANDLE thread = CreateThread(NULL, 0, WorkerThreadProc, this, 0, NULL);
+        if (!thread) {
+            Logger::Log(LogLevel::Error, "Failed to create IPC worker thread, error: %s", Utils::GetLastErrorString().c_str());
+            SetLastError(::GetLastError());
+            ReleaseServerResources();
+            return false;
+        }
+        m_workerThreads.push_back(thread);
+    }
     
     m_serverRunning = true;
-    Logger::Log(LogLevel::Info, "IPC server started successfully");
+    Logger::Log(LogLevel::Info, "IPC server started successfully (instances: %lu, workers: %lu, command threads: %zu)",
+                instanceCount, workerCount, m_commandPool.GetThreadCount());
     return true;
 }
 
@@ -49,182 +130,1281 @@ void IPCManager::StopServer() {
     }
     
     Logger::Log(LogLevel::Info, "Stopping IPC server...");
-    SetEvent(m_stopEvent);
+    ReleaseServerResources();
     
-    // 发送一个连接请求来唤醒服务器线程
-    HANDLE hPipe = CreateFileW(
-        m_pipeName.c_str(),
-        GENERIC_WRITE,
-        0,
-        NULL,
-        OPEN_EXISTING,
-        0,
-        NULL
-    );
+    m_serverRunning = false;
+    m_requestHandler = nullptr;
+    
+    IPCCacheStats stats = m_responseCache.GetStats();
+    Logger::Log(LogLevel::Info, "IPC server stopped (cache hits: %llu, misses: %llu, coalesced: %llu)",
+                stats.hits, stats.misses, stats.coalesced);
+}
+
+void IPCManager::ReleaseServerResources() {
+    m_stopping = true;
     
-    if (hPipe != INVALID_HANDLE_VALUE) {
-        CloseHandle(hPipe);
+    // 工作线程退出后不会再有新的读写发起
+    WakeWorkers();
+    for (HANDLE thread : m_workerThreads) {
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
     }
+    m_workerThreads.clear();
     
-    if (m_serverThread != INVALID_HANDLE_VALUE) {
-        WaitForSingleObject(m_serverThread, 5000);
-        CloseHandle(m_serverThread);
-        m_serverThread = INVALID_HANDLE_VALUE;
+    // 停止期间命令不再执行，已提交的任务只做清理，完成后不会再有新的共享内存会话
+    m_commandPool.Stop();
+    ReapSharedSessions(true);
+    CloseTransport();
+    
+    std::lock_guard<std::mutex> lock(m_publishMutex);
+    m_instances.clear();
+}
+
+#ifdef _WIN32
+bool IPCManager::OpenTransport() {
+    m_completionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 0);
+    if (!m_completionPort) {
+        Logger::Log(LogLevel::Error, "Failed to create completion port, error: %s", Utils::GetLastErrorString().c_str());
+        SetLastError(::GetLastError());
+        return false;
+    }
+    return true;
+}
+
+void IPCManager::WakeWorkers() {
+    // 每个工作线程收到一个空完成包后退出
+    for (size_t i = 0; i < m_workerThreads.size(); ++i) {
+        PostQueuedCompletionStatus(m_completionPort, 0, 0, NULL);
+    }
+}
+
+void IPCManager::CloseTransport() {
+    // 取消仍在进行的操作并等待其结束，之后才能释放OVERLAPPED所在的内存
+    for (auto& instance : m_instances) {
+        DWORD bytesTransferred;
+        CancelIoEx(instance->pipe, NULL);
+        GetOverlappedResult(instance->pipe, &instance->readRequest.overlapped, &bytesTransferred, TRUE);
+        GetOverlappedResult(instance->pipe, &instance->writeRequest.overlapped, &bytesTransferred, TRUE);
+        CloseHandle(instance->pipe);
     }
     
-    m_serverRunning = false;
-    m_commandHandler = nullptr;
-    Logger::Log(LogLevel::Info, "IPC server stopped");
+    if (m_completionPort) {
+        CloseHandle(m_completionPort);
+        m_completionPort = NULL;
+    }
 }
 
-bool IPCManager::SendCommand(const String& command, String& response) {
-    HANDLE hPipe = CreateFileW(
+bool IPCManager::CreateInstance() {
+    // 实例数即可同时连接的客户端数，其余客户端在WaitNamedPipe中等待空闲实例
+    DWORD maxInstances = std::min<DWORD>(std::max<DWORD>(m_serverConfig.instanceCount, 1), PIPE_UNLIMITED_INSTANCES);
+    
+    auto instance = std::make_unique<PipeInstance>();
+    instance->pipe = CreateNamedPipeW(
         m_pipeName.c_str(),
-        GENERIC_READ | GENERIC_WRITE,
-        0,
-        NULL,
-        OPEN_EXISTING,
+        PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+        // 消息类型的管道兼容以PIPE_READMODE_MESSAGE读取响应的旧版客户端，服务器和新版客户端仍按字节流读取
+        PIPE_TYPE_MESSAGE | PIPE_READMODE_BYTE | PIPE_WAIT,
+        maxInstances,
+        sizeof(instance->buffer),
+        sizeof(instance->buffer),
         0,
         NULL
     );
     
-    if (hPipe == INVALID_HANDLE_VALUE) {
-        Logger::Log(LogLevel::Error, "Failed to connect to IPC server, error: %s", Utils::GetLastErrorString().c_str());
-        SetLastError(ErrorCode::IPCConnectionFailed);
+    if (instance->pipe == INVALID_HANDLE_VALUE) {
+        Logger::Log(LogLevel::Error, "Failed to create named pipe, error: %s", Utils::GetLastErrorString().c_str());
+        SetLastError(::GetLastError());
         return false;
     }
     
-    // 设置管道模式
-    DWORD mode = PIPE_READMODE_MESSAGE;
-    if (!SetNamedPipeHandleState(hPipe, &mode, NULL, NULL)) {
-        Logger::Log(LogLevel::Error, "Failed to set pipe mode, error: %s", Utils::GetLastErrorString().c_str());
-        CloseHandle(hPipe);
-        SetLastError(GetLastError());
+    // 以实例指针作为完成键
+    if (!CreateIoCompletionPort(instance->pipe, m_completionPort, reinterpret_cast<ULONG_PTR>(instance.get()), 0)) {
+        Logger::Log(LogLevel::Error, "Failed to associate pipe with completion port, error: %s", Utils::GetLastErrorString().c_str());
+        SetLastError(::GetLastError());
+        CloseHandle(instance->pipe);
         return false;
     }
     
-    // 发送命令
-    DWORD bytesWritten;
-    if (!WriteFile(hPipe, command.c_str(), static_cast<DWORD>(command.length()), &bytesWritten, NULL)) {
-        Logger::Log(LogLevel::Error, "Failed to send command, error: %s", Utils::GetLastErrorString().c_str());
-        CloseHandle(hPipe);
-        SetLastError(GetLastError());
+    PipeInstance* pipeInstance = instance.get();
+    m_instances.push_back(std::move(instance));
+    
+    std::lock_guard<std::mutex> lock(pipeInstance->mutex);
+    BeginConnect(pipeInstance);
+    return true;
+}
+
+void IPCManager::BeginConnect(PipeInstance* instance) {
+    if (m_stopping) {
+        return;
+    }
+    
+    IoRequest& request = instance->readRequest;
+    request.operation = PipeOperation::Connect;
+    ZeroMemory(&request.overlapped, sizeof(request.overlapped));
+    
+    if (ConnectNamedPipe(instance->pipe, &request.overlapped)) {
+        return;
+    }
+    
+    switch (::GetLastError()) {
+        case ERROR_IO_PENDING:
+            instance->reading = true;
+            break;
+        case ERROR_PIPE_CONNECTED:
+            // 客户端在创建实例和等待连接之间已连上，不会产生完成包
+            OnConnected(instance, TRUE);
+            break;
+        case ERROR_NO_DATA:
+            // 客户端已关闭但实例尚未断开
+            DisconnectNamedPipe(instance->pipe);
+            BeginConnect(instance);
+            break;
+        default:
+            Logger::Log(LogLevel::Error, "Failed to wait for IPC client, error: %s", Utils::GetLastErrorString().c_str());
+            break;
+    }
+}
+
+void IPCManager::BeginRead(PipeInstance* instance) {
+    if (m_stopping || instance->closing) {
+        return;
+    }
+    
+    IoRequest& request = instance->readRequest;
+    request.operation = PipeOperation::Read;
+    ZeroMemory(&request.overlapped, sizeof(request.overlapped));
+    
+    // 同步完成时同样会投递完成包，统一在完成通知中处理
+    if (!ReadFile(instance->pipe, instance->buffer, sizeof(instance->buffer), NULL, &request.overlapped) &&
+        ::GetLastError() != ERROR_IO_PENDING) {
+        CloseConnection(instance);
+        return;
+    }
+    instance->reading = true;
+}
+
+void IPCManager::DisconnectInstance(PipeInstance* instance) {
+    DisconnectNamedPipe(instance->pipe);
+}
+
+DWORD IPCManager::GetClientProcessId(PipeInstance* instance) {
+    ULONG clientProcessId = 0;
+    if (!GetNamedPipeClientProcessId(instance->pipe, &clientProcessId)) {
+        return 0;
+    }
+    return clientProcessId;
+}
+#else
+bool IPCManager::OpenTransport() {
+    m_socketPath = IPCSocket::GetSocketPath(m_pipeName);
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll >= 0) {
+        m_stopEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    }
+    if (m_epoll < 0 || m_stopEvent < 0) {
+        ::SetLastError(errno);
+        Logger::Log(LogLevel::Error, "Failed to create epoll instance, error: %s", Utils::GetLastErrorString().c_str());
+        SetLastError(::GetLastError());
+        CloseTransport();
         return false;
     }
     
-    // 读取响应
-    char buffer[4096];
-    DWORD bytesRead;
-    if (!ReadFile(hPipe, buffer, sizeof(buffer) - 1, &bytesRead, NULL)) {
-        Logger::Log(LogLevel::Error, "Failed to read response, error: %s", Utils::GetLastErrorString().c_str());
-        CloseHandle(hPipe);
-        SetLastError(GetLastError());
+    m_listenSocket = IPCSocket::Listen(m_socketPath);
+    if (m_listenSocket < 0) {
+        Logger::Log(LogLevel::Error, "Failed to listen on IPC socket %s, error: %s", m_socketPath.c_str(),
+                    Utils::GetLastErrorString().c_str());
+        SetLastError(::GetLastError());
+        CloseTransport();
         return false;
     }
     
-    buffer[bytesRead] = '\0';
-    response = String(buffer);
+    // 停止事件写入后一直可读，所有工作线程都会收到；监听套接字等有了空闲槽位再开始accept
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = &m_stopEvent;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_stopEvent, &event);
     
-    CloseHandle(hPipe);
-    Logger::Log(LogLevel::Debug, "Command sent successfully, response: %s", response.c_str());
+    event.events = EPOLLONESHOT;
+    event.data.ptr = &m_listenSocket;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listenSocket, &event);
+    m_acceptPaused = true;
     return true;
 }
 
-bool IPCManager::SendCommand(const String& command) {
+void IPCManager::WakeWorkers() {
+    if (m_stopEvent >= 0) {
+        uint64_t value = 1;
+        ssize_t written = write(m_stopEvent, &value, sizeof(value));
+        (void)written;
+    }
+}
+
+void IPCManager::CloseTransport() {
+    // 工作线程均已退出，不会再有线程访问这些套接字
+    for (auto& instance : m_instances) {
+        if (instance->socket >= 0) {
+            close(instance->socket);
+            instance->socket = -1;
+        }
+    }
+    
+    if (m_listenSocket >= 0) {
+        close(m_listenSocket);
+        unlink(m_socketPath.c_str());
+        m_listenSocket = -1;
+    }
+    
+    if (m_stopEvent >= 0) {
+        close(m_stopEvent);
+        m_stopEvent = -1;
+    }
+    
+    if (m_epoll >= 0) {
+        close(m_epoll);
+        m_epoll = -1;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_acceptMutex);
+    m_freeInstances.clear();
+    m_acceptPaused = false;
+}
+
+bool IPCManager::CreateInstance() {
+    auto instance = std::make_unique<PipeInstance>();
+    PipeInstance* pipeInstance = instance.get();
+    m_instances.push_back(std::move(instance));
+    
+    std::lock_guard<std::mutex> lock(pipeInstance->mutex);
+    BeginConnect(pipeInstance);
+    return true;
+}
+
+void IPCManager::BeginConnect(PipeInstance* instance) {
+    if (m_stopping) {
+        return;
+    }
+    
+    // 槽位回到空闲列表，此前因槽位用完而暂停的accept随之恢复
+    std::lock_guard<std::mutex> lock(m_acceptMutex);
+    m_freeInstances.push_back(instance);
+    if (m_acceptPaused) {
+        m_acceptPaused = false;
+        
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLONESHOT;
+        event.data.ptr = &m_listenSocket;
+        epoll_ctl(m_epoll, EPOLL_CTL_MOD, m_listenSocket, &event);
+    }
+}
+
+void IPCManager::BeginRead(PipeInstance* instance) {
+    if (m_stopping || instance->closing) {
+        return;
+    }
+    
+    instance->reading = true;
+    WatchSocket(instance);
+}
+
+void IPCManager::DisconnectInstance(PipeInstance* instance) {
+    if (instance->socket >= 0) {
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, instance->socket, NULL);
+        close(instance->socket);
+        instance->socket = -1;
+    }
+}
+
+DWORD IPCManager::GetClientProcessId(PipeInstance* instance) {
+    return IPCSocket::GetPeerProcessId(instance->socket);
+}
+
+void IPCManager::AcceptConnections() {
+    // 监听套接字以EPOLLONESHOT注册，同时只有一个工作线程在此accept
+    while (!m_stopping) {
+        PipeInstance* instance;
+        {
+            std::lock_guard<std::mutex> lock(m_acceptMutex);
+            if (m_freeInstances.empty()) {
+                m_acceptPaused = true;
+                return;
+            }
+            instance = m_freeInstances.back();
+            m_freeInstances.pop_back();
+        }
+        
+        int socket = accept4(m_listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (socket < 0) {
+            if (errno == EINTR) {
+                std::lock_guard<std::mutex> lock(m_acceptMutex);
+                m_freeInstances.push_back(instance);
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_DEBUG("Failed to accept IPC client, error: %d", errno);
+            }
+            std::lock_guard<std::mutex> lock(m_acceptMutex);
+            m_freeInstances.push_back(instance);
+            break;
+        }
+        
+        std::lock_guard<std::mutex> lock(instance->mutex);
+        instance->socket = socket;
+        
+        // 连接上的读写通知同样以EPOLLONESHOT注册，处理完后由WatchSocket重新登记
+        epoll_event event = {};
+        event.events = EPOLLONESHOT;
+        event.data.ptr = instance;
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event) != 0) {
+            Logger::Log(LogLevel::Error, "Failed to watch IPC client socket, error: %d", errno);
+            close(socket);
+            instance->socket = -1;
+            BeginConnect(instance);
+            continue;
+        }
+        OnConnected(instance, TRUE);
+    }
+    
+    if (!m_stopping) {
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLONESHOT;
+        event.data.ptr = &m_listenSocket;
+        epoll_ctl(m_epoll, EPOLL_CTL_MOD, m_listenSocket, &event);
+    }
+}
+
+void IPCManager::OnSocketEvent(PipeInstance* instance) {
+    std::lock_guard<std::mutex> lock(instance->mutex);
+    
+    // 槽位可能已断开并被新连接复用，此时的通知是残留的，读写都按非阻塞处理即可
+    if (instance->socket < 0) {
+        return;
+    }
+    
+    if (instance->writing) {
+        ContinueWrite(instance);
+    }
+    
+    if (!instance->reading) {
+        return;
+    }
+    
+    ssize_t received = recv(instance->socket, instance->buffer, sizeof(instance->buffer), 0);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        WatchSocket(instance);
+        return;
+    }
+    
+    // 读完一次后由OnReadCompleted经BeginRead重新登记可读
+    instance->reading = false;
+    if (received > 0) {
+        OnReadCompleted(instance, TRUE, static_cast<DWORD>(received), ERROR_SUCCESS);
+    } else {
+        OnReadCompleted(instance, FALSE, 0, received == 0 ? ERROR_BROKEN_PIPE : errno);
+    }
+}
+
+void IPCManager::ContinueWrite(PipeInstance* instance) {
+    while (instance->writeOffset < instance->writeBuffer.length()) {
+        ssize_t written = send(instance->socket, instance->writeBuffer.data() + instance->writeOffset,
+                               instance->writeBuffer.length() - instance->writeOffset, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            
+            // 发送缓冲已满，等待套接字可写后继续
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                WatchSocket(instance);
+                return;
+            }
+            
+            instance->writing = false;
+            OnWriteCompleted(instance, FALSE);
+            return;
+        }
+        instance->writeOffset += static_cast<size_t>(written);
+    }
+    
+    instance->writing = false;
+    OnWriteCompleted(instance, TRUE);
+}
+
+void IPCManager::WatchSocket(PipeInstance* instance) {
+    epoll_event event = {};
+    event.events = EPOLLONESHOT;
+    if (instance->reading) {
+        event.events |= EPOLLIN;
+    }
+    if (instance->writing) {
+        event.events |= EPOLLOUT;
+    }
+    event.data.ptr = instance;
+    epoll_ctl(m_epoll, EPOLL_CTL_MOD, instance->socket, &event);
+}
+#endif
+
+void IPCManager::BeginWrite(PipeInstance* instance) {
+    if (m_stopping) {
+        return;
+    }
+    
+    // 排队的响应整体写出，写出期间新的响应继续追加到pendingWrites
+    instance->writeBuffer.swap(instance->pendingWrites);
+    instance->writingEvents = instance->queuedEvents;
+    instance->queuedEvents = 0;
+
+#ifdef _WIN32
+    IoRequest& request = instance->writeRequest;
+    ZeroMemory(&request.overlapped, sizeof(request.overlapped));
+    
+    if (!WriteFile(instance->pipe, instance->writeBuffer.c_str(), static_cast<DWORD>(instance->writeBuffer.length()),
+                   NULL, &request.overlapped) && ::GetLastError() != ERROR_IO_PENDING) {
+        IPCBufferPool::Release(instance->writeBuffer);
+        CloseConnection(instance);
+        return;
+    }
+    instance->writing = true;
+#else
+    instance->writeOffset = 0;
+    instance->writing = true;
+    ContinueWrite(instance);
+#endif
+}
+
+void IPCManager::CloseConnection(PipeInstance* instance) {
+    instance->closing = true;
+    
+    // 写失败时读操作可能仍在等待一个不再发送数据的客户端
+    if (instance->reading) {
+#ifdef _WIN32
+        CancelIoEx(instance->pipe, &instance->readRequest.overlapped);
+#else
+        // 套接字上没有进行中的读操作，不再等待可读即可
+        instance->reading = false;
+#endif
+    }
+    
+    TryResetInstance(instance);
+}
+
+void IPCManager::TryResetInstance(PipeInstance* instance) {
+    if (!instance->closing || instance->reading || instance->writing || instance->pendingCommands > 0) {
+        return;
+    }
+    
+    // 连接上的所有操作都已结束，实例回到等待连接状态
+    instance->reader.Reset();
+    IPCBufferPool::Release(instance->writeBuffer);
+    IPCBufferPool::Release(instance->pendingWrites);
+    instance->closing = false;
+    instance->eventMask = 0;
+    instance->subscriptionId = 0;
+    instance->queuedEvents = 0;
+    instance->writingEvents = 0;
+    instance->droppedEvents = 0;
+    instance->clientProcessId = 0;
+    instance->clientKey = 0;
+    instance->detected = false;
+    instance->unframed = false;
+    
+    DisconnectInstance(instance);
+    BeginConnect(instance);
+}
+
+#ifdef _WIN32
+void IPCManager::OnCompletion(PipeInstance* instance, IoRequest* request, BOOL success, DWORD bytesTransferred, DWORD error) {
+    std::lock_guard<std::mutex> lock(instance->mutex);
+    switch (request->operation) {
+        case PipeOperation::Connect:
+            instance->reading = false;
+            OnConnected(instance, success);
+            break;
+        case PipeOperation::Read:
+            instance->reading = false;
+            OnReadCompleted(instance, success, bytesTransferred, error);
+            break;
+        case PipeOperation::Write:
+            instance->writing = false;
+            OnWriteCompleted(instance, success);
+            break;
+    }
+}
+#endif
+
+void IPCManager::OnConnected(PipeInstance* instance, BOOL success) {
+    if (success) {
+        // 无法查询进程ID的客户端不共用同一个令牌桶，否则其中一个过快就会限制其余全部客户端
+        DWORD clientProcessId = GetClientProcessId(instance);
+        if (clientProcessId == 0) {
+            LOG_DEBUG("Failed to query IPC client process, error: %lu", ::GetLastError());
+            instance->clientKey = (1ull << 32) | ++m_nextConnectionKey;
+        } else {
+            instance->clientKey = clientProcessId;
+        }
+        instance->clientProcessId = clientProcessId;
+        
+        LOG_BINARY(LogLevel::Debug, "Client connected to IPC pipe, process %lu", clientProcessId);
+        BeginRead(instance);
+    } else {
+        CloseConnection(instance);
+    }
+}
+
+void IPCManager::OnReadCompleted(PipeInstance* instance, BOOL success, DWORD bytesTransferred, DWORD error) {
+    if (!success || bytesTransferred == 0) {
+        // 客户端关闭连接
+        if (!success && error != ERROR_BROKEN_PIPE && error != ERROR_OPERATION_ABORTED) {
+            LOG_DEBUG("IPC read failed, error: %lu", error);
+        }
+        CloseConnection(instance);
+        return;
+    }
+    
+    // 第一次读取的数据不是帧时按旧版客户端处理，此后该连接上的请求和响应都不带帧头
+    if (!instance->detected) {
+        instance->detected = true;
+        instance->unframed = IPCFrame::IsUnframedText(instance->buffer, bytesTransferred);
+        if (instance->unframed) {
+            LOG_DEBUG("Unframed IPC client connected, process %lu", instance->clientProcessId);
+        }
+    }
+    
+    if (instance->unframed) {
+        // 旧版客户端每次写入一条以NUL结尾或不带结尾的命令，一次读取即为完整命令
+        String command(instance->buffer, strnlen(instance->buffer, bytesTransferred));
+        SubmitMessage(instance, 0, IPCFrame::MessageCommand, command);
+        BeginRead(instance);
+        return;
+    }
+    
+    instance->reader.Append(instance->buffer, bytesTransferred);
+    
+    // 一次读取可能包含多条完整消息，也可能不足一条；每条消息作为独立任务交给命令线程池
+    uint32_t requestId;
+    uint16_t type;
+    String command;
+    while (instance->reader.NextMessage(requestId, type, command)) {
+        SubmitMessage(instance, requestId, type, command);
+    }
+    
+    if (instance->reader.HasError()) {
+        Logger::Log(LogLevel::Warning, "Invalid IPC frame received, closing connection");
+        CloseConnection(instance);
+        return;
+    }
+    
+    // 继续读取后续请求，不等待当前请求的响应
+    BeginRead(instance);
+}
+
+void IPCManager::SubmitMessage(PipeInstance* instance, uint32_t requestId, uint16_t type, String& message) {
+    auto task = std::make_unique<CommandTask>();
+    task->instance = instance;
+    task->requestId = requestId;
+    task->type = type;
+    task->command.swap(message);
+    
+    // 订阅不执行命令，不受限速约束；被拒绝的请求直接响应，不进入线程池
+    DWORD retryAfterMs = 0;
+    IPCStatus admission = IPCStatus::Ok;
+    if (type != IPCFrame::MessageSubscribe) {
+        admission = AdmitRequest(instance->clientKey, instance->pendingCommands, type, task->command,
+                                 retryAfterMs);
+    }
+    if (admission != IPCStatus::Ok) {
+        String response;
+        BuildRejectResponse(type, task->command, admission, retryAfterMs, response);
+        QueueWrite(instance, requestId, type, response);
+        return;
+    }
+    
+    if (!SubmitTask(task, ClassifyMessage(type, task->command))) {
+        Logger::Log(LogLevel::Error, "Failed to queue IPC command");
+        return;
+    }
+    instance->pendingCommands++;
+}
+
+void IPCManager::OnWriteCompleted(PipeInstance* instance, BOOL success) {
+    IPCBufferPool::Release(instance->writeBuffer);
+    instance->writingEvents = 0;
+    
+    // 队列腾出空间后告知订阅者此前丢弃的事件数
+    if (success && !instance->closing && instance->droppedEvents > 0 &&
+        instance->queuedEvents < m_serverConfig.maxQueuedEvents) {
+        IPCEvent dropped(IPCEventType::EventsDropped);
+        dropped.sequence = m_eventSequence;
+        dropped.timestamp = GetEventTimestamp();
+        dropped.count = instance->droppedEvents;
+        instance->droppedEvents = 0;
+        
+        String payload;
+        IPCProtocol::EncodeEvent(dropped, payload);
+        QueueEvent(instance, payload);
+        return;
+    }
+    
+    if (!success) {
+        CloseConnection(instance);
+    } else if (instance->closing) {
+        TryResetInstance(instance);
+    } else if (!instance->pendingWrites.empty()) {
+        BeginWrite(instance);
+    }
+}
+
+bool IPCManager::SubmitTask(std::unique_ptr<CommandTask>& task, IPCCommandClass commandClass) {
+    // 提交成功后任务由ExecuteCommand释放
+    CommandTask* raw = task.get();
+    m_inflightCommands++;
+    if (!m_commandPool.Submit(commandClass, [this, raw]() { ExecuteCommand(raw); })) {
+        m_inflightCommands--;
+        return false;
+    }
+    
+    task.release();
+    return true;
+}
+
+IPCStatus IPCManager::AdmitRequest(uint64_t clientKey, unsigned pendingCommands, uint16_t type,
+                                   const String& message, DWORD& retryAfterMs) {
+    // 批量请求按命令数计入队列长度和令牌，并行执行时每条命令都占用一个队列位置
+    DWORD cost = 1;
+    if (type == IPCFrame::MessageBatch) {
+        cost = static_cast<DWORD>(std::max<size_t>(IPCBatch::GetCommandCount(message), 1));
+    }
+    
+    // 超出容量的批量请求重试也无法被接受，直接拒绝
+    retryAfterMs = 0;
+    if (cost > m_serverConfig.maxQueuedCommands || cost > m_rateLimiter.GetMaxTokens()) {
+        Logger::Log(LogLevel::Warning, "IPC batch of %lu commands from client %llu exceeds server capacity",
+                    cost, static_cast<unsigned long long>(clientKey));
+        return IPCStatus::InvalidRequest;
+    }
+    
+    // 先检查队列长度，被拒绝的请求不消耗令牌；单个连接上的批量请求只算一个未完成请求
+    if (pendingCommands >= m_serverConfig.maxPendingPerClient ||
+        m_inflightCommands + cost > m_serverConfig.maxQueuedCommands) {
+        retryAfterMs = kBusyRetryMs;
+    } else if (m_rateLimiter.TryAcquire(clientKey, cost, retryAfterMs)) {
+        return IPCStatus::Ok;
+    }
+    
+    LOG_BINARY(LogLevel::Debug, "IPC request from client %llu rejected, retry after %lu ms",
+               static_cast<unsigned long long>(clientKey), retryAfterMs);
+    return IPCStatus::Busy;
+}
+
+void IPCManager::BuildRejectResponse(uint16_t type, const String& message, IPCStatus status, DWORD retryAfterMs,
+                                     String& response) {
+    String text;
+    if (status == IPCStatus::Busy) {
+        text = "Server busy, retry after " + std::to_string(retryAfterMs) + " ms";
+    } else {
+        text = "Request exceeds server capacity";
+    }
+    
+    switch (type) {
+        case IPCFrame::MessageBinary: {
+            IPCResult result(status, status == IPCStatus::Busy ? ErrorCode::ServerBusy : ErrorCode::InvalidParameter,
+                             text);
+            result.retryAfterMs = retryAfterMs;
+            IPCProtocol::EncodeResult(result, response);
+            break;
+        }
+        case IPCFrame::MessageBatch: {
+            // 整批拒绝，每条命令都返回失败
+            std::vector<String> commands;
+            IPCBatchMode mode;
+            IPCBatch::DecodeRequest(message, commands, mode);
+            std::vector<IPCBatchResult> results(commands.size());
+            for (IPCBatchResult& result : results) {
+                result.response = text;
+            }
+            IPCBatch::EncodeResponse(results, response);
+            break;
+        }
+        case IPCFrame::MessageSharedMemory:
+            // 空响应表示拒绝，客户端继续使用管道
+            response.clear();
+            break;
+        default:
+            response = text;
+            break;
+    }
+}
+
+IPCCommandClass IPCManager::ClassifyMessage(uint16_t type, const String& message) {
+    IPCRequest request;
+    switch (type) {
+        case IPCFrame::MessageCommand:
+            if (IPCProtocol::ParseTextCommand(message, request)) {
+                return GetOpcodeClass(request.opcode);
+            }
+            break;
+        case IPCFrame::MessageBinary:
+            if (IPCProtocol::DecodeRequest(message, request) == IPCStatus::Ok) {
+                return GetOpcodeClass(request.opcode);
+            }
+            break;
+        case IPCFrame::MessageBatch: {
+            // 顺序执行的批量命令按其中最慢的一类处理
+            std::vector<String> commands;
+            IPCBatchMode mode;
+            IPCCommandClass batchClass = IPCCommandClass::Query;
+            if (IPCBatch::DecodeRequest(message, commands, mode)) {
+                for (const String& command : commands) {
+                    batchClass = std::max(batchClass, ClassifyMessage(IPCFrame::MessageCommand, command));
+                }
+            }
+            return batchClass;
+        }
+        default:
+            break;
+    }
+    return IPCCommandClass::Query;
+}
+
+void IPCManager::ExecuteCommand(CommandTask* task) {
+    std::unique_ptr<CommandTask> owner(task);
+    PipeInstance* instance = task->instance;
+    
+    // 命令在锁外执行，同一连接上的其他请求可以并行处理
     String response;
-    return SendCommand(command, response);
+    bool respond = false;
+    bool subscribe = false;
+    uint32_t eventMask = 0;
+    if (!m_stopping) {
+        if (task->type == IPCFrame::MessageSubscribe) {
+            // 订阅在持有锁时生效，确保确认响应先于第一个事件写出
+            if (task->command.length() == sizeof(eventMask)) {
+                memcpy(&eventMask, task->command.data(), sizeof(eventMask));
+            }
+            response.assign(reinterpret_cast<const char*>(&eventMask), sizeof(eventMask));
+            subscribe = true;
+            respond = true;
+        } else if (task->batch) {
+            respond = ExecuteBatchItem(task, response);
+        } else if (task->type == IPCFrame::MessageBatch) {
+            respond = ExecuteBatch(task, response);
+        } else if (task->type == IPCFrame::MessageSharedMemory) {
+            OpenSharedSession(instance, task->command, response);
+            respond = true;
+        } else {
+            ExecuteMessage(task->type, task->command, response);
+            respond = true;
+        }
+    }
+    m_inflightCommands--;
+    
+    std::lock_guard<std::mutex> lock(instance->mutex);
+    instance->pendingCommands--;
+    
+    if (instance->closing || m_stopping) {
+        TryResetInstance(instance);
+        return;
+    }
+    
+    // 并行批量命令只有最后完成的一条负责响应
+    if (!respond) {
+        return;
+    }
+    
+    if (subscribe) {
+        instance->eventMask = eventMask;
+        instance->subscriptionId = task->requestId;
+        LOG_BINARY(LogLevel::Debug, "IPC client subscribed to events, mask: 0x%08X", eventMask);
+    }
+    
+    QueueWrite(instance, task->requestId, task->type, response);
 }
 
-void IPCManager::SetPipeName(const WString& pipeName) {
-    if (m_serverRunning) {
-        Logger::Log(LogLevel::Warning, "Cannot change pipe name while server is running");
+void IPCManager::QueueWrite(PipeInstance* instance, uint32_t requestId, uint16_t type, const String& payload) {
+    if (instance->pendingWrites.empty()) {
+        instance->pendingWrites = IPCBufferPool::Acquire();
+    }
+    
+    // 旧版客户端一次读取一条原始文本响应
+    if (instance->unframed) {
+        instance->pendingWrites += payload;
+    } else {
+        IPCFrame::AppendMessage(instance->pendingWrites, requestId, payload, type);
+    }
+    
+    if (!instance->writing) {
+        BeginWrite(instance);
+    }
+}
+
+void IPCManager::PublishEvent(const IPCEvent& source) {
+    IPCEvent event = source;
+    event.sequence = ++m_eventSequence;
+    if (event.timestamp == 0) {
+        event.timestamp = GetEventTimestamp();
+    }
+    
+    // 系统中任意进程的启动和退出都会产生事件，一律失效会使缓存在繁忙的主机上形同虚设；
+    // 查询函数刷新进程快照时也会发布这类事件，失效会丢弃其自身的查询结果
+    if (event.type != IPCEventType::ProcessStarted && event.type != IPCEventType::ProcessExited) {
+        m_responseCache.Invalidate();
+    }
+    
+    uint32_t mask = IPCProtocol::GetEventMask(event.type);
+    String payload;
+    IPCProtocol::EncodeEvent(event, payload);
+    
+    std::lock_guard<std::mutex> publishLock(m_publishMutex);
+    if (!m_serverRunning || m_stopping) {
         return;
     }
-    m_pipeName = pipeName;
+    
+    for (auto& instance : m_instances) {
+        std::lock_guard<std::mutex> lock(instance->mutex);
+        if ((instance->eventMask & mask) && !instance->closing) {
+            QueueEvent(instance.get(), payload);
+        }
+    }
 }
 
-String IPCManager::GetLastErrorString() const {
-    switch (m_lastError) {
-        case ErrorCode::Success: return "Success";
-        case ErrorCode::InvalidParameter: return "Invalid parameter";
-        case ErrorCode::AccessDenied: return "Access denied";
-        case ErrorCode::ServiceNotFound: return "Service not found";
-        case ErrorCode::ProcessNotFound: return "Process not found";
-        case ErrorCode::IPCConnectionFailed: return "IPC connection failed";
-        case ErrorCode::UnknownError: return "Unknown error";
-        default: return "Unknown error";
+void IPCManager::QueueEvent(PipeInstance* instance, const String& payload) {
+    // 慢速订阅者的队列满后丢弃新事件，不阻塞发布方和其他订阅者
+    if (instance->queuedEvents + instance->writingEvents >= m_serverConfig.maxQueuedEvents) {
+        instance->droppedEvents++;
+        return;
     }
+    
+    instance->queuedEvents++;
+    QueueWrite(instance, instance->subscriptionId, IPCFrame::MessageEvent, payload);
 }
 
-DWORD WINAPI IPCManager::ServerThreadProc(LPVOID lpParam) {
-    IPCManager* pThis = static_cast<IPCManager*>(lpParam);
-    if (!pThis) {
-        return 1;
+bool IPCManager::ExecuteBatch(CommandTask* task, String& response) {
+    auto batch = std::make_shared<BatchState>();
+    IPCBatchMode mode;
+    if (!IPCBatch::DecodeRequest(task->command, batch->commands, mode)) {
+        Logger::Log(LogLevel::Warning, "Invalid IPC batch request received");
+        IPCBatch::EncodeResponse(batch->results, response);
+        return true;
     }
     
-    Logger::Log(LogLevel::Info, "IPC server thread started");
+    LOG_DEBUG("Executing batch of %zu commands", batch->commands.size());
+    batch->results.resize(batch->commands.size());
     
-    while (WaitForSingleObject(pThis->m_stopEvent, 100) != WAIT_OBJECT_0) {
-        HANDLE hPipe = CreateNamedPipeW(
-            pThis->m_pipeName.c_str(),
-            PIPE_ACCESS_DUPLEX,
-            PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
-            PIPE_UNLIMITED_INSTANCES,
-            4096,
-            4096,
-            0,
-            NULL
-        );
+    if (mode == IPCBatchMode::Sequential || batch->commands.size() <= 1) {
+        for (size_t i = 0; i < batch->commands.size(); ++i) {
+            batch->results[i].success = RunCommand(batch->commands[i], batch->results[i].response);
+        }
+        IPCBatch::EncodeResponse(batch->results, response);
+        return true;
+    }
+    
+    // 每条命令作为独立任务投递，调用线程不等待子任务完成；准入检查时已按命令数预留队列位置和令牌
+    PipeInstance* instance = task->instance;
+    batch->remaining = batch->commands.size();
+    
+    std::lock_guard<std::mutex> lock(instance->mutex);
+    for (size_t i = 0; i < batch->commands.size(); ++i) {
+        auto item = std::make_unique<CommandTask>();
+        item->instance = instance;
+        item->requestId = task->requestId;
+        item->type = IPCFrame::MessageBatch;
+        item->batch = batch;
+        item->batchIndex = i;
+        
+        if (SubmitTask(item, ClassifyMessage(IPCFrame::MessageCommand, batch->commands[i]))) {
+            instance->pendingCommands++;
+            continue;
+        }
         
-        if (hPipe == INVALID_HANDLE_VALUE) {
-            Logger::Log(LogLevel::Error, "Failed to create named pipe, error: %s", Utils::GetLastErrorString().c_str());
+        batch->results[i].response = "Failed to queue command";
+        if (batch->remaining.fetch_sub(1) == 1) {
+            IPCBatch::EncodeResponse(batch->results, response);
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool IPCManager::ExecuteBatchItem(CommandTask* task, String& response) {
+    BatchState& batch = *task->batch;
+    IPCBatchResult& result = batch.results[task->batchIndex];
+    result.success = RunCommand(batch.commands[task->batchIndex], result.response);
+    
+    if (batch.remaining.fetch_sub(1) != 1) {
+        return false;
+    }
+    
+    IPCBatch::EncodeResponse(batch.results, response);
+    return true;
+}
+
+void IPCManager::ExecuteMessage(uint16_t type, const String& message, String& response) {
+    switch (type) {
+        case IPCFrame::MessageCommand:
+            RunCommand(message, response);
+            break;
+        case IPCFrame::MessageBinary:
+            RunRequest(message, response);
+            break;
+        case IPCFrame::MessageBatch: {
+            // 共享内存会话只有一个处理线程，并行批量命令同样按顺序执行
+            std::vector<String> commands;
+            std::vector<IPCBatchResult> results;
+            IPCBatchMode mode;
+            if (IPCBatch::DecodeRequest(message, commands, mode)) {
+                results.resize(commands.size());
+                for (size_t i = 0; i < commands.size(); ++i) {
+                    results[i].success = RunCommand(commands[i], results[i].response);
+                }
+            } else {
+                Logger::Log(LogLevel::Warning, "Invalid IPC batch request received");
+            }
+            IPCBatch::EncodeResponse(results, response);
+            break;
+        }
+        default:
+            response = "Unsupported message type";
+            break;
+    }
+}
+
+void IPCManager::OpenSharedSession(PipeInstance* instance, const String& request, String& response) {
+    // 拒绝时以空响应通知客户端继续使用管道
+    response.clear();
+    
+    size_t capacity = m_serverConfig.sharedCapacity;
+    uint32_t requested = 0;
+    if (request.length() == sizeof(requested)) {
+        memcpy(&requested, request.data(), sizeof(requested));
+        if (requested != 0) {
+            capacity = requested;
+        }
+    }
+    
+    ReapSharedSessions(false);
+    
+    std::lock_guard<std::mutex> lock(m_sessionMutex);
+    if (m_stopping || m_sharedSessions.size() >= m_serverConfig.maxSharedChannels) {
+        Logger::Log(LogLevel::Warning, "Shared memory channel refused, %zu channels open", m_sharedSessions.size());
+        return;
+    }
+    
+    // 客户端进程退出时会话随之结束，不依赖客户端主动关闭通道
+    DWORD clientProcessId = GetClientProcessId(instance);
+    if (clientProcessId == 0) {
+        Logger::Log(LogLevel::Error, "Failed to query IPC client process, error: %s", Utils::GetLastErrorString().c_str());
+        return;
+    }
+    
+    auto session = std::make_unique<SharedSession>();
+    session->owner = this;
+    session->clientProcessId = clientProcessId;
+    session->clientProcess = IPCSharedChannel::OpenPeerProcess(clientProcessId);
+    if (session->clientProcess == kNoPeerProcess) {
+        Logger::Log(LogLevel::Error, "Failed to open IPC client process, error: %s", Utils::GetLastErrorString().c_str());
+        return;
+    }
+    
+    // Linux上shm_open的名称以'/'开头且不能含有其他'/'
+#ifdef _WIN32
+    String name = "Global\\WinlogonManagerService.";
+#else
+    String name = "/WinlogonManagerService.";
+#endif
+    name += std::to_string(GetCurrentProcessId()) + "." + std::to_string(m_nextSessionId++);
+    if (!session->channel.Create(name, capacity)) {
+        Logger::Log(LogLevel::Error, "Failed to create shared memory channel, error: %s", Utils::GetLastErrorString().c_str());
+        IPCSharedChannel::ClosePeerProcess(session->clientProcess);
+        return;
+    }
+    
+    session->thread = CreateThread(NULL, 0, SharedSessionProc, session.get(), 0, NULL);
+    if (!session->thread) {
+        Logger::Log(LogLevel::Error, "Failed to create shared memory session thread, error: %s", Utils::GetLastErrorString().c_str());
+        session->channel.Close();
+        IPCSharedChannel::ClosePeerProcess(session->clientProcess);
+        return;
+    }
+    
+    LOG_BINARY(LogLevel::Debug, "Shared memory channel opened for process %lu", clientProcessId);
+    response = name;
+    m_sharedSessions.push_back(std::move(session));
+}
+
+void IPCManager::RunSharedSession(SharedSession* session) {
+    IPCSharedChannel& channel = session->channel;
+    IPCFrameReader reader;
+    String message;
+    String response;
+    String frames;
+    char buffer[16 * 1024];
+    bool open = true;
+    DWORD retryAfterMs;
+    
+    while (open && !m_stopping) {
+        size_t size = channel.GetRequestRing().Read(buffer, sizeof(buffer), INFINITE, session->clientProcess);
+        if (size == 0) {
             break;
         }
         
-        // 等待客户端连接
-        BOOL connected = ConnectNamedPipe(hPipe, NULL) ? 
-            TRUE : (GetLastError() == ERROR_PIPE_CONNECTED);
+        reader.Append(buffer, size);
         
-        if (connected) {
-            Logger::Log(LogLevel::Debug, "Client connected to IPC pipe");
+        uint32_t requestId;
+        uint16_t type;
+        while (open && reader.NextMessage(requestId, type, message)) {
+            // 会话顺序执行请求，同时只有一条未完成
+            response.clear();
+            IPCStatus admission = AdmitRequest(session->clientProcessId, 0, type, message, retryAfterMs);
+            if (admission == IPCStatus::Ok) {
+                ExecuteMessage(type, message, response);
+            } else {
+                BuildRejectResponse(type, message, admission, retryAfterMs, response);
+            }
             
-            char buffer[4096];
-            DWORD bytesRead;
+            frames.clear();
+            IPCFrame::AppendMessage(frames, requestId, response, type);
             
-            if (ReadFile(hPipe, buffer, sizeof(buffer) - 1, &bytesRead, NULL) && bytesRead > 0) {
-                buffer[bytesRead] = '\0';
-                String command(buffer);
-                pThis->ProcessClientCommand(hPipe, command);
+            // 客户端长时间不读取响应时放弃该会话
+            open = channel.GetResponseRing().Write(frames.c_str(), frames.length(), m_timeoutMs);
+        }
+        
+        if (reader.HasError()) {
+            Logger::Log(LogLevel::Warning, "Invalid IPC frame received on shared memory channel");
+            break;
+        }
+    }
+    
+    reader.Reset();
+    channel.Shutdown();
+    session->finished = true;
+}
+
+void IPCManager::ReapSharedSessions(bool all) {
+    std::lock_guard<std::mutex> lock(m_sessionMutex);
+    
+    auto it = m_sharedSessions.begin();
+    while (it != m_sharedSessions.end()) {
+        SharedSession* session = it->get();
+        if (!all && !session->finished) {
+            ++it;
+            continue;
+        }
+        
+        session->channel.Shutdown();
+        WaitForSingleObject(session->thread, INFINITE);
+        CloseHandle(session->thread);
+        IPCSharedChannel::ClosePeerProcess(session->clientProcess);
+        session->channel.Close();
+        it = m_sharedSessions.erase(it);
+    }
+}
+
+DWORD WINAPI IPCManager::SharedSessionProc(LPVOID lpParam) {
+    SharedSession* session = static_cast<SharedSession*>(lpParam);
+    if (!session) {
+        return 1;
+    }
+    
+    session->owner->RunSharedSession(session);
+    return 0;
+}
+
+DWORD WINAPI IPCManager::WorkerThreadProc(LPVOID lpParam) {
+    IPCManager* pThis = static_cast<IPCManager*>(lpParam);
+    if (!pThis) {
+        return 1;
+    }
+
+#ifdef _WIN32
+    while (true) {
+        DWORD bytesTransferred = 0;
+        ULONG_PTR completionKey = 0;
+        LPOVERLAPPED overlapped = NULL;
+        BOOL success = GetQueuedCompletionStatus(pThis->m_completionPort, &bytesTransferred,
+                                                 &completionKey, &overlapped, INFINITE);
+        DWORD error = success ? ERROR_SUCCESS : ::GetLastError();
+        
+        // 空完成包为退出通知
+        if (!overlapped) {
+            break;
+        }
+        
+        pThis->OnCompletion(reinterpret_cast<PipeInstance*>(completionKey), reinterpret_cast<IoRequest*>(overlapped),
+                            success, bytesTransferred, error);
+    }
+#else
+    // 每次只取少量通知，其余的留给其他空闲的工作线程
+    epoll_event events[8];
+    while (true) {
+        int count = epoll_wait(pThis->m_epoll, events, 8, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
             }
+            break;
         }
         
-        CloseHandle(hPipe);
+        for (int i = 0; i < count; ++i) {
+            void* key = events[i].data.ptr;
+            if (key == &pThis->m_stopEvent) {
+                return 0;
+            }
+            
+            if (key == &pThis->m_listenSocket) {
+                pThis->AcceptConnections();
+            } else {
+                pThis->OnSocketEvent(static_cast<PipeInstance*>(key));
+            }
+        }
     }
+#endif
     
-    Logger::Log(LogLevel::Info, "IPC server thread stopped");
     return 0;
 }
 
-void IPCManager::ProcessClientCommand(HANDLE hPipe, const String& command) {
-    Logger::Log(LogLevel::Info, "Processing command: %s", command.c_str());
+bool IPCManager::SendCommand(const String& command, String& response) {
+    // 一次性请求：建立连接、发送一条命令并等待响应后断开
+    IPCClient client;
+    if (!client.Connect(m_pipeName, m_timeoutMs) || !client.Request(command, response)) {
+        SetLastError(client.GetLastError());
+        return false;
+    }
+    
+    LOG_DEBUG("Command sent successfully, response: %s", response.c_str());
+    return true;
+}
+
+bool IPCManager::SendBatch(const std::vector<String>& commands, std::vector<IPCBatchResult>& results, IPCBatchMode mode) {
+    IPCClient client;
+    if (!client.Connect(m_pipeName, m_timeoutMs) || !client.RequestBatch(commands, mode, results)) {
+        SetLastError(client.GetLastError());
+        return false;
+    }
+    
+    LOG_DEBUG("Batch of %zu commands sent successfully", commands.size());
+    return true;
+}
+
+bool IPCManager::SendRequest(const IPCRequest& request, IPCResult& result) {
+    IPCClient client;
+    if (!client.Connect(m_pipeName, m_timeoutMs) || !client.Call(request, result)) {
+        SetLastError(client.GetLastError());
+        return false;
+    }
     
+    LOG_DEBUG("Request %s sent successfully, status: %u", IPCProtocol::GetOpcodeName(request.opcode),
+              static_cast<unsigned>(result.status));
+    return true;
+}
+
+bool IPCManager::ConnectAsync(IPCAsyncClient& client) {
+    if (!client.Connect(m_pipeName, m_timeoutMs)) {
+        SetLastError(client.GetLastError());
+        return false;
+    }
+    return true;
+}
+
+bool IPCManager::SendCommand(const String& command) {
     String response;
+    return SendCommand(command, response);
+}
+
+void IPCManager::SetPipeName(const WString& pipeName) {
+    if (m_serverRunning) {
+        Logger::Log(LogLevel::Warning, "Cannot change pipe name while server is running");
+        return;
+    }
+    m_pipeName = pipeName;
+}
+
+void IPCManager::SetServerConfig(const IPCServerConfig& config) {
+    if (m_serverRunning) {
+        Logger::Log(LogLevel::Warning, "Cannot change server config while server is running");
+        return;
+    }
+    m_serverConfig = config;
+}
+
+String IPCManager::GetLastErrorString() const {
+    switch (m_lastError) {
+        case ErrorCode::Success: return "Success";
+        case ErrorCode::InvalidParameter: return "Invalid parameter";
+        case ErrorCode::AccessDenied: return "Access denied";
+        case ErrorCode::ServiceNotFound: return "Service not found";
+        case ErrorCode::ProcessNotFound: return "Process not found";
+        case ErrorCode::IPCConnectionFailed: return "IPC connection failed";
+        case ErrorCode::ServerBusy: return "Server busy";
+        case ErrorCode::UnknownError: return "Unknown error";
+        default: return "Unknown error";
+    }
+}
+
+bool IPCManager::RunCommand(const String& command, String& response) {
+    LOG_BINARY(LogLevel::Info, "Processing command: %s", command.c_str());
     
-    if (m_commandHandler) {
-        if (m_commandHandler(command)) {
+    // 旧文本命令转换为二进制请求处理，响应文本保持不变
+    bool success = false;
+    IPCRequest request;
+    if (!m_requestHandler) {
+        response = "No command handler available";
+    } else if (!IPCProtocol::ParseTextCommand(command, request)) {
+        Logger::Log(LogLevel::Warning, "Unknown command: %s", command.c_str());
+        response = "Command execution failed: " + command;
+    } else {
+        IPCResult result = Dispatch(request);
+        success = result.IsOk();
+        if (success) {
             response = "Command executed successfully: " + command;
         } else {
             response = "Command execution failed: " + command;
         }
+        
+        // 状态查询的结果另起一行附在原有响应之后
+        if (IsCacheableOpcode(request.opcode) && !result.message.empty()) {
+            response += "\n" + result.message;
+        }
+    }
+    
+    LOG_BINARY(LogLevel::Debug, "Response sent: %s", response.c_str());
+    return success;
+}
+
+void IPCManager::RunRequest(const String& payload, String& response) {
+    IPCRequest request;
+    IPCResult result;
+    IPCStatus status = IPCProtocol::DecodeRequest(payload, request);
+    if (status != IPCStatus::Ok) {
+        Logger::Log(LogLevel::Warning, "Invalid binary IPC request received");
+        result = IPCResult(status, ErrorCode::InvalidParameter, "Invalid request");
+    } else if (!m_requestHandler) {
+        result = IPCResult(IPCStatus::Failed, ErrorCode::UnknownError, "No command handler available");
     } else {
-        response = "No command handler available";
+        result = Dispatch(request);
     }
     
-    // 发送响应
-    DWORD bytesWritten;
-    WriteFile(hPipe, response.c_str(), static_cast<DWORD>(response.length()), &bytesWritten, NULL);
+    IPCProtocol::EncodeResult(result, response);
+}
+
+IPCResult IPCManager::Dispatch(const IPCRequest& request) {
+    LOG_BINARY(LogLevel::Info, "Processing request: %s, pid: %lu", IPCProtocol::GetOpcodeName(request.opcode),
+               request.processId);
+    
+    IPCResult result;
+    if (m_serverConfig.responseCacheTtlMs > 0 && IsCacheableOpcode(request.opcode)) {
+        result = m_responseCache.Get(request.opcode, [this, &request]() { return m_requestHandler(request); });
+    } else {
+        result = m_requestHandler(request);
+        
+        // 服务和进程操作执行后（无论成败）缓存的状态不再可信
+        if (GetOpcodeClass(request.opcode) != IPCCommandClass::Query) {
+            m_responseCache.Invalidate();
+        }
+    }
     
-    Logger::Log(LogLevel::Debug, "Response sent: %s", response.c_str());
+    LOG_BINARY(LogLevel::Debug, "Request %s completed, status: %u", IPCProtocol::GetOpcodeName(request.opcode),
+               static_cast<unsigned>(result.status));
+    return result;
 }
 
 void IPCManager::SetLastError(ErrorCode error) {
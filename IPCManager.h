@@ -2,8 +2,36 @@
 
 #include "Common.h"
 #include "Logger.h"
+#include "BinaryLogger.h"
+#include "IPCFrame.h"
+#include "IPCClient.h"
+#include "IPCAsyncClient.h"
+#include "IPCCommandPool.h"
+#include "IPCSharedChannel.h"
+#include "IPCRateLimiter.h"
+#include "IPCResponseCache.h"
 #include "Utils.h"
 
+// 服务器配置
+struct IPCServerConfig {
+    DWORD instanceCount;   // 预先创建的管道实例数，即可同时服务的客户端数
+    DWORD workerCount;     // 完成端口（Linux上为epoll）工作线程数，只负责读写，0表示与CPU核数相同
+    DWORD maxSharedChannels;  // 共享内存通道数上限，0表示不提供共享内存传输
+    DWORD sharedCapacity;     // 客户端未指定时共享内存环的容量
+    DWORD maxQueuedEvents;    // 每个订阅者尚未写出的事件上限，超出后丢弃新事件
+    IPCCommandPoolConfig commandPool;  // 命令在独立的线程池中执行，不占用读写线程
+    IPCRateLimit clientRateLimit;      // 每个客户端进程的请求速率
+    IPCRateLimit globalRateLimit;      // 全部客户端合计的请求速率，默认不限
+    DWORD maxPendingPerClient;  // 单个连接上尚未完成的命令上限
+    DWORD maxQueuedCommands;    // 全部连接排队和执行中的命令上限
+    DWORD responseCacheTtlMs;   // 服务和Winlogon状态查询结果的缓存时间，0表示不缓存
+    
+    IPCServerConfig()
+        : instanceCount(8), workerCount(0), maxSharedChannels(16),
+          sharedCapacity(static_cast<DWORD>(IPCSharedChannel::kDefaultCapacity)), maxQueuedEvents(256),
+          clientRateLimit(1000, 2000), maxPendingPerClient(64), maxQueuedCommands(1024), responseCacheTtlMs(200) {}
+};
+
 class IPCManager {
 public:
     IPCManager();
@@ -13,36 +41,220 @@ public:
     IPCManager(const IPCManager&) = delete;
     IPCManager& operator=(const IPCManager&) = delete;
     
-    // 服务器功能
-    bool StartServer(CommandHandler handler = nullptr);
+    // 服务器功能，请求处理函数会在命令线程池的多个线程上并发调用；
+    // 文本命令经IPCProtocol::ParseTextCommand转换后交给同一个处理函数。
+    // 超出限速或队列上限的请求不会执行，直接以“忙，稍后重试”响应
+    bool StartServer(RequestHandler handler = nullptr);
     void StopServer();
     bool IsServerRunning() const { return m_serverRunning; }
     
+    // 向订阅了该类事件的连接推送事件，可在任意线程调用。挂起、恢复和服务状态变化同时使缓存的状态查询结果失效；
+    // 进程启动和退出不影响缓存，与缓存的状态有关时（如winlogon进程）由调用方另外调用InvalidateResponseCache
+    void PublishEvent(const IPCEvent& event);
+    void InvalidateResponseCache() { m_responseCache.Invalidate(); }
+    
+    // 状态查询缓存的命中统计，服务器启动时清零
+    IPCCacheStats GetCacheStats() const { return m_responseCache.GetStats(); }
+    
     // 客户端功能
     bool SendCommand(const String& command, String& response);
     bool SendCommand(const String& command);
+    bool SendBatch(const std::vector<String>& commands, std::vector<IPCBatchResult>& results,
+                   IPCBatchMode mode = IPCBatchMode::Sequential);
+    bool SendRequest(const IPCRequest& request, IPCResult& result);
     
-    // 配置
+    // 以当前的管道名和超时连接异步客户端，请求由调用方的事件循环驱动
+    bool ConnectAsync(IPCAsyncClient& client);
+    
+    // 配置。Linux上管道名映射为Unix域套接字路径，见IPCSocket
     void SetPipeName(const WString& pipeName);
     WString GetPipeName() const { return m_pipeName; }
     void SetTimeout(DWORD timeoutMs) { m_timeoutMs = timeoutMs; }
     DWORD GetTimeout() const { return m_timeoutMs; }
+    void SetServerConfig(const IPCServerConfig& config);
+    const IPCServerConfig& GetServerConfig() const { return m_serverConfig; }
     
     // 错误处理
     ErrorCode GetLastError() const { return m_lastError; }
     String GetLastErrorString() const;
-    
+
 private:
+#ifdef _WIN32
+    // 完成端口上的操作类型
+    enum class PipeOperation {
+        Connect,
+        Read,
+        Write
+    };
+    
+    // OVERLAPPED必须是第一个成员，完成通知据此还原出请求
+    struct IoRequest {
+        OVERLAPPED overlapped;
+        PipeOperation operation;
+        
+        explicit IoRequest(PipeOperation op) : operation(op) {
+            ZeroMemory(&overlapped, sizeof(overlapped));
+        }
+    };
+#endif
+    
+    struct PipeInstance;
+    
+    // 并行批量命令的共享状态，最后完成的子任务负责写出整批响应
+    struct BatchState {
+        std::vector<String> commands;
+        std::vector<IPCBatchResult> results;
+        std::atomic<size_t> remaining;
+        
+        BatchState() : remaining(0) {}
+    };
+    
+    struct CommandTask {
+        PipeInstance* instance;
+        uint32_t requestId;
+        uint16_t type;
+        String command;
+        std::shared_ptr<BatchState> batch;  // 非空表示并行批量命令中的一条
+        size_t batchIndex;
+        
+        CommandTask()
+            : instance(nullptr), requestId(0), type(IPCFrame::MessageCommand), batchIndex(0) {}
+    };
+    
+    // 每个管道实例同时只有一个读操作和一个写操作，连接上的多个请求并发执行，
+    // 响应按完成顺序排队写出。连接断开后等读写和命令全部结束再重新等待连接。
+    // Linux上实例是一个连接槽位，reading/writing表示正在等待套接字可读/可写
+    struct PipeInstance {
+#ifdef _WIN32
+        HANDLE pipe;
+        IoRequest readRequest;    // 等待连接和读取共用
+        IoRequest writeRequest;
+#else
+        int socket;               // 已接受的连接，-1表示空闲
+        size_t writeOffset;       // writeBuffer中已写出的字节数
+#endif
+        std::mutex mutex;
+        char buffer[IPCFrame::kMaxFrameBytes];
+        IPCFrameReader reader;
+        String writeBuffer;       // 正在写出的响应帧
+        String pendingWrites;     // 等待下一次写出的响应帧
+        bool reading;
+        bool writing;
+        bool closing;
+        unsigned pendingCommands;
+        uint32_t eventMask;       // 订阅的事件，0表示未订阅
+        uint32_t subscriptionId;  // 订阅请求的ID，推送的事件沿用该ID
+        size_t queuedEvents;      // pendingWrites中的事件数
+        size_t writingEvents;     // writeBuffer中的事件数
+        uint32_t droppedEvents;   // 队列满时丢弃、尚未告知订阅者的事件数
+        DWORD clientProcessId;
+        uint64_t clientKey;       // 限速的令牌桶：客户端进程ID，无法查询时为按连接分配的键
+        bool detected;            // 已根据第一次读取的数据判断连接是否分帧
+        bool unframed;            // 旧版客户端，请求和响应都是不带帧头的文本
+        
+        PipeInstance()
+#ifdef _WIN32
+            : pipe(INVALID_HANDLE_VALUE), readRequest(PipeOperation::Connect), writeRequest(PipeOperation::Write),
+#else
+            : socket(-1), writeOffset(0),
+#endif
+              reading(false), writing(false), closing(false), pendingCommands(0), eventMask(0), subscriptionId(0),
+              queuedEvents(0), writingEvents(0), droppedEvents(0), clientProcessId(0), clientKey(0), detected(false),
+              unframed(false) {}
+    };
+    
+    // 共享内存会话由专用线程顺序处理请求，省去完成端口的调度延迟；
+    // 客户端关闭通道或进程退出时会话结束
+    struct SharedSession {
+        IPCManager* owner;
+        IPCSharedChannel channel;
+        IPCPeerProcess clientProcess;
+        DWORD clientProcessId;
+        HANDLE thread;
+        std::atomic<bool> finished;
+        
+        SharedSession()
+            : owner(nullptr), clientProcess(kNoPeerProcess), clientProcessId(0), thread(NULL), finished(false) {}
+    };
+    
     WString m_pipeName;
     DWORD m_timeoutMs;
-    HANDLE m_serverThread;
-    HANDLE m_stopEvent;
+    IPCServerConfig m_serverConfig;
+#ifdef _WIN32
+    HANDLE m_completionPort;
+#else
+    int m_epoll;
+    int m_listenSocket;
+    int m_stopEvent;          // eventfd，写入后所有工作线程退出
+    String m_socketPath;
+    std::mutex m_acceptMutex;
+    std::vector<PipeInstance*> m_freeInstances;  // 空闲的连接槽位
+    bool m_acceptPaused;      // 槽位用完后暂停accept，其余客户端在监听队列中等待
+#endif
+    std::vector<HANDLE> m_workerThreads;
+    IPCCommandPool m_commandPool;
+    std::vector<std::unique_ptr<PipeInstance>> m_instances;
+    std::atomic<bool> m_stopping;
     std::atomic<bool> m_serverRunning;
-    CommandHandler m_commandHandler;
+    std::mutex m_sessionMutex;
+    std::vector<std::unique_ptr<SharedSession>> m_sharedSessions;
+    std::atomic<uint32_t> m_nextSessionId;
+    std::mutex m_publishMutex;    // 推送事件期间保持m_instances有效
+    std::atomic<uint64_t> m_eventSequence;
+    IPCRateLimiter m_rateLimiter;
+    std::atomic<uint32_t> m_nextConnectionKey;  // 无法查询客户端进程的连接依次编号，各用独立的令牌桶
+    std::atomic<size_t> m_inflightCommands;  // 已提交到线程池尚未完成的命令数
+    IPCResponseCache m_responseCache;
+    RequestHandler m_requestHandler;
     ErrorCode m_lastError;
     
-    static DWORD WINAPI ServerThreadProc(LPVOID lpParam);
-    void ProcessClientCommand(HANDLE hPipe, const String& command);
+    static DWORD WINAPI WorkerThreadProc(LPVOID lpParam);
+    static DWORD WINAPI SharedSessionProc(LPVOID lpParam);
+    bool OpenTransport();
+    void WakeWorkers();
+    void CloseTransport();
+    bool CreateInstance();
+    
+    // 以下方法均在持有instance->mutex时调用
+    void BeginConnect(PipeInstance* instance);
+    void BeginRead(PipeInstance* instance);
+    void BeginWrite(PipeInstance* instance);
+    void CloseConnection(PipeInstance* instance);
+    void TryResetInstance(PipeInstance* instance);
+    void DisconnectInstance(PipeInstance* instance);
+    DWORD GetClientProcessId(PipeInstance* instance);
+    void QueueWrite(PipeInstance* instance, uint32_t requestId, uint16_t type, const String& payload);
+    void QueueEvent(PipeInstance* instance, const String& payload);
+
+#ifdef _WIN32
+    void OnCompletion(PipeInstance* instance, IoRequest* request, BOOL success, DWORD bytesTransferred, DWORD error);
+#else
+    void AcceptConnections();
+    void OnSocketEvent(PipeInstance* instance);
+    void ContinueWrite(PipeInstance* instance);
+    void WatchSocket(PipeInstance* instance);
+#endif
+    void OnConnected(PipeInstance* instance, BOOL success);
+    void OnReadCompleted(PipeInstance* instance, BOOL success, DWORD bytesTransferred, DWORD error);
+    void SubmitMessage(PipeInstance* instance, uint32_t requestId, uint16_t type, String& message);
+    void OnWriteCompleted(PipeInstance* instance, BOOL success);
+    bool SubmitTask(std::unique_ptr<CommandTask>& task, IPCCommandClass commandClass);
+    IPCStatus AdmitRequest(uint64_t clientKey, unsigned pendingCommands, uint16_t type, const String& message,
+                           DWORD& retryAfterMs);
+    static void BuildRejectResponse(uint16_t type, const String& message, IPCStatus status, DWORD retryAfterMs,
+                                    String& response);
+    void ExecuteCommand(CommandTask* task);
+    bool ExecuteBatch(CommandTask* task, String& response);
+    bool ExecuteBatchItem(CommandTask* task, String& response);
+    void ExecuteMessage(uint16_t type, const String& message, String& response);
+    void OpenSharedSession(PipeInstance* instance, const String& request, String& response);
+    void RunSharedSession(SharedSession* session);
+    void ReapSharedSessions(bool all);
+    void ReleaseServerResources();
+    bool RunCommand(const String& command, String& response);
+    void RunRequest(const String& payload, String& response);
+    IPCResult Dispatch(const IPCRequest& request);
+    static IPCCommandClass ClassifyMessage(uint16_t type, const String& message);
     void SetLastError(ErrorCode error);
     void SetLastError(DWORD win32Error);
 };
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "IPCProtocol.h"
+
+namespace {
+
+template <typename T>
+void AppendValue(String& out, T value) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+class ProtocolReader {
+public:
+    explicit ProtocolReader(const String& data) : m_data(data), m_offset(0) {}
+    
+    bool AtEnd() const { return m_offset == m_data.size(); }
+    
+    template <typename T>
+    bool Read(T& value) {
+        if (m_data.size() - m_offset < sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, m_data.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+    
+    bool ReadWString(WString& value) {
+        uint16_t length;
+        const char* units;
+        if (!Read(length) || !ReadBytes(length * sizeof(uint16_t), units)) {
+            return false;
+        }
+        
+        value.resize(length);
+        for (uint16_t i = 0; i < length; ++i) {
+            uint16_t unit;
+            memcpy(&unit, units + i * sizeof(uint16_t), sizeof(unit));
+            value[i] = static_cast<wchar_t>(unit);
+        }
+        return true;
+    }
+    
+    bool ReadBytes(size_t size, const char*& bytes) {
+        if (m_data.size() - m_offset < size) {
+            return false;
+        }
+        bytes = m_data.data() + m_offset;
+        m_offset += size;
+        return true;
+    }
+
+private:
+    const String& m_data;
+    size_t m_offset;
+};
+
+// 旧文本命令到操作码的映射
+const std::unordered_map<String, IPCOpcode>& GetTextCommands() {
+    static const std::unordered_map<String, IPCOpcode> commands = {
+        { "--install", IPCOpcode::InstallService },
+        { "--uninstall", IPCOpcode::UninstallService },
+        { "--start", IPCOpcode::StartService },
+        { "--stop", IPCOpcode::StopService },
+        { "--restart", IPCOpcode::RestartService },
+        { "--status", IPCOpcode::QueryServiceStatus },
+        { "--suspend", IPCOpcode::SuspendWinlogon },
+        { "--resume", IPCOpcode::ResumeWinlogon },
+        { "--winlogon-status", IPCOpcode::QueryWinlogonStatus },
+        { "--help", IPCOpcode::Help }
+    };
+    return commands;
+}
+
+// [length u16][UTF-16码元]
+void AppendWString(String& out, const WString& value) {
+    uint16_t length = static_cast<uint16_t>(std::min<size_t>(value.length(), 0xFFFF));
+    AppendValue<uint16_t>(out, length);
+    for (uint16_t i = 0; i < length; ++i) {
+        AppendValue<uint16_t>(out, static_cast<uint16_t>(value[i]));
+    }
+}
+
+} // namespace
+
+void IPCProtocol::EncodeRequest(const IPCRequest& request, String& out) {
+    AppendValue<uint8_t>(out, kVersion);
+    AppendValue<uint16_t>(out, static_cast<uint16_t>(request.opcode));
+    AppendValue<uint32_t>(out, request.processId);
+    AppendValue<uint32_t>(out, request.exitCode);
+    AppendWString(out, request.processName);
+}
+
+IPCStatus IPCProtocol::DecodeRequest(const String& data, IPCRequest& request) {
+    ProtocolReader reader(data);
+    uint8_t version;
+    if (!reader.Read(version)) {
+        return IPCStatus::InvalidRequest;
+    }
+    if (version != kVersion) {
+        return IPCStatus::UnsupportedVersion;
+    }
+    
+    uint16_t opcode;
+    uint32_t processId;
+    uint32_t exitCode;
+    if (!reader.Read(opcode) || !reader.Read(processId) || !reader.Read(exitCode) ||
+        !reader.ReadWString(request.processName) || !reader.AtEnd()) {
+        return IPCStatus::InvalidRequest;
+    }
+    
+    request.opcode = static_cast<IPCOpcode>(opcode);
+    request.processId = processId;
+    request.exitCode = exitCode;
+    return IPCStatus::Ok;
+}
+
+void IPCProtocol::EncodeResult(const IPCResult& result, String& out) {
+    AppendValue<uint8_t>(out, kVersion);
+    AppendValue<uint16_t>(out, static_cast<uint16_t>(result.status));
+    AppendValue<uint32_t>(out, static_cast<uint32_t>(result.error));
+    AppendValue<uint32_t>(out, static_cast<uint32_t>(result.message.length()));
+    out += result.message;
+    // retryAfterMs是可选尾部，只随Busy结果发送，旧版本客户端解码普通结果不受影响
+    if (result.status == IPCStatus::Busy) {
+        AppendValue<uint32_t>(out, result.retryAfterMs);
+    }
+}
+
+bool IPCProtocol::DecodeResult(const String& data, IPCResult& result) {
+    ProtocolReader reader(data);
+    uint8_t version;
+    uint16_t status;
+    uint32_t error;
+    uint32_t messageLength;
+    const char* message;
+    uint32_t retryAfterMs = 0;
+    if (!reader.Read(version) || version != kVersion || !reader.Read(status) || !reader.Read(error) ||
+        !reader.Read(messageLength) || !reader.ReadBytes(messageLength, message)) {
+        return false;
+    }
+    
+    // 旧版本服务器不发送retryAfterMs尾部
+    if (!reader.AtEnd() && (!reader.Read(retryAfterMs) || !reader.AtEnd())) {
+        return false;
+    }
+    
+    result.status = static_cast<IPCStatus>(status);
+    result.error = static_cast<ErrorCode>(error);
+    result.message.assign(message, messageLength);
+    result.retryAfterMs = retryAfterMs;
+    return true;
+}
+
+void IPCProtocol::EncodeEvent(const IPCEvent& event, String& out) {
+    AppendValue<uint8_t>(out, kVersion);
+    AppendValue<uint16_t>(out, static_cast<uint16_t>(event.type));
+    AppendValue<uint64_t>(out, event.sequence);
+    AppendValue<uint64_t>(out, event.timestamp);
+    AppendValue<uint32_t>(out, event.processId);
+    AppendValue<uint32_t>(out, event.state);
+    AppendValue<uint32_t>(out, event.count);
+    AppendWString(out, event.name);
+}
+
+bool IPCProtocol::DecodeEvent(const String& data, IPCEvent& event) {
+    ProtocolReader reader(data);
+    uint8_t version;
+    uint16_t type;
+    uint32_t processId;
+    uint32_t state;
+    if (!reader.Read(version) || version != kVersion || !reader.Read(type) || !reader.Read(event.sequence) ||
+        !reader.Read(event.timestamp) || !reader.Read(processId) || !reader.Read(state) ||
+        !reader.Read(event.count) || !reader.ReadWString(event.name) || !reader.AtEnd()) {
+        return false;
+    }
+    
+    event.type = static_cast<IPCEventType>(type);
+    event.processId = processId;
+    event.state = state;
+    return true;
+}
+
+bool IPCProtocol::ParseTextCommand(const String& command, IPCRequest& request) {
+    const auto& commands = GetTextCommands();
+    auto it = commands.find(command);
+    if (it == commands.end()) {
+        request = IPCRequest();
+        return false;
+    }
+    
+    request = IPCRequest(it->second);
+    return true;
+}
+
+const char* IPCProtocol::GetOpcodeName(IPCOpcode opcode) {
+    switch (opcode) {
+        case IPCOpcode::InstallService: return "InstallService";
+        case IPCOpcode::UninstallService: return "UninstallService";
+        case IPCOpcode::StartService: return "StartService";
+        case IPCOpcode::StopService: return "StopService";
+        case IPCOpcode::RestartService: return "RestartService";
+        case IPCOpcode::QueryServiceStatus: return "QueryServiceStatus";
+        case IPCOpcode::SuspendWinlogon: return "SuspendWinlogon";
+        case IPCOpcode::ResumeWinlogon: return "ResumeWinlogon";
+        case IPCOpcode::QueryWinlogonStatus: return "QueryWinlogonStatus";
+        case IPCOpcode::Help: return "Help";
+        case IPCOpcode::SuspendProcess: return "SuspendProcess";
+        case IPCOpcode::ResumeProcess: return "ResumeProcess";
+        case IPCOpcode::TerminateProcess: return "TerminateProcess";
+        default: return "Invalid";
+    }
+}
\ No newline at end of file
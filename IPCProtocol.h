@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Common.h"
+#include <unordered_map>
+
+// 命令操作码，数值一经发布不得修改
+enum class IPCOpcode : uint16_t {
+    Invalid = 0,
+    InstallService = 1,
+    UninstallService = 2,
+    StartService = 3,
+    StopService = 4,
+    RestartService = 5,
+    QueryServiceStatus = 6,
+    SuspendWinlogon = 7,
+    ResumeWinlogon = 8,
+    QueryWinlogonStatus = 9,
+    Help = 10,
+    SuspendProcess = 11,    // 参数: processId 或 processName
+    ResumeProcess = 12,     // 参数: processId 或 processName
+    TerminateProcess = 13   // 参数: processId 或 processName, exitCode
+};
+
+// 命令执行状态
+enum class IPCStatus : uint16_t {
+    Ok = 0,
+    Failed = 1,
+    InvalidRequest = 2,
+    UnknownOpcode = 3,
+    UnsupportedVersion = 4,
+    Busy = 5              // 服务器限流或队列已满，retryAfterMs后重试
+};
+
+struct IPCRequest {
+    IPCOpcode opcode;
+    DWORD processId;       // 0表示按processName查找
+    WString processName;
+    UINT exitCode;
+    
+    IPCRequest() : opcode(IPCOpcode::Invalid), processId(0), exitCode(0) {}
+    explicit IPCRequest(IPCOpcode op) : opcode(op), processId(0), exitCode(0) {}
+};
+
+struct IPCResult {
+    IPCStatus status;
+    ErrorCode error;
+    String message;
+    DWORD retryAfterMs;   // 仅status为Busy时有效
+    
+    IPCResult() : status(IPCStatus::Ok), error(ErrorCode::Success), retryAfterMs(0) {}
+    IPCResult(IPCStatus resultStatus, ErrorCode resultError, const String& resultMessage = "")
+        : status(resultStatus), error(resultError), message(resultMessage), retryAfterMs(0) {}
+    
+    bool IsOk() const { return status == IPCStatus::Ok; }
+};
+
+using RequestHandler = std::function<IPCResult(const IPCRequest&)>;
+
+// 服务器推送的事件类型
+enum class IPCEventType : uint16_t {
+    ProcessStarted = 1,
+    ProcessExited = 2,
+    ProcessSuspended = 3,
+    ProcessResumed = 4,
+    ServiceStateChanged = 5,
+    EventsDropped = 6   // 订阅者处理过慢，count条事件被丢弃
+};
+
+// 订阅掩码，每种事件类型占一位；EventsDropped总是推送给订阅者
+enum IPCEventMask : uint32_t {
+    EventMaskProcessStarted = 1u << 1,
+    EventMaskProcessExited = 1u << 2,
+    EventMaskProcessSuspended = 1u << 3,
+    EventMaskProcessResumed = 1u << 4,
+    EventMaskServiceState = 1u << 5,
+    EventMaskAll = 0xFFFFFFFFu
+};
+
+struct IPCEvent {
+    IPCEventType type;
+    uint64_t sequence;    // 服务器端递增的事件序号
+    uint64_t timestamp;   // FILETIME（UTC）
+    DWORD processId;
+    DWORD state;          // ServiceStateChanged时为SERVICE_RUNNING等服务状态
+    uint32_t count;       // EventsDropped时为丢弃的事件数
+    WString name;         // 进程名或服务名
+    
+    IPCEvent() : type(IPCEventType::ProcessStarted), sequence(0), timestamp(0), processId(0), state(0), count(0) {}
+    explicit IPCEvent(IPCEventType eventType)
+        : type(eventType), sequence(0), timestamp(0), processId(0), state(0), count(0) {}
+};
+
+// 二进制命令协议，作为MessageBinary类型的消息内容，整数均为小端序：
+//   请求 [version u8][opcode u16][processId u32][exitCode u32][nameLength u16][UTF-16进程名]
+//   响应 [version u8][status u16][error u32][messageLength u32][UTF-8消息]([retryAfterMs u32])
+//        retryAfterMs为可选尾部，仅Busy响应携带，缺省时按0处理
+//   事件 [version u8][type u16][sequence u64][timestamp u64][processId u32][state u32][count u32]
+//        [nameLength u16][UTF-16名称]，作为MessageEvent类型的消息推送
+namespace IPCProtocol {
+
+const uint8_t kVersion = 1;
+
+void EncodeRequest(const IPCRequest& request, String& out);
+IPCStatus DecodeRequest(const String& data, IPCRequest& request);
+
+void EncodeResult(const IPCResult& result, String& out);
+bool DecodeResult(const String& data, IPCResult& result);
+
+void EncodeEvent(const IPCEvent& event, String& out);
+bool DecodeEvent(const String& data, IPCEvent& event);
+
+inline uint32_t GetEventMask(IPCEventType type) {
+    return 1u << static_cast<uint16_t>(type);
+}
+
+// 文本兼容层：将 "--suspend" 这类旧命令映射到操作码，未知命令返回false
+bool ParseTextCommand(const String& command, IPCRequest& request);
+
+const char* GetOpcodeName(IPCOpcode opcode);
+
+} // namespace IPCProtocol
\ No newline at end of file
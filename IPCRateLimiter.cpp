@@ -0,0 +1,103 @@
+#include "IPCRateLimiter.h"
+#include <cmath>
+
+IPCRateLimiter::IPCRateLimiter()
+    : m_lastPrune(0) {
+    m_globalBucket.tokens = 0;
+    m_globalBucket.lastRefill = 0;
+}
+
+void IPCRateLimiter::Configure(const IPCRateLimit& perClient, const IPCRateLimit& global) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_perClient = perClient;
+    m_global = global;
+    m_globalBucket.tokens = GetCapacity(global);
+    m_globalBucket.lastRefill = GetTickCount64();
+    m_clients.clear();
+}
+
+bool IPCRateLimiter::TryAcquire(uint64_t clientKey, DWORD tokens, DWORD& retryAfterMs) {
+    retryAfterMs = 0;
+    double cost = static_cast<double>(tokens);
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_perClient.IsEnabled() && !m_global.IsEnabled()) {
+        return true;
+    }
+    
+    ULONGLONG now = GetTickCount64();
+    
+    Bucket* client = nullptr;
+    if (m_perClient.IsEnabled()) {
+        auto it = m_clients.find(clientKey);
+        if (it == m_clients.end()) {
+            Prune(now);
+            Bucket bucket;
+            bucket.tokens = GetCapacity(m_perClient);
+            bucket.lastRefill = now;
+            it = m_clients.emplace(clientKey, bucket).first;
+        }
+        
+        client = &it->second;
+        Refill(*client, m_perClient, now);
+        if (client->tokens < cost) {
+            retryAfterMs = GetRetryAfter(*client, m_perClient, cost);
+            return false;
+        }
+    }
+    
+    // 全局令牌不足时不消耗客户端令牌，避免被限速的请求再占用客户端的配额
+    if (m_global.IsEnabled()) {
+        Refill(m_globalBucket, m_global, now);
+        if (m_globalBucket.tokens < cost) {
+            retryAfterMs = GetRetryAfter(m_globalBucket, m_global, cost);
+            return false;
+        }
+        m_globalBucket.tokens -= cost;
+    }
+    
+    if (client) {
+        client->tokens -= cost;
+    }
+    return true;
+}
+
+DWORD IPCRateLimiter::GetMaxTokens() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    double capacity = static_cast<double>(MAXDWORD);
+    if (m_perClient.IsEnabled()) {
+        capacity = std::min(capacity, GetCapacity(m_perClient));
+    }
+    if (m_global.IsEnabled()) {
+        capacity = std::min(capacity, GetCapacity(m_global));
+    }
+    return static_cast<DWORD>(capacity);
+}
+
+void IPCRateLimiter::Refill(Bucket& bucket, const IPCRateLimit& limit, ULONGLONG now) {
+    double elapsedSeconds = static_cast<double>(now - bucket.lastRefill) / 1000.0;
+    bucket.tokens = std::min(GetCapacity(limit), bucket.tokens + elapsedSeconds * limit.ratePerSecond);
+    bucket.lastRefill = now;
+}
+
+DWORD IPCRateLimiter::GetRetryAfter(const Bucket& bucket, const IPCRateLimit& limit, double tokens) {
+    double missing = tokens - bucket.tokens;
+    return static_cast<DWORD>(std::ceil(missing * 1000.0 / limit.ratePerSecond));
+}
+
+void IPCRateLimiter::Prune(ULONGLONG now) {
+    if (now - m_lastPrune < kPruneIntervalMs) {
+        return;
+    }
+    m_lastPrune = now;
+    
+    auto it = m_clients.begin();
+    while (it != m_clients.end()) {
+        Refill(it->second, m_perClient, now);
+        if (it->second.tokens >= GetCapacity(m_perClient)) {
+            it = m_clients.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Common.h"
+#include <unordered_map>
+
+// 令牌桶参数：每秒补充ratePerSecond个令牌，最多积累burst个，ratePerSecond为0表示不限速
+struct IPCRateLimit {
+    double ratePerSecond;
+    double burst;
+    
+    IPCRateLimit() : ratePerSecond(0), burst(0) {}
+    IPCRateLimit(double rate, double burstSize) : ratePerSecond(rate), burst(burstSize) {}
+    
+    bool IsEnabled() const { return ratePerSecond > 0; }
+};
+
+// 按客户端和全局两级令牌桶限速，每个请求消耗一个令牌，批量请求按命令数消耗。
+// 客户端以64位键区分：通常为客户端进程ID，无法查询进程ID的连接由调用方分配高32位非零的键，各自使用独立的令牌桶
+class IPCRateLimiter {
+public:
+    IPCRateLimiter();
+    
+    // 禁用拷贝构造和赋值
+    IPCRateLimiter(const IPCRateLimiter&) = delete;
+    IPCRateLimiter& operator=(const IPCRateLimiter&) = delete;
+    
+    // 同时清空全部令牌桶
+    void Configure(const IPCRateLimit& perClient, const IPCRateLimit& global);
+    
+    // 两级令牌桶都有足够令牌时消耗并返回true，否则retryAfterMs为令牌补足前需要等待的时间
+    bool TryAcquire(uint64_t clientKey, DWORD& retryAfterMs) { return TryAcquire(clientKey, 1, retryAfterMs); }
+    bool TryAcquire(uint64_t clientKey, DWORD tokens, DWORD& retryAfterMs);
+    
+    // 单次请求最多可消耗的令牌数，即两级令牌桶中较小的容量，超出的请求等待多久都无法被接受
+    DWORD GetMaxTokens() const;
+
+private:
+    // 空闲客户端的令牌桶定期清理，已补满的桶与新建的桶没有区别
+    static const ULONGLONG kPruneIntervalMs = 60 * 1000;
+    
+    struct Bucket {
+        double tokens;
+        ULONGLONG lastRefill;
+    };
+    
+    mutable std::mutex m_mutex;
+    IPCRateLimit m_perClient;
+    IPCRateLimit m_global;
+    Bucket m_globalBucket;
+    std::unordered_map<uint64_t, Bucket> m_clients;
+    ULONGLONG m_lastPrune;
+    
+    static void Refill(Bucket& bucket, const IPCRateLimit& limit, ULONGLONG now);
+    static double GetCapacity(const IPCRateLimit& limit) { return std::max(limit.burst, 1.0); }
+    static DWORD GetRetryAfter(const Bucket& bucket, const IPCRateLimit& limit, double tokens);
+    void Prune(ULONGLONG now);
+};
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "IPCResponseCache.h"
+
+IPCResponseCache::IPCResponseCache()
+    : m_ttlMs(0)
+    , m_generation(0) {
+}
+
+void IPCResponseCache::Configure(DWORD ttlMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ttlMs = ttlMs;
+    m_generation++;
+    for (auto& pair : m_entries) {
+        pair.second.valid = false;
+    }
+    m_stats = IPCCacheStats();
+}
+
+IPCResult IPCResponseCache::Get(IPCOpcode opcode, const Loader& loader) {
+    uint16_t key = static_cast<uint16_t>(opcode);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    Entry& entry = m_entries[key];
+    if (entry.valid && GetTickCount64() < entry.expires) {
+        m_stats.hits++;
+        return entry.result;
+    }
+    
+    if (entry.flight) {
+        std::shared_ptr<Flight> flight = entry.flight;
+        m_stats.coalesced++;
+        m_loaded.wait(lock, [&flight]() { return flight->done; });
+        return flight->result;
+    }
+    
+    // 由当前线程执行查询，期间其他相同查询在上面等待
+    m_stats.misses++;
+    std::shared_ptr<Flight> flight = std::make_shared<Flight>();
+    entry.flight = flight;
+    uint64_t generation = m_generation;
+    lock.unlock();
+    
+    // 查询函数抛出异常时同样结束本次查询，等待者收到失败结果而不是永远阻塞
+    struct FlightGuard {
+        IPCResponseCache* cache;
+        uint16_t key;
+        std::shared_ptr<Flight> flight;
+        uint64_t generation;
+        bool completed;
+        
+        ~FlightGuard() {
+            if (!completed) {
+                cache->Complete(key, *flight, generation, nullptr);
+            }
+        }
+    };
+    FlightGuard guard = { this, key, flight, generation, false };
+    
+    IPCResult result = loader();
+    guard.completed = true;
+    Complete(key, *flight, generation, &result);
+    return result;
+}
+
+void IPCResponseCache::Complete(uint16_t key, Flight& flight, uint64_t generation, const IPCResult* result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (result) {
+        flight.result = *result;
+    } else {
+        flight.result = IPCResult(IPCStatus::Failed, ErrorCode::UnknownError, "Query failed");
+    }
+    flight.done = true;
+    
+    // 查询期间调用过Invalidate时，条目上可能已是之后开始的查询
+    Entry& current = m_entries[key];
+    if (current.flight.get() == &flight) {
+        current.flight.reset();
+    }
+    if (result && generation == m_generation && m_ttlMs > 0) {
+        current.valid = true;
+        current.expires = GetTickCount64() + m_ttlMs;
+        current.result = *result;
+    }
+    
+    m_loaded.notify_all();
+}
+
+void IPCResponseCache::Invalidate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_generation++;
+    for (auto& pair : m_entries) {
+        pair.second.valid = false;
+        pair.second.flight.reset();
+    }
+}
+
+IPCCacheStats IPCResponseCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
\ No newline at end of file
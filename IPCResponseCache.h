@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Common.h"
+#include "IPCProtocol.h"
+#include <unordered_map>
+#include <condition_variable>
+
+struct IPCCacheStats {
+    uint64_t hits;       // 直接返回缓存结果
+    uint64_t misses;     // 执行了实际查询
+    uint64_t coalesced;  // 等待同一查询的进行中结果
+    
+    IPCCacheStats() : hits(0), misses(0), coalesced(0) {}
+};
+
+// 无参数查询的响应缓存：结果在TTL内复用，缓存失效时并发的相同查询只执行一次，
+// 其余调用等待并共享该结果
+class IPCResponseCache {
+public:
+    using Loader = std::function<IPCResult()>;
+    
+    IPCResponseCache();
+    
+    // 禁用拷贝构造和赋值
+    IPCResponseCache(const IPCResponseCache&) = delete;
+    IPCResponseCache& operator=(const IPCResponseCache&) = delete;
+    
+    // 同时清空缓存和统计
+    void Configure(DWORD ttlMs);
+    
+    // loader抛出的异常传给调用者，同时等待该查询的其他调用收到失败结果
+    IPCResult Get(IPCOpcode opcode, const Loader& loader);
+    
+    // 状态可能已改变时调用；进行中的查询结果仍返回给已在等待的调用，但不再写入缓存，
+    // 之后的调用不再等待它而是重新查询
+    void Invalidate();
+    
+    IPCCacheStats GetStats() const;
+
+private:
+    struct Flight {
+        bool done;
+        IPCResult result;
+        
+        Flight() : done(false) {}
+    };
+    
+    struct Entry {
+        bool valid;
+        ULONGLONG expires;
+        IPCResult result;
+        std::shared_ptr<Flight> flight;  // 进行中的查询
+        
+        Entry() : valid(false), expires(0) {}
+    };
+    
+    mutable std::mutex m_mutex;
+    std::condition_variable m_loaded;
+    DWORD m_ttlMs;
+    uint64_t m_generation;
+    std::unordered_map<uint16_t, Entry> m_entries;
+    IPCCacheStats m_stats;
+    
+    // 结束进行中的查询并唤醒等待者，result为空表示查询失败，结果不写入缓存
+    void Complete(uint16_t key, Flight& flight, uint64_t generation, const IPCResult* result);
+};
\ No newline at end of file
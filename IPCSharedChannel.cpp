@@ -0,0 +1,485 @@
+#include "IPCSharedChannel.h"
+
+#ifndef _WIN32
+#include <climits>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+namespace {
+
+// 映射为MAP_SHARED，不能使用FUTEX_PRIVATE_FLAG
+void FutexWait(std::atomic<uint32_t>* word, uint32_t expected, DWORD timeoutMs) {
+    timespec timeout;
+    timeout.tv_sec = static_cast<time_t>(timeoutMs / 1000);
+    timeout.tv_nsec = static_cast<long>((timeoutMs % 1000) * 1000000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected,
+            timeoutMs == INFINITE ? nullptr : &timeout, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// pidfd在进程退出后变为可读
+bool HasExited(IPCPeerProcess peer) {
+    pollfd descriptor = { peer, POLLIN, 0 };
+    return poll(&descriptor, 1, 0) > 0;
+}
+
+} // namespace
+#endif
+
+IPCSharedRing::IPCSharedRing()
+    : m_header(nullptr), m_data(nullptr), m_capacity(0), m_dataSignal(NULL), m_spaceSignal(NULL), m_closed(nullptr) {
+}
+
+void IPCSharedRing::Attach(IPCSharedRingHeader* header, char* data, size_t capacity,
+                           WakeSignal dataSignal, WakeSignal spaceSignal, const std::atomic<uint32_t>* closed) {
+    m_header = header;
+    m_data = data;
+    m_capacity = capacity;
+    m_dataSignal = dataSignal;
+    m_spaceSignal = spaceSignal;
+    m_closed = closed;
+}
+
+void IPCSharedRing::Notify(WakeSignal signal) {
+#ifdef _WIN32
+    SetEvent(signal);
+#else
+    signal->fetch_add(1);
+    FutexWakeAll(signal);
+#endif
+}
+
+template <typename Ready>
+bool IPCSharedRing::Wait(std::atomic<uint32_t>& waiting, WakeSignal signal, Ready ready,
+                         ULONGLONG start, DWORD timeoutMs, IPCPeerProcess peer) {
+    // 高频请求下对端通常很快就有进展，自旋可以省去一次内核等待和唤醒；
+    // 单处理器上对端在自旋期间无法运行，直接休眠
+    static const unsigned spinCount = []() {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        return systemInfo.dwNumberOfProcessors > 1 ? kSpinCount : 0u;
+    }();
+    for (unsigned i = 0; i < spinCount; ++i) {
+        if (ready() || IsClosed()) {
+            return true;
+        }
+        YieldProcessor();
+    }
+    
+    // 登记等待后必须重新检查条件，否则可能错过对端在登记之前的写入
+    waiting.store(1);
+    bool success = true;
+    while (!ready() && !IsClosed()) {
+        DWORD remaining = INFINITE;
+        if (timeoutMs != INFINITE) {
+            ULONGLONG elapsed = GetTickCount64() - start;
+            if (elapsed >= timeoutMs) {
+                success = false;
+                break;
+            }
+            remaining = static_cast<DWORD>(timeoutMs - elapsed);
+        }
+
+#ifdef _WIN32
+        HANDLE handles[2] = { signal, peer };
+        DWORD result = WaitForMultipleObjects(peer ? 2 : 1, handles, FALSE, remaining);
+        if (result != WAIT_OBJECT_0 && result != WAIT_TIMEOUT) {
+            success = false;
+            break;
+        }
+#else
+        // 先取通知计数再检查条件，检查之后的通知会使futex等待立即返回
+        uint32_t sequence = signal->load();
+        if (ready() || IsClosed()) {
+            break;
+        }
+        if (peer != kNoPeerProcess && remaining > kPeerPollMs) {
+            remaining = kPeerPollMs;
+        }
+        FutexWait(signal, sequence, remaining);
+        if (peer != kNoPeerProcess && HasExited(peer)) {
+            success = false;
+            break;
+        }
+#endif
+    }
+    waiting.store(0);
+    return success;
+}
+
+bool IPCSharedRing::Write(const char* data, size_t size, DWORD timeoutMs) {
+    ULONGLONG start = GetTickCount64();
+    uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+    auto hasSpace = [this, &tail]() {
+        return tail - m_header->head.load(std::memory_order_acquire) < m_capacity;
+    };
+    
+    size_t written = 0;
+    while (written < size) {
+        if (IsClosed()) {
+            return false;
+        }
+        
+        if (!hasSpace()) {
+            if (!Wait(m_header->writerWaiting, m_spaceSignal, hasSpace, start, timeoutMs, kNoPeerProcess)) {
+                return false;
+            }
+            continue;
+        }
+        
+        // 空间不足以容纳全部数据时分段写入，消费者可以边读边腾出空间
+        size_t freeBytes = m_capacity - static_cast<size_t>(tail - m_header->head.load(std::memory_order_acquire));
+        size_t chunk = std::min(freeBytes, size - written);
+        size_t offset = static_cast<size_t>(tail & (m_capacity - 1));
+        size_t first = std::min(chunk, m_capacity - offset);
+        memcpy(m_data + offset, data + written, first);
+        memcpy(m_data, data + written + first, chunk - first);
+        
+        tail += chunk;
+        written += chunk;
+        m_header->tail.store(tail);
+        if (m_header->readerWaiting.load()) {
+            Notify(m_dataSignal);
+        }
+    }
+    return true;
+}
+
+size_t IPCSharedRing::Read(char* buffer, size_t size, DWORD timeoutMs, IPCPeerProcess peer) {
+    uint64_t head = m_header->head.load(std::memory_order_relaxed);
+    auto hasData = [this, head]() {
+        return m_header->tail.load(std::memory_order_acquire) != head;
+    };
+    
+    if (!hasData() && !Wait(m_header->readerWaiting, m_dataSignal, hasData, GetTickCount64(), timeoutMs, peer)) {
+        return 0;
+    }
+    
+    // 通道关闭后仍先读完已写入的数据
+    uint64_t tail = m_header->tail.load(std::memory_order_acquire);
+    size_t chunk = static_cast<size_t>(std::min<uint64_t>(tail - head, size));
+    if (chunk == 0) {
+        return 0;
+    }
+    
+    size_t offset = static_cast<size_t>(head & (m_capacity - 1));
+    size_t first = std::min(chunk, m_capacity - offset);
+    memcpy(buffer, m_data + offset, first);
+    memcpy(buffer + first, m_data, chunk - first);
+    
+    m_header->head.store(head + chunk);
+    if (m_header->writerWaiting.load()) {
+        Notify(m_spaceSignal);
+    }
+    return chunk;
+}
+
+void IPCSharedRing::Wake() {
+    if (m_dataSignal) {
+        Notify(m_dataSignal);
+    }
+    if (m_spaceSignal) {
+        Notify(m_spaceSignal);
+    }
+}
+
+#ifdef _WIN32
+IPCSharedChannel::IPCSharedChannel()
+    : m_mapping(NULL), m_view(nullptr), m_header(nullptr) {
+    for (HANDLE& event : m_events) {
+        event = NULL;
+    }
+}
+#else
+IPCSharedChannel::IPCSharedChannel()
+    : m_viewSize(0), m_owner(false), m_view(nullptr), m_header(nullptr) {
+}
+#endif
+
+IPCSharedChannel::~IPCSharedChannel() {
+    Close();
+}
+
+size_t IPCSharedChannel::GetMappingSize(size_t capacity) {
+    return sizeof(Header) + 2 * sizeof(IPCSharedRingHeader) + 2 * capacity;
+}
+
+bool IPCSharedChannel::Create(const String& name, size_t capacity) {
+    Close();
+    
+    size_t ringCapacity = kMinCapacity;
+    while (ringCapacity < capacity && ringCapacity < kMaxCapacity) {
+        ringCapacity *= 2;
+    }
+
+#ifndef _WIN32
+    // O_EXCL保证不会使用他人预先创建的同名对象
+    size_t mappingSize = GetMappingSize(ringCapacity);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        SetLastError(errno);
+        return false;
+    }
+    
+    m_name = name;
+    m_owner = true;
+    if (ftruncate(fd, static_cast<off_t>(mappingSize)) != 0) {
+        SetLastError(errno);
+        close(fd);
+        Close();
+        return false;
+    }
+    
+    void* view = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        SetLastError(errno);
+        Close();
+        return false;
+    }
+    
+    // ftruncate扩展的内容为零，读写位置、等待标志和futex字无需初始化
+    m_view = static_cast<char*>(view);
+    m_viewSize = mappingSize;
+    m_header = reinterpret_cast<Header*>(m_view);
+    m_header->magic = kMagic;
+    m_header->version = kVersion;
+    m_header->capacity = ringCapacity;
+    
+    AttachRings(ringCapacity);
+    return true;
+#else
+    uint64_t mappingSize = GetMappingSize(ringCapacity);
+    m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                   static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize), name.c_str());
+    
+    // 同名对象已存在说明名称被占用，不能使用他人创建的映射
+    if (!m_mapping || ::GetLastError() == ERROR_ALREADY_EXISTS) {
+        Close();
+        return false;
+    }
+    
+    m_view = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0));
+    if (!m_view) {
+        Close();
+        return false;
+    }
+    
+    // 新建的映射内容为零，读写位置和等待标志无需初始化
+    m_name = name;
+    m_header = reinterpret_cast<Header*>(m_view);
+    m_header->magic = kMagic;
+    m_header->version = kVersion;
+    m_header->capacity = ringCapacity;
+    
+    if (!OpenEvents(true)) {
+        Close();
+        return false;
+    }
+    
+    AttachRings(ringCapacity);
+    return true;
+#endif
+}
+
+bool IPCSharedChannel::Open(const String& name) {
+    Close();
+
+#ifndef _WIN32
+    int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        SetLastError(errno);
+        return false;
+    }
+    
+    // 先按对象的实际大小映射，校验头部后才信任其中的容量
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        SetLastError(errno);
+        close(fd);
+        return false;
+    }
+    if (static_cast<size_t>(status.st_size) < GetMappingSize(kMinCapacity)) {
+        SetLastError(ERROR_INVALID_DATA);
+        close(fd);
+        return false;
+    }
+    
+    size_t mappingSize = static_cast<size_t>(status.st_size);
+    void* view = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        SetLastError(errno);
+        return false;
+    }
+    
+    m_name = name;
+    m_view = static_cast<char*>(view);
+    m_viewSize = mappingSize;
+    m_header = reinterpret_cast<Header*>(m_view);
+    if (m_header->magic != kMagic || m_header->version != kVersion || m_header->capacity < kMinCapacity ||
+        m_header->capacity > kMaxCapacity || (m_header->capacity & (m_header->capacity - 1)) != 0 ||
+        GetMappingSize(static_cast<size_t>(m_header->capacity)) > mappingSize) {
+        SetLastError(ERROR_INVALID_DATA);
+        Close();
+        return false;
+    }
+    
+    AttachRings(static_cast<size_t>(m_header->capacity));
+    return true;
+#else
+    m_mapping = OpenFileMappingA(FILE_MAP_WRITE, FALSE, name.c_str());
+    if (!m_mapping) {
+        return false;
+    }
+    
+    m_view = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0));
+    if (!m_view) {
+        Close();
+        return false;
+    }
+    
+    m_name = name;
+    m_header = reinterpret_cast<Header*>(m_view);
+    if (m_header->magic != kMagic || m_header->version != kVersion || m_header->capacity < kMinCapacity ||
+        m_header->capacity > kMaxCapacity || (m_header->capacity & (m_header->capacity - 1)) != 0) {
+        Close();
+        return false;
+    }
+    
+    if (!OpenEvents(false)) {
+        Close();
+        return false;
+    }
+    
+    AttachRings(static_cast<size_t>(m_header->capacity));
+    return true;
+#endif
+}
+
+#ifdef _WIN32
+bool IPCSharedChannel::OpenEvents(bool create) {
+    static const char* const kSuffixes[EventCount] = { ".rd", ".rs", ".sd", ".ss" };
+    for (int i = 0; i < EventCount; ++i) {
+        String eventName = m_name + kSuffixes[i];
+        if (create) {
+            m_events[i] = CreateEventA(NULL, FALSE, FALSE, eventName.c_str());
+            if (m_events[i] && ::GetLastError() == ERROR_ALREADY_EXISTS) {
+                return false;
+            }
+        } else {
+            m_events[i] = OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, eventName.c_str());
+        }
+        
+        if (!m_events[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+void IPCSharedChannel::AttachRings(size_t capacity) {
+    auto* ringHeaders = reinterpret_cast<IPCSharedRingHeader*>(m_view + sizeof(Header));
+    char* data = m_view + sizeof(Header) + 2 * sizeof(IPCSharedRingHeader);
+
+#ifdef _WIN32
+    m_requestRing.Attach(&ringHeaders[0], data, capacity,
+                         m_events[RequestData], m_events[RequestSpace], &m_header->closed);
+    m_responseRing.Attach(&ringHeaders[1], data + capacity, capacity,
+                          m_events[ResponseData], m_events[ResponseSpace], &m_header->closed);
+#else
+    m_requestRing.Attach(&ringHeaders[0], data, capacity,
+                         &ringHeaders[0].dataSignal, &ringHeaders[0].spaceSignal, &m_header->closed);
+    m_responseRing.Attach(&ringHeaders[1], data + capacity, capacity,
+                          &ringHeaders[1].dataSignal, &ringHeaders[1].spaceSignal, &m_header->closed);
+#endif
+}
+
+bool IPCSharedChannel::IsClosed() const {
+    return !m_header || m_header->closed.load() != 0;
+}
+
+void IPCSharedChannel::Shutdown() {
+    if (!m_header) {
+        return;
+    }
+    
+    m_header->closed.store(1);
+    m_requestRing.Wake();
+    m_responseRing.Wake();
+}
+
+void IPCSharedChannel::Close() {
+    Shutdown();
+    
+    m_requestRing = IPCSharedRing();
+    m_responseRing = IPCSharedRing();
+    m_header = nullptr;
+
+#ifdef _WIN32
+    if (m_view) {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+    
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    
+    for (HANDLE& event : m_events) {
+        if (event) {
+            CloseHandle(event);
+            event = NULL;
+        }
+    }
+#else
+    if (m_view) {
+        munmap(m_view, m_viewSize);
+        m_view = nullptr;
+        m_viewSize = 0;
+    }
+    
+    // 已打开的一方保留映射，删除名称只影响之后的打开
+    if (m_owner) {
+        shm_unlink(m_name.c_str());
+        m_owner = false;
+    }
+#endif
+    
+    m_name.clear();
+}
+
+IPCPeerProcess IPCSharedChannel::OpenPeerProcess(DWORD processId) {
+#ifdef _WIN32
+    return OpenProcess(SYNCHRONIZE, FALSE, processId);
+#else
+    int pidfd = static_cast<int>(syscall(SYS_pidfd_open, static_cast<pid_t>(processId), 0));
+    if (pidfd < 0) {
+        SetLastError(errno);
+        return kNoPeerProcess;
+    }
+    return pidfd;
+#endif
+}
+
+void IPCSharedChannel::ClosePeerProcess(IPCPeerProcess& process) {
+    if (process == kNoPeerProcess) {
+        return;
+    }
+#ifdef _WIN32
+    CloseHandle(process);
+#else
+    close(process);
+#endif
+    process = kNoPeerProcess;
+}
\ No newline at end of file
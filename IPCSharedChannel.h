@@ -0,0 +1,149 @@
+#pragma once
+
+#include "Common.h"
+
+// 对端进程的等待句柄，对端退出后共享内存环上的等待随之结束。Windows上为进程句柄，Linux上为pidfd
+#ifdef _WIN32
+typedef HANDLE IPCPeerProcess;
+const IPCPeerProcess kNoPeerProcess = NULL;
+#else
+typedef int IPCPeerProcess;
+const IPCPeerProcess kNoPeerProcess = -1;
+#endif
+
+// 共享内存环的控制块，读写位置各占一个缓存行，避免生产者和消费者互相干扰
+struct IPCSharedRingHeader {
+    alignas(64) std::atomic<uint64_t> head;   // 已读取的字节总数，仅由消费者修改
+    alignas(64) std::atomic<uint64_t> tail;   // 已写入的字节总数，仅由生产者修改
+    alignas(64) std::atomic<uint32_t> readerWaiting;
+    std::atomic<uint32_t> writerWaiting;
+#ifndef _WIN32
+    std::atomic<uint32_t> dataSignal;    // futex字，每次通知加一，代替Windows的命名事件
+    std::atomic<uint32_t> spaceSignal;
+#endif
+};
+
+// 单生产者单消费者字节环，数据按IPC帧格式连续写入。
+// 等待方先自旋一段时间，仍无进展时登记等待标志并在事件（Linux上为futex）上休眠，对端只在有等待者时才通知
+class IPCSharedRing {
+public:
+#ifdef _WIN32
+    typedef HANDLE WakeSignal;
+#else
+    typedef std::atomic<uint32_t>* WakeSignal;
+#endif
+    
+    IPCSharedRing();
+    
+    void Attach(IPCSharedRingHeader* header, char* data, size_t capacity,
+                WakeSignal dataSignal, WakeSignal spaceSignal, const std::atomic<uint32_t>* closed);
+    
+    // 写入全部数据，空间不足时等待消费者；超时或通道关闭时返回false
+    bool Write(const char* data, size_t size, DWORD timeoutMs);
+    
+    // 读取当前可用的数据，没有数据时等待；超时、通道关闭或对端进程退出时返回0
+    size_t Read(char* buffer, size_t size, DWORD timeoutMs, IPCPeerProcess peer = kNoPeerProcess);
+    
+    // 唤醒在本环上等待的读写方
+    void Wake();
+
+private:
+    static const unsigned kSpinCount = 4000;
+#ifndef _WIN32
+    static const DWORD kPeerPollMs = 100;  // futex不能同时等待pidfd，按此间隔检查对端是否退出
+#endif
+    
+    IPCSharedRingHeader* m_header;
+    char* m_data;
+    size_t m_capacity;
+    WakeSignal m_dataSignal;
+    WakeSignal m_spaceSignal;
+    const std::atomic<uint32_t>* m_closed;
+    
+    bool IsClosed() const { return m_closed->load() != 0; }
+    
+    static void Notify(WakeSignal signal);
+    
+    template <typename Ready>
+    bool Wait(std::atomic<uint32_t>& waiting, WakeSignal signal, Ready ready,
+              ULONGLONG start, DWORD timeoutMs, IPCPeerProcess peer);
+};
+
+// 共享内存通道：一个命名文件映射中的请求环和响应环，以及四个命名事件。
+// Linux上为shm_open创建的共享内存对象，名称以'/'开头，等待和唤醒使用环控制块中的futex字。
+// 客户端通过管道发送MessageSharedMemory消息协商，消息内容为期望的容量 [capacity u32]，
+// 服务器创建通道后以通道名作为响应，拒绝时响应为空；此后该客户端的请求和响应都经由通道传输
+class IPCSharedChannel {
+public:
+    static const size_t kDefaultCapacity = 1024 * 1024;
+    static const size_t kMinCapacity = 64 * 1024;
+    static const size_t kMaxCapacity = 64 * 1024 * 1024;
+    
+    IPCSharedChannel();
+    ~IPCSharedChannel();
+    
+    // 禁用拷贝构造和赋值
+    IPCSharedChannel(const IPCSharedChannel&) = delete;
+    IPCSharedChannel& operator=(const IPCSharedChannel&) = delete;
+    
+    // 服务器端创建通道，每个环的容量向上取整为2的幂
+    bool Create(const String& name, size_t capacity);
+    
+    // 客户端打开服务器创建的通道
+    bool Open(const String& name);
+    
+    // 标记通道关闭并唤醒两端的等待者，映射保持有效
+    void Shutdown();
+    
+    // 关闭通道并释放映射，调用前须确保本端没有线程仍在读写
+    void Close();
+    
+    bool IsOpen() const { return m_view != nullptr; }
+    bool IsClosed() const;
+    const String& GetName() const { return m_name; }
+    
+    IPCSharedRing& GetRequestRing() { return m_requestRing; }
+    IPCSharedRing& GetResponseRing() { return m_responseRing; }
+    
+    // 打开对端进程用于等待其退出，失败时返回kNoPeerProcess并设置最后错误
+    static IPCPeerProcess OpenPeerProcess(DWORD processId);
+    static void ClosePeerProcess(IPCPeerProcess& process);
+
+private:
+    static const uint32_t kMagic = 0x4D534C57;  // "WLSM"
+    static const uint32_t kVersion = 1;
+    
+    struct alignas(64) Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t capacity;
+        std::atomic<uint32_t> closed;
+    };
+    
+    enum EventIndex {
+        RequestData = 0,
+        RequestSpace,
+        ResponseData,
+        ResponseSpace,
+        EventCount
+    };
+
+#ifdef _WIN32
+    HANDLE m_mapping;
+    HANDLE m_events[EventCount];
+#else
+    size_t m_viewSize;
+    bool m_owner;   // 创建者关闭时删除共享内存对象
+#endif
+    char* m_view;
+    Header* m_header;
+    IPCSharedRing m_requestRing;
+    IPCSharedRing m_responseRing;
+    String m_name;
+    
+    static size_t GetMappingSize(size_t capacity);
+#ifdef _WIN32
+    bool OpenEvents(bool create);
+#endif
+    void AttachRings(size_t capacity);
+};
\ No newline at end of file
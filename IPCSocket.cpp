@@ -0,0 +1,123 @@
+#include "IPCSocket.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace {
+
+bool FillAddress(const String& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.length() >= sizeof(address.sun_path)) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.length());
+    return true;
+}
+
+} // namespace
+
+String IPCSocket::GetSocketPath(const WString& pipeName) {
+    String name = Utils::WStringToString(pipeName);
+    if (!name.empty() && name[0] == '/') {
+        return name;
+    }
+    
+    size_t pos = name.find_last_of("\\/");
+    if (pos != String::npos) {
+        name = name.substr(pos + 1);
+    }
+    return "/tmp/" + name + ".sock";
+}
+
+int IPCSocket::Listen(const String& path) {
+    sockaddr_un address;
+    if (!FillAddress(path, address)) {
+        return -1;
+    }
+    
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        SetLastError(errno);
+        return -1;
+    }
+    
+    // 服务器异常退出后套接字文件仍然存在，bind会因此失败
+    unlink(path.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, SOMAXCONN) != 0) {
+        SetLastError(errno);
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+int IPCSocket::Connect(const String& path, DWORD timeoutMs) {
+    sockaddr_un address;
+    if (!FillAddress(path, address)) {
+        return -1;
+    }
+    
+    int client = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (client < 0) {
+        SetLastError(errno);
+        return -1;
+    }
+    
+    // 监听队列满时connect在发送超时内等待，相当于命名管道的WaitNamedPipe；连接后恢复为不超时
+    timeval timeout = {};
+    if (timeoutMs != INFINITE) {
+        timeout.tv_sec = static_cast<time_t>(timeoutMs / 1000);
+        timeout.tv_usec = static_cast<suseconds_t>((timeoutMs % 1000) * 1000);
+    }
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    
+    int result;
+    do {
+        result = connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    } while (result != 0 && errno == EINTR);
+    
+    if (result != 0) {
+        SetLastError(errno == EAGAIN ? ERROR_PIPE_BUSY : errno);
+        close(client);
+        return -1;
+    }
+    
+    timeout = timeval();
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    return client;
+}
+
+bool IPCSocket::SetNonBlocking(int socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+DWORD IPCSocket::GetPeerProcessId(int socket) {
+    ucred credentials = {};
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) {
+        SetLastError(errno);
+        return 0;
+    }
+    return static_cast<DWORD>(credentials.pid);
+}
+
+bool IPCSocket::SendAll(int socket, const char* data, size_t size) {
+    size_t offset = 0;
+    while (offset < size) {
+        ssize_t written = send(socket, data + offset, size - offset, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            SetLastError(errno);
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    return true;
+}
\ No newline at end of file
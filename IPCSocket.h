@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Common.h"
+
+// 非Windows平台上代替命名管道的Unix域套接字传输。
+// 管道名的最后一段映射为/tmp下的套接字文件，例如 \\.\pipe\WinlogonManagerService
+// 对应 /tmp/WinlogonManagerService.sock；以'/'开头的名称直接作为套接字路径
+namespace IPCSocket {
+
+String GetSocketPath(const WString& pipeName);
+
+// 创建非阻塞的监听套接字，先删除上次运行遗留的套接字文件。失败时返回-1并设置最后错误
+int Listen(const String& path);
+
+// 连接服务器，监听队列已满时最多等待timeoutMs。失败时返回-1并设置最后错误
+int Connect(const String& path, DWORD timeoutMs);
+
+bool SetNonBlocking(int socket);
+
+// 对端进程ID，取不到时返回0
+DWORD GetPeerProcessId(int socket);
+
+// 写出全部数据，对端关闭时返回false而不是触发SIGPIPE
+bool SendAll(int socket, const char* data, size_t size);
+
+} // namespace IPCSocket
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "LogCrashRing.h"
+#include "Utils.h"
+#include <ctime>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace LogCrashRingFormat;
+
+LogCrashRing::LogCrashRing()
+#ifdef _WIN32
+    : m_file(INVALID_HANDLE_VALUE), m_mapping(NULL),
+#else
+    : m_file(-1),
+#endif
+      m_view(nullptr), m_header(nullptr), m_data(nullptr), m_capacity(0), m_open(false) {
+}
+
+LogCrashRing::~LogCrashRing() {
+    Close();
+}
+
+bool LogCrashRing::Open(const String& filePath, size_t capacity) {
+    Close();
+    
+    // 数据区至少64KB，按记录对齐
+    uint64_t dataSize = std::max<uint64_t>(capacity, 64 * 1024);
+    dataSize = (dataSize + kAlignment - 1) & ~(kAlignment - 1);
+    uint64_t fileSize = sizeof(FileHeader) + dataSize;
+    
+    bool reuse = false;
+    if (!MapFile(filePath, fileSize, reuse)) {
+        DWORD error = ::GetLastError();
+        Close();
+        SetLastError(error);
+        return false;
+    }
+    
+    m_header = reinterpret_cast<FileHeader*>(m_view);
+    m_data = m_view + sizeof(FileHeader);
+    m_capacity = dataSize;
+    
+    // 文件头无效或容量不同时重新初始化
+    if (!reuse || memcmp(m_header->magic, kMagic, sizeof(kMagic)) != 0 ||
+        m_header->version != kVersion || m_header->capacity != dataSize) {
+        memset(m_view, 0, sizeof(FileHeader));
+        memcpy(m_header->magic, kMagic, sizeof(kMagic));
+        m_header->version = kVersion;
+        m_header->headerSize = sizeof(FileHeader);
+        m_header->capacity = dataSize;
+        m_header->reserved = 0;
+    }
+    
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_s(&local, &now);
+    m_header->utcOffsetMinutes = static_cast<int32_t>((_mkgmtime(&local) - now) / 60);
+    
+    m_open = true;
+    return true;
+}
+
+bool LogCrashRing::MapFile(const String& filePath, uint64_t fileSize, bool& reuse) {
+#ifdef _WIN32
+    m_file = CreateFileA(filePath.c_str(), GENERIC_READ | GENERIC_WRITE,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    LARGE_INTEGER currentSize;
+    if (!GetFileSizeEx(m_file, &currentSize)) {
+        return false;
+    }
+    
+    reuse = static_cast<uint64_t>(currentSize.QuadPart) == fileSize;
+    if (!reuse) {
+        LARGE_INTEGER newSize;
+        newSize.QuadPart = static_cast<LONGLONG>(fileSize);
+        if (!SetFilePointerEx(m_file, newSize, NULL, FILE_BEGIN) || !SetEndOfFile(m_file)) {
+            return false;
+        }
+    }
+    
+    m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READWRITE, 0, 0, NULL);
+    if (!m_mapping) {
+        return false;
+    }
+    
+    m_view = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0));
+    return m_view != nullptr;
+#else
+    m_file = open(filePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_file < 0) {
+        SetLastError(errno);
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(m_file, &info) != 0) {
+        SetLastError(errno);
+        return false;
+    }
+    
+    reuse = static_cast<uint64_t>(info.st_size) == fileSize;
+    if (!reuse && ftruncate(m_file, static_cast<off_t>(fileSize)) != 0) {
+        SetLastError(errno);
+        return false;
+    }
+    
+    // 共享映射的脏页属于页缓存，进程被杀死后仍由内核写回文件
+    void* view = mmap(nullptr, static_cast<size_t>(fileSize), PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+    if (view == MAP_FAILED) {
+        SetLastError(errno);
+        return false;
+    }
+    m_view = static_cast<char*>(view);
+    return true;
+#endif
+}
+
+void LogCrashRing::Close() {
+    m_open = false;
+
+#ifdef _WIN32
+    if (m_view) {
+        FlushViewOfFile(m_view, 0);
+        UnmapViewOfFile(m_view);
+    }
+    
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_view) {
+        munmap(m_view, static_cast<size_t>(sizeof(FileHeader) + m_capacity));
+    }
+    
+    if (m_file >= 0) {
+        close(m_file);
+        m_file = -1;
+    }
+#endif
+    
+    m_view = nullptr;
+    m_header = nullptr;
+    m_data = nullptr;
+    m_capacity = 0;
+}
+
+void LogCrashRing::Append(LogLevel level, const char* message, size_t messageLength,
+                          const char* fields, size_t fieldsLength) {
+    if (!m_open) {
+        return;
+    }
+    
+    // 先在栈上组装完整记录并计算校验和，再一次性拷入环形区
+    char buffer[sizeof(RecordHeader) + kMaxMessageBytes];
+    messageLength = std::min(messageLength, kMaxMessageBytes);
+    fieldsLength = std::min(fieldsLength, kMaxMessageBytes - messageLength);
+    memcpy(buffer + sizeof(RecordHeader), message, messageLength);
+    memcpy(buffer + sizeof(RecordHeader) + messageLength, fields, fieldsLength);
+    
+    RecordHeader header;
+    header.length = static_cast<uint16_t>(messageLength + fieldsLength);
+    uint64_t recordSize = GetRecordSize(header.length);
+    
+    FILETIME fileTime;
+    GetSystemTimeAsFileTime(&fileTime);
+    header.magic = kRecordMagic;
+    header.position = static_cast<uint64_t>(InterlockedExchangeAdd64(
+        reinterpret_cast<volatile LONG64*>(&m_header->reserved), static_cast<LONG64>(recordSize)));
+    header.timestamp = (static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+    header.threadId = GetCurrentThreadId();
+    header.level = static_cast<uint8_t>(level);
+    header.flags = 0;
+    
+    const size_t checkedOffset = offsetof(RecordHeader, position);
+    uint32_t checksum = Checksum(kChecksumSeed, reinterpret_cast<const char*>(&header) + checkedOffset,
+                                 sizeof(RecordHeader) - checkedOffset);
+    header.checksum = Checksum(checksum, buffer + sizeof(RecordHeader), header.length);
+    memcpy(buffer, &header, sizeof(RecordHeader));
+    
+    // 对齐填充不参与校验，无需清零
+    CopyToRing(header.position, buffer, static_cast<size_t>(recordSize));
+}
+
+void LogCrashRing::CopyToRing(uint64_t position, const char* data, size_t size) {
+    size_t offset = static_cast<size_t>(position % m_capacity);
+    size_t first = std::min(size, static_cast<size_t>(m_capacity - offset));
+    memcpy(m_data + offset, data, first);
+    if (first < size) {
+        memcpy(m_data, data + first, size - first);
+    }
+}
+
+void LogCrashRing::Flush() {
+    if (!m_open) {
+        return;
+    }
+
+#ifdef _WIN32
+    FlushViewOfFile(m_view, 0);
+#else
+    msync(m_view, static_cast<size_t>(sizeof(FileHeader) + m_capacity), MS_SYNC);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Common.h"
+#include "LogCrashRingFormat.h"
+
+// 崩溃安全的日志环形文件：通过文件映射写入，每条日志只有内存拷贝而没有系统调用。
+// 进程异常退出时已写入映射的页面仍由系统写回文件，可使用logrecover工具取出最后的记录。
+// Windows上使用文件映射对象，其他平台使用mmap共享映射
+class LogCrashRing {
+public:
+    LogCrashRing();
+    ~LogCrashRing();
+    
+    // 禁用拷贝构造和赋值
+    LogCrashRing(const LogCrashRing&) = delete;
+    LogCrashRing& operator=(const LogCrashRing&) = delete;
+    
+    // 已存在且容量相同的环形文件会继续追加，保留上次运行的记录
+    bool Open(const String& filePath, size_t capacity);
+    void Close();
+    bool IsOpen() const { return m_open; }
+    
+    // 可由多个线程并发调用
+    void Append(LogLevel level, const char* message, size_t messageLength,
+                const char* fields, size_t fieldsLength);
+    
+    // 将映射页面写回磁盘，仅在需要防范系统掉电时使用
+    void Flush();
+
+private:
+#ifdef _WIN32
+    HANDLE m_file;
+    HANDLE m_mapping;
+#else
+    int m_file;
+#endif
+    char* m_view;
+    LogCrashRingFormat::FileHeader* m_header;
+    char* m_data;
+    uint64_t m_capacity;
+    std::atomic<bool> m_open;
+    
+    // 打开并映射整个文件，reuse返回文件原有大小是否与所需大小一致
+    bool MapFile(const String& filePath, uint64_t fileSize, bool& reuse);
+    void CopyToRing(uint64_t position, const char* data, size_t size);
+};
\ No newline at end of file
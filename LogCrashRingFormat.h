@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// 崩溃日志环形文件格式，由LogCrashRing写入、logrecover读取
+// 本文件不依赖Windows头文件，以便恢复工具在其他平台上构建
+//
+// 文件 = 64字节文件头 + capacity字节数据区，多字节整数均为小端序
+// 写入端通过原子加法在 reserved 上预留空间，数据区按 position % capacity 环形寻址，
+// 记录可能跨越数据区末尾。记录头中的 position 和校验和用于识别写到一半或已被覆盖的记录
+namespace LogCrashRingFormat {
+
+const char kMagic[8] = { 'W', 'L', 'M', 'R', 'I', 'N', 'G', '1' };
+const uint32_t kVersion = 1;
+const uint32_t kRecordMagic = 0x43524C57;  // "WLRC"
+
+// 记录按8字节对齐
+const uint64_t kAlignment = 8;
+
+// 单条记录消息的最大长度
+const size_t kMaxMessageBytes = 4096;
+
+#pragma pack(push, 1)
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t capacity;          // 数据区字节数，kAlignment的整数倍
+    uint64_t reserved;          // 已预留的总字节数（单调递增）
+    int32_t utcOffsetMinutes;   // 写入端本地时区偏移
+    uint8_t padding[28];
+};
+
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t checksum;   // 除本字段外的记录头与消息的FNV-1a校验和
+    uint64_t position;   // 记录的预留位置，与所在位置不符即为旧数据
+    uint64_t timestamp;  // FILETIME（自1601-01-01起的100ns计数，UTC）
+    uint32_t threadId;
+    uint8_t level;
+    uint8_t flags;
+    uint16_t length;     // 消息字节数
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 64, "Unexpected crash ring file header size");
+static_assert(sizeof(RecordHeader) == 32, "Unexpected crash ring record header size");
+
+inline uint64_t GetRecordSize(uint16_t length) {
+    return (sizeof(RecordHeader) + length + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+inline uint32_t Checksum(uint32_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+const uint32_t kChecksumSeed = 2166136261u;
+
+} // namespace LogCrashRingFormat
\ No newline at end of file
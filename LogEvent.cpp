@@ -0,0 +1,132 @@
+#include "LogEvent.h"
+#include "Logger.h"
+#include "Utils.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+// 线程内复用的字段缓冲，避免每个事件重新分配内存
+static thread_local String t_eventFields;
+static thread_local bool t_eventFieldsInUse = false;
+
+LogEvent::LogEvent(LogLevel level, const char* name)
+    : m_level(level), m_name(name ? name : ""), m_format(Logger::GetOutputFormat()),
+      m_enabled(Logger::IsEnabled(level)), m_ownsBuffer(false), m_fields(&m_localFields) {
+    if (m_enabled && !t_eventFieldsInUse) {
+        t_eventFieldsInUse = true;
+        t_eventFields.clear();
+        m_fields = &t_eventFields;
+        m_ownsBuffer = true;
+    }
+}
+
+LogEvent::~LogEvent() {
+    if (m_enabled) {
+        Logger::SubmitEvent(m_level, m_name, *m_fields);
+    }
+    
+    if (m_ownsBuffer) {
+        t_eventFieldsInUse = false;
+    }
+}
+
+void LogEvent::AppendKey(const char* key) {
+    if (m_format == LogOutputFormat::JsonLines) {
+        m_fields->push_back(',');
+        AppendString(*m_fields, key, strlen(key), m_format);
+        m_fields->push_back(':');
+    } else {
+        m_fields->push_back(' ');
+        m_fields->append(key);
+        m_fields->push_back('=');
+    }
+}
+
+void LogEvent::AppendWString(const wchar_t* data, size_t length) {
+    // 短字符串在栈上转换为UTF-8
+    char buffer[1024];
+    int converted = 0;
+    if (length > 0 && length <= sizeof(buffer) / 4) {
+        converted = WideCharToMultiByte(CP_UTF8, 0, data, static_cast<int>(length),
+                                        buffer, sizeof(buffer), NULL, NULL);
+    }
+    
+    if (converted > 0 || length == 0) {
+        AppendString(*m_fields, buffer, converted, m_format);
+    } else {
+        String value = Utils::WStringToString(WString(data, length));
+        AppendString(*m_fields, value.c_str(), value.length(), m_format);
+    }
+}
+
+void LogEvent::AppendSigned(int64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    m_fields->append(buffer, result.ptr - buffer);
+}
+
+void LogEvent::AppendUnsigned(uint64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    m_fields->append(buffer, result.ptr - buffer);
+}
+
+void LogEvent::AppendDouble(double value) {
+    // JSON不能表示NaN和无穷大
+    if (m_format == LogOutputFormat::JsonLines && !std::isfinite(value)) {
+        m_fields->append("null");
+        return;
+    }
+    
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+    if (length > 0) {
+        m_fields->append(buffer, length);
+    }
+}
+
+void LogEvent::AppendString(String& out, const char* data, size_t length, LogOutputFormat format) {
+    static const char kHexDigits[] = "0123456789abcdef";
+    
+    if (format != LogOutputFormat::JsonLines) {
+        // logfmt仅在值为空或包含空白、'='、'"'及控制字符时加引号
+        bool needsQuotes = length == 0;
+        for (size_t i = 0; i < length && !needsQuotes; ++i) {
+            unsigned char ch = static_cast<unsigned char>(data[i]);
+            needsQuotes = ch <= ' ' || ch == '=' || ch == '"' || ch == 0x7F;
+        }
+        
+        if (!needsQuotes) {
+            out.append(data, length);
+            return;
+        }
+    }
+    
+    out.push_back('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char ch = static_cast<unsigned char>(data[i]);
+        if (ch >= 0x20 && ch != '"' && ch != '\\') {
+            continue;
+        }
+        
+        // 连续的普通字符一次性追加
+        out.append(data + runStart, i - runStart);
+        runStart = i + 1;
+        
+        switch (ch) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                out.append("\\u00");
+                out.push_back(kHexDigits[ch >> 4]);
+                out.push_back(kHexDigits[ch & 0x0F]);
+                break;
+        }
+    }
+    out.append(data + runStart, length - runStart);
+    out.push_back('"');
+}
\ No newline at end of file
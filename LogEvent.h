@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Common.h"
+#include <type_traits>
+#include <cstring>
+
+// 日志输出格式
+enum class LogOutputFormat {
+    Text = 0,       // 2024-01-01 12:00:00.123 [INFO] 消息 key=value
+    JsonLines = 1,  // {"ts":"...","level":"INFO","msg":"消息","key":value}
+    Logfmt = 2      // ts="..." level=INFO msg="消息" key=value
+};
+
+// 结构化日志事件：字段在With调用时直接序列化到线程内复用的缓冲中，
+// 事件对象在完整表达式结束析构时提交，例如
+//   Logger::Event("process.suspend").With("pid", processId).With("ok", true);
+class LogEvent {
+public:
+    ~LogEvent();
+    
+    // 禁用拷贝和移动，事件只能以临时对象形式使用
+    LogEvent(const LogEvent&) = delete;
+    LogEvent& operator=(const LogEvent&) = delete;
+    
+    template <typename T>
+    LogEvent& With(const char* key, const T& value) {
+        if (!m_enabled) {
+            return *this;
+        }
+        
+        using U = typename std::decay<T>::type;
+        AppendKey(key);
+        if constexpr (std::is_same<U, String>::value) {
+            AppendString(*m_fields, value.c_str(), value.length(), m_format);
+        } else if constexpr (std::is_same<U, WString>::value) {
+            AppendWString(value.c_str(), value.length());
+        } else if constexpr (std::is_same<U, char*>::value || std::is_same<U, const char*>::value) {
+            const char* str = value;
+            AppendString(*m_fields, str ? str : "", str ? strlen(str) : 0, m_format);
+        } else if constexpr (std::is_same<U, wchar_t*>::value || std::is_same<U, const wchar_t*>::value) {
+            const wchar_t* str = value;
+            AppendWString(str ? str : L"", str ? wcslen(str) : 0);
+        } else if constexpr (std::is_same<U, bool>::value) {
+            m_fields->append(value ? "true" : "false");
+        } else if constexpr (std::is_floating_point<U>::value) {
+            AppendDouble(static_cast<double>(value));
+        } else if constexpr (std::is_enum<U>::value) {
+            AppendSigned(static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral<U>::value && std::is_signed<U>::value) {
+            AppendSigned(static_cast<int64_t>(value));
+        } else {
+            static_assert(std::is_integral<U>::value, "Unsupported log field type");
+            AppendUnsigned(static_cast<uint64_t>(value));
+        }
+        return *this;
+    }
+    
+    // 按输出格式写入带引号和转义的字符串
+    static void AppendString(String& out, const char* data, size_t length, LogOutputFormat format);
+
+private:
+    friend class Logger;
+    
+    LogEvent(LogLevel level, const char* name);
+    
+    LogLevel m_level;
+    const char* m_name;
+    LogOutputFormat m_format;
+    bool m_enabled;
+    bool m_ownsBuffer;     // 线程缓冲被外层事件占用时使用自身缓冲
+    String* m_fields;
+    String m_localFields;
+    
+    void AppendKey(const char* key);
+    void AppendWString(const wchar_t* data, size_t length);
+    void AppendSigned(int64_t value);
+    void AppendUnsigned(uint64_t value);
+    void AppendDouble(double value);
+};
\ No newline at end of file
@@ -0,0 +1,525 @@
+#include "LogFileSink.h"
+#include <algorithm>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+#ifdef WLM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#endif
+
+// 缓冲上限，超过后即使策略未要求落盘也先写入文件
+static const size_t kMaxBufferBytes = 1024 * 1024;
+
+namespace {
+
+// 以追加方式打开日志文件，不存在时创建
+LogFileHandle OpenAppend(const String& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file != INVALID_HANDLE_VALUE) {
+        SetFilePointer(file, 0, NULL, FILE_END);
+    }
+    return file;
+#else
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        SetLastError(static_cast<DWORD>(errno));
+    }
+    return fd;
+#endif
+}
+
+// 打开已轮转出的历史文件用于压缩，句柄在文件后续被改名或删除时依然有效
+LogFileHandle OpenSegment(const String& path) {
+#ifdef _WIN32
+    return CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                       FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#else
+    return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+}
+
+uint64_t GetSize(LogFileHandle file) {
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    return GetFileSizeEx(file, &size) ? static_cast<uint64_t>(size.QuadPart) : 0;
+#else
+    struct stat info;
+    return fstat(file, &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+#endif
+}
+
+// 返回实际写入的字节数
+size_t WriteAll(LogFileHandle file, const char* data, size_t length) {
+#ifdef _WIN32
+    DWORD bytesWritten = 0;
+    WriteFile(file, data, static_cast<DWORD>(length), &bytesWritten, NULL);
+    return bytesWritten;
+#else
+    size_t offset = 0;
+    while (offset < length) {
+        ssize_t written = write(file, data + offset, length - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            SetLastError(static_cast<DWORD>(errno));
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    return offset;
+#endif
+}
+
+// 落盘：只同步文件数据，追加写入引起的长度变化也包含在内
+void SyncData(LogFileHandle file) {
+#ifdef _WIN32
+    FlushFileBuffers(file);
+#else
+    fdatasync(file);
+#endif
+}
+
+void CloseFile(LogFileHandle file) {
+#ifdef _WIN32
+    CloseHandle(file);
+#else
+    close(file);
+#endif
+}
+
+void DeletePath(const String& path) {
+#ifdef _WIN32
+    DeleteFileA(path.c_str());
+#else
+    unlink(path.c_str());
+#endif
+}
+
+void MovePath(const String& from, const String& to) {
+#ifdef _WIN32
+    MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    rename(from.c_str(), to.c_str());
+#endif
+}
+
+// 历史文件可能已被压缩为.gz，两种形式一起删除或改名
+void DeleteSegment(const String& path) {
+    DeletePath(path);
+    DeletePath(path + ".gz");
+}
+
+void MoveSegment(const String& from, const String& to) {
+    MovePath(from, to);
+    MovePath(from + ".gz", to + ".gz");
+}
+
+#ifdef WLM_HAVE_ZLIB
+// 把source从头到尾压缩为gzip格式写入target
+bool WriteGzip(LogFileHandle source, LogFileHandle target) {
+    z_stream stream = {};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    
+    std::vector<char> input(64 * 1024);
+    std::vector<char> output(64 * 1024);
+    bool ok = true;
+    int flush = Z_NO_FLUSH;
+    while (ok && flush != Z_FINISH) {
+        ssize_t bytesRead = read(source, input.data(), input.size());
+        if (bytesRead < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        
+        flush = bytesRead == 0 ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = reinterpret_cast<Bytef*>(input.data());
+        stream.avail_in = static_cast<uInt>(bytesRead);
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(output.data());
+            stream.avail_out = static_cast<uInt>(output.size());
+            deflate(&stream, flush);
+            size_t produced = output.size() - stream.avail_out;
+            if (WriteAll(target, output.data(), produced) != produced) {
+                ok = false;
+                break;
+            }
+        } while (stream.avail_out == 0);
+    }
+    
+    deflateEnd(&stream);
+    return ok;
+}
+#endif
+
+} // namespace
+
+LogFlushPolicy LogFlushPolicy::EveryLine() {
+    return LogFlushPolicy();
+}
+
+LogFlushPolicy LogFlushPolicy::EveryBytes(size_t bytes) {
+    LogFlushPolicy policy;
+    policy.mode = LogFlushMode::Bytes;
+    policy.bytesThreshold = bytes;
+    return policy;
+}
+
+LogFlushPolicy LogFlushPolicy::EveryInterval(DWORD intervalMs) {
+    LogFlushPolicy policy;
+    policy.mode = LogFlushMode::Interval;
+    policy.intervalMs = intervalMs;
+    return policy;
+}
+
+LogFlushPolicy LogFlushPolicy::OnError() {
+    LogFlushPolicy policy;
+    policy.mode = LogFlushMode::OnError;
+    return policy;
+}
+
+LogFileSink::LogFileSink()
+    : m_file(kInvalidLogFile)
+    , m_fileSize(0)
+    , m_openedTick(0)
+    , m_lastCommitTick(0)
+    , m_dirty(false) {
+}
+
+LogFileSink::~LogFileSink() {
+    Close();
+}
+
+bool LogFileSink::Open(const String& filePath, const LogFlushPolicy& policy) {
+    Close();
+    
+    m_filePath = filePath;
+    if (!OpenFile()) {
+        return false;
+    }
+    
+    m_policy = policy;
+    m_buffer.clear();
+    m_dirty = false;
+    m_buffer.reserve(std::min(kMaxBufferBytes, std::max(policy.bytesThreshold, static_cast<size_t>(4096))) + 4096);
+    m_lastCommitTick = GetTickCount64();
+    return true;
+}
+
+void LogFileSink::Close() {
+    if (m_file != kInvalidLogFile) {
+        Commit();
+        CloseFile(m_file);
+        m_file = kInvalidLogFile;
+    }
+    m_buffer.clear();
+}
+
+void LogFileSink::Append(LogLevel level, const char* data, size_t length) {
+    if (m_file == kInvalidLogFile) {
+        return;
+    }
+    
+    m_buffer.append(data, length);
+    
+    switch (m_policy.mode) {
+        case LogFlushMode::EveryLine:
+            Commit();
+            return;
+        case LogFlushMode::Bytes:
+            if (m_buffer.size() >= m_policy.bytesThreshold) {
+                Commit();
+                return;
+            }
+            break;
+        case LogFlushMode::Interval:
+            if (GetTickCount64() - m_lastCommitTick >= m_policy.intervalMs) {
+                Commit();
+                return;
+            }
+            break;
+        case LogFlushMode::OnError:
+            if (level >= LogLevel::Error) {
+                Commit();
+                return;
+            }
+            break;
+    }
+    
+    if (m_buffer.size() >= kMaxBufferBytes) {
+        WriteBuffer();
+    }
+}
+
+void LogFileSink::Tick() {
+    if (m_file == kInvalidLogFile || m_policy.mode != LogFlushMode::Interval) {
+        return;
+    }
+    
+    if (GetTickCount64() - m_lastCommitTick >= m_policy.intervalMs) {
+        Commit();
+    }
+}
+
+void LogFileSink::Commit() {
+    if (m_file == kInvalidLogFile) {
+        return;
+    }
+    
+    WriteBuffer();
+    if (m_dirty) {
+        SyncData(m_file);
+        m_dirty = false;
+    }
+    m_lastCommitTick = GetTickCount64();
+}
+
+bool LogFileSink::OpenFile() {
+    m_file = OpenAppend(m_filePath);
+    if (m_file == kInvalidLogFile) {
+        return false;
+    }
+    
+    m_fileSize = GetSize(m_file);
+    m_openedTick = GetTickCount64();
+    return true;
+}
+
+void LogFileSink::WriteBuffer() {
+    if (m_buffer.empty()) {
+        return;
+    }
+    
+    // 轮转发生在写入之前，保证整批内容落在同一个文件中
+    if (ShouldRotate(m_buffer.length())) {
+        Rotate();
+        if (m_file == kInvalidLogFile) {
+            m_buffer.clear();
+            return;
+        }
+    }
+    
+    m_fileSize += WriteAll(m_file, m_buffer.c_str(), m_buffer.length());
+    m_buffer.clear();
+    m_dirty = true;
+}
+
+bool LogFileSink::ShouldRotate(size_t pendingBytes) const {
+    if (!m_rotation.IsEnabled() || m_fileSize == 0) {
+        return false;
+    }
+    
+    if (m_rotation.maxBytes > 0 && m_fileSize + pendingBytes > m_rotation.maxBytes) {
+        return true;
+    }
+    
+    if (m_rotation.intervalSeconds > 0 &&
+        GetTickCount64() - m_openedTick >= static_cast<ULONGLONG>(m_rotation.intervalSeconds) * 1000) {
+        return true;
+    }
+    
+    return false;
+}
+
+void LogFileSink::Rotate() {
+    if (m_dirty) {
+        SyncData(m_file);
+        m_dirty = false;
+    }
+    CloseFile(m_file);
+    m_file = kInvalidLogFile;
+    
+    if (m_rotation.retainCount == 0) {
+        DeletePath(m_filePath);
+    } else {
+        // 删除最旧的文件，其余依次后移：file.N-1 -> file.N, ..., file -> file.1
+        {
+            std::lock_guard<std::mutex> lock(LogCompressor::GetSegmentMutex());
+            DeleteSegment(GetSegmentPath(m_rotation.retainCount));
+            for (unsigned i = m_rotation.retainCount - 1; i >= 1; --i) {
+                MoveSegment(GetSegmentPath(i), GetSegmentPath(i + 1));
+            }
+            MovePath(m_filePath, GetSegmentPath(1));
+        }
+        
+        if (m_rotation.compress) {
+            LogFileHandle segment = OpenSegment(GetSegmentPath(1));
+            if (segment != kInvalidLogFile) {
+                LogCompressor::Submit(segment, m_filePath, m_rotation.retainCount);
+            }
+        }
+    }
+    
+    OpenFile();
+}
+
+String LogFileSink::GetSegmentPath(unsigned index) const {
+    return m_filePath + "." + std::to_string(index);
+}
+
+std::mutex LogCompressor::s_mutex;
+std::mutex LogCompressor::s_segmentMutex;
+std::vector<LogCompressor::PendingFile> LogCompressor::s_pending;
+HANDLE LogCompressor::s_thread = INVALID_HANDLE_VALUE;
+HANDLE LogCompressor::s_wakeEvent = INVALID_HANDLE_VALUE;
+bool LogCompressor::s_stop = false;
+
+void LogCompressor::Submit(LogFileHandle file, const String& basePath, unsigned retainCount) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    
+    if (s_thread == INVALID_HANDLE_VALUE) {
+        s_stop = false;
+        s_wakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+        s_thread = s_wakeEvent ? CreateThread(NULL, 0, ThreadProc, NULL, 0, NULL) : NULL;
+        if (!s_thread) {
+            // 无法启动后台线程时放弃压缩，不影响日志写入
+            s_thread = INVALID_HANDLE_VALUE;
+            if (s_wakeEvent) {
+                CloseHandle(s_wakeEvent);
+            }
+            s_wakeEvent = INVALID_HANDLE_VALUE;
+            CloseFile(file);
+            return;
+        }
+    }
+    
+    PendingFile pending = { file, basePath, retainCount };
+    s_pending.push_back(pending);
+    SetEvent(s_wakeEvent);
+}
+
+void LogCompressor::Shutdown() {
+    HANDLE thread;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_thread == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        s_stop = true;
+        SetEvent(s_wakeEvent);
+        thread = s_thread;
+    }
+    
+    // 线程在处理完当前文件后即退出，不再取新的文件。压缩单个大文件可能耗时较长，
+    // 必须等到线程真正结束后才能关闭它仍在使用的事件句柄
+    WaitForSingleObject(thread, INFINITE);
+    
+    std::lock_guard<std::mutex> lock(s_mutex);
+    CloseHandle(s_thread);
+    CloseHandle(s_wakeEvent);
+    s_thread = INVALID_HANDLE_VALUE;
+    s_wakeEvent = INVALID_HANDLE_VALUE;
+    
+    // 未处理的文件保持未压缩状态
+    for (const PendingFile& pending : s_pending) {
+        CloseFile(pending.file);
+    }
+    s_pending.clear();
+}
+
+DWORD WINAPI LogCompressor::ThreadProc(LPVOID lpParam) {
+    (void)lpParam;
+
+#ifdef _WIN32
+    // 后台模式同时降低CPU和I/O优先级
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#else
+    // Linux上setpriority作用于指定的线程
+    setpriority(PRIO_PROCESS, static_cast<id_t>(GetCurrentThreadId()), 19);
+#endif
+    
+    while (true) {
+        WaitForSingleObject(s_wakeEvent, INFINITE);
+        
+        while (true) {
+            PendingFile pending;
+            {
+                std::lock_guard<std::mutex> lock(s_mutex);
+                if (s_stop || s_pending.empty()) {
+                    break;
+                }
+                pending = s_pending.front();
+                s_pending.erase(s_pending.begin());
+            }
+            
+            Compress(pending);
+            CloseFile(pending.file);
+        }
+        
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_stop) {
+            break;
+        }
+    }
+
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+#endif
+    return 0;
+}
+
+void LogCompressor::Compress(const PendingFile& pending) {
+#ifdef _WIN32
+    USHORT format = COMPRESSION_FORMAT_DEFAULT;
+    DWORD bytesReturned = 0;
+    
+    // 非NTFS卷不支持压缩，此时保留原文件
+    DeviceIoControl(pending.file, FSCTL_SET_COMPRESSION, &format, sizeof(format), NULL, 0, &bytesReturned, NULL);
+#elif defined(WLM_HAVE_ZLIB)
+    // 先写入临时文件并落盘，失败时保留原文件
+    String tempPath = pending.basePath + ".gz.tmp";
+    int target = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (target < 0) {
+        return;
+    }
+    bool written = WriteGzip(pending.file, target);
+    if (written) {
+        SyncData(target);
+    }
+    CloseFile(target);
+    
+    struct stat source;
+    if (!written || fstat(pending.file, &source) != 0) {
+        DeletePath(tempPath);
+        return;
+    }
+    
+    // 压缩期间可能又发生了轮转，按inode找到文件当前的序号；已被保留策略删除时丢弃压缩结果
+    std::lock_guard<std::mutex> lock(s_segmentMutex);
+    for (unsigned index = 1; index <= pending.retainCount; ++index) {
+        String path = pending.basePath + "." + std::to_string(index);
+        struct stat segment;
+        if (stat(path.c_str(), &segment) == 0 && segment.st_dev == source.st_dev && segment.st_ino == source.st_ino) {
+            MovePath(tempPath, path + ".gz");
+            DeletePath(path);
+            return;
+        }
+    }
+    DeletePath(tempPath);
+#elif defined(FS_IOC_SETFLAGS)
+    // 不支持压缩属性的文件系统（如ext4）返回错误，此时保留原文件
+    int flags = 0;
+    if (ioctl(pending.file, FS_IOC_GETFLAGS, &flags) == 0 && !(flags & FS_COMPR_FL)) {
+        flags |= FS_COMPR_FL;
+        ioctl(pending.file, FS_IOC_SETFLAGS, &flags);
+    }
+#else
+    (void)pending;
+#endif
+}
\ No newline at end of file
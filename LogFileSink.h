@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Common.h"
+
+// 平台文件句柄：Windows上为文件句柄，其他平台为文件描述符
+#ifdef _WIN32
+typedef HANDLE LogFileHandle;
+const LogFileHandle kInvalidLogFile = INVALID_HANDLE_VALUE;
+#else
+typedef int LogFileHandle;
+const LogFileHandle kInvalidLogFile = -1;
+#endif
+
+// 日志文件落盘策略
+enum class LogFlushMode {
+    EveryLine = 0,  // 每次写入后立即落盘
+    Bytes = 1,      // 缓冲累计达到指定字节数后落盘
+    Interval = 2,   // 距上次落盘超过指定时间后落盘
+    OnError = 3     // 仅在写入Error级别日志时落盘
+};
+
+struct LogFlushPolicy {
+    LogFlushMode mode;
+    size_t bytesThreshold;
+    DWORD intervalMs;
+    
+    LogFlushPolicy() : mode(LogFlushMode::EveryLine), bytesThreshold(64 * 1024), intervalMs(1000) {}
+    
+    static LogFlushPolicy EveryLine();
+    static LogFlushPolicy EveryBytes(size_t bytes);
+    static LogFlushPolicy EveryInterval(DWORD intervalMs);
+    static LogFlushPolicy OnError();
+};
+
+// 日志文件轮转策略
+struct LogRotationPolicy {
+    uint64_t maxBytes;       // 单个文件的最大字节数，0表示不按大小轮转
+    DWORD intervalSeconds;   // 单个文件的最长使用时间，0表示不按时间轮转
+    unsigned retainCount;    // 保留的历史文件数量（file.1 ~ file.N，压缩后为file.N.gz）
+    bool compress;           // 是否在后台压缩历史文件
+    
+    LogRotationPolicy() : maxBytes(0), intervalSeconds(0), retainCount(5), compress(true) {}
+    
+    bool IsEnabled() const { return maxBytes > 0 || intervalSeconds > 0; }
+};
+
+// 分组提交的日志文件输出：先写入内存缓冲，满足策略时一次性写出并落盘
+class LogFileSink {
+public:
+    LogFileSink();
+    ~LogFileSink();
+    
+    // 禁用拷贝构造和赋值
+    LogFileSink(const LogFileSink&) = delete;
+    LogFileSink& operator=(const LogFileSink&) = delete;
+    
+    bool Open(const String& filePath, const LogFlushPolicy& policy);
+    void Close();
+    bool IsOpen() const { return m_file != kInvalidLogFile; }
+    
+    // level为本次写入内容中的最高级别
+    void Append(LogLevel level, const char* data, size_t length);
+    
+    // 定期调用，用于按时间间隔落盘
+    void Tick();
+    
+    // 写出缓冲并落盘
+    void Commit();
+    
+    const LogFlushPolicy& GetPolicy() const { return m_policy; }
+    
+    // 轮转策略在重新打开文件后仍然有效
+    void SetRotationPolicy(const LogRotationPolicy& policy) { m_rotation = policy; }
+    const LogRotationPolicy& GetRotationPolicy() const { return m_rotation; }
+
+private:
+    LogFileHandle m_file;
+    String m_filePath;
+    LogFlushPolicy m_policy;
+    LogRotationPolicy m_rotation;
+    uint64_t m_fileSize;
+    ULONGLONG m_openedTick;
+    String m_buffer;
+    ULONGLONG m_lastCommitTick;
+    bool m_dirty;  // 已写入文件但尚未落盘
+    
+    bool OpenFile();
+    void WriteBuffer();
+    bool ShouldRotate(size_t pendingBytes) const;
+    void Rotate();
+    String GetSegmentPath(unsigned index) const;
+};
+
+// 历史日志压缩：在低优先级后台线程上压缩轮转出的文件。Windows上启用NTFS透明压缩；
+// 其他平台有zlib时写成gzip格式的file.N.gz并删除原文件，没有zlib时设置FS_COMPR_FL属性
+class LogCompressor {
+public:
+    // 接管文件句柄，压缩完成后关闭。basePath和retainCount用于在完成时找到文件当前的序号
+    static void Submit(LogFileHandle file, const String& basePath, unsigned retainCount);
+    static void Shutdown();
+    
+    // 轮转改名期间持有，压缩完成后的改名也在此锁内进行，两者不会交错
+    static std::mutex& GetSegmentMutex() { return s_segmentMutex; }
+
+private:
+    struct PendingFile {
+        LogFileHandle file;
+        String basePath;
+        unsigned retainCount;
+    };
+    
+    static std::mutex s_mutex;
+    static std::mutex s_segmentMutex;
+    static std::vector<PendingFile> s_pending;
+    static HANDLE s_thread;
+    static HANDLE s_wakeEvent;
+    static bool s_stop;
+    
+    static DWORD WINAPI ThreadProc(LPVOID lpParam);
+    static void Compress(const PendingFile& pending);
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "LogRingBuffer.h"
+
+LogRingBuffer::LogRingBuffer(size_t capacity)
+    : m_cells(nullptr)
+    , m_mask(0)
+    , m_enqueuePos(0)
+    , m_dequeuePos(0) {
+    
+    // 容量向上取整到2的幂，便于用掩码取模
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    
+    m_cells = new Cell[size];
+    m_mask = size - 1;
+    
+    for (size_t i = 0; i < size; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+LogRingBuffer::~LogRingBuffer() {
+    delete[] m_cells;
+}
+
+bool LogRingBuffer::TryPush(LogRecord&& record) {
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    
+    while (true) {
+        Cell& cell = m_cells[pos & m_mask];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.record = std::move(record);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // 队列已满
+            return false;
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool LogRingBuffer::TryPop(LogRecord& record) {
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    
+    while (true) {
+        Cell& cell = m_cells[pos & m_mask];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        
+        if (diff == 0) {
+            if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                record = std::move(cell.record);
+                cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // 队列为空
+            return false;
+        } else {
+            pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool LogRingBuffer::IsEmpty() const {
+    return m_dequeuePos.load(std::memory_order_acquire) >= m_enqueuePos.load(std::memory_order_acquire);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Common.h"
+#include <chrono>
+
+// 异步日志记录
+struct LogRecord {
+    LogLevel level;
+    std::chrono::system_clock::time_point time;
+    int64_t counter;  // 单调计时模式下的性能计数器值
+    String message;
+    String fields;    // 结构化事件已按输出格式序列化的字段
+    
+    LogRecord() : level(LogLevel::Info), counter(0) {}
+};
+
+// 有界多生产者环形队列（基于序号的无锁实现）
+class LogRingBuffer {
+public:
+    explicit LogRingBuffer(size_t capacity);
+    ~LogRingBuffer();
+    
+    // 禁用拷贝构造和赋值
+    LogRingBuffer(const LogRingBuffer&) = delete;
+    LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+    
+    // 队列满时返回false，不阻塞
+    bool TryPush(LogRecord&& record);
+    bool TryPop(LogRecord& record);
+    
+    size_t GetCapacity() const { return m_mask + 1; }
+    bool IsEmpty() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+    
+    Cell* m_cells;
+    size_t m_mask;
+    
+    // 生产者与消费者位置分开放置，避免伪共享
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) std::atomic<size_t> m_dequeuePos;
+};
+
+// 单个生产线程独占的日志缓冲（按线程缓冲模式）
+struct LogThreadBuffer {
+    uint32_t threadId;
+    LogRingBuffer queue;
+    std::atomic<uint64_t> enqueued;   // 仅由所属线程递增
+    std::atomic<uint64_t> completed;  // 已写出或被丢弃的记录数
+    std::atomic<bool> abandoned;      // 所属线程已退出
+    
+    LogThreadBuffer(uint32_t id, size_t capacity)
+        : threadId(id), queue(capacity), enqueued(0), completed(0), abandoned(false) {}
+};
\ No newline at end of file
@@ -3,26 +3,95 @@
 #include <fstream>
 #include <chrono>
 #include <iomanip>
+#include <algorithm>
 
 std::mutex Logger::s_logMutex;
-LogLevel Logger::s_currentLevel = LogLevel::Info;
+std::atomic<LogLevel> Logger::s_currentLevel(LogLevel::Info);
 bool Logger::s_logToFile = false;
 String Logger::s_logFilePath;
-HANDLE Logger::s_logFile = INVALID_HANDLE_VALUE;
+LogFileSink Logger::s_fileSink;
+LogCrashRing Logger::s_crashRing;
+
+std::atomic<bool> Logger::s_asyncMode(false);
+std::unique_ptr<LogRingBuffer> Logger::s_queue;
+LogOverflowPolicy Logger::s_overflowPolicy = LogOverflowPolicy::Block;
+HANDLE Logger::s_writerThread = INVALID_HANDLE_VALUE;
+HANDLE Logger::s_wakeEvent = INVALID_HANDLE_VALUE;
+HANDLE Logger::s_drainedEvent = INVALID_HANDLE_VALUE;
+HANDLE Logger::s_spaceEvent = INVALID_HANDLE_VALUE;
+std::atomic<bool> Logger::s_writerStop(false);
+std::atomic<bool> Logger::s_writerIdle(false);
+std::atomic<uint32_t> Logger::s_blockedProducers(0);
+std::atomic<uint64_t> Logger::s_enqueuedCount(0);
+std::atomic<uint64_t> Logger::s_completedCount(0);
+std::atomic<uint64_t> Logger::s_droppedCount(0);
+HANDLE Logger::s_tickerThread = INVALID_HANDLE_VALUE;
+HANDLE Logger::s_tickerStopEvent = INVALID_HANDLE_VALUE;
+
+LogQueueMode Logger::s_queueMode = LogQueueMode::Shared;
+size_t Logger::s_queueCapacity = 0;
+std::atomic<uint64_t> Logger::s_bufferGeneration(0);
+std::mutex Logger::s_threadBuffersMutex;
+std::vector<std::shared_ptr<LogThreadBuffer>> Logger::s_threadBuffers;
+std::vector<LogRecord> Logger::s_mergeRecords;
+bool Logger::s_sharding = false;
+std::map<uint32_t, std::unique_ptr<LogFileSink>> Logger::s_shardSinks;
+
+std::atomic<LogTimestampMode> Logger::s_timestampMode(LogTimestampMode::WallClock);
+std::atomic<LogOutputFormat> Logger::s_outputFormat(LogOutputFormat::Text);
+String Logger::s_lineBuffer;
+int64_t Logger::s_counterFrequency = 0;
+int64_t Logger::s_counterStart = 0;
+
+// 单批次最多写出的字节数
+static const size_t kMaxBatchBytes = 64 * 1024;
+
+// "YYYY-MM-DD HH:MM:SS.mmm" 及结尾'\0'所需的长度
+static const size_t kTimestampBufferSize = 32;
+
+// 每个线程缓存当前秒的日期时间前缀，同一秒内只需填入毫秒
+struct TimestampCache {
+    time_t second;
+    char prefix[20];  // "YYYY-MM-DD HH:MM:SS"
+    
+    TimestampCache() : second(-1) { prefix[0] = '\0'; }
+};
+
+static thread_local TimestampCache t_timestampCache;
+
+// 线程退出时标记其缓冲为废弃，写线程取空后回收
+struct ThreadBufferHolder {
+    std::shared_ptr<LogThreadBuffer> buffer;
+    uint64_t generation;
+    
+    ThreadBufferHolder() : generation(0) {}
+    ~ThreadBufferHolder() {
+        if (buffer) {
+            buffer->abandoned = true;
+        }
+    }
+};
+
+static thread_local ThreadBufferHolder t_threadBuffer;
 
 void Logger::Initialize() {
     std::lock_guard<std::mutex> lock(s_logMutex);
     s_currentLevel = LogLevel::Info;
     s_logToFile = false;
-    s_logFile = INVALID_HANDLE_VALUE;
 }
 
 void Logger::Shutdown() {
-    std::lock_guard<std::mutex> lock(s_logMutex);
-    if (s_logFile != INVALID_HANDLE_VALUE) {
-        CloseHandle(s_logFile);
-        s_logFile = INVALID_HANDLE_VALUE;
+    SetAsyncMode(false);
+    StopTicker();
+    
+    {
+        std::lock_guard<std::mutex> lock(s_logMutex);
+        s_fileSink.Close();
+        CloseShardSinks();
     }
+    
+    s_crashRing.Close();
+    LogCompressor::Shutdown();
 }
 
 void Logger::Log(LogLevel level, const String& message) {
@@ -30,8 +99,67 @@ void Logger::Log(LogLevel level, const String& message) {
         return;
     }
     
+    LogRecord record;
+    record.level = level;
+    record.message = message;
+    Submit(std::move(record));
+}
+
+void Logger::SubmitEvent(LogLevel level, const char* name, const String& fields) {
+    size_t nameLength = strlen(name);
+    if (s_crashRing.IsOpen()) {
+        s_crashRing.Append(level, name, nameLength, fields.c_str(), fields.length());
+    }
+    
+    // 队列中的记录须持有自己的数据，字段缓冲随后会被调用线程复用
+    if (s_asyncMode) {
+        LogRecord record;
+        record.level = level;
+        record.message.assign(name, nameLength);
+        record.fields = fields;
+        QueueRecord(std::move(record));
+        return;
+    }
+    
+    // 同步模式下直接从事件名和线程字段缓冲格式化，不经过LogRecord的字符串
+    std::lock_guard<std::mutex> lock(s_logMutex);
+    LogRecord stamp;
+    stamp.level = level;
+    StampRecord(stamp);
+    
+    char timestamp[kTimestampBufferSize];
+    size_t timestampLength = FormatTimestamp(stamp, timestamp, sizeof(timestamp));
+    s_lineBuffer.clear();
+    FormatLine(level, timestamp, timestampLength, name, nameLength, fields.c_str(), fields.length(), s_lineBuffer);
+    WriteBatch(s_lineBuffer, level);
+}
+
+void Logger::Submit(LogRecord&& record) {
+    // 在入队或写出之前记录，确保崩溃时仍在队列或缓冲中的日志可以恢复
+    if (s_crashRing.IsOpen()) {
+        s_crashRing.Append(record.level, record.message.c_str(), record.message.length(),
+                           record.fields.c_str(), record.fields.length());
+    }
+    
+    if (s_asyncMode) {
+        QueueRecord(std::move(record));
+        return;
+    }
+    
     std::lock_guard<std::mutex> lock(s_logMutex);
-    WriteLog(level, message);
+    StampRecord(record);
+    WriteLog(record);
+}
+
+void Logger::QueueRecord(LogRecord&& record) {
+    StampRecord(record);
+    
+    if (s_queueMode == LogQueueMode::PerThread) {
+        LogThreadBuffer* buffer = GetThreadBuffer();
+        Enqueue(buffer->queue, buffer->enqueued, buffer->completed, std::move(record));
+    } else {
+        Enqueue(*s_queue, s_enqueuedCount, s_completedCount, std::move(record));
+    }
 }
 
 void Logger::Log(LogLevel level, const WString& message) {
@@ -71,53 +199,556 @@ void Logger::Log(LogLevel level, const wchar_t* format, ...) {
 }
 
 void Logger::SetLogLevel(LogLevel level) {
-    std::lock_guard<std::mutex> lock(s_logMutex);
     s_currentLevel = level;
 }
 
-void Logger::SetLogToFile(bool enable, const String& filePath) {
+void Logger::SetLogToFile(bool enable, const String& filePath, const LogFlushPolicy& policy) {
+    // 定时线程会获取s_logMutex，须在加锁前停止
+    StopTicker();
+    
+    {
+        std::lock_guard<std::mutex> lock(s_logMutex);
+        
+        s_fileSink.Close();
+        CloseShardSinks();
+        
+        s_logToFile = enable;
+        s_logFilePath = filePath;
+        
+        if (!enable || filePath.empty() || !s_fileSink.Open(filePath, policy)) {
+            return;
+        }
+    }
+    
+    // 同步模式下只在写日志时检查间隔，没有后续日志时需要定时线程把缓冲落盘
+    if (policy.mode == LogFlushMode::Interval) {
+        StartTicker(policy.intervalMs);
+    }
+}
+
+void Logger::SetLogRotation(const LogRotationPolicy& policy) {
+    std::lock_guard<std::mutex> lock(s_logMutex);
+    s_fileSink.SetRotationPolicy(policy);
+}
+
+void Logger::SetLogSharding(bool enable) {
+    std::lock_guard<std::mutex> lock(s_logMutex);
+    if (!enable) {
+        CloseShardSinks();
+    }
+    s_sharding = enable;
+}
+
+bool Logger::SetCrashLog(bool enable, const String& filePath, size_t capacity) {
+    // 与其他模式切换一样应在初始化或退出阶段调用
+    s_crashRing.Close();
+    if (!enable) {
+        return true;
+    }
+    
+    if (!s_crashRing.Open(filePath, capacity)) {
+        Log(LogLevel::Error, "Failed to open crash log file: %s, error: %s",
+            filePath.c_str(), Utils::GetLastErrorString().c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Logger::SetAsyncMode(bool enable, size_t queueCapacity, LogOverflowPolicy policy, LogQueueMode queueMode) {
+    // 切换模式应在初始化或退出阶段进行，此时不应有其他线程正在写日志
+    if (!enable) {
+        if (s_asyncMode) {
+            s_asyncMode = false;
+            StopWriter();
+        }
+        return true;
+    }
+    
+    if (s_asyncMode) {
+        StopWriter();
+    }
+    
+    s_queueMode = queueMode;
+    s_queueCapacity = queueCapacity;
+    s_overflowPolicy = policy;
+    if (queueMode == LogQueueMode::Shared) {
+        s_queue = std::make_unique<LogRingBuffer>(queueCapacity);
+    }
+    
+    // 各线程在下一次写日志时按新配置重新创建缓冲
+    {
+        std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+        s_threadBuffers.clear();
+    }
+    s_bufferGeneration++;
+    
+    s_writerStop = false;
+    s_writerIdle = false;
+    s_blockedProducers = 0;
+    
+    s_wakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+    s_drainedEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    s_spaceEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+    if (!s_wakeEvent || !s_drainedEvent || !s_spaceEvent) {
+        Log(LogLevel::Error, "Failed to create logger events, error: %s", Utils::GetLastErrorString().c_str());
+        StopWriter();
+        return false;
+    }
+    
+    s_writerThread = CreateThread(NULL, 0, WriterThreadProc, NULL, 0, NULL);
+    if (!s_writerThread) {
+        s_writerThread = INVALID_HANDLE_VALUE;
+        Log(LogLevel::Error, "Failed to create log writer thread, error: %s", Utils::GetLastErrorString().c_str());
+        StopWriter();
+        return false;
+    }
+    
+    s_asyncMode = true;
+    return true;
+}
+
+void Logger::Flush() {
+    if (s_asyncMode && s_queueMode == LogQueueMode::PerThread) {
+        // 记录每个线程缓冲此刻的入队数，等待它们全部写出
+        std::vector<std::pair<std::shared_ptr<LogThreadBuffer>, uint64_t>> targets;
+        for (const auto& buffer : GetThreadBuffers(false)) {
+            targets.emplace_back(buffer, buffer->enqueued.load());
+        }
+        
+        for (const auto& target : targets) {
+            while (target.first->completed.load() < target.second && !s_writerStop) {
+                WakeWriter();
+                WaitForSingleObject(s_drainedEvent, 10);
+            }
+        }
+    } else if (s_asyncMode) {
+        uint64_t target = s_enqueuedCount.load();
+        while (s_completedCount.load() < target && !s_writerStop) {
+            WakeWriter();
+            WaitForSingleObject(s_drainedEvent, 10);
+        }
+    }
+    
+    // 写线程在持锁期间完成出队和写出，拿到锁即说明在途批次已落盘
+    std::lock_guard<std::mutex> lock(s_logMutex);
+    std::cout.flush();
+    s_fileSink.Commit();
+    s_crashRing.Flush();
+    for (auto& shard : s_shardSinks) {
+        shard.second->Commit();
+    }
+}
+
+void Logger::Enqueue(LogRingBuffer& queue, std::atomic<uint64_t>& enqueued,
+                     std::atomic<uint64_t>& completed, LogRecord&& record) {
+    bool blocked = false;
+    while (!queue.TryPush(std::move(record))) {
+        if (s_writerStop) {
+            // 写线程已退出，直接同步写出
+            if (blocked) {
+                s_blockedProducers--;
+            }
+            std::lock_guard<std::mutex> lock(s_logMutex);
+            WriteLog(record);
+            return;
+        }
+        
+        switch (s_overflowPolicy) {
+            case LogOverflowPolicy::DropNewest:
+                s_droppedCount++;
+                return;
+            case LogOverflowPolicy::DropOldest: {
+                LogRecord oldest;
+                if (queue.TryPop(oldest)) {
+                    s_droppedCount++;
+                    completed++;
+                }
+                break;
+            }
+            case LogOverflowPolicy::Block:
+            default:
+                // 先登记再重试入队，写线程取出记录后看到登记即发出空位信号；
+                // 超时只是防止信号丢失的兜底，正常情况下阻塞的线程不会空转
+                if (!blocked) {
+                    blocked = true;
+                    s_blockedProducers++;
+                    continue;
+                }
+                WakeWriter();
+                WaitForSingleObject(s_spaceEvent, 10);
+                break;
+        }
+    }
+    
+    // 空位信号只唤醒一个线程，由它接力唤醒下一个，队列再次满时后者会重新等待
+    if (blocked && --s_blockedProducers > 0) {
+        SetEvent(s_spaceEvent);
+    }
+    
+    enqueued++;
+    WakeWriter();
+}
+
+LogThreadBuffer* Logger::GetThreadBuffer() {
+    ThreadBufferHolder& holder = t_threadBuffer;
+    uint64_t generation = s_bufferGeneration.load(std::memory_order_acquire);
+    
+    // 仅在线程首次写日志或配置变化时注册，之后入队不再触及共享状态
+    if (!holder.buffer || holder.generation != generation) {
+        if (holder.buffer) {
+            holder.buffer->abandoned = true;
+        }
+        holder.buffer = std::make_shared<LogThreadBuffer>(GetCurrentThreadId(), s_queueCapacity);
+        holder.generation = generation;
+        
+        std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+        s_threadBuffers.push_back(holder.buffer);
+    }
+    
+    return holder.buffer.get();
+}
+
+std::vector<std::shared_ptr<LogThreadBuffer>> Logger::GetThreadBuffers(bool pruneAbandoned) {
+    std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+    
+    if (pruneAbandoned) {
+        s_threadBuffers.erase(
+            std::remove_if(s_threadBuffers.begin(), s_threadBuffers.end(),
+                [](const std::shared_ptr<LogThreadBuffer>& buffer) {
+                    return buffer->abandoned && buffer->queue.IsEmpty();
+                }),
+            s_threadBuffers.end());
+    }
+    
+    return s_threadBuffers;
+}
+
+bool Logger::HasPendingRecords() {
+    if (s_queueMode == LogQueueMode::PerThread) {
+        for (const auto& buffer : GetThreadBuffers(false)) {
+            if (!buffer->queue.IsEmpty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return !s_queue->IsEmpty();
+}
+
+void Logger::WakeWriter() {
+    // 仅在写线程空闲等待时才触发事件，避免每条日志一次系统调用；
+    // 先读后交换，写线程忙碌时不产生共享缓存行的写竞争。
+    // 入队与读取空闲标志之间的全屏障和写线程一侧的屏障配对：要么写线程看到新记录不再等待，
+    // 要么这里看到空闲标志并唤醒它，不会两边都错过
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (s_writerIdle.load(std::memory_order_acquire) && s_writerIdle.exchange(false, std::memory_order_acq_rel)) {
+        SetEvent(s_wakeEvent);
+    }
+}
+
+void Logger::StopWriter() {
+    if (s_writerThread != INVALID_HANDLE_VALUE) {
+        s_writerStop = true;
+        SetEvent(s_wakeEvent);
+        WaitForSingleObject(s_writerThread, INFINITE);
+        CloseHandle(s_writerThread);
+        s_writerThread = INVALID_HANDLE_VALUE;
+    }
+    
+    if (s_wakeEvent && s_wakeEvent != INVALID_HANDLE_VALUE) {
+        CloseHandle(s_wakeEvent);
+    }
+    s_wakeEvent = INVALID_HANDLE_VALUE;
+    
+    if (s_drainedEvent && s_drainedEvent != INVALID_HANDLE_VALUE) {
+        CloseHandle(s_drainedEvent);
+    }
+    s_drainedEvent = INVALID_HANDLE_VALUE;
+    
+    if (s_spaceEvent && s_spaceEvent != INVALID_HANDLE_VALUE) {
+        CloseHandle(s_spaceEvent);
+    }
+    s_spaceEvent = INVALID_HANDLE_VALUE;
+    
+    s_writerStop = true;
+}
+
+void Logger::DrainQueue(String& batch) {
     std::lock_guard<std::mutex> lock(s_logMutex);
+    ResetEvent(s_drainedEvent);
+    
+    if (s_queueMode == LogQueueMode::PerThread) {
+        DrainThreadBuffers(batch);
+    } else {
+        DrainSharedQueue(batch);
+    }
+    
+    // 按时间间隔策略落盘
+    s_fileSink.Tick();
+    for (auto& shard : s_shardSinks) {
+        shard.second->Tick();
+    }
+    
+    SetEvent(s_drainedEvent);
+    if (s_blockedProducers.load(std::memory_order_seq_cst) > 0) {
+        SetEvent(s_spaceEvent);
+    }
+}
+
+void Logger::DrainSharedQueue(String& batch) {
+    LogRecord record;
+    LogLevel maxLevel = LogLevel::Debug;
+    uint64_t count = 0;
+    while (s_queue->TryPop(record)) {
+        FormatRecord(record, batch);
+        if (record.level > maxLevel) {
+            maxLevel = record.level;
+        }
+        count++;
+        
+        if (batch.size() >= kMaxBatchBytes) {
+            WriteBatch(batch, maxLevel);
+            batch.clear();
+            maxLevel = LogLevel::Debug;
+        }
+    }
     
-    if (s_logFile != INVALID_HANDLE_VALUE) {
-        CloseHandle(s_logFile);
-        s_logFile = INVALID_HANDLE_VALUE;
+    if (!batch.empty()) {
+        WriteBatch(batch, maxLevel);
+        batch.clear();
     }
     
-    s_logToFile = enable;
-    s_logFilePath = filePath;
+    s_completedCount += count;
+}
+
+void Logger::DrainThreadBuffers(String& batch) {
+    auto buffers = GetThreadBuffers(true);
+    std::vector<size_t> counts(buffers.size(), 0);
+    
+    // 每轮每个线程最多取出一个队列容量的记录，避免单个线程长期占用写线程
+    s_mergeRecords.clear();
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        LogRecord record;
+        while (counts[i] < s_queueCapacity && buffers[i]->queue.TryPop(record)) {
+            s_mergeRecords.push_back(std::move(record));
+            counts[i]++;
+        }
+    }
     
-    if (enable && !filePath.empty()) {
-        s_logFile = CreateFileA(
-            filePath.c_str(),
-            GENERIC_WRITE,
-            FILE_SHARE_READ,
-            NULL,
-            OPEN_ALWAYS,
-            FILE_ATTRIBUTE_NORMAL,
-            NULL
-        );
+    bool sharded = s_sharding && s_logToFile && !s_logFilePath.empty();
+    if (sharded) {
+        // 同一线程的记录在合并缓冲中是连续的，直接写入该线程的分片文件
+        size_t offset = 0;
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            LogLevel maxLevel = LogLevel::Debug;
+            for (size_t n = 0; n < counts[i]; ++n) {
+                const LogRecord& record = s_mergeRecords[offset + n];
+                FormatRecord(record, batch);
+                if (record.level > maxLevel) {
+                    maxLevel = record.level;
+                }
+            }
+            offset += counts[i];
+            
+            if (!batch.empty()) {
+                std::cout.write(batch.c_str(), batch.length());
+                LogFileSink* shard = GetShardSink(buffers[i]->threadId);
+                if (shard) {
+                    shard->Append(maxLevel, batch.c_str(), batch.length());
+                }
+                batch.clear();
+            }
+        }
+    } else {
+        // 各线程内部已有序，稳定排序即可得到按时间戳合并的结果；
+        // 跨批次的先后只能保证到写线程的一次取出为止
+        bool monotonic = s_timestampMode == LogTimestampMode::Monotonic;
+        std::stable_sort(s_mergeRecords.begin(), s_mergeRecords.end(),
+            [monotonic](const LogRecord& a, const LogRecord& b) {
+                return monotonic ? a.counter < b.counter : a.time < b.time;
+            });
+        
+        LogLevel maxLevel = LogLevel::Debug;
+        for (const auto& record : s_mergeRecords) {
+            FormatRecord(record, batch);
+            if (record.level > maxLevel) {
+                maxLevel = record.level;
+            }
+            
+            if (batch.size() >= kMaxBatchBytes) {
+                WriteBatch(batch, maxLevel);
+                batch.clear();
+                maxLevel = LogLevel::Debug;
+            }
+        }
         
-        if (s_logFile != INVALID_HANDLE_VALUE) {
-            SetFilePointer(s_logFile, 0, NULL, FILE_END);
+        if (!batch.empty()) {
+            WriteBatch(batch, maxLevel);
+            batch.clear();
         }
     }
+    
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        buffers[i]->completed += counts[i];
+    }
+    s_mergeRecords.clear();
 }
 
-void Logger::WriteLog(LogLevel level, const String& message) {
-    String logMessage = GetCurrentTimeString() + " [" + GetLogLevelString(level) + "] " + message + "\n";
+LogFileSink* Logger::GetShardSink(uint32_t threadId) {
+    auto it = s_shardSinks.find(threadId);
+    if (it != s_shardSinks.end()) {
+        return it->second.get();
+    }
     
+    auto shard = std::make_unique<LogFileSink>();
+    shard->SetRotationPolicy(s_fileSink.GetRotationPolicy());
+    if (!shard->Open(s_logFilePath + "." + std::to_string(threadId), s_fileSink.GetPolicy())) {
+        return nullptr;
+    }
+    
+    LogFileSink* result = shard.get();
+    s_shardSinks[threadId] = std::move(shard);
+    return result;
+}
+
+void Logger::CloseShardSinks() {
+    s_shardSinks.clear();
+}
+
+DWORD WINAPI Logger::WriterThreadProc(LPVOID lpParam) {
+    (void)lpParam;
+    
+    String batch;
+    batch.reserve(kMaxBatchBytes + 1024);
+    
+    while (!s_writerStop) {
+        // 与WakeWriter中的屏障配对，先公布空闲再检查队列
+        s_writerIdle.store(true, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!HasPendingRecords()) {
+            WaitForSingleObject(s_wakeEvent, 100);
+        }
+        s_writerIdle.store(false, std::memory_order_release);
+        
+        DrainQueue(batch);
+    }
+    
+    // 退出前写出剩余记录
+    DrainQueue(batch);
+    return 0;
+}
+
+void Logger::StartTicker(DWORD intervalMs) {
+    s_tickerStopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!s_tickerStopEvent) {
+        s_tickerStopEvent = INVALID_HANDLE_VALUE;
+        return;
+    }
+    
+    // 按半个间隔检查，缓冲中的日志最迟约1.5个间隔后落盘
+    DWORD period = std::max<DWORD>(intervalMs / 2, 10);
+    s_tickerThread = CreateThread(NULL, 0, TickerThreadProc,
+                                  reinterpret_cast<LPVOID>(static_cast<uintptr_t>(period)), 0, NULL);
+    if (!s_tickerThread) {
+        s_tickerThread = INVALID_HANDLE_VALUE;
+        CloseHandle(s_tickerStopEvent);
+        s_tickerStopEvent = INVALID_HANDLE_VALUE;
+    }
+}
+
+void Logger::StopTicker() {
+    if (s_tickerThread != INVALID_HANDLE_VALUE) {
+        SetEvent(s_tickerStopEvent);
+        WaitForSingleObject(s_tickerThread, INFINITE);
+        CloseHandle(s_tickerThread);
+        s_tickerThread = INVALID_HANDLE_VALUE;
+    }
+    
+    if (s_tickerStopEvent != INVALID_HANDLE_VALUE) {
+        CloseHandle(s_tickerStopEvent);
+        s_tickerStopEvent = INVALID_HANDLE_VALUE;
+    }
+}
+
+DWORD WINAPI Logger::TickerThreadProc(LPVOID lpParam) {
+    DWORD period = static_cast<DWORD>(reinterpret_cast<uintptr_t>(lpParam));
+    
+    while (WaitForSingleObject(s_tickerStopEvent, period) == WAIT_TIMEOUT) {
+        if (s_asyncMode) {
+            continue;
+        }
+        
+        std::lock_guard<std::mutex> lock(s_logMutex);
+        s_fileSink.Tick();
+        for (auto& shard : s_shardSinks) {
+            shard.second->Tick();
+        }
+    }
+    return 0;
+}
+
+void Logger::WriteLog(const LogRecord& record) {
+    // 调用方持有s_logMutex，格式化缓冲可在多次写入间复用
+    s_lineBuffer.clear();
+    FormatRecord(record, s_lineBuffer);
+    WriteBatch(s_lineBuffer, record.level);
+}
+
+void Logger::WriteBatch(const String& batch, LogLevel maxLevel) {
     // 输出到控制台
-    std::cout << logMessage;
+    std::cout.write(batch.c_str(), batch.length());
     
-    // 输出到文件
-    if (s_logToFile && s_logFile != INVALID_HANDLE_VALUE) {
-        DWORD bytesWritten;
-        WriteFile(s_logFile, logMessage.c_str(), static_cast<DWORD>(logMessage.length()), &bytesWritten, NULL);
-        FlushFileBuffers(s_logFile);
+    // 输出到文件，按落盘策略分组提交
+    if (s_logToFile) {
+        s_fileSink.Append(maxLevel, batch.c_str(), batch.length());
     }
 }
 
-String Logger::GetLogLevelString(LogLevel level) {
+void Logger::FormatRecord(const LogRecord& record, String& out) {
+    char timestamp[kTimestampBufferSize];
+    size_t length = FormatTimestamp(record, timestamp, sizeof(timestamp));
+    FormatLine(record.level, timestamp, length, record.message.c_str(), record.message.length(),
+               record.fields.c_str(), record.fields.length(), out);
+}
+
+void Logger::FormatLine(LogLevel level, const char* timestamp, size_t timestampLength,
+                        const char* message, size_t messageLength,
+                        const char* fields, size_t fieldsLength, String& out) {
+    LogOutputFormat format = s_outputFormat;
+    switch (format) {
+        case LogOutputFormat::JsonLines:
+            out += "{\"ts\":";
+            LogEvent::AppendString(out, timestamp, timestampLength, format);
+            out += ",\"level\":\"";
+            out += GetLogLevelString(level);
+            out += "\",\"msg\":";
+            LogEvent::AppendString(out, message, messageLength, format);
+            out.append(fields, fieldsLength);
+            out += "}\n";
+            break;
+        case LogOutputFormat::Logfmt:
+            out += "ts=";
+            LogEvent::AppendString(out, timestamp, timestampLength, format);
+            out += " level=";
+            out += GetLogLevelString(level);
+            out += " msg=";
+            LogEvent::AppendString(out, message, messageLength, format);
+            out.append(fields, fieldsLength);
+            out += "\n";
+            break;
+        default:
+            out.append(timestamp, timestampLength);
+            out += " [";
+            out += GetLogLevelString(level);
+            out += "] ";
+            out.append(message, messageLength);
+            out.append(fields, fieldsLength);
+            out += "\n";
+            break;
+    }
+}
+
+const char* Logger::GetLogLevelString(LogLevel level) {
     switch (level) {
         case LogLevel::Debug: return "DEBUG";
         case LogLevel::Info: return "INFO";
@@ -127,17 +758,94 @@ String Logger::GetLogLevelString(LogLevel level) {
     }
 }
 
-String Logger::GetCurrentTimeString() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+void Logger::SetTimestampMode(LogTimestampMode mode) {
+    if (mode == LogTimestampMode::Monotonic && s_counterFrequency == 0) {
+        LARGE_INTEGER frequency;
+        LARGE_INTEGER counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        s_counterStart = counter.QuadPart;
+        s_counterFrequency = frequency.QuadPart;
+    }
+    s_timestampMode = mode;
+}
+
+void Logger::SetOutputFormat(LogOutputFormat format) {
+    s_outputFormat = format;
+}
+
+void Logger::StampRecord(LogRecord& record) {
+    if (s_timestampMode == LogTimestampMode::Monotonic) {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        record.counter = counter.QuadPart;
+    } else {
+        record.time = std::chrono::system_clock::now();
+    }
+}
+
+size_t Logger::GetCurrentTimeString(char* buffer, size_t size) {
+    LogRecord record;
+    StampRecord(record);
+    return FormatTimestamp(record, buffer, size);
+}
+
+size_t Logger::FormatTimestamp(const LogRecord& record, char* buffer, size_t size) {
+    if (size < kTimestampBufferSize) {
+        if (size > 0) {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+    
+    if (s_timestampMode == LogTimestampMode::Monotonic && s_counterFrequency > 0) {
+        int64_t elapsed = record.counter - s_counterStart;
+        int64_t seconds = elapsed / s_counterFrequency;
+        int64_t micros = (elapsed % s_counterFrequency) * 1000000 / s_counterFrequency;
+        if (elapsed < 0) {
+            seconds = 0;
+            micros = 0;
+        }
+        
+        // 逐位写出，高频跟踪时避免snprintf的开销
+        char digits[20];
+        size_t count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + seconds % 10);
+            seconds /= 10;
+        } while (seconds > 0);
+        
+        size_t length = 0;
+        buffer[length++] = '+';
+        while (count > 0) {
+            buffer[length++] = digits[--count];
+        }
+        buffer[length++] = '.';
+        for (int64_t divisor = 100000; divisor > 0; divisor /= 10) {
+            buffer[length++] = static_cast<char>('0' + micros / divisor % 10);
+        }
+        buffer[length] = '\0';
+        return length;
+    }
+    
+    auto sinceEpoch = record.time.time_since_epoch();
+    time_t second = static_cast<time_t>(std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch).count());
+    int ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count() % 1000);
     
-    std::stringstream ss;
-    struct tm timeinfo;
-    localtime_s(&timeinfo, &time_t);
-    ss << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+    // 跨秒时才重新做本地时间换算
+    TimestampCache& cache = t_timestampCache;
+    if (cache.second != second) {
+        struct tm timeinfo;
+        localtime_s(&timeinfo, &second);
+        strftime(cache.prefix, sizeof(cache.prefix), "%Y-%m-%d %H:%M:%S", &timeinfo);
+        cache.second = second;
+    }
     
-    return ss.str();
+    memcpy(buffer, cache.prefix, 19);
+    buffer[19] = '.';
+    buffer[20] = static_cast<char>('0' + ms / 100);
+    buffer[21] = static_cast<char>('0' + ms / 10 % 10);
+    buffer[22] = static_cast<char>('0' + ms % 10);
+    buffer[23] = '\0';
+    return 23;
 }
\ No newline at end of file
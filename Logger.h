@@ -1,19 +1,40 @@
 #pragma once
 
-#include <windows.h>
+#include "Common.h"
+#include "LogRingBuffer.h"
+#include "LogFileSink.h"
+#include "LogEvent.h"
+#include "LogCrashRing.h"
 #include <string>
 #include <mutex>
 #include <fstream>
 #include <chrono>
 #include <iomanip>
 #include <cstdarg>
+#include <map>
 
-// 日志级别
-enum class LogLevel {
-    Debug = 0,
-    Info = 1,
-    Warning = 2,
-    Error = 3
+// 异步模式下队列满时的处理策略
+enum class LogOverflowPolicy {
+    Block = 0,       // 阻塞调用线程直到有空位
+    DropNewest = 1,  // 丢弃当前要写入的记录
+    DropOldest = 2   // 丢弃队列中最旧的记录
+};
+
+// 异步模式下的队列组织方式
+enum class LogQueueMode {
+    Shared = 0,    // 所有线程共用一个多生产者队列
+    PerThread = 1  // 每个线程独占一个队列，由写线程按时间戳合并
+};
+
+// 编译期最低日志级别（0=Debug, 1=Info, 2=Warning, 3=Error），由CMake选项WLM_MIN_LOG_LEVEL设置
+#ifndef WLM_MIN_LOG_LEVEL
+#define WLM_MIN_LOG_LEVEL 0
+#endif
+
+// 日志时间戳格式
+enum class LogTimestampMode {
+    WallClock = 0,  // 本地时间，如 2024-01-01 12:00:00.123
+    Monotonic = 1   // 自日志系统启动起的单调时间（性能计数器），如 +12.345678，适合高频跟踪
 };
 
 class Logger {
@@ -26,17 +47,156 @@ public:
     static void Log(LogLevel level, const char* format, ...);
     static void Log(LogLevel level, const wchar_t* format, ...);
     
+    // 结构化日志：Logger::Event("process.suspend").With("pid", processId).With("ok", true);
+    static LogEvent Event(const char* name) { return LogEvent(LogLevel::Info, name); }
+    static LogEvent Event(LogLevel level, const char* name) { return LogEvent(level, name); }
+    
     static void SetLogLevel(LogLevel level);
-    static void SetLogToFile(bool enable, const String& filePath = "");
+    static bool IsEnabled(LogLevel level) {
+        return static_cast<int>(level) >= WLM_MIN_LOG_LEVEL && level >= s_currentLevel;
+    }
+    static void SetLogToFile(bool enable, const String& filePath = "",
+                             const LogFlushPolicy& policy = LogFlushPolicy());
+    static void SetLogRotation(const LogRotationPolicy& policy);
+    
+    // 异步模式：调用线程只负责入队，由后台写线程批量输出
+    // PerThread模式下queueCapacity为每个线程的队列容量
+    static bool SetAsyncMode(bool enable, size_t queueCapacity = 8192,
+                             LogOverflowPolicy policy = LogOverflowPolicy::Block,
+                             LogQueueMode queueMode = LogQueueMode::Shared);
+    static bool IsAsyncMode() { return s_asyncMode; }
+    static uint64_t GetDroppedCount() { return s_droppedCount; }
     
+    // 按线程分片写文件：每个线程写入独立的 <日志文件>.<线程ID>，仅在PerThread模式下生效
+    static void SetLogSharding(bool enable);
+    
+    // 崩溃日志：每条日志在提交时同时写入内存映射的环形文件，进程崩溃后可用logrecover取出
+    static bool SetCrashLog(bool enable, const String& filePath = "", size_t capacity = 4 * 1024 * 1024);
+    
+    // 等待此前提交的所有日志写出
+    static void Flush();
+    
+    static void SetTimestampMode(LogTimestampMode mode);
+    static LogTimestampMode GetTimestampMode() { return s_timestampMode; }
+    
+    // 输出格式应在初始化阶段设置，切换前已序列化的事件字段不会重新编码
+    static void SetOutputFormat(LogOutputFormat format);
+    static LogOutputFormat GetOutputFormat() { return s_outputFormat; }
+    
+    // 将当前时间格式化到调用方提供的缓冲区，返回写入的字符数（不含结尾的'\0'）
+    static size_t GetCurrentTimeString(char* buffer, size_t size);
+
 private:
+    friend class LogEvent;
+    
     static std::mutex s_logMutex;
-    static LogLevel s_currentLevel;
+    static std::atomic<LogLevel> s_currentLevel;
     static bool s_logToFile;
     static String s_logFilePath;
-    static HANDLE s_logFile;
+    static LogFileSink s_fileSink;
+    static LogCrashRing s_crashRing;
     
-    static void WriteLog(LogLevel level, const String& message);
-    static String GetLogLevelString(LogLevel level);
-    static String GetCurrentTimeString();
-};
\ No newline at end of file
+    // 异步模式状态
+    static std::atomic<bool> s_asyncMode;
+    static std::unique_ptr<LogRingBuffer> s_queue;
+    static LogOverflowPolicy s_overflowPolicy;
+    static HANDLE s_writerThread;
+    static HANDLE s_wakeEvent;
+    static HANDLE s_drainedEvent;
+    static HANDLE s_spaceEvent;     // 自动重置，写线程取出记录后唤醒一个因队列满而阻塞的线程
+    static std::atomic<bool> s_writerStop;
+    static std::atomic<bool> s_writerIdle;
+    static std::atomic<uint32_t> s_blockedProducers;
+    static std::atomic<uint64_t> s_enqueuedCount;
+    static std::atomic<uint64_t> s_completedCount;
+    static std::atomic<uint64_t> s_droppedCount;
+    
+    // 同步模式下按时间间隔落盘的定时线程，异步模式由写线程负责
+    static HANDLE s_tickerThread;
+    static HANDLE s_tickerStopEvent;
+    
+    // 按线程缓冲模式状态
+    static LogQueueMode s_queueMode;
+    static size_t s_queueCapacity;
+    static std::atomic<uint64_t> s_bufferGeneration;
+    static std::mutex s_threadBuffersMutex;
+    static std::vector<std::shared_ptr<LogThreadBuffer>> s_threadBuffers;
+    static std::vector<LogRecord> s_mergeRecords;
+    static bool s_sharding;
+    static std::map<uint32_t, std::unique_ptr<LogFileSink>> s_shardSinks;
+    
+    // 时间戳状态
+    static std::atomic<LogTimestampMode> s_timestampMode;
+    static int64_t s_counterFrequency;
+    static int64_t s_counterStart;
+    
+    static std::atomic<LogOutputFormat> s_outputFormat;
+    static String s_lineBuffer;
+    
+    static void Submit(LogRecord&& record);
+    static void SubmitEvent(LogLevel level, const char* name, const String& fields);
+    static void QueueRecord(LogRecord&& record);
+    
+    static void Enqueue(LogRingBuffer& queue, std::atomic<uint64_t>& enqueued,
+                        std::atomic<uint64_t>& completed, LogRecord&& record);
+    static LogThreadBuffer* GetThreadBuffer();
+    static std::vector<std::shared_ptr<LogThreadBuffer>> GetThreadBuffers(bool pruneAbandoned);
+    static bool HasPendingRecords();
+    static void WakeWriter();
+    static void StopWriter();
+    static void DrainQueue(String& batch);
+    static void DrainSharedQueue(String& batch);
+    static void DrainThreadBuffers(String& batch);
+    static LogFileSink* GetShardSink(uint32_t threadId);
+    static void CloseShardSinks();
+    static DWORD WINAPI WriterThreadProc(LPVOID lpParam);
+    static void StartTicker(DWORD intervalMs);
+    static void StopTicker();
+    static DWORD WINAPI TickerThreadProc(LPVOID lpParam);
+    
+    static void WriteLog(const LogRecord& record);
+    static void WriteBatch(const String& batch, LogLevel maxLevel);
+    static void StampRecord(LogRecord& record);
+    static void FormatRecord(const LogRecord& record, String& out);
+    static void FormatLine(LogLevel level, const char* timestamp, size_t timestampLength,
+                           const char* message, size_t messageLength,
+                           const char* fields, size_t fieldsLength, String& out);
+    static size_t FormatTimestamp(const LogRecord& record, char* buffer, size_t size);
+    static const char* GetLogLevelString(LogLevel level);
+};
+
+// 先判断级别再求值参数，被禁用级别的调用不会产生任何参数计算
+#define WLM_LOG(level, ...) \
+    do { \
+        if (Logger::IsEnabled(level)) { \
+            Logger::Log(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+// 低于编译期最低级别的调用保留类型检查，但整体被编译器消除
+#define WLM_LOG_DISABLED(level, ...) \
+    do { \
+        if (false) { \
+            Logger::Log(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#if WLM_MIN_LOG_LEVEL <= 0
+#define LOG_DEBUG(...) WLM_LOG(LogLevel::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) WLM_LOG_DISABLED(LogLevel::Debug, __VA_ARGS__)
+#endif
+
+#if WLM_MIN_LOG_LEVEL <= 1
+#define LOG_INFO(...) WLM_LOG(LogLevel::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) WLM_LOG_DISABLED(LogLevel::Info, __VA_ARGS__)
+#endif
+
+#if WLM_MIN_LOG_LEVEL <= 2
+#define LOG_WARNING(...) WLM_LOG(LogLevel::Warning, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) WLM_LOG_DISABLED(LogLevel::Warning, __VA_ARGS__)
+#endif
+
+#define LOG_ERROR(...) WLM_LOG(LogLevel::Error, __VA_ARGS__)
\ No newline at end of file
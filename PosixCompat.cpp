@@ -0,0 +1,430 @@
+#include "Common.h"
+#include <algorithm>
+#include <climits>
+#include <condition_variable>
+#include <chrono>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace {
+
+// 等待多个对象的线程在各对象上登记，任一对象被触发时唤醒
+struct MultiWaiter {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool notified;
+    
+    MultiWaiter() : notified(false) {}
+};
+
+// 事件和线程共用的可等待状态，线程结束时触发（手动重置）
+struct WaitableState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool manualReset;
+    bool signaled;
+    std::vector<MultiWaiter*> waiters;
+    
+    WaitableState(bool manual, bool initial) : manualReset(manual), signaled(initial) {}
+};
+
+// 句柄只持有状态的引用，关闭句柄后仍在运行的线程不受影响
+struct WaitableHandle {
+    std::shared_ptr<WaitableState> state;
+};
+
+struct ThreadStart {
+    LPTHREAD_START_ROUTINE routine;
+    LPVOID parameter;
+    std::shared_ptr<WaitableState> state;
+};
+
+thread_local DWORD t_lastError = 0;
+
+WaitableState* GetState(HANDLE handle) {
+    if (!handle || handle == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    return static_cast<WaitableHandle*>(handle)->state.get();
+}
+
+void Signal(WaitableState& state) {
+    std::vector<MultiWaiter*> waiters;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.signaled = true;
+        waiters = state.waiters;
+    }
+    
+    if (state.manualReset) {
+        state.cv.notify_all();
+    } else {
+        state.cv.notify_one();
+    }
+    
+    for (MultiWaiter* waiter : waiters) {
+        std::lock_guard<std::mutex> lock(waiter->mutex);
+        waiter->notified = true;
+        waiter->cv.notify_one();
+    }
+}
+
+// 已触发时返回true，自动重置的对象同时复位
+bool TryConsume(WaitableState& state) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.signaled) {
+        return false;
+    }
+    if (!state.manualReset) {
+        state.signaled = false;
+    }
+    return true;
+}
+
+void Unregister(WaitableState& state, MultiWaiter* waiter) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.waiters.erase(std::remove(state.waiters.begin(), state.waiters.end(), waiter), state.waiters.end());
+}
+
+void* ThreadEntry(void* parameter) {
+    std::unique_ptr<ThreadStart> start(static_cast<ThreadStart*>(parameter));
+    start->routine(start->parameter);
+    Signal(*start->state);
+    return nullptr;
+}
+
+HANDLE CreateWaitable(bool manualReset, bool initialState) {
+    WaitableHandle* handle = new (std::nothrow) WaitableHandle;
+    if (!handle) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+    handle->state = std::make_shared<WaitableState>(manualReset, initialState);
+    return handle;
+}
+
+uint64_t GetMonotonicNanoseconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+// UTF-8解码，非法序列按U+FFFD处理，与Windows未指定MB_ERR_INVALID_CHARS时一致
+size_t DecodeUtf8(const unsigned char* data, size_t length, uint32_t& codePoint) {
+    unsigned char lead = data[0];
+    size_t size = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+    if (size == 0 || size > length) {
+        codePoint = 0xFFFD;
+        return 1;
+    }
+    if (size == 1) {
+        codePoint = lead;
+        return 1;
+    }
+    
+    codePoint = lead & (0xFF >> (size + 1));
+    for (size_t i = 1; i < size; ++i) {
+        if ((data[i] & 0xC0) != 0x80) {
+            codePoint = 0xFFFD;
+            return i;
+        }
+        codePoint = (codePoint << 6) | (data[i] & 0x3F);
+    }
+    
+    static const uint32_t kMinimum[] = { 0, 0, 0x80, 0x800, 0x10000 };
+    if (codePoint < kMinimum[size] || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+        codePoint = 0xFFFD;
+    }
+    return size;
+}
+
+size_t EncodeUtf8(uint32_t codePoint, char* out) {
+    if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+        codePoint = 0xFFFD;
+    }
+    if (codePoint < 0x80) {
+        out[0] = static_cast<char>(codePoint);
+        return 1;
+    }
+    if (codePoint < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+        out[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    if (codePoint < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+        out[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+    out[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    return 4;
+}
+
+} // namespace
+
+HANDLE CreateEventW(LPSECURITY_ATTRIBUTES attributes, BOOL manualReset, BOOL initialState, LPCWSTR name) {
+    (void)attributes;
+    (void)name;
+    return CreateWaitable(manualReset != FALSE, initialState != FALSE);
+}
+
+HANDLE CreateEventA(LPSECURITY_ATTRIBUTES attributes, BOOL manualReset, BOOL initialState, LPCSTR name) {
+    (void)attributes;
+    (void)name;
+    return CreateWaitable(manualReset != FALSE, initialState != FALSE);
+}
+
+BOOL SetEvent(HANDLE event) {
+    WaitableState* state = GetState(event);
+    if (!state) {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+    Signal(*state);
+    return TRUE;
+}
+
+BOOL ResetEvent(HANDLE event) {
+    WaitableState* state = GetState(event);
+    if (!state) {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->signaled = false;
+    return TRUE;
+}
+
+HANDLE CreateThread(LPSECURITY_ATTRIBUTES attributes, size_t stackSize, LPTHREAD_START_ROUTINE startAddress,
+                    LPVOID parameter, DWORD creationFlags, DWORD* threadId) {
+    (void)attributes;
+    (void)creationFlags;
+    
+    HANDLE handle = CreateWaitable(true, false);
+    if (!handle) {
+        return NULL;
+    }
+    
+    ThreadStart* start = new ThreadStart{ startAddress, parameter, static_cast<WaitableHandle*>(handle)->state };
+    
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (stackSize > 0) {
+        pthread_attr_setstacksize(&attr, std::max<size_t>(stackSize, PTHREAD_STACK_MIN));
+    }
+    
+    pthread_t thread;
+    int result = pthread_create(&thread, &attr, ThreadEntry, start);
+    pthread_attr_destroy(&attr);
+    if (result != 0) {
+        delete start;
+        CloseHandle(handle);
+        SetLastError(static_cast<DWORD>(result));
+        return NULL;
+    }
+    
+    // 新线程的内核线程ID要到其运行后才能取得，调用方需要时应在线程内调用GetCurrentThreadId
+    if (threadId) {
+        *threadId = 0;
+    }
+    return handle;
+}
+
+BOOL CloseHandle(HANDLE handle) {
+    if (!handle || handle == INVALID_HANDLE_VALUE) {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+    delete static_cast<WaitableHandle*>(handle);
+    return TRUE;
+}
+
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds) {
+    WaitableState* state = GetState(handle);
+    if (!state) {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return WAIT_FAILED;
+    }
+    
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (milliseconds == INFINITE) {
+        state->cv.wait(lock, [state]() { return state->signaled; });
+    } else if (!state->cv.wait_for(lock, std::chrono::milliseconds(milliseconds),
+                                   [state]() { return state->signaled; })) {
+        return WAIT_TIMEOUT;
+    }
+    
+    if (!state->manualReset) {
+        state->signaled = false;
+    }
+    return WAIT_OBJECT_0;
+}
+
+DWORD WaitForMultipleObjects(DWORD count, const HANDLE* handles, BOOL waitAll, DWORD milliseconds) {
+    std::vector<WaitableState*> states;
+    for (DWORD i = 0; i < count; ++i) {
+        WaitableState* state = GetState(handles[i]);
+        if (!state) {
+            SetLastError(ERROR_INVALID_HANDLE);
+            return WAIT_FAILED;
+        }
+        states.push_back(state);
+    }
+    if (waitAll || states.empty()) {
+        SetLastError(ERROR_NOT_SUPPORTED);
+        return WAIT_FAILED;
+    }
+    
+    MultiWaiter waiter;
+    for (WaitableState* state : states) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->waiters.push_back(&waiter);
+    }
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+    DWORD result = WAIT_TIMEOUT;
+    while (true) {
+        // 先清除通知再检查，检查之后发生的触发会让下面的等待立即返回
+        {
+            std::lock_guard<std::mutex> lock(waiter.mutex);
+            waiter.notified = false;
+        }
+        
+        for (DWORD i = 0; i < count && result == WAIT_TIMEOUT; ++i) {
+            if (TryConsume(*states[i])) {
+                result = WAIT_OBJECT_0 + i;
+            }
+        }
+        if (result != WAIT_TIMEOUT) {
+            break;
+        }
+        
+        std::unique_lock<std::mutex> lock(waiter.mutex);
+        if (milliseconds == INFINITE) {
+            waiter.cv.wait(lock, [&waiter]() { return waiter.notified; });
+        } else if (!waiter.cv.wait_until(lock, deadline, [&waiter]() { return waiter.notified; })) {
+            break;
+        }
+    }
+    
+    for (WaitableState* state : states) {
+        Unregister(*state, &waiter);
+    }
+    return result;
+}
+
+ULONGLONG GetTickCount64() {
+    return GetMonotonicNanoseconds() / 1000000;
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter) {
+    counter->QuadPart = static_cast<LONGLONG>(GetMonotonicNanoseconds());
+    return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency) {
+    frequency->QuadPart = 1000000000LL;
+    return TRUE;
+}
+
+void GetSystemTimeAsFileTime(FILETIME* fileTime) {
+    // FILETIME以1601-01-01起的100纳秒为单位
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t value = static_cast<uint64_t>(now.tv_sec) * 10000000ULL + static_cast<uint64_t>(now.tv_nsec) / 100 +
+                     116444736000000000ULL;
+    fileTime->dwLowDateTime = static_cast<DWORD>(value & 0xFFFFFFFFULL);
+    fileTime->dwHighDateTime = static_cast<DWORD>(value >> 32);
+}
+
+void Sleep(DWORD milliseconds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+DWORD GetCurrentThreadId() {
+    static thread_local DWORD threadId = static_cast<DWORD>(syscall(SYS_gettid));
+    return threadId;
+}
+
+DWORD GetCurrentProcessId() {
+    return static_cast<DWORD>(getpid());
+}
+
+void GetSystemInfo(SYSTEM_INFO* systemInfo) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    systemInfo->dwNumberOfProcessors = processors > 0 ? static_cast<DWORD>(processors) : 1;
+    systemInfo->dwPageSize = pageSize > 0 ? static_cast<DWORD>(pageSize) : 4096;
+}
+
+DWORD GetLastError() {
+    return t_lastError;
+}
+
+void SetLastError(DWORD error) {
+    t_lastError = error;
+}
+
+int MultiByteToWideChar(unsigned codePage, DWORD flags, const char* input, int inputLength,
+                        wchar_t* output, int outputLength) {
+    (void)flags;
+    if (codePage != CP_UTF8 || !input) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return 0;
+    }
+    
+    // 长度为-1时包括结尾的'\0'
+    size_t length = inputLength < 0 ? strlen(input) + 1 : static_cast<size_t>(inputLength);
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(input);
+    
+    int written = 0;
+    for (size_t offset = 0; offset < length; ) {
+        uint32_t codePoint;
+        offset += DecodeUtf8(data + offset, length - offset, codePoint);
+        if (outputLength > 0) {
+            if (written >= outputLength) {
+                SetLastError(ENOBUFS);
+                return 0;
+            }
+            output[written] = static_cast<wchar_t>(codePoint);
+        }
+        written++;
+    }
+    return written;
+}
+
+int WideCharToMultiByte(unsigned codePage, DWORD flags, const wchar_t* input, int inputLength,
+                        char* output, int outputLength, const char* defaultChar, BOOL* usedDefaultChar) {
+    (void)flags;
+    (void)defaultChar;
+    if (usedDefaultChar) {
+        *usedDefaultChar = FALSE;
+    }
+    if (codePage != CP_UTF8 || !input) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return 0;
+    }
+    
+    size_t length = inputLength < 0 ? wcslen(input) + 1 : static_cast<size_t>(inputLength);
+    
+    int written = 0;
+    for (size_t i = 0; i < length; ++i) {
+        char encoded[4];
+        size_t size = EncodeUtf8(static_cast<uint32_t>(input[i]), encoded);
+        if (outputLength > 0) {
+            if (written + static_cast<int>(size) > outputLength) {
+                SetLastError(ENOBUFS);
+                return 0;
+            }
+            memcpy(output + written, encoded, size);
+        }
+        written += static_cast<int>(size);
+    }
+    return written;
+}
\ No newline at end of file
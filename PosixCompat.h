@@ -0,0 +1,144 @@
+#pragma once
+
+// 非Windows平台上的最小Win32兼容层：只提供核心模块共用的类型、事件、线程、计时和字符串转换接口。
+// 文件、共享内存、IPC传输和进程控制不在此模拟，由各模块按平台分别实现
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <cwchar>
+#include <ctime>
+#include <cerrno>
+
+// 基本类型，DWORD与Win32一样是unsigned long，已有的%lu格式保持不变
+typedef unsigned long DWORD;
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned short USHORT;
+typedef unsigned int UINT;
+typedef unsigned long ULONG;
+typedef long LONG;
+typedef int64_t LONG64;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+typedef void* LPVOID;
+typedef void* HANDLE;
+typedef char* LPSTR;
+typedef const char* LPCSTR;
+typedef const wchar_t* LPCWSTR;
+typedef void* LPSECURITY_ATTRIBUTES;
+typedef DWORD (*LPTHREAD_START_ROUTINE)(LPVOID);
+
+#define TRUE 1
+#define FALSE 0
+#define WINAPI
+#define INFINITE 0xFFFFFFFFUL
+#define MAXDWORD 0xFFFFFFFFUL
+#define MAX_PATH 4096
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(static_cast<intptr_t>(-1)))
+
+#define WAIT_OBJECT_0 0UL
+#define WAIT_TIMEOUT 258UL
+#define WAIT_FAILED 0xFFFFFFFFUL
+
+#define CP_UTF8 65001U
+
+// 错误码直接取errno的值，GetLastErrorString可统一用strerror描述
+#define ERROR_SUCCESS 0
+#define ERROR_FILE_NOT_FOUND ENOENT
+#define ERROR_ACCESS_DENIED EACCES
+#define ERROR_INVALID_HANDLE EBADF
+#define ERROR_NOT_ENOUGH_MEMORY ENOMEM
+#define ERROR_INVALID_PARAMETER EINVAL
+#define ERROR_INVALID_DATA EBADMSG
+#define ERROR_NOT_SUPPORTED ENOTSUP
+#define ERROR_ALREADY_EXISTS EEXIST
+#define ERROR_BROKEN_PIPE EPIPE
+#define ERROR_PIPE_BUSY EAGAIN
+#define ERROR_PIPE_NOT_CONNECTED ENOTCONN
+#define ERROR_NO_DATA ECONNRESET
+#define ERROR_TIMEOUT ETIMEDOUT
+#define ERROR_OPERATION_ABORTED ECANCELED
+#define ERROR_NOT_FOUND ESRCH
+#define ERROR_PROCESS_NOT_FOUND ESRCH
+
+union LARGE_INTEGER {
+    LONGLONG QuadPart;
+};
+
+struct FILETIME {
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+};
+
+struct SYSTEM_INFO {
+    DWORD dwNumberOfProcessors;
+    DWORD dwPageSize;
+};
+
+// 事件与线程句柄，CloseHandle只释放句柄本身，线程结束前仍可正常运行
+HANDLE CreateEventW(LPSECURITY_ATTRIBUTES attributes, BOOL manualReset, BOOL initialState, LPCWSTR name);
+HANDLE CreateEventA(LPSECURITY_ATTRIBUTES attributes, BOOL manualReset, BOOL initialState, LPCSTR name);
+BOOL SetEvent(HANDLE event);
+BOOL ResetEvent(HANDLE event);
+HANDLE CreateThread(LPSECURITY_ATTRIBUTES attributes, size_t stackSize, LPTHREAD_START_ROUTINE startAddress,
+                    LPVOID parameter, DWORD creationFlags, DWORD* threadId);
+BOOL CloseHandle(HANDLE handle);
+
+// 仅支持等待任意一个对象（waitAll为FALSE）
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds);
+DWORD WaitForMultipleObjects(DWORD count, const HANDLE* handles, BOOL waitAll, DWORD milliseconds);
+
+// 计时
+ULONGLONG GetTickCount64();
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+void GetSystemTimeAsFileTime(FILETIME* fileTime);
+void Sleep(DWORD milliseconds);
+
+// 进程与线程信息
+DWORD GetCurrentThreadId();
+DWORD GetCurrentProcessId();
+void GetSystemInfo(SYSTEM_INFO* systemInfo);
+
+// 每个线程独立的最后错误码
+DWORD GetLastError();
+void SetLastError(DWORD error);
+
+// 仅支持CP_UTF8
+int MultiByteToWideChar(unsigned codePage, DWORD flags, const char* input, int inputLength,
+                        wchar_t* output, int outputLength);
+int WideCharToMultiByte(unsigned codePage, DWORD flags, const wchar_t* input, int inputLength,
+                        char* output, int outputLength, const char* defaultChar, BOOL* usedDefaultChar);
+
+inline int localtime_s(struct tm* result, const time_t* time) {
+    return localtime_r(time, result) ? 0 : errno;
+}
+
+inline time_t _mkgmtime(struct tm* time) {
+    return timegm(time);
+}
+
+inline int vsnprintf_s(char* buffer, size_t size, const char* format, va_list args) {
+    return vsnprintf(buffer, size, format, args);
+}
+
+template <size_t N>
+inline int vswprintf_s(wchar_t (&buffer)[N], const wchar_t* format, va_list args) {
+    return vswprintf(buffer, N, format, args);
+}
+
+inline LONG64 InterlockedExchangeAdd64(volatile LONG64* addend, LONG64 value) {
+    return __atomic_fetch_add(addend, value, __ATOMIC_SEQ_CST);
+}
+
+inline void YieldProcessor() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "ProcFs.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+
+namespace {
+
+bool ListNumericEntries(const char* path, std::vector<DWORD>& ids) {
+    ids.clear();
+    DIR* dir = opendir(path);
+    if (!dir) {
+        SetLastError(errno);
+        return false;
+    }
+    
+    while (dirent* entry = readdir(dir)) {
+        char* end = nullptr;
+        unsigned long id = strtoul(entry->d_name, &end, 10);
+        if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9' && *end == '\0') {
+            ids.push_back(static_cast<DWORD>(id));
+        }
+    }
+    
+    closedir(dir);
+    return true;
+}
+
+// 格式: pid (comm) state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt
+//       utime stime cutime cstime priority nice num_threads itrealvalue starttime ...
+// comm中可能含有空格和括号，以最后一个')'为界
+bool ParseStat(const char* path, ProcFs::Stat& stat) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    
+    char buffer[1024];
+    ssize_t size = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (size <= 0) {
+        return false;
+    }
+    buffer[size] = '\0';
+    
+    char* nameStart = strchr(buffer, '(');
+    char* nameEnd = strrchr(buffer, ')');
+    if (!nameStart || !nameEnd || nameEnd < nameStart || nameEnd[1] != ' ' || nameEnd[2] == '\0') {
+        return false;
+    }
+    
+    stat.processId = static_cast<DWORD>(strtoul(buffer, nullptr, 10));
+    stat.name.assign(nameStart + 1, nameEnd);
+    stat.state = nameEnd[2];
+    
+    // 从state之后的第4个字段ppid开始按序号取值
+    char* cursor = nameEnd + 3;
+    for (int field = 4; field <= 22; ++field) {
+        char* end = nullptr;
+        unsigned long long value = strtoull(cursor, &end, 10);
+        if (end == cursor) {
+            return false;
+        }
+        cursor = end;
+        
+        if (field == 4) {
+            stat.parentProcessId = static_cast<DWORD>(value);
+        } else if (field == 20) {
+            stat.threadCount = static_cast<DWORD>(value);
+        } else if (field == 22) {
+            stat.startTime = value;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool ProcFs::ListProcesses(std::vector<DWORD>& processIds) {
+    return ListNumericEntries("/proc", processIds);
+}
+
+bool ProcFs::ListThreads(DWORD processId, std::vector<DWORD>& threadIds) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%lu/task", processId);
+    return ListNumericEntries(path, threadIds);
+}
+
+bool ProcFs::ReadStat(DWORD processId, Stat& stat) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%lu/stat", processId);
+    return ParseStat(path, stat);
+}
+
+bool ProcFs::ReadThreadStat(DWORD processId, DWORD threadId, Stat& stat) {
+    char path[96];
+    snprintf(path, sizeof(path), "/proc/%lu/task/%lu/stat", processId, threadId);
+    return ParseStat(path, stat);
+}
+
+const String& ProcFs::GetCgroupMount() {
+    // 格式: id parent major:minor root mountpoint options [optional...] - fstype source superoptions
+    static const String mount = []() {
+        String content, line;
+        ReadFile("/proc/self/mountinfo", content);
+        std::istringstream lines(content);
+        while (std::getline(lines, line)) {
+            size_t separator = line.find(" - ");
+            if (separator == String::npos || line.compare(separator + 3, 8, "cgroup2 ") != 0) {
+                continue;
+            }
+            
+            std::istringstream fields(line.substr(0, separator));
+            String id, parent, device, root, mountPoint;
+            fields >> id >> parent >> device >> root >> mountPoint;
+            return mountPoint;
+        }
+        return String();
+    }();
+    return mount;
+}
+
+bool ProcFs::GetCgroupPath(DWORD processId, String& path) {
+    const String& mount = GetCgroupMount();
+    char file[64];
+    snprintf(file, sizeof(file), "/proc/%lu/cgroup", processId);
+    String content;
+    if (mount.empty() || !ReadFile(file, content)) {
+        return false;
+    }
+    
+    // cgroup v2的条目为"0::<路径>"，v1各层级的条目以层级ID开头
+    std::istringstream lines(content);
+    String line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 3, "0::") == 0) {
+            String relative = line.substr(3);
+            path = relative == "/" ? mount : mount + relative;
+            return true;
+        }
+    }
+    SetLastError(ERROR_NOT_SUPPORTED);
+    return false;
+}
+
+bool ProcFs::ReadFile(const String& path, String& content) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        SetLastError(errno);
+        return false;
+    }
+    
+    content.clear();
+    char buffer[4096];
+    ssize_t size;
+    while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+        content.append(buffer, static_cast<size_t>(size));
+    }
+    if (size < 0) {
+        SetLastError(errno);
+    }
+    close(fd);
+    return size == 0;
+}
+
+bool ProcFs::WriteFile(const String& path, const String& content) {
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        SetLastError(errno);
+        return false;
+    }
+    
+    // cgroup接口文件要求一次写入完整的值
+    bool written = write(fd, content.c_str(), content.length()) == static_cast<ssize_t>(content.length());
+    if (!written) {
+        SetLastError(errno);
+    }
+    close(fd);
+    return written;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Common.h"
+
+// 非Windows平台上代替ToolHelp快照的/proc读取。
+// 进程名取自/proc/<pid>/stat中的comm字段，最长15个字符
+namespace ProcFs {
+
+// /proc/<pid>/stat或/proc/<pid>/task/<tid>/stat中用到的字段
+struct Stat {
+    DWORD processId;         // 读取线程时为线程ID
+    String name;
+    char state;              // R/S/D/T/t/Z等，T表示被SIGSTOP停止
+    DWORD parentProcessId;
+    DWORD threadCount;
+    uint64_t startTime;      // 自系统启动起的时钟滴答数，与PID一起唯一标识进程
+    
+    Stat() : processId(0), state(0), parentProcessId(0), threadCount(0), startTime(0) {}
+};
+
+// 列出/proc下的进程ID或/proc/<pid>/task下的线程ID。失败时返回false并设置最后错误
+bool ListProcesses(std::vector<DWORD>& processIds);
+bool ListThreads(DWORD processId, std::vector<DWORD>& threadIds);
+
+// 进程或线程已退出时返回false
+bool ReadStat(DWORD processId, Stat& stat);
+bool ReadThreadStat(DWORD processId, DWORD threadId, Stat& stat);
+
+// cgroup v2的挂载点，未挂载时返回空字符串；只在首次调用时读取/proc/self/mountinfo
+const String& GetCgroupMount();
+
+// 进程所在cgroup v2目录的完整路径，例如 /sys/fs/cgroup/user.slice/app.scope
+bool GetCgroupPath(DWORD processId, String& path);
+
+// 读写/proc和cgroup中的小文件。失败时返回false并设置最后错误
+bool ReadFile(const String& path, String& content);
+bool WriteFile(const String& path, const String& content);
+
+} // namespace ProcFs
\ No newline at end of file
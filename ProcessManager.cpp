@@ -1,71 +1,211 @@
 #include "ProcessManager.h"
+
+#ifdef _WIN32
 #include <tlhelp32.h>
 #include <psapi.h>
+#else
+#include "ProcFs.h"
+#include <csignal>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+typedef LONG (NTAPI *NtProcessControlFunc)(HANDLE processHandle);
+
+// ntdll中未公开的整进程挂起/恢复函数，在内核中一次挂起进程的全部线程，不会遗漏遍历期间新建的线程；
+// 与逐个线程挂起一样增加每个线程的挂起计数，两种方式挂起和恢复可以混用
+struct NativeProcessControl {
+    NtProcessControlFunc suspend;
+    NtProcessControlFunc resume;
+    
+    NativeProcessControl() : suspend(nullptr), resume(nullptr) {
+        HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+        if (ntdll) {
+            suspend = reinterpret_cast<NtProcessControlFunc>(GetProcAddress(ntdll, "NtSuspendProcess"));
+            resume = reinterpret_cast<NtProcessControlFunc>(GetProcAddress(ntdll, "NtResumeProcess"));
+        }
+    }
+    
+    bool IsAvailable() const { return suspend && resume; }
+};
 
-ProcessManager::ProcessManager() : m_lastError(ErrorCode::Success) {
+const NativeProcessControl& GetNativeProcessControl() {
+    static const NativeProcessControl control;
+    return control;
 }
+#else
+// SIGSTOP是异步的，发送后等待各线程进入停止状态的上限
+const DWORD kStopTimeoutMs = 1000;
 
-ProcessManager::~ProcessManager() {
+// T为停止，t为被跟踪时停止；已退出的线程不再运行，同样视为已停止
+bool IsStopped(char state) {
+    return state == 'T' || state == 't' || state == 'Z' || state == 'X';
 }
 
-std::vector<ProcessInfo> ProcessManager::GetProcessList() {
-    std::vector<ProcessInfo> processes;
-    
-    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (hSnapshot == INVALID_HANDLE_VALUE) {
-        Logger::Log(LogLevel::Error, "Failed to create process snapshot, error: %s", Utils::GetLastErrorString().c_str());
-        SetLastError(GetLastError());
-        return processes;
+// 逐个读取/proc/<pid>/task下线程的状态，全部停止时返回true；进程已退出时返回false
+bool WaitThreadsStopped(DWORD processId, ULONGLONG deadline, std::vector<DWORD>& threadIds) {
+    if (!ProcFs::ListThreads(processId, threadIds)) {
+        return false;
     }
     
-    PROCESSENTRY32W pe32;
-    pe32.dwSize = sizeof(PROCESSENTRY32W);
+    ProcFs::Stat stat;
+    for (DWORD threadId : threadIds) {
+        while (ProcFs::ReadThreadStat(processId, threadId, stat) && !IsStopped(stat.state)) {
+            if (GetTickCount64() >= deadline) {
+                Logger::Log(LogLevel::Warning, "Thread %lu of process %lu has not stopped yet, state: %c",
+                            threadId, processId, stat.state);
+                return true;
+            }
+            usleep(50);
+        }
+    }
+    return true;
+}
+
+// 本服务创建的冻结cgroup的目录名前缀，后接PID和序号
+const char kFreezePrefix[] = "wlm-freeze.";
+
+bool IsFreezeCgroup(const String& path) {
+    size_t slash = path.rfind('/');
+    return slash != String::npos && path.compare(slash + 1, sizeof(kFreezePrefix) - 1, kFreezePrefix) == 0;
+}
+
+// 解冻后将cgroup中的全部进程（包括移入后派生的子进程）移回原cgroup，再删除该cgroup。
+// 有进程未能移回时保留该cgroup并返回false，最后错误为移回失败的原因
+bool ThawCgroup(const String& cgroup, const String& originalCgroup) {
+    if (!ProcFs::WriteFile(cgroup + "/cgroup.freeze", "0")) {
+        return false;
+    }
     
-    if (Process32FirstW(hSnapshot, &pe32)) {
-        do {
-            ProcessInfo info;
-            info.processId = pe32.th32ProcessID;
-            info.processName = pe32.szExeFile;
-            info.threadCount = pe32.cntThreads;
-            info.parentProcessId = pe32.th32ParentProcessID;
-            
-            if (IsValidProcess(info)) {
-                processes.push_back(info);
+    // 解冻后的进程可能在移回期间继续派生子进程，重新读取直到cgroup为空；
+    // 移回时已退出的进程同样从cgroup.procs中消失
+    const int kMoveRounds = 3;
+    DWORD error = ERROR_SUCCESS;
+    String content;
+    for (int round = 0;; ++round) {
+        content.clear();
+        if (!ProcFs::ReadFile(cgroup + "/cgroup.procs", content) || content.empty() || round == kMoveRounds) {
+            break;
+        }
+        
+        String processId;
+        std::istringstream lines(content);
+        while (std::getline(lines, processId)) {
+            if (!ProcFs::WriteFile(originalCgroup + "/cgroup.procs", processId)) {
+                error = ::GetLastError();
+                Logger::Log(LogLevel::Warning, "Failed to move process %s back to cgroup %s, error: %s",
+                            processId.c_str(), originalCgroup.c_str(), Utils::GetLastErrorString().c_str());
             }
-        } while (Process32NextW(hSnapshot, &pe32));
+        }
     }
     
-    CloseHandle(hSnapshot);
-    Logger::Log(LogLevel::Debug, "Found %zu processes", processes.size());
+    if (!content.empty()) {
+        if (error == ERROR_SUCCESS) {
+            error = EBUSY;
+        }
+        ::SetLastError(error);
+        Logger::Log(LogLevel::Error, "Processes remain in cgroup %s after thaw, error: %s", cgroup.c_str(),
+                    Utils::GetLastErrorString().c_str());
+        ::SetLastError(error);
+        return false;
+    }
+    
+    // 进程已全部移回，删除失败只留下空目录，不影响恢复结果
+    if (rmdir(cgroup.c_str()) != 0 && errno != ENOENT) {
+        ::SetLastError(errno);
+        Logger::Log(LogLevel::Warning, "Failed to remove cgroup %s, error: %s", cgroup.c_str(),
+                    Utils::GetLastErrorString().c_str());
+    }
+    return true;
+}
+
+// cgroup v2的cgroup.freeze在内核中冻结cgroup内的全部线程，冻结期间新建的线程同样被冻结，
+// 不需要遍历/proc/<pid>/task。进程移入原cgroup下新建的子cgroup后冻结，恢复时由ThawCgroup移回。
+// 未挂载cgroup v2、无权创建cgroup或原cgroup为线程化cgroup时失败，由调用方回退到SIGSTOP
+bool FreezeCgroup(DWORD processId, String& cgroup, String& originalCgroup) {
+    static std::atomic<uint32_t> sequence(0);
+    String current;
+    if (!ProcFs::GetCgroupPath(processId, current)) {
+        return false;
+    }
+    
+    // 仍在此前冻结时创建的cgroup中（已被其他程序解冻），新的cgroup与之并列，恢复时移回真正的原cgroup
+    originalCgroup = IsFreezeCgroup(current) ? current.substr(0, current.rfind('/')) : current;
+    cgroup = originalCgroup + "/" + kFreezePrefix + std::to_string(processId) + "." + std::to_string(++sequence);
+    if (mkdir(cgroup.c_str(), 0755) != 0 && errno != EEXIST) {
+        ::SetLastError(errno);
+        return false;
+    }
+    
+    if (!ProcFs::WriteFile(cgroup + "/cgroup.procs", std::to_string(processId)) ||
+        !ProcFs::WriteFile(cgroup + "/cgroup.freeze", "1")) {
+        DWORD error = ::GetLastError();
+        ThawCgroup(cgroup, originalCgroup);
+        ::SetLastError(error);
+        return false;
+    }
+    
+    // 冻结是异步的，全部线程停止后cgroup.events中变为"frozen 1"
+    ULONGLONG deadline = GetTickCount64() + kStopTimeoutMs;
+    String events;
+    while (ProcFs::ReadFile(cgroup + "/cgroup.events", events) && events.find("frozen 1") == String::npos) {
+        if (GetTickCount64() >= deadline) {
+            Logger::Log(LogLevel::Warning, "Cgroup of process %lu has not frozen yet", processId);
+            break;
+        }
+        usleep(50);
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+thread_local ErrorCode ProcessManager::t_lastError = ErrorCode::Success;
+
+ProcessManager::ProcessManager() : m_nativeSuspend(true) {
+}
+
+ProcessManager::~ProcessManager() {
+}
+
+std::vector<ProcessInfo> ProcessManager::GetProcessList() {
+    std::vector<ProcessInfo> processes;
+    if (!m_processTable.GetAll(processes)) {
+        SetLastError(::GetLastError());
+        return processes;
+    }
+    
+    LOG_DEBUG("Found %zu processes", processes.size());
     return processes;
 }
 
 std::vector<ProcessInfo> ProcessManager::FindProcesses(const WString& processName) {
     std::vector<ProcessInfo> result;
-    auto processes = GetProcessList();
-    
-    for (const auto& process : processes) {
-        if (_wcsicmp(process.processName.c_str(), processName.c_str()) == 0) {
-            result.push_back(process);
-        }
+    if (!m_processTable.FindByName(processName, result)) {
+        SetLastError(::GetLastError());
+        return result;
     }
     
-    Logger::Log(LogLevel::Debug, "Found %zu processes with name: %s", 
-                result.size(), Utils::WStringToString(processName).c_str());
+    LOG_DEBUG("Found %zu processes with name: %s",
+              result.size(), Utils::WStringToString(processName).c_str());
     return result;
 }
 
 ProcessInfo ProcessManager::FindProcess(DWORD processId) {
     ProcessInfo info;
-    auto processes = GetProcessList();
-    
-    for (const auto& process : processes) {
-        if (process.processId == processId) {
-            return process;
-        }
+    bool found = false;
+    if (!m_processTable.Find(processId, info, found)) {
+        SetLastError(::GetLastError());
+        return info;
     }
     
-    SetLastError(ErrorCode::ProcessNotFound);
+    if (!found) {
+        SetLastError(ErrorCode::ProcessNotFound);
+    }
     return info;
 }
 
@@ -82,61 +222,41 @@ ProcessInfo ProcessManager::FindProcess(const WString& processName) {
 }
 
 bool ProcessManager::SuspendProcess(const WString& processName) {
-    auto processes = FindProcesses(processName);
-    if (processes.empty()) {
+    auto pids = GetProcessIds(processName);
+    if (pids.empty()) {
         Logger::Log(LogLevel::Warning, "Process not found: %s", Utils::WStringToString(processName).c_str());
         SetLastError(ErrorCode::ProcessNotFound);
         return false;
     }
     
-    bool anySuspended = false;
-    for (const auto& process : processes) {
-        if (SuspendProcess(process.processId)) {
-            anySuspended = true;
-        }
-    }
-    
-    return anySuspended;
+    return SuspendResumeProcesses(pids, true, false);
 }
 
 bool ProcessManager::ResumeProcess(const WString& processName) {
-    auto processes = FindProcesses(processName);
-    if (processes.empty()) {
+    auto pids = GetProcessIds(processName);
+    if (pids.empty()) {
         Logger::Log(LogLevel::Warning, "Process not found: %s", Utils::WStringToString(processName).c_str());
         SetLastError(ErrorCode::ProcessNotFound);
         return false;
     }
     
-    bool anyResumed = false;
-    for (const auto& process : processes) {
-        if (ResumeProcess(process.processId)) {
-            anyResumed = true;
-        }
-    }
-    
-    return anyResumed;
+    return SuspendResumeProcesses(pids, false, false);
 }
 
 bool ProcessManager::SuspendProcess(DWORD processId) {
-    if (SuspendResumeThreads(processId, true)) {
-        Logger::Log(LogLevel::Info, "Process suspended successfully (PID: %d)", processId);
-        return true;
-    }
-    
-    Logger::Log(LogLevel::Error, "Failed to suspend process (PID: %d), error: %s", 
-                processId, Utils::GetLastErrorString().c_str());
-    return false;
+    return SuspendResumeProcesses(std::vector<DWORD>(1, processId), true, true);
 }
 
 bool ProcessManager::ResumeProcess(DWORD processId) {
-    if (SuspendResumeThreads(processId, false)) {
-        Logger::Log(LogLevel::Info, "Process resumed successfully (PID: %d)", processId);
-        return true;
-    }
-    
-    Logger::Log(LogLevel::Error, "Failed to resume process (PID: %d), error: %s", 
-                processId, Utils::GetLastErrorString().c_str());
-    return false;
+    return SuspendResumeProcesses(std::vector<DWORD>(1, processId), false, true);
+}
+
+bool ProcessManager::SuspendProcesses(const std::vector<DWORD>& processIds) {
+    return SuspendResumeProcesses(processIds, true, true);
+}
+
+bool ProcessManager::ResumeProcesses(const std::vector<DWORD>& processIds) {
+    return SuspendResumeProcesses(processIds, false, true);
 }
 
 bool ProcessManager::TerminateProcess(const WString& processName, UINT exitCode) {
@@ -158,33 +278,49 @@ bool ProcessManager::TerminateProcess(const WString& processName, UINT exitCode)
 }
 
 bool ProcessManager::TerminateProcess(DWORD processId, UINT exitCode) {
+#ifdef _WIN32
     HANDLE hProcess = OpenProcess(PROCESS_TERMINATE, FALSE, processId);
     if (!hProcess) {
-        Logger::Log(LogLevel::Error, "Failed to open process (PID: %d), error: %s", 
+        Logger::Log(LogLevel::Error, "Failed to open process (PID: %d), error: %s",
                     processId, Utils::GetLastErrorString().c_str());
-        SetLastError(GetLastError());
+        SetLastError(::GetLastError());
         return false;
     }
     
     BOOL result = ::TerminateProcess(hProcess, exitCode);
     CloseHandle(hProcess);
+#else
+    // 无法指定退出码，与TerminateProcess一样强制结束
+    BOOL result = kill(static_cast<pid_t>(processId), SIGKILL) == 0;
+    if (!result) {
+        ::SetLastError(errno);
+    }
+#endif
     
     if (result) {
-        Logger::Log(LogLevel::Info, "Process terminated successfully (PID: %d)", processId);
+        // 已终止的进程不应再出现在缓存的快照中
+        m_processTable.Invalidate();
+        Logger::Event("process.terminate").With("pid", processId).With("exitCode", exitCode).With("ok", true);
         return true;
     }
     
-    Logger::Log(LogLevel::Error, "Failed to terminate process (PID: %d), error: %s", 
-                processId, Utils::GetLastErrorString().c_str());
-    SetLastError(GetLastError());
+    Logger::Event(LogLevel::Error, "process.terminate").With("pid", processId).With("ok", false)
+        .With("error", Utils::GetLastErrorString());
+    SetLastError(::GetLastError());
     return false;
 }
 
+void ProcessManager::SetNativeSuspendEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_suspendMutex);
+    m_nativeSuspend = enabled;
+}
+
 bool ProcessManager::IsProcessRunning(const WString& processName) {
     return !FindProcesses(processName).empty();
 }
 
 bool ProcessManager::IsProcessRunning(DWORD processId) {
+#ifdef _WIN32
     HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, processId);
     if (!hProcess) {
         return false;
@@ -195,6 +331,11 @@ bool ProcessManager::IsProcessRunning(DWORD processId) {
     CloseHandle(hProcess);
     
     return result && exitCode == STILL_ACTIVE;
+#else
+    // 僵尸进程已经退出，只是尚未被父进程回收
+    ProcFs::Stat stat;
+    return ProcFs::ReadStat(processId, stat) && stat.state != 'Z' && stat.state != 'X';
+#endif
 }
 
 DWORD ProcessManager::GetProcessId(const WString& processName) {
@@ -214,73 +355,366 @@ std::vector<DWORD> ProcessManager::GetProcessIds(const WString& processName) {
 }
 
 String ProcessManager::GetLastErrorString() const {
-    switch (m_lastError) {
+    switch (t_lastError) {
         case ErrorCode::Success: return "Success";
         case ErrorCode::InvalidParameter: return "Invalid parameter";
         case ErrorCode::AccessDenied: return "Access denied";
         case ErrorCode::ProcessNotFound: return "Process not found";
         case ErrorCode::IPCConnectionFailed: return "IPC connection failed";
+        case ErrorCode::ServerBusy: return "Server busy";
         case ErrorCode::UnknownError: return "Unknown error";
         default: return "Unknown error";
     }
 }
 
 void ProcessManager::SetLastError(ErrorCode error) {
-    m_lastError = error;
+    t_lastError = error;
 }
 
 void ProcessManager::SetLastError(DWORD win32Error) {
     switch (win32Error) {
-        case ERROR_ACCESS_DENIED: m_lastError = ErrorCode::AccessDenied; break;
-        case ERROR_INVALID_PARAMETER: m_lastError = ErrorCode::InvalidParameter; break;
-        case ERROR_PROCESS_NOT_FOUND: m_lastError = ErrorCode::ProcessNotFound; break;
-        default: m_lastError = ErrorCode::UnknownError; break;
+        case ERROR_ACCESS_DENIED: t_lastError = ErrorCode::AccessDenied; break;
+        case ERROR_INVALID_PARAMETER: t_lastError = ErrorCode::InvalidParameter; break;
+        case ERROR_PROCESS_NOT_FOUND: t_lastError = ErrorCode::ProcessNotFound; break;
+#ifndef _WIN32
+        case EPERM: t_lastError = ErrorCode::AccessDenied; break;
+#endif
+        default: t_lastError = ErrorCode::UnknownError; break;
+    }
+}
+
+bool ProcessManager::SuspendResumeProcesses(const std::vector<DWORD>& processIds, bool suspend, bool requireAll) {
+    // 同时只有一个挂起/恢复操作，台账与进程的实际状态保持一致
+    std::lock_guard<std::mutex> lock(m_suspendMutex);
+    m_suspendLedger.PruneExited();
+    
+    // 重复的PID只处理一次
+    std::unordered_set<DWORD> pending(processIds.begin(), processIds.end());
+    std::unordered_set<DWORD> succeeded;
+    const char* event = suspend ? "process.suspend" : "process.resume";
+    
+    // 核实仍处于挂起状态的进程不再重复挂起，避免线程被嵌套挂起；已被其他程序部分恢复的进程
+    // 重新挂起，新的挂起生效后再撤销原记录的挂起，期间线程不会运行。恢复时只撤销台账中记录的挂起
+    std::unordered_set<DWORD> untracked;
+    std::unordered_map<DWORD, SuspendLedger::Record> stale;
+    for (DWORD processId : pending) {
+        if (suspend && m_suspendLedger.Contains(processId)) {
+            if (m_suspendLedger.Verify(processId) == SuspendState::Suspended) {
+                succeeded.insert(processId);
+                Logger::Event(event).With("pid", processId).With("alreadySuspended", true).With("ok", true);
+            } else if (m_suspendLedger.Take(processId, stale[processId])) {
+                untracked.insert(processId);
+            }
+        } else if (!suspend && ResumeTracked(processId)) {
+            succeeded.insert(processId);
+        } else {
+            untracked.insert(processId);
+        }
+    }
+    
+    // 优先整进程挂起，无法打开进程或系统不支持时回退到逐个线程挂起
+    std::unordered_set<DWORD> fallback;
+    for (DWORD processId : untracked) {
+        SuspendLedger::Record record;
+        if (!m_nativeSuspend || !SuspendResumeNative(processId, suspend, record)) {
+            fallback.insert(processId);
+            continue;
+        }
+        
+        succeeded.insert(processId);
+        if (suspend) {
+            record.processId = processId;
+            record.native = true;
+            record.suspendedAt = SuspendLedger::GetTimestamp();
+            m_suspendLedger.Add(record);
+        } else {
+            SuspendLedger::Release(record);
+        }
+        Logger::Event(event).With("pid", processId).With("method", "process").With("ok", true);
+    }
+    
+    // 逐个线程挂起前先打开进程句柄（Linux上读取启动时间），保证PID在记录期间不被复用，也用于判断进程退出；
+    // 无法打开的进程已经退出或无权访问，不挂起其线程，避免留下台账之外的挂起
+    std::unordered_map<DWORD, SuspendLedger::Record> records;
+    if (suspend) {
+        for (auto it = fallback.begin(); it != fallback.end();) {
+            if (!SuspendLedger::Open(*it, records[*it])) {
+                Logger::Event(LogLevel::Error, event).With("pid", *it).With("ok", false)
+                    .With("error", Utils::GetLastErrorString());
+                SetLastError(::GetLastError());
+                records.erase(*it);
+                it = fallback.erase(it);
+                continue;
+            }
+            ++it;
+        }
+    }
+    
+    SuspendResumeThreads(fallback, suspend, succeeded, suspend ? &records : nullptr);
+    
+    for (DWORD processId : fallback) {
+        if (!succeeded.count(processId)) {
+            Logger::Event(LogLevel::Error, event).With("pid", processId).With("ok", false)
+                .With("error", Utils::GetLastErrorString());
+            SetLastError(::GetLastError());
+            continue;
+        }
+        
+        auto it = records.find(processId);
+        if (it != records.end()) {
+            SuspendLedger::Record& record = it->second;
+            record.processId = processId;
+            record.suspendedAt = SuspendLedger::GetTimestamp();
+            Logger::Event(event).With("pid", processId).With("method", "threads")
+                .With("threads", record.threads.size()).With("ok", true);
+            m_suspendLedger.Add(record);
+        } else {
+            Logger::Event(event).With("pid", processId).With("method", "threads").With("ok", true);
+        }
+    }
+    
+    // 挂起失败的进程不留下句柄
+    for (auto& pair : records) {
+        SuspendLedger::Release(pair.second);
+    }
+    
+    // 重新挂起成功后撤销原记录的挂起，失败时原记录放回台账
+    for (auto& pair : stale) {
+        if (succeeded.count(pair.first)) {
+            bool undo = true;
+#ifndef _WIN32
+            // SIGSTOP不计数，重新以SIGSTOP挂起时与原记录是同一次停止，再发送SIGCONT会撤销新的挂起
+            SuspendInfo info;
+            undo = pair.second.native || (m_suspendLedger.GetInfo(pair.first, info) && info.native);
+#endif
+            if (undo) {
+                ResumeRecord(pair.second);
+            }
+            Logger::Event(event).With("pid", pair.first).With("resuspended", true).With("ok", true);
+            SuspendLedger::Release(pair.second);
+        } else {
+            m_suspendLedger.Add(pair.second);
+        }
+    }
+    
+    return requireAll ? succeeded.size() == pending.size() : !succeeded.empty();
+}
+
+bool ProcessManager::ResumeTracked(DWORD processId) {
+    SuspendLedger::Record record;
+    if (!m_suspendLedger.Take(processId, record)) {
+        return false;
     }
+    
+    bool resumed = ResumeRecord(record);
+    if (resumed) {
+        Logger::Event("process.resume").With("pid", processId).With("method", record.native ? "process" : "threads")
+            .With("suspendedMs", (SuspendLedger::GetTimestamp() - record.suspendedAt) / 10000).With("ok", true);
+    } else {
+        Logger::Event(LogLevel::Error, "process.resume").With("pid", processId).With("ok", false)
+            .With("error", Utils::GetLastErrorString());
+    }
+    
+    SuspendLedger::Release(record);
+    return resumed;
 }
 
-bool ProcessManager::SuspendResumeThreads(DWORD processId, bool suspend) {
+bool ProcessManager::ResumeRecord(const SuspendLedger::Record& record) {
+#ifdef _WIN32
+    // 使用挂起时保存的句柄，每个线程只恢复一次，其他程序施加的挂起保持不变
+    if (record.native) {
+        const NativeProcessControl& control = GetNativeProcessControl();
+        return control.resume(record.process) >= 0;
+    }
+    
+    bool resumed = false;
+    for (const SuspendLedger::ThreadEntry& thread : record.threads) {
+        if (ResumeThread(thread.handle) != static_cast<DWORD>(-1)) {
+            resumed = true;
+        }
+    }
+    return resumed;
+#else
+    // PID已被新进程复用时不发送信号
+    ProcFs::Stat stat;
+    bool exists = ProcFs::ReadStat(record.processId, stat) && stat.startTime == record.startTime;
+    
+    // 冻结cgroup中只有本服务移入的进程，进程已退出时同样解冻并删除该cgroup
+    if (record.native) {
+        if (!ThawCgroup(record.cgroup, record.originalCgroup)) {
+            return false;
+        }
+    } else if (exists) {
+        // 挂起前已被其他程序停止的进程保持停止，与Windows上挂起计数减一后仍大于0一致
+        for (const SuspendLedger::ThreadEntry& thread : record.threads) {
+            if (thread.suspendCount > 1) {
+                return true;
+            }
+        }
+        
+        if (kill(static_cast<pid_t>(record.processId), SIGCONT) != 0) {
+            ::SetLastError(errno);
+            return false;
+        }
+    }
+    
+    if (!exists) {
+        ::SetLastError(ERROR_PROCESS_NOT_FOUND);
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool ProcessManager::SuspendResumeNative(DWORD processId, bool suspend, SuspendLedger::Record& record) {
+#ifdef _WIN32
+    const NativeProcessControl& control = GetNativeProcessControl();
+    if (!control.IsAvailable()) {
+        return false;
+    }
+    
+    // 挂起成功时句柄交给调用方，用于记录到台账
+    // 核实状态时经该句柄遍历进程的线程，需要查询权限
+    HANDLE hProcess = OpenProcess(PROCESS_SUSPEND_RESUME | PROCESS_QUERY_INFORMATION | SYNCHRONIZE, FALSE, processId);
+    if (!hProcess) {
+        return false;
+    }
+    
+    LONG status = suspend ? control.suspend(hProcess) : control.resume(hProcess);
+    if (status < 0) {
+        LOG_DEBUG("Native %s failed for PID %lu, status: 0x%08lX", suspend ? "suspend" : "resume", processId,
+                  static_cast<unsigned long>(status));
+        CloseHandle(hProcess);
+        return false;
+    }
+    record.process = hProcess;
+    return true;
+#else
+    if (suspend) {
+        if (!SuspendLedger::Open(processId, record) ||
+            !FreezeCgroup(processId, record.cgroup, record.originalCgroup)) {
+            LOG_DEBUG("Cgroup freeze unavailable for PID %lu, error: %s", processId,
+                      Utils::GetLastErrorString().c_str());
+            record.cgroup.clear();
+            return false;
+        }
+        return true;
+    }
+    
+    // 不在台账中但仍在本服务创建的冻结cgroup中（服务重启前冻结），解冻后移回上一级cgroup
+    String current;
+    if (!ProcFs::GetCgroupPath(processId, current) || !IsFreezeCgroup(current)) {
+        return false;
+    }
+    return ThawCgroup(current, current.substr(0, current.rfind('/')));
+#endif
+}
+
+bool ProcessManager::SuspendResumeThreads(const std::unordered_set<DWORD>& processIds, bool suspend,
+                                          std::unordered_set<DWORD>& succeeded,
+                                          std::unordered_map<DWORD, SuspendLedger::Record>* records) {
+    if (processIds.empty()) {
+        return true;
+    }
+
+#ifdef _WIN32
+    // 一次遍历系统全部线程，按所属进程是否在集合中筛选
     HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
     if (hSnapshot == INVALID_HANDLE_VALUE) {
         Logger::Log(LogLevel::Error, "Failed to create thread snapshot, error: %s", Utils::GetLastErrorString().c_str());
-        SetLastError(GetLastError());
+        SetLastError(::GetLastError());
         return false;
     }
     
     THREADENTRY32 te32;
     te32.dwSize = sizeof(THREADENTRY32);
     
-    bool success = false;
     if (Thread32First(hSnapshot, &te32)) {
         do {
-            if (te32.th32OwnerProcessID == processId) {
-                HANDLE hThread = OpenThread(THREAD_SUSPEND_RESUME, FALSE, te32.th32ThreadID);
-                if (hThread) {
-                    if (suspend) {
-                        SuspendThread(hThread);
-                    } else {
-                        ResumeThread(hThread);
-                    }
-                    CloseHandle(hThread);
-                    success = true;
-                }
+            if (!processIds.count(te32.th32OwnerProcessID)) {
+                continue;
+            }
+            
+            // 查询权限用于核实挂起状态时读取挂起计数
+            HANDLE hThread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_QUERY_LIMITED_INFORMATION, FALSE, te32.th32ThreadID);
+            if (!hThread) {
+                continue;
+            }
+            
+            // 返回值为操作前的挂起计数，失败时为-1
+            DWORD previous = suspend ? SuspendThread(hThread) : ResumeThread(hThread);
+            if (previous == static_cast<DWORD>(-1)) {
+                CloseHandle(hThread);
+                continue;
+            }
+            succeeded.insert(te32.th32OwnerProcessID);
+            
+            // 挂起时保留线程句柄，恢复时无需再次获取快照
+            if (records) {
+                SuspendLedger::ThreadEntry entry;
+                entry.threadId = te32.th32ThreadID;
+                entry.handle = hThread;
+                entry.suspendCount = previous + 1;
+                (*records)[te32.th32OwnerProcessID].threads.push_back(entry);
+            } else {
+                CloseHandle(hThread);
             }
         } while (Thread32Next(hSnapshot, &te32));
     }
     
     CloseHandle(hSnapshot);
-    return success;
-}
-
-bool ProcessManager::IsValidProcess(const ProcessInfo& process) {
-    // 过滤掉系统进程和无效进程
-    if (process.processId == 0 || process.processId == 4) { // System Idle Process, System
-        return false;
+#else
+    // SIGSTOP和SIGCONT作用于整个线程组，每个进程只发送一次信号，不需要系统范围的线程扫描。
+    // 停止是异步的：先向全部进程发送信号，再逐个读取/proc/<pid>/task等待其线程进入停止状态，
+    // 总等待时间不随进程数叠加
+    std::vector<std::pair<DWORD, bool>> signalled;
+    for (DWORD processId : processIds) {
+        ProcFs::Stat stat;
+        if (!ProcFs::ReadStat(processId, stat) || stat.state == 'Z') {
+            ::SetLastError(ERROR_PROCESS_NOT_FOUND);
+            continue;
+        }
+        
+        // 打开记录后PID已被新进程复用
+        if (records) {
+            auto it = records->find(processId);
+            if (it != records->end() && it->second.startTime != stat.startTime) {
+                ::SetLastError(ERROR_PROCESS_NOT_FOUND);
+                continue;
+            }
+        }
+        
+        if (kill(static_cast<pid_t>(processId), suspend ? SIGSTOP : SIGCONT) != 0) {
+            ::SetLastError(errno);
+            continue;
+        }
+        signalled.emplace_back(processId, stat.state == 'T' || stat.state == 't');
     }
     
-    // 检查进程名是否有效
-    if (process.processName.empty()) {
-        return false;
+    ULONGLONG deadline = GetTickCount64() + kStopTimeoutMs;
+    std::vector<DWORD> threadIds;
+    for (const auto& pair : signalled) {
+        if (!suspend) {
+            succeeded.insert(pair.first);
+            continue;
+        }
+        if (!WaitThreadsStopped(pair.first, deadline, threadIds)) {
+            continue;
+        }
+        succeeded.insert(pair.first);
+        
+        // 挂起前已停止的进程记录挂起计数为2，恢复时保持停止
+        if (records) {
+            std::vector<SuspendLedger::ThreadEntry>& threads = (*records)[pair.first].threads;
+            for (DWORD threadId : threadIds) {
+                SuspendLedger::ThreadEntry entry;
+                entry.threadId = threadId;
+                entry.handle = NULL;
+                entry.suspendCount = pair.second ? 2 : 1;
+                threads.push_back(entry);
+            }
+        }
     }
-    
+#endif
     return true;
 }
\ No newline at end of file
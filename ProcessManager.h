@@ -3,6 +3,9 @@
 #include "Common.h"
 #include "Logger.h"
 #include "Utils.h"
+#include "ProcessTable.h"
+#include "SuspendLedger.h"
+#include <unordered_set>
 
 class ProcessManager {
 public:
@@ -13,7 +16,7 @@ public:
     ProcessManager(const ProcessManager&) = delete;
     ProcessManager& operator=(const ProcessManager&) = delete;
     
-    // 进程查询功能
+    // 进程查询功能，结果来自缓存的进程快照，快照过期后自动重新获取
     std::vector<ProcessInfo> GetProcessList();
     std::vector<ProcessInfo> FindProcesses(const WString& processName);
     ProcessInfo FindProcess(DWORD processId);
@@ -25,23 +28,62 @@ public:
     bool SuspendProcess(DWORD processId);
     bool ResumeProcess(DWORD processId);
     bool TerminateProcess(const WString& processName, UINT exitCode = 0);
+    
+    // 批量挂起/恢复，优先使用整进程挂起，不可用的进程只获取一次线程快照逐个线程处理；
+    // Linux上整进程挂起为cgroup v2冻结，不可用时向每个进程发送一次SIGSTOP/SIGCONT，
+    // 再经/proc/<pid>/task等待其线程停止。全部进程都成功时返回true
+    bool SuspendProcesses(const std::vector<DWORD>& processIds);
+    bool ResumeProcesses(const std::vector<DWORD>& processIds);
+    
+    // 挂起台账：核实仍处于挂起状态的进程不会被重复挂起，已被其他程序部分恢复的进程重新挂起；
+    // 恢复时只撤销本服务施加的挂起。状态通过挂起时保存的句柄读取挂起计数核实，不重新获取线程快照
+    SuspendState GetSuspendState(DWORD processId) const { return m_suspendLedger.Verify(processId); }
+    bool GetSuspendInfo(DWORD processId, SuspendInfo& info) const { return m_suspendLedger.GetInfo(processId, info); }
+    std::vector<SuspendInfo> GetSuspendedProcesses() const { return m_suspendLedger.GetAll(); }
     bool TerminateProcess(DWORD processId, UINT exitCode = 0);
     
+    // 关闭后不再尝试整进程挂起，总是逐个线程挂起（Linux上为SIGSTOP），默认开启
+    void SetNativeSuspendEnabled(bool enabled);
+    
     // 进程信息查询
     bool IsProcessRunning(const WString& processName);
     bool IsProcessRunning(DWORD processId);
     DWORD GetProcessId(const WString& processName);
     std::vector<DWORD> GetProcessIds(const WString& processName);
     
-    // 错误处理
-    ErrorCode GetLastError() const { return m_lastError; }
-    String GetLastErrorString() const;
+    // 进程快照配置，0表示每次查询都重新获取
+    void SetSnapshotMaxAge(DWORD maxAgeMs) { m_processTable.SetMaxAge(maxAgeMs); }
+    bool RefreshProcessList() { return m_processTable.Refresh(); }
+    
+    // 订阅进程启动、退出和线程数变化，变化在每次获取快照时计算，定期调用RefreshProcessList即可持续收到
+    uint32_t SubscribeProcessChanges(ProcessTable::ChangeListener listener) {
+        return m_processTable.AddListener(std::move(listener));
+    }
+    void UnsubscribeProcessChanges(uint32_t subscriptionId) { m_processTable.RemoveListener(subscriptionId); }
     
+    // 错误处理，与Win32的GetLastError一样按线程保存，并发执行的命令互不覆盖
+    ErrorCode GetLastError() const { return t_lastError; }
+    String GetLastErrorString() const;
+
 private:
-    ErrorCode m_lastError;
+    static thread_local ErrorCode t_lastError;
+    
+    ProcessTable m_processTable;
+    std::mutex m_suspendMutex;
+    SuspendLedger m_suspendLedger;
+    bool m_nativeSuspend;
     
     void SetLastError(ErrorCode error);
     void SetLastError(DWORD win32Error);
-    bool SuspendResumeThreads(DWORD processId, bool suspend);
-    bool IsValidProcess(const ProcessInfo& process);
+    // requireAll为false时任一进程成功即返回true
+    bool SuspendResumeProcesses(const std::vector<DWORD>& processIds, bool suspend, bool requireAll);
+    bool ResumeTracked(DWORD processId);
+    bool ResumeRecord(const SuspendLedger::Record& record);
+    // 挂起成功时将进程句柄（Linux上为冻结cgroup）填入record
+    bool SuspendResumeNative(DWORD processId, bool suspend, SuspendLedger::Record& record);
+    
+    // records非空时保留挂起的线程句柄和挂起计数
+    bool SuspendResumeThreads(const std::unordered_set<DWORD>& processIds, bool suspend,
+                              std::unordered_set<DWORD>& succeeded,
+                              std::unordered_map<DWORD, SuspendLedger::Record>* records = nullptr);
 };
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "ProcessTable.h"
+#include "Logger.h"
+#include "Utils.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <tlhelp32.h>
+#else
+#include "ProcFs.h"
+#include <cwctype>
+#endif
+
+ProcessTable::ProcessTable()
+    : m_maxAgeMs(250)
+    , m_valid(false)
+    , m_loaded(false)
+    , m_refreshTick(0)
+    , m_nextListenerId(1) {
+}
+
+void ProcessTable::SetMaxAge(DWORD maxAgeMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxAgeMs = maxAgeMs;
+}
+
+bool ProcessTable::Refresh() {
+    bool result;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        result = Load();
+    }
+    
+    NotifyChanges();
+    return result;
+}
+
+void ProcessTable::SetSnapshotSource(SnapshotSource source) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_source = std::move(source);
+    m_valid = false;
+}
+
+void ProcessTable::Invalidate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_valid = false;
+}
+
+bool ProcessTable::GetAll(std::vector<ProcessInfo>& processes) {
+    bool result;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        result = EnsureFresh();
+        if (result) {
+            processes = m_processes;
+        }
+    }
+    
+    NotifyChanges();
+    return result;
+}
+
+bool ProcessTable::Find(DWORD processId, ProcessInfo& process, bool& found) {
+    bool result;
+    found = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        result = EnsureFresh();
+        auto it = m_byId.find(processId);
+        if (result && it != m_byId.end()) {
+            process = m_processes[it->second];
+            found = true;
+        }
+    }
+    
+    NotifyChanges();
+    return result;
+}
+
+bool ProcessTable::FindByName(const WString& processName, std::vector<ProcessInfo>& processes) {
+    WString key = FoldName(processName);
+    bool result;
+    processes.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        result = EnsureFresh();
+        auto it = m_byName.find(key);
+        if (result && it != m_byName.end()) {
+            processes.reserve(it->second.size());
+            for (size_t index : it->second) {
+                processes.push_back(m_processes[index]);
+            }
+        }
+    }
+    
+    NotifyChanges();
+    return result;
+}
+
+uint32_t ProcessTable::AddListener(ChangeListener listener) {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    uint32_t listenerId = m_nextListenerId++;
+    m_listeners.emplace_back(listenerId, std::move(listener));
+    return listenerId;
+}
+
+void ProcessTable::RemoveListener(uint32_t listenerId) {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    for (auto it = m_listeners.begin(); it != m_listeners.end(); ++it) {
+        if (it->first == listenerId) {
+            m_listeners.erase(it);
+            break;
+        }
+    }
+}
+
+WString ProcessTable::FoldName(const WString& processName) {
+    WString folded(processName);
+#ifdef _WIN32
+    // 不带LCMAP_LINGUISTIC_CASING时按文件系统规则映射，与序数比较相同，不受区域设置影响
+    if (!folded.empty()) {
+        LCMapStringEx(LOCALE_NAME_INVARIANT, LCMAP_UPPERCASE, processName.c_str(), static_cast<int>(processName.length()),
+                      &folded[0], static_cast<int>(folded.length()), NULL, NULL, 0);
+    }
+#else
+    for (wchar_t& ch : folded) {
+        ch = static_cast<wchar_t>(towupper(ch));
+    }
+#endif
+    return folded;
+}
+
+bool ProcessTable::EnsureFresh() {
+    if (m_valid && m_maxAgeMs > 0 && GetTickCount64() - m_refreshTick < m_maxAgeMs) {
+        return true;
+    }
+    return Load();
+}
+
+bool ProcessTable::Load() {
+    std::vector<ProcessInfo> processes;
+    bool loaded = m_source ? m_source(processes) : ReadSnapshot(processes, m_processes.size());
+    if (!loaded) {
+        return false;
+    }
+    
+    // 过滤掉系统进程和无效进程
+    processes.erase(std::remove_if(processes.begin(), processes.end(),
+                                   [](const ProcessInfo& process) { return !IsValidProcess(process); }),
+                    processes.end());
+    
+    // 首次快照没有可比较的基准
+    if (m_loaded) {
+        Diff(processes);
+    }
+    
+    m_processes.swap(processes);
+    m_byId.clear();
+    m_byId.reserve(m_processes.size());
+    m_byName.clear();
+    for (size_t i = 0; i < m_processes.size(); ++i) {
+        m_byId[m_processes[i].processId] = i;
+        m_byName[FoldName(m_processes[i].processName)].push_back(i);
+    }
+    
+    m_valid = true;
+    m_loaded = true;
+    m_refreshTick = GetTickCount64();
+    LOG_DEBUG("Process table refreshed, %zu processes", m_processes.size());
+    return true;
+}
+
+bool ProcessTable::ReadSnapshot(std::vector<ProcessInfo>& processes, size_t expectedCount) {
+    // 按上一次的进程数预留空间，避免逐个插入时反复扩容
+    processes.reserve(expectedCount + 64);
+
+#ifdef _WIN32
+    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (hSnapshot == INVALID_HANDLE_VALUE) {
+        // 写日志可能覆盖错误码，调用方仍需取得原因
+        DWORD error = ::GetLastError();
+        Logger::Log(LogLevel::Error, "Failed to create process snapshot, error: %s", Utils::GetLastErrorString().c_str());
+        ::SetLastError(error);
+        return false;
+    }
+    
+    PROCESSENTRY32W pe32;
+    pe32.dwSize = sizeof(PROCESSENTRY32W);
+    
+    if (Process32FirstW(hSnapshot, &pe32)) {
+        do {
+            ProcessInfo info;
+            info.processId = pe32.th32ProcessID;
+            info.processName = pe32.szExeFile;
+            info.threadCount = pe32.cntThreads;
+            info.parentProcessId = pe32.th32ParentProcessID;
+            
+            // 快照不含创建时间，需要打开进程查询；受保护的进程无法打开时记为未知
+            HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pe32.th32ProcessID);
+            if (process) {
+                FILETIME creationTime, exitTime, kernelTime, userTime;
+                if (GetProcessTimes(process, &creationTime, &exitTime, &kernelTime, &userTime)) {
+                    info.startTime = (static_cast<uint64_t>(creationTime.dwHighDateTime) << 32) |
+                        creationTime.dwLowDateTime;
+                }
+                CloseHandle(process);
+            }
+            processes.push_back(std::move(info));
+        } while (Process32NextW(hSnapshot, &pe32));
+    }
+    
+    CloseHandle(hSnapshot);
+#else
+    std::vector<DWORD> processIds;
+    if (!ProcFs::ListProcesses(processIds)) {
+        DWORD error = ::GetLastError();
+        Logger::Log(LogLevel::Error, "Failed to read /proc, error: %s", Utils::GetLastErrorString().c_str());
+        ::SetLastError(error);
+        return false;
+    }
+    
+    // 列出目录后退出的进程读取失败，直接跳过
+    ProcFs::Stat stat;
+    for (DWORD processId : processIds) {
+        if (!ProcFs::ReadStat(processId, stat)) {
+            continue;
+        }
+        
+        ProcessInfo info;
+        info.processId = stat.processId;
+        info.processName = Utils::StringToWString(stat.name);
+        info.threadCount = stat.threadCount;
+        info.parentProcessId = stat.parentProcessId;
+        info.startTime = stat.startTime;
+        processes.push_back(std::move(info));
+    }
+#endif
+    return true;
+}
+
+void ProcessTable::Diff(const std::vector<ProcessInfo>& processes) {
+    // 以上一次快照的PID索引逐个比对，记录仍然存在的进程在上一次快照中的位置，
+    // 上一次快照中未被匹配的即已退出
+    const size_t kNotFound = static_cast<size_t>(-1);
+    std::vector<size_t> previousIndex(processes.size(), kNotFound);
+    std::vector<bool> seen(m_processes.size(), false);
+    for (size_t i = 0; i < processes.size(); ++i) {
+        auto it = m_byId.find(processes[i].processId);
+        if (it == m_byId.end()) {
+            continue;
+        }
+        
+        // PID被新进程复用时按旧进程退出、新进程启动处理。同名程序由同一父进程重新启动时
+        // 只有启动时间不同；任一方启动时间未知时退回比较名称和父进程
+        const ProcessInfo& previous = m_processes[it->second];
+        const ProcessInfo& current = processes[i];
+        if (previous.processName != current.processName || previous.parentProcessId != current.parentProcessId ||
+            (previous.startTime != 0 && current.startTime != 0 && previous.startTime != current.startTime)) {
+            continue;
+        }
+        
+        previousIndex[i] = it->second;
+        seen[it->second] = true;
+    }
+    
+    // 先报告退出再报告启动，PID被复用时监听者先看到旧进程退出
+    for (size_t i = 0; i < m_processes.size(); ++i) {
+        if (!seen[i]) {
+            m_pendingChanges.emplace_back(ProcessChangeType::Exited, m_processes[i]);
+        }
+    }
+    
+    for (size_t i = 0; i < processes.size(); ++i) {
+        const ProcessInfo& process = processes[i];
+        if (previousIndex[i] == kNotFound) {
+            m_pendingChanges.emplace_back(ProcessChangeType::Started, process);
+            continue;
+        }
+        
+        const ProcessInfo& previous = m_processes[previousIndex[i]];
+        if (previous.threadCount != process.threadCount) {
+            ProcessChange change(ProcessChangeType::ThreadCountChanged, process);
+            change.previousThreadCount = previous.threadCount;
+            m_pendingChanges.push_back(std::move(change));
+        }
+    }
+}
+
+void ProcessTable::NotifyChanges() {
+    std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
+    
+    std::vector<ProcessChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        changes.swap(m_pendingChanges);
+    }
+    
+    if (changes.empty()) {
+        return;
+    }
+    
+    LOG_DEBUG("Process table changed, %zu changes", changes.size());
+    for (auto& listener : m_listeners) {
+        listener.second(changes);
+    }
+}
+
+bool ProcessTable::IsValidProcess(const ProcessInfo& process) {
+#ifdef _WIN32
+    if (process.processId == 0 || process.processId == 4) { // System Idle Process, System
+        return false;
+    }
+#else
+    if (process.processId == 0) {
+        return false;
+    }
+#endif
+    
+    // 检查进程名是否有效
+    if (process.processName.empty()) {
+        return false;
+    }
+    
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Common.h"
+#include <unordered_map>
+
+enum class ProcessChangeType {
+    Started = 0,
+    Exited = 1,
+    ThreadCountChanged = 2
+};
+
+// 相邻两次快照之间的进程变化，Exited时process为上一次快照中的信息；
+// 同一批变化中退出总是排在启动之前，PID被复用时旧进程的退出先于新进程的启动
+struct ProcessChange {
+    ProcessChangeType type;
+    ProcessInfo process;
+    DWORD previousThreadCount;  // 仅ThreadCountChanged时有效
+    
+    ProcessChange() : type(ProcessChangeType::Started), previousThreadCount(0) {}
+    ProcessChange(ProcessChangeType changeType, const ProcessInfo& info)
+        : type(changeType), process(info), previousThreadCount(0) {}
+};
+
+// 进程快照缓存：按PID和忽略大小写的进程名建立哈希索引，
+// 快照超过最大时长后由下一次查询重新获取，也可以主动刷新或使其失效。
+// 每次获取快照时与上一次快照比较，变化按顺序通知给监听者。
+// Windows上快照来自ToolHelp，Linux上扫描/proc
+class ProcessTable {
+public:
+    using ChangeListener = std::function<void(const std::vector<ProcessChange>& changes)>;
+    using SnapshotSource = std::function<bool(std::vector<ProcessInfo>& processes)>;
+    
+    ProcessTable();
+    
+    // 禁用拷贝构造和赋值
+    ProcessTable(const ProcessTable&) = delete;
+    ProcessTable& operator=(const ProcessTable&) = delete;
+    
+    // 0表示每次查询都重新获取快照
+    void SetMaxAge(DWORD maxAgeMs);
+    DWORD GetMaxAge() const { return m_maxAgeMs; }
+    
+    // 立即重新获取快照，失败时保留原有内容并返回false
+    bool Refresh();
+    
+    // 进程创建或退出后调用，下一次查询重新获取快照
+    void Invalidate();
+    
+    // 查询前按需刷新；获取快照失败时返回false，调用方可通过GetLastError取得原因
+    bool GetAll(std::vector<ProcessInfo>& processes);
+    bool Find(DWORD processId, ProcessInfo& process, bool& found);
+    bool FindByName(const WString& processName, std::vector<ProcessInfo>& processes);
+    
+    // 监听者在触发刷新的线程上调用，回调中不能再访问本对象；首次获取的快照不产生变化
+    uint32_t AddListener(ChangeListener listener);
+    void RemoveListener(uint32_t listenerId);
+    
+    // 以自定义的来源代替系统快照，用于测试和基准测试；为空时恢复系统快照
+    void SetSnapshotSource(SnapshotSource source);
+    
+    // 进程名索引和查询唯一使用的大小写折叠，规则与CompareStringOrdinal忽略大小写一致：
+    // Windows上为LCMapStringEx的文件系统大写映射，Linux上逐字符towupper
+    static WString FoldName(const WString& processName);
+
+private:
+    mutable std::mutex m_mutex;
+    DWORD m_maxAgeMs;
+    bool m_valid;
+    bool m_loaded;
+    ULONGLONG m_refreshTick;
+    std::vector<ProcessInfo> m_processes;
+    std::unordered_map<DWORD, size_t> m_byId;
+    std::unordered_map<WString, std::vector<size_t>> m_byName;
+    std::vector<ProcessChange> m_pendingChanges;  // 尚未通知的变化
+    SnapshotSource m_source;
+    
+    // 通知期间持有，保证各次刷新的变化按顺序送达
+    std::mutex m_listenerMutex;
+    std::vector<std::pair<uint32_t, ChangeListener>> m_listeners;
+    uint32_t m_nextListenerId;
+    
+    // 以下方法均在持有m_mutex时调用
+    bool EnsureFresh();
+    bool Load();
+    static bool ReadSnapshot(std::vector<ProcessInfo>& processes, size_t expectedCount);
+    void Diff(const std::vector<ProcessInfo>& processes);
+    static bool IsValidProcess(const ProcessInfo& process);
+    
+    // 在锁外调用
+    void NotifyChanges();
+};
\ No newline at end of file
@@ -1,14 +1,14 @@
 #include "ServiceManager.h"
 
+thread_local ErrorCode ServiceManager::t_lastError = ErrorCode::Success;
+
 ServiceManager::ServiceManager(const WString& serviceName)
     : m_serviceName(serviceName)
-    , m_scManager(NULL)
-    , m_service(NULL)
-    , m_lastError(ErrorCode::Success) {
+    , m_scManager(NULL) {
     
     m_scManager = OpenSCManagerW(NULL, NULL, SC_MANAGER_ALL_ACCESS);
     if (!m_scManager) {
-        DWORD error = GetLastError();
+        DWORD error = ::GetLastError();
         Logger::Log(LogLevel::Error, "Failed to open service control manager, error: %d", error);
         SetLastError(error);
         
@@ -19,7 +19,6 @@ ServiceManager::ServiceManager(const WString& serviceName)
 }
 
 ServiceManager::~ServiceManager() {
-    CloseService();
     if (m_scManager) {
         CloseServiceHandle(m_scManager);
     }
@@ -38,7 +37,7 @@ bool ServiceManager::InstallService(const WString& displayName, const WString& d
         return true;
     }
     
-    m_service = CreateServiceW(
+    SC_HANDLE service = CreateServiceW(
         m_scManager,
         m_serviceName.c_str(),
         displayName.c_str(),
@@ -50,8 +49,8 @@ bool ServiceManager::InstallService(const WString& displayName, const WString& d
         NULL, NULL, NULL, NULL, NULL
     );
     
-    if (!m_service) {
-        DWORD error = GetLastError();
+    if (!service) {
+        DWORD error = ::GetLastError();
         Logger::Log(LogLevel::Error, "Failed to create service, error: %d", error);
         SetLastError(error);
         
@@ -80,50 +79,52 @@ bool ServiceManager::InstallService(const WString& displayName, const WString& d
     
     // 设置服务描述
     SERVICE_DESCRIPTIONW sd = { const_cast<LPWSTR>(description.c_str()) };
-    ChangeServiceConfig2W(m_service, SERVICE_CONFIG_DESCRIPTION, &sd);
+    ChangeServiceConfig2W(service, SERVICE_CONFIG_DESCRIPTION, &sd);
     
     Logger::Log(LogLevel::Info, "Service installed successfully: %s", Utils::WStringToString(m_serviceName).c_str());
-    CloseService();
+    CloseServiceHandle(service);
     return true;
 }
 
 bool ServiceManager::UninstallService() {
-    if (!OpenService()) {
+    SC_HANDLE service = OpenService();
+    if (!service) {
         Logger::Log(LogLevel::Info, "Service not found: %s", Utils::WStringToString(m_serviceName).c_str());
         return true; // 服务不存在，认为卸载成功
     }
     
     // 停止服务
     SERVICE_STATUS status;
-    if (ControlService(m_service, SERVICE_CONTROL_STOP, &status)) {
+    if (ControlService(service, SERVICE_CONTROL_STOP, &status)) {
         Logger::Log(LogLevel::Info, "Stopping service...");
         Sleep(1000); // 等待服务停止
     }
     
-    if (!DeleteService(m_service)) {
-        DWORD error = GetLastError();
+    if (!DeleteService(service)) {
+        DWORD error = ::GetLastError();
         Logger::Log(LogLevel::Error, "Failed to delete service, error: %d", error);
         SetLastError(error);
-        CloseService();
+        CloseServiceHandle(service);
         return false;
     }
     
     Logger::Log(LogLevel::Info, "Service uninstalled successfully: %s", Utils::WStringToString(m_serviceName).c_str());
-    CloseService();
+    CloseServiceHandle(service);
     return true;
 }
 
 bool ServiceManager::StartService() {
-    if (!OpenService()) {
+    SC_HANDLE service = OpenService();
+    if (!service) {
         SetLastError(ErrorCode::ServiceNotFound);
         return false;
     }
     
-    if (!::StartServiceW(m_service, 0, NULL)) {
-        DWORD error = GetLastError();
+    if (!::StartServiceW(service, 0, NULL)) {
+        DWORD error = ::GetLastError();
         Logger::Log(LogLevel::Error, "Failed to start service, error: %d", error);
         SetLastError(error);
-        CloseService();
+        CloseServiceHandle(service);
         
         if (error == ERROR_SERVICE_ALREADY_RUNNING) {
             Logger::Log(LogLevel::Info, "Service is already running: %s", Utils::WStringToString(m_serviceName).c_str());
@@ -133,27 +134,28 @@ bool ServiceManager::StartService() {
     }
     
     Logger::Log(LogLevel::Info, "Service started successfully: %s", Utils::WStringToString(m_serviceName).c_str());
-    CloseService();
+    CloseServiceHandle(service);
     return true;
 }
 
 bool ServiceManager::StopService() {
-    if (!OpenService()) {
+    SC_HANDLE service = OpenService();
+    if (!service) {
         SetLastError(ErrorCode::ServiceNotFound);
         return false;
     }
     
     SERVICE_STATUS status;
-    if (!ControlService(m_service, SERVICE_CONTROL_STOP, &status)) {
-        DWORD error = GetLastError();
+    if (!ControlService(service, SERVICE_CONTROL_STOP, &status)) {
+        DWORD error = ::GetLastError();
         Logger::Log(LogLevel::Error, "Failed to stop service, error: %d", error);
         SetLastError(error);
-        CloseService();
+        CloseServiceHandle(service);
         return false;
     }
     
     Logger::Log(LogLevel::Info, "Service stopped successfully: %s", Utils::WStringToString(m_serviceName).c_str());
-    CloseService();
+    CloseServiceHandle(service);
     return true;
 }
 
@@ -167,45 +169,54 @@ bool ServiceManager::RestartService() {
     return StartService();
 }
 
-bool ServiceManager::QueryStatus() {
-    if (!OpenService()) {
+bool ServiceManager::QueryStatus(ServiceState& state) {
+    SC_HANDLE service = OpenService();
+    if (!service) {
         SetLastError(ErrorCode::ServiceNotFound);
         return false;
     }
     
     SERVICE_STATUS status;
-    if (!QueryServiceStatus(m_service, &status)) {
-        DWORD error = GetLastError();
+    if (!QueryServiceStatus(service, &status)) {
+        DWORD error = ::GetLastError();
         Logger::Log(LogLevel::Error, "Failed to query service status, error: %d", error);
         SetLastError(error);
-        CloseService();
+        CloseServiceHandle(service);
         return false;
     }
     
-    Logger::Log(LogLevel::Info, "Service status: %s", GetServiceStateString().c_str());
-    CloseService();
+    state = ToServiceState(status.dwCurrentState);
+    Logger::Log(LogLevel::Info, "Service status: %s", GetServiceStateString(state));
+    CloseServiceHandle(service);
     return true;
 }
 
 bool ServiceManager::IsInstalled() {
-    if (!OpenService()) {
+    SC_HANDLE service = OpenService();
+    if (!service) {
         return false;
     }
-    CloseService();
+    CloseServiceHandle(service);
     return true;
 }
 
 ServiceState ServiceManager::GetServiceState() const {
-    if (!m_service) {
+    SC_HANDLE service = OpenService();
+    if (!service) {
         return ServiceState::Stopped;
     }
     
     SERVICE_STATUS status;
-    if (!QueryServiceStatus(m_service, &status)) {
-        return ServiceState::Stopped;
+    ServiceState state = ServiceState::Stopped;
+    if (QueryServiceStatus(service, &status)) {
+        state = ToServiceState(status.dwCurrentState);
     }
-    
-    switch (status.dwCurrentState) {
+    CloseServiceHandle(service);
+    return state;
+}
+
+ServiceState ServiceManager::ToServiceState(DWORD currentState) {
+    switch (currentState) {
         case SERVICE_STOPPED: return ServiceState::Stopped;
         case SERVICE_START_PENDING: return ServiceState::Starting;
         case SERVICE_RUNNING: return ServiceState::Running;
@@ -215,7 +226,11 @@ ServiceState ServiceManager::GetServiceState() const {
 }
 
 String ServiceManager::GetServiceStateString() const {
-    switch (GetServiceState()) {
+    return GetServiceStateString(GetServiceState());
+}
+
+const char* ServiceManager::GetServiceStateString(ServiceState state) {
+    switch (state) {
         case ServiceState::Stopped: return "Stopped";
         case ServiceState::Starting: return "Starting";
         case ServiceState::Running: return "Running";
@@ -225,43 +240,35 @@ String ServiceManager::GetServiceStateString() const {
 }
 
 String ServiceManager::GetLastErrorString() const {
-    switch (m_lastError) {
+    switch (t_lastError) {
         case ErrorCode::Success: return "Success";
         case ErrorCode::InvalidParameter: return "Invalid parameter";
         case ErrorCode::AccessDenied: return "Access denied";
         case ErrorCode::ServiceNotFound: return "Service not found";
         case ErrorCode::ProcessNotFound: return "Process not found";
         case ErrorCode::IPCConnectionFailed: return "IPC connection failed";
+        case ErrorCode::ServerBusy: return "Server busy";
         case ErrorCode::UnknownError: return "Unknown error";
         default: return "Unknown error";
     }
 }
 
-bool ServiceManager::OpenService() {
-    if (m_service) {
-        CloseServiceHandle(m_service);
-    }
-    
-    m_service = ::OpenServiceW(m_scManager, m_serviceName.c_str(), SERVICE_ALL_ACCESS);
-    return m_service != NULL;
-}
-
-void ServiceManager::CloseService() {
-    if (m_service) {
-        CloseServiceHandle(m_service);
-        m_service = NULL;
+SC_HANDLE ServiceManager::OpenService() const {
+    if (!m_scManager) {
+        return NULL;
     }
+    return ::OpenServiceW(m_scManager, m_serviceName.c_str(), SERVICE_ALL_ACCESS);
 }
 
 void ServiceManager::SetLastError(ErrorCode error) {
-    m_lastError = error;
+    t_lastError = error;
 }
 
 void ServiceManager::SetLastError(DWORD win32Error) {
     switch (win32Error) {
-        case ERROR_ACCESS_DENIED: m_lastError = ErrorCode::AccessDenied; break;
-        case ERROR_SERVICE_DOES_NOT_EXIST: m_lastError = ErrorCode::ServiceNotFound; break;
-        case ERROR_INVALID_PARAMETER: m_lastError = ErrorCode::InvalidParameter; break;
-        default: m_lastError = ErrorCode::UnknownError; break;
+        case ERROR_ACCESS_DENIED: t_lastError = ErrorCode::AccessDenied; break;
+        case ERROR_SERVICE_DOES_NOT_EXIST: t_lastError = ErrorCode::ServiceNotFound; break;
+        case ERROR_INVALID_PARAMETER: t_lastError = ErrorCode::InvalidParameter; break;
+        default: t_lastError = ErrorCode::UnknownError; break;
     }
 }
\ No newline at end of file
@@ -19,26 +19,28 @@ public:
     bool StartService();
     bool StopService();
     bool RestartService();
-    bool QueryStatus();
+    bool QueryStatus(ServiceState& state);
     bool IsInstalled();
     
     // 获取服务信息
     WString GetServiceName() const { return m_serviceName; }
     ServiceState GetServiceState() const;
     String GetServiceStateString() const;
+    static const char* GetServiceStateString(ServiceState state);
     
-    // 错误处理
-    ErrorCode GetLastError() const { return m_lastError; }
+    // 错误处理，与Win32的GetLastError一样按线程保存，并发执行的命令互不覆盖
+    ErrorCode GetLastError() const { return t_lastError; }
     String GetLastErrorString() const;
-    
+
 private:
+    static thread_local ErrorCode t_lastError;
+    
     WString m_serviceName;
     SC_HANDLE m_scManager;
-    SC_HANDLE m_service;
-    ErrorCode m_lastError;
     
-    bool OpenService();
-    void CloseService();
+    // 每次操作单独打开服务句柄，不在并发的命令之间共享
+    SC_HANDLE OpenService() const;
+    static ServiceState ToServiceState(DWORD currentState);
     void SetLastError(ErrorCode error);
     void SetLastError(DWORD win32Error);
 };
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "SuspendLedger.h"
+#include <algorithm>
+
+#ifdef _WIN32
+namespace {
+
+typedef LONG (NTAPI *NtQueryInformationThreadFunc)(HANDLE threadHandle, ULONG informationClass, PVOID information,
+                                                   ULONG informationLength, PULONG returnLength);
+typedef LONG (NTAPI *NtGetNextThreadFunc)(HANDLE processHandle, HANDLE threadHandle, ACCESS_MASK desiredAccess,
+                                          ULONG handleAttributes, ULONG flags, PHANDLE newThreadHandle);
+
+// THREADINFOCLASS中的ThreadSuspendCount，Windows 8.1起可用
+const ULONG kThreadSuspendCount = 35;
+
+// 读取线程挂起计数而不改变线程状态；NtGetNextThread经进程句柄遍历其线程，无需系统线程快照
+struct NativeThreadQuery {
+    NtQueryInformationThreadFunc queryThread;
+    NtGetNextThreadFunc getNextThread;
+    
+    NativeThreadQuery() : queryThread(nullptr), getNextThread(nullptr) {
+        HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+        if (ntdll) {
+            queryThread = reinterpret_cast<NtQueryInformationThreadFunc>(GetProcAddress(ntdll, "NtQueryInformationThread"));
+            getNextThread = reinterpret_cast<NtGetNextThreadFunc>(GetProcAddress(ntdll, "NtGetNextThread"));
+        }
+    }
+};
+
+const NativeThreadQuery& GetNativeThreadQuery() {
+    static const NativeThreadQuery query;
+    return query;
+}
+
+// 线程已退出或系统不支持该信息类时返回false
+bool QuerySuspendCount(HANDLE thread, DWORD& count) {
+    const NativeThreadQuery& query = GetNativeThreadQuery();
+    ULONG value = 0;
+    if (!query.queryThread || query.queryThread(thread, kThreadSuspendCount, &value, sizeof(value), NULL) < 0) {
+        return false;
+    }
+    count = value;
+    return true;
+}
+
+} // namespace
+#else
+#include "Logger.h"
+#include "ProcFs.h"
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+SuspendLedger::SuspendLedger() {
+}
+
+SuspendLedger::~SuspendLedger() {
+    // 只关闭句柄，服务退出后进程保持挂起
+    for (auto& pair : m_records) {
+        Release(pair.second);
+    }
+}
+
+bool SuspendLedger::Contains(DWORD processId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_records.count(processId) != 0;
+}
+
+bool SuspendLedger::Open(DWORD processId, Record& record) {
+    record.processId = processId;
+#ifdef _WIN32
+    record.process = OpenProcess(SYNCHRONIZE, FALSE, processId);
+    return record.process != NULL;
+#else
+    // 僵尸进程已经退出，只是尚未被父进程回收
+    ProcFs::Stat stat;
+    if (!ProcFs::ReadStat(processId, stat) || stat.state == 'Z') {
+        ::SetLastError(ERROR_PROCESS_NOT_FOUND);
+        return false;
+    }
+    record.startTime = stat.startTime;
+    return true;
+#endif
+}
+
+void SuspendLedger::Add(Record& record) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Record& entry = m_records[record.processId];
+    Release(entry);
+    entry = std::move(record);
+    
+    record.process = NULL;
+    record.threads.clear();
+#ifndef _WIN32
+    record.cgroup.clear();
+#endif
+}
+
+bool SuspendLedger::Take(DWORD processId, Record& record) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_records.find(processId);
+    if (it == m_records.end()) {
+        return false;
+    }
+    
+    record = std::move(it->second);
+    m_records.erase(it);
+    return true;
+}
+
+void SuspendLedger::Release(Record& record) {
+#ifdef _WIN32
+    for (ThreadEntry& thread : record.threads) {
+        CloseHandle(thread.handle);
+    }
+    
+    if (record.process) {
+        CloseHandle(record.process);
+        record.process = NULL;
+    }
+#else
+    // 只删除已经为空的冻结cgroup（进程已退出或已移回原cgroup），仍有进程时保持冻结
+    if (!record.cgroup.empty()) {
+        if (rmdir(record.cgroup.c_str()) != 0 && errno != ENOENT) {
+            // 调用方可能随后读取恢复失败的原因，写日志前后保持最后错误不变
+            DWORD error = ::GetLastError();
+            ::SetLastError(errno);
+            Logger::Log(LogLevel::Warning, "Failed to remove cgroup %s, error: %s", record.cgroup.c_str(),
+                        Utils::GetLastErrorString().c_str());
+            ::SetLastError(error);
+        }
+        record.cgroup.clear();
+    }
+#endif
+    record.threads.clear();
+}
+
+void SuspendLedger::PruneExited() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_records.begin();
+    while (it != m_records.end()) {
+        if (HasExited(it->second)) {
+            Release(it->second);
+            it = m_records.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+SuspendState SuspendLedger::Verify(DWORD processId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_records.find(processId);
+    if (it == m_records.end()) {
+        return SuspendState::NotTracked;
+    }
+    
+    const Record& record = it->second;
+    if (HasExited(record)) {
+        return SuspendState::Exited;
+    }
+
+#ifdef _WIN32
+    return record.native ? VerifyProcess(record.process) : VerifyThreads(record.threads);
+#else
+    return record.native ? VerifyFrozen(record) : VerifyStopped(record);
+#endif
+}
+
+#ifdef _WIN32
+SuspendState SuspendLedger::VerifyProcess(HANDLE process) {
+    // 读取进程当前全部线程的挂起计数，包括挂起后由其他进程远程创建的线程
+    const NativeThreadQuery& query = GetNativeThreadQuery();
+    if (!query.getNextThread) {
+        return SuspendState::Suspended;
+    }
+    
+    SuspendState state = SuspendState::Suspended;
+    HANDLE thread = NULL;
+    HANDLE next = NULL;
+    while (query.getNextThread(process, thread, THREAD_QUERY_LIMITED_INFORMATION, 0, 0, &next) >= 0) {
+        if (thread) {
+            CloseHandle(thread);
+        }
+        thread = next;
+        
+        DWORD count;
+        if (QuerySuspendCount(thread, count) && count == 0) {
+            state = SuspendState::PartiallySuspended;
+            break;
+        }
+    }
+    
+    if (thread) {
+        CloseHandle(thread);
+    }
+    return state;
+}
+
+SuspendState SuspendLedger::VerifyThreads(const std::vector<ThreadEntry>& threads) {
+    // 计数为0说明该线程已被其他程序恢复；已退出的线程读取失败，不影响结果
+    for (const ThreadEntry& thread : threads) {
+        DWORD count;
+        if (QuerySuspendCount(thread.handle, count) && count == 0) {
+            return SuspendState::PartiallySuspended;
+        }
+    }
+    return SuspendState::Suspended;
+}
+#else
+SuspendState SuspendLedger::VerifyStopped(const Record& record) {
+    // SIGSTOP和SIGCONT作用于整个进程，读取主线程的状态即可，不需要遍历/proc/<pid>/task；
+    // 不是T（停止）或t（被跟踪时停止）说明已被其他程序以SIGCONT恢复
+    ProcFs::Stat stat;
+    if (!ProcFs::ReadStat(record.processId, stat)) {
+        return SuspendState::Exited;
+    }
+    return stat.state == 'T' || stat.state == 't' ? SuspendState::Suspended : SuspendState::PartiallySuspended;
+}
+
+SuspendState SuspendLedger::VerifyFrozen(const Record& record) {
+    // 冻结完成后cgroup.events中为"frozen 1"，其中的全部线程都已停止；
+    // cgroup被其他程序解冻或进程被移出该cgroup说明已被恢复
+    String events;
+    String current;
+    if (!ProcFs::ReadFile(record.cgroup + "/cgroup.events", events) || events.find("frozen 1") == String::npos ||
+        !ProcFs::GetCgroupPath(record.processId, current) || current != record.cgroup) {
+        return SuspendState::PartiallySuspended;
+    }
+    return SuspendState::Suspended;
+}
+#endif
+
+bool SuspendLedger::GetInfo(DWORD processId, SuspendInfo& info) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_records.find(processId);
+    if (it == m_records.end()) {
+        return false;
+    }
+    
+    FillInfo(it->second, info);
+    return true;
+}
+
+std::vector<SuspendInfo> SuspendLedger::GetAll() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<SuspendInfo> result(m_records.size());
+    size_t index = 0;
+    for (const auto& pair : m_records) {
+        FillInfo(pair.second, result[index++]);
+    }
+    return result;
+}
+
+uint64_t SuspendLedger::GetTimestamp() {
+    FILETIME fileTime;
+    GetSystemTimeAsFileTime(&fileTime);
+    return (static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+}
+
+bool SuspendLedger::HasExited(const Record& record) {
+#ifdef _WIN32
+    return record.process && WaitForSingleObject(record.process, 0) == WAIT_OBJECT_0;
+#else
+    // 启动时间不同说明PID已被新进程复用
+    ProcFs::Stat stat;
+    return !ProcFs::ReadStat(record.processId, stat) || stat.startTime != record.startTime || stat.state == 'Z';
+#endif
+}
+
+void SuspendLedger::FillInfo(const Record& record, SuspendInfo& info) {
+    info.processId = record.processId;
+    info.native = record.native;
+    info.suspendedAt = record.suspendedAt;
+    info.threadCount = record.threads.size();
+    info.maxSuspendCount = record.native ? 1 : 0;
+    for (const ThreadEntry& thread : record.threads) {
+        info.maxSuspendCount = std::max(info.maxSuspendCount, thread.suspendCount);
+    }
+}
\ No newline at end of file
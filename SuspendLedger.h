@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Common.h"
+#include <unordered_map>
+
+// 由SuspendLedger核实的进程挂起状态
+enum class SuspendState {
+    NotTracked = 0,          // 未经本服务挂起
+    Suspended = 1,
+    PartiallySuspended = 2,  // 部分线程已被其他程序恢复
+    Exited = 3
+};
+
+// 挂起记录的摘要，供状态查询使用
+struct SuspendInfo {
+    DWORD processId;
+    bool native;             // 整进程挂起，否则为逐个线程挂起
+    uint64_t suspendedAt;    // FILETIME（UTC）
+    size_t threadCount;      // 逐个线程挂起时记录的线程数
+    DWORD maxSuspendCount;   // 挂起后线程的最大挂起计数，大于1表示此前已被其他程序挂起
+    
+    SuspendInfo() : processId(0), native(false), suspendedAt(0), threadCount(0), maxSuspendCount(0) {}
+};
+
+// 已挂起进程的台账：保存挂起时打开的进程和线程句柄及挂起计数，
+// 恢复时只撤销本服务施加的挂起，核实状态时无需重新获取线程快照。
+// 每条记录都持有进程句柄，句柄未关闭前PID不会被系统复用。
+// Linux上没有进程句柄，以PID加/proc中的启动时间标识进程；以SIGSTOP挂起的进程读取/proc/<pid>/stat核实，
+// 以cgroup冻结的进程读取冻结cgroup的cgroup.events核实
+class SuspendLedger {
+public:
+    struct ThreadEntry {
+        DWORD threadId;
+        HANDLE handle;       // 需要THREAD_SUSPEND_RESUME和THREAD_QUERY_LIMITED_INFORMATION权限，Linux上为NULL
+        DWORD suspendCount;  // SuspendThread之后的挂起计数；Linux上挂起前已被停止时为2，否则为1
+    };
+    
+    struct Record {
+        DWORD processId;
+        HANDLE process;      // Windows上不能为空；整进程挂起时用于恢复和遍历线程，同时用于判断进程是否已退出
+        bool native;
+        uint64_t suspendedAt;
+        std::vector<ThreadEntry> threads;
+#ifndef _WIN32
+        uint64_t startTime;  // 与PID一起标识进程，PID被复用后不会误操作新进程
+        String cgroup;       // 整进程冻结时进程所在的冻结cgroup目录
+        String originalCgroup; // 冻结前所在的cgroup目录，恢复时移回
+#endif
+
+#ifdef _WIN32
+        Record() : processId(0), process(NULL), native(false), suspendedAt(0) {}
+#else
+        Record() : processId(0), process(NULL), native(false), suspendedAt(0), startTime(0) {}
+#endif
+    };
+    
+    SuspendLedger();
+    ~SuspendLedger();
+    
+    // 禁用拷贝构造和赋值
+    SuspendLedger(const SuspendLedger&) = delete;
+    SuspendLedger& operator=(const SuspendLedger&) = delete;
+    
+    bool Contains(DWORD processId) const;
+    
+    // 为逐个线程挂起准备记录：Windows上打开用于判断退出的进程句柄，Linux上读取启动时间。
+    // 进程已退出或无权访问时返回false并设置最后错误
+    static bool Open(DWORD processId, Record& record);
+    
+    // 接管记录中的句柄，Windows上record.process不能为空
+    void Add(Record& record);
+    
+    // 取出记录，调用方恢复后以Release关闭句柄
+    bool Take(DWORD processId, Record& record);
+    static void Release(Record& record);
+    
+    // 丢弃已退出进程的记录，避免PID被复用后误判为已挂起
+    void PruneExited();
+    
+    // 读取线程的挂起计数核实状态，不挂起或恢复任何线程；
+    // 系统不支持查询挂起计数时（Windows 8.1以前）沿用台账中的记录
+    SuspendState Verify(DWORD processId) const;
+    bool GetInfo(DWORD processId, SuspendInfo& info) const;
+    std::vector<SuspendInfo> GetAll() const;
+    
+    static uint64_t GetTimestamp();
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<DWORD, Record> m_records;
+    
+    static bool HasExited(const Record& record);
+#ifdef _WIN32
+    static SuspendState VerifyProcess(HANDLE process);
+    static SuspendState VerifyThreads(const std::vector<ThreadEntry>& threads);
+#else
+    static SuspendState VerifyStopped(const Record& record);
+    static SuspendState VerifyFrozen(const Record& record);
+#endif
+    static void FillInfo(const Record& record, SuspendInfo& info);
+};
\ No newline at end of file
@@ -2,6 +2,10 @@
 #include <locale>
 #include <codecvt>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 WString Utils::StringToWString(const String& str) {
     if (str.empty()) return WString();
     
@@ -27,7 +31,8 @@ String Utils::WStringToString(const WString& str) {
 String Utils::GetLastErrorString() {
     DWORD error = GetLastError();
     if (error == 0) return "No error";
-    
+
+#ifdef _WIN32
     LPSTR messageBuffer = nullptr;
     size_t size = FormatMessageA(
         FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
@@ -38,9 +43,14 @@ String Utils::GetLastErrorString() {
     LocalFree(messageBuffer);
     
     return message;
+#else
+    // 非Windows平台上错误码即errno
+    return strerror(static_cast<int>(error));
+#endif
 }
 
 bool Utils::IsRunningAsAdmin() {
+#ifdef _WIN32
     BOOL isAdmin = FALSE;
     PSID adminGroup = NULL;
     
@@ -53,12 +63,23 @@ bool Utils::IsRunningAsAdmin() {
     }
     
     return isAdmin == TRUE;
+#else
+    return geteuid() == 0;
+#endif
 }
 
 String Utils::GetModulePath() {
     char path[MAX_PATH];
+#ifdef _WIN32
     if (GetModuleFileNameA(NULL, path, MAX_PATH) == 0) {
         return String();
     }
     return String(path);
+#else
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0) {
+        return String();
+    }
+    return String(path, static_cast<size_t>(length));
+#endif
 }
\ No newline at end of file
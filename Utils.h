@@ -1,12 +1,3 @@
 #pragma once
 
-#include "Common.h"
-
-class Utils {
-public:
-    static WString StringToWString(const String& str);
-    static String WStringToString(const WString& str);
-    static String GetLastErrorString();
-    static bool IsRunningAsAdmin();
-    static String GetModulePath();
-};
\ No newline at end of file
+#include "Common.h"
\ No newline at end of file
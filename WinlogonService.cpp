@@ -3,13 +3,13 @@
 // 静态成员定义
 WinlogonService* WinlogonService::s_instance = nullptr;
 std::mutex WinlogonService::s_instanceMutex;
+thread_local ErrorCode WinlogonService::t_lastError = ErrorCode::Success;
 
 WinlogonService::WinlogonService()
     : m_serviceStatusHandle(NULL)
     , m_serviceStopEvent(INVALID_HANDLE_VALUE)
     , m_isRunningAsService(false)
-    , m_winlogonSuspended(false)
-    , m_lastError(ErrorCode::Success) {
+    , m_processSubscription(0) {
     
     // 初始化服务状态
     m_serviceStatus.dwServiceType = SERVICE_WIN32_OWN_PROCESS;
@@ -46,9 +46,15 @@ int WinlogonService::Run(int argc, char* argv[]) {
     }
     
     // 检查是否作为服务运行
-    if (argc > 1 && strcmp(argv[1], "--service") == 0) {
+    if (m_currentCommand == "--service") {
         Logger::Log(LogLevel::Info, "Starting as Windows service...");
         
+        // 服务模式下使用异步日志，避免IPC线程阻塞在磁盘写入上；
+        // 崩溃日志保留尚未写出的记录，供异常退出后用logrecover查看
+        Logger::SetCrashLog(true, Utils::GetModulePath() + ".crashlog");
+        Logger::SetAsyncMode(true);
+        OpenBinaryLog();
+        
         SERVICE_TABLE_ENTRYW serviceTable[] = {
             { (LPWSTR)L"WinlogonManagerService", ServiceMain },
             { NULL, NULL }
@@ -56,8 +62,12 @@ int WinlogonService::Run(int argc, char* argv[]) {
         
         if (!StartServiceCtrlDispatcherW(serviceTable)) {
             Logger::Log(LogLevel::Error, "Failed to start service control dispatcher, error: %s", Utils::GetLastErrorString().c_str());
+            BinaryLogger::Close();
+            Logger::Shutdown();
             return 1;
         }
+        BinaryLogger::Close();
+        Logger::Shutdown();
         return 0;
     }
     else {
@@ -69,10 +79,12 @@ int WinlogonService::Run(int argc, char* argv[]) {
         }
         
         // 启动IPC服务器
-        if (!m_ipcManager->StartServer([this](const String& cmd) {
-            return this->HandleIPCCommand(cmd);
+        OpenBinaryLog();
+        if (!m_ipcManager->StartServer([this](const IPCRequest& request) {
+            return this->HandleIPCRequest(request);
         })) {
             Logger::Log(LogLevel::Error, "Failed to start IPC server");
+            BinaryLogger::Close();
             return 1;
         }
         
@@ -81,57 +93,86 @@ int WinlogonService::Run(int argc, char* argv[]) {
         std::cin.get();
         
         m_ipcManager->StopServer();
+        BinaryLogger::Close();
         return 0;
     }
 }
 
 bool WinlogonService::ParseCommandLine(int argc, char* argv[]) {
-    if (argc > 1) {
-        m_currentCommand = argv[1];
-        return true;
+    // --binary-log [路径] 可出现在任意位置，省略路径时写到程序旁的.blog文件；
+    // 其余第一个参数作为命令
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--binary-log") == 0) {
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+                m_binaryLogPath = argv[++i];
+            } else {
+                m_binaryLogPath = Utils::GetModulePath() + ".blog";
+            }
+        } else if (m_currentCommand.empty()) {
+            m_currentCommand = argv[i];
+        }
+    }
+    return !m_currentCommand.empty();
+}
+
+void WinlogonService::OpenBinaryLog() {
+    if (m_binaryLogPath.empty()) {
+        return;
+    }
+    
+    // 打开失败时LOG_BINARY回退到文本日志，不影响服务运行
+    if (BinaryLogger::Open(m_binaryLogPath)) {
+        Logger::Log(LogLevel::Info, "Binary log enabled: %s", m_binaryLogPath.c_str());
     }
-    return false;
 }
 
 bool WinlogonService::HandleCommand(const String& command) {
     Logger::Log(LogLevel::Info, "Handling command: %s", command.c_str());
     
-    if (command == "--install") {
-        return InstallService();
-    }
-    else if (command == "--uninstall") {
-        return UninstallService();
-    }
-    else if (command == "--start") {
-        return StartService();
-    }
-    else if (command == "--stop") {
-        return StopService();
-    }
-    else if (command == "--restart") {
-        return RestartService();
-    }
-    else if (command == "--status") {
-        return QueryServiceStatus();
-    }
-    else if (command == "--suspend") {
-        return SuspendWinlogon();
-    }
-    else if (command == "--resume") {
-        return ResumeWinlogon();
-    }
-    else if (command == "--winlogon-status") {
-        return QueryWinlogonStatus();
-    }
-    else if (command == "--help") {
-        ShowHelp();
-        return true;
-    }
-    else {
+    IPCRequest request;
+    if (!IPCProtocol::ParseTextCommand(command, request)) {
         Logger::Log(LogLevel::Warning, "Unknown command: %s", command.c_str());
         ShowHelp();
         return false;
     }
+    
+    return Execute(request).IsOk();
+}
+
+IPCResult WinlogonService::Execute(const IPCRequest& request) {
+    SetLastError(ErrorCode::Success);
+    
+    // 状态查询把查询到的状态作为结果消息返回
+    String status;
+    bool result = false;
+    switch (request.opcode) {
+        case IPCOpcode::InstallService: result = InstallService(); break;
+        case IPCOpcode::UninstallService: result = UninstallService(); break;
+        case IPCOpcode::StartService: result = StartService(); break;
+        case IPCOpcode::StopService: result = StopService(); break;
+        case IPCOpcode::RestartService: result = RestartService(); break;
+        case IPCOpcode::QueryServiceStatus: result = QueryServiceStatus(status); break;
+        case IPCOpcode::SuspendWinlogon: result = SuspendWinlogon(); break;
+        case IPCOpcode::ResumeWinlogon: result = ResumeWinlogon(); break;
+        case IPCOpcode::QueryWinlogonStatus: result = QueryWinlogonStatus(status); break;
+        case IPCOpcode::Help: ShowHelp(); result = true; break;
+        case IPCOpcode::SuspendProcess: result = SuspendProcess(request); break;
+        case IPCOpcode::ResumeProcess: result = ResumeProcess(request); break;
+        case IPCOpcode::TerminateProcess: result = TerminateProcess(request); break;
+        default:
+            Logger::Log(LogLevel::Warning, "Unknown opcode: %u", static_cast<unsigned>(request.opcode));
+            return IPCResult(IPCStatus::UnknownOpcode, ErrorCode::InvalidParameter, "Unknown opcode");
+    }
+    
+    String name = IPCProtocol::GetOpcodeName(request.opcode);
+    if (result) {
+        PublishCommandEvent(request);
+        return IPCResult(IPCStatus::Ok, ErrorCode::Success, status.empty() ? name + " succeeded" : status);
+    }
+    
+    // 错误码属于当前线程，同时执行的其他命令不会覆盖
+    ErrorCode error = t_lastError != ErrorCode::Success ? t_lastError : ErrorCode::UnknownError;
+    return IPCResult(IPCStatus::Failed, error, name + " failed");
 }
 
 void WinlogonService::ShowHelp() {
@@ -147,6 +188,8 @@ void WinlogonService::ShowHelp() {
     std::cout << "  --resume          Resume winlogon process" << std::endl;
     std::cout << "  --winlogon-status Query winlogon process status" << std::endl;
     std::cout << "  --help            Show this help message" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --binary-log [path]  Write hot-path logs in binary form (decode with logdecode)" << std::endl;
 }
 
 bool WinlogonService::InstallService() {
@@ -154,6 +197,9 @@ bool WinlogonService::InstallService() {
     
     WString modulePath = Utils::StringToWString(Utils::GetModulePath());
     WString servicePath = modulePath + L" --service";
+    if (!m_binaryLogPath.empty()) {
+        servicePath += L" --binary-log \"" + Utils::StringToWString(m_binaryLogPath) + L"\"";
+    }
     
     bool result = m_serviceManager->InstallService(
         L"Winlogon Manager Service",
@@ -165,6 +211,7 @@ bool WinlogonService::InstallService() {
         Logger::Log(LogLevel::Info, "Service installed successfully");
     } else {
         Logger::Log(LogLevel::Error, "Failed to install service: %s", m_serviceManager->GetLastErrorString().c_str());
+        SetLastError(m_serviceManager->GetLastError());
     }
     
     return result;
@@ -179,6 +226,7 @@ bool WinlogonService::UninstallService() {
         Logger::Log(LogLevel::Info, "Service uninstalled successfully");
     } else {
         Logger::Log(LogLevel::Error, "Failed to uninstall service: %s", m_serviceManager->GetLastErrorString().c_str());
+        SetLastError(m_serviceManager->GetLastError());
     }
     
     return result;
@@ -193,6 +241,7 @@ bool WinlogonService::StartService() {
         Logger::Log(LogLevel::Info, "Service started successfully");
     } else {
         Logger::Log(LogLevel::Error, "Failed to start service: %s", m_serviceManager->GetLastErrorString().c_str());
+        SetLastError(m_serviceManager->GetLastError());
     }
     
     return result;
@@ -207,6 +256,7 @@ bool WinlogonService::StopService() {
         Logger::Log(LogLevel::Info, "Service stopped successfully");
     } else {
         Logger::Log(LogLevel::Error, "Failed to stop service: %s", m_serviceManager->GetLastErrorString().c_str());
+        SetLastError(m_serviceManager->GetLastError());
     }
     
     return result;
@@ -221,20 +271,24 @@ bool WinlogonService::RestartService() {
         Logger::Log(LogLevel::Info, "Service restarted successfully");
     } else {
         Logger::Log(LogLevel::Error, "Failed to restart service: %s", m_serviceManager->GetLastErrorString().c_str());
+        SetLastError(m_serviceManager->GetLastError());
     }
     
     return result;
 }
 
-bool WinlogonService::QueryServiceStatus() {
+bool WinlogonService::QueryServiceStatus(String& status) {
     Logger::Log(LogLevel::Info, "Querying service status...");
     
-    bool result = m_serviceManager->QueryStatus();
+    ServiceState state;
+    bool result = m_serviceManager->QueryStatus(state);
     
     if (result) {
-        Logger::Log(LogLevel::Info, "Service status: %s", m_serviceManager->GetServiceStateString().c_str());
+        status = String("Service status: ") + ServiceManager::GetServiceStateString(state);
+        Logger::Log(LogLevel::Info, "%s", status.c_str());
     } else {
         Logger::Log(LogLevel::Error, "Failed to query service status: %s", m_serviceManager->GetLastErrorString().c_str());
+        SetLastError(m_serviceManager->GetLastError());
     }
     
     return result;
@@ -252,10 +306,10 @@ bool WinlogonService::SuspendWinlogon() {
     bool result = m_processManager->SuspendProcess(L"winlogon.exe");
     
     if (result) {
-        m_winlogonSuspended = true;
         Logger::Log(LogLevel::Info, "Winlogon process suspended successfully");
     } else {
         Logger::Log(LogLevel::Error, "Failed to suspend winlogon process: %s", m_processManager->GetLastErrorString().c_str());
+        SetLastError(m_processManager->GetLastError());
     }
     
     return result;
@@ -273,42 +327,115 @@ bool WinlogonService::ResumeWinlogon() {
     bool result = m_processManager->ResumeProcess(L"winlogon.exe");
     
     if (result) {
-        m_winlogonSuspended = false;
         Logger::Log(LogLevel::Info, "Winlogon process resumed successfully");
     } else {
         Logger::Log(LogLevel::Error, "Failed to resume winlogon process: %s", m_processManager->GetLastErrorString().c_str());
+        SetLastError(m_processManager->GetLastError());
     }
     
     return result;
 }
 
-bool WinlogonService::QueryWinlogonStatus() {
+bool WinlogonService::QueryWinlogonStatus(String& status) {
     Logger::Log(LogLevel::Info, "Querying winlogon process status...");
     
-    bool isRunning = m_processManager->IsProcessRunning(L"winlogon.exe");
+    std::vector<DWORD> pids = m_processManager->GetProcessIds(L"winlogon.exe");
+    
+    if (pids.empty()) {
+        status = "Winlogon process is not running";
+        Logger::Log(LogLevel::Warning, "%s", status.c_str());
+        return true;
+    }
     
-    if (isRunning) {
-        Logger::Log(LogLevel::Info, "Winlogon process is running");
-        if (m_winlogonSuspended) {
-            Logger::Log(LogLevel::Info, "Winlogon process is suspended");
-        } else {
-            Logger::Log(LogLevel::Info, "Winlogon process is active");
+    // 每个会话各有一个winlogon进程，挂起状态按台账逐个核实，每个进程一行
+    Logger::Log(LogLevel::Info, "Winlogon process is running");
+    char line[256];
+    for (DWORD pid : pids) {
+        SuspendInfo info;
+        switch (m_processManager->GetSuspendState(pid)) {
+            case SuspendState::Suspended:
+                m_processManager->GetSuspendInfo(pid, info);
+                snprintf(line, sizeof(line), "Winlogon process (PID: %lu) is suspended for %llu ms, suspend count: %lu",
+                         pid, static_cast<unsigned long long>((SuspendLedger::GetTimestamp() - info.suspendedAt) / 10000),
+                         info.maxSuspendCount);
+                Logger::Log(LogLevel::Info, "%s", line);
+                break;
+            case SuspendState::PartiallySuspended:
+                snprintf(line, sizeof(line), "Winlogon process (PID: %lu) is partially suspended, some threads were resumed externally", pid);
+                Logger::Log(LogLevel::Warning, "%s", line);
+                break;
+            default:
+                snprintf(line, sizeof(line), "Winlogon process (PID: %lu) is active", pid);
+                Logger::Log(LogLevel::Info, "%s", line);
+                break;
         }
-    } else {
-        Logger::Log(LogLevel::Warning, "Winlogon process is not running");
+        
+        if (!status.empty()) {
+            status += "\n";
+        }
+        status += line;
     }
     
     return true;
 }
 
+bool WinlogonService::SuspendProcess(const IPCRequest& request) {
+    if (!Utils::IsRunningAsAdmin()) {
+        Logger::Log(LogLevel::Error, "Administrator privileges required to suspend process");
+        SetLastError(ErrorCode::AccessDenied);
+        return false;
+    }
+    
+    bool result = request.processId != 0
+        ? m_processManager->SuspendProcess(request.processId)
+        : m_processManager->SuspendProcess(request.processName);
+    if (!result) {
+        SetLastError(m_processManager->GetLastError());
+    }
+    return result;
+}
+
+bool WinlogonService::ResumeProcess(const IPCRequest& request) {
+    if (!Utils::IsRunningAsAdmin()) {
+        Logger::Log(LogLevel::Error, "Administrator privileges required to resume process");
+        SetLastError(ErrorCode::AccessDenied);
+        return false;
+    }
+    
+    bool result = request.processId != 0
+        ? m_processManager->ResumeProcess(request.processId)
+        : m_processManager->ResumeProcess(request.processName);
+    if (!result) {
+        SetLastError(m_processManager->GetLastError());
+    }
+    return result;
+}
+
+bool WinlogonService::TerminateProcess(const IPCRequest& request) {
+    if (!Utils::IsRunningAsAdmin()) {
+        Logger::Log(LogLevel::Error, "Administrator privileges required to terminate process");
+        SetLastError(ErrorCode::AccessDenied);
+        return false;
+    }
+    
+    bool result = request.processId != 0
+        ? m_processManager->TerminateProcess(request.processId, request.exitCode)
+        : m_processManager->TerminateProcess(request.processName, request.exitCode);
+    if (!result) {
+        SetLastError(m_processManager->GetLastError());
+    }
+    return result;
+}
+
 String WinlogonService::GetLastErrorString() const {
-    switch (m_lastError) {
+    switch (t_lastError) {
         case ErrorCode::Success: return "Success";
         case ErrorCode::InvalidParameter: return "Invalid parameter";
         case ErrorCode::AccessDenied: return "Access denied";
         case ErrorCode::ServiceNotFound: return "Service not found";
         case ErrorCode::ProcessNotFound: return "Process not found";
         case ErrorCode::IPCConnectionFailed: return "IPC connection failed";
+        case ErrorCode::ServerBusy: return "Server busy";
         case ErrorCode::UnknownError: return "Unknown error";
         default: return "Unknown error";
     }
@@ -344,12 +471,19 @@ void WINAPI WinlogonService::ServiceMain(DWORD argc, LPTSTR* argv) {
     }
     
     // 启动IPC服务器
-    if (!s_instance->m_ipcManager->StartServer([s_instance](const String& cmd) {
-        return s_instance->HandleIPCCommand(cmd);
+    if (!s_instance->m_ipcManager->StartServer([s_instance](const IPCRequest& request) {
+        return s_instance->HandleIPCRequest(request);
     })) {
         Logger::Log(LogLevel::Warning, "Failed to start IPC server, but service will continue running");
     }
     
+    // 工作线程定期刷新进程快照，启动和退出的进程作为事件推送给订阅者
+    s_instance->m_processSubscription = s_instance->m_processManager->SubscribeProcessChanges(
+        [](const std::vector<ProcessChange>& changes) {
+            s_instance->PublishProcessChanges(changes);
+        });
+    s_instance->m_processManager->RefreshProcessList();
+    
     // 设置服务运行状态
     s_instance->UpdateServiceStatus(SERVICE_RUNNING);
     s_instance->m_isRunningAsService = true;
@@ -386,8 +520,8 @@ void WINAPI WinlogonService::ServiceCtrlHandler(DWORD dwCtrl) {
     }
 }
 
-bool WinlogonService::HandleIPCCommand(const String& command) {
-    return HandleCommand(command);
+IPCResult WinlogonService::HandleIPCRequest(const IPCRequest& request) {
+    return Execute(request);
 }
 
 void WinlogonService::InitializeService() {
@@ -397,6 +531,11 @@ void WinlogonService::InitializeService() {
 void WinlogonService::CleanupService() {
     Logger::Log(LogLevel::Info, "Cleaning up service...");
     
+    if (m_processSubscription != 0) {
+        m_processManager->UnsubscribeProcessChanges(m_processSubscription);
+        m_processSubscription = 0;
+    }
+    
     if (m_ipcManager) {
         m_ipcManager->StopServer();
     }
@@ -418,24 +557,24 @@ void WinlogonService::ServiceWorkerThread() {
             break;
         }
         
-        // 这里可以添加定期检查的任务
-        // 例如：检查系统状态、处理请求等
+        // 与上一次快照比较，产生进程启动和退出事件
+        m_processManager->RefreshProcessList();
     }
     
     Logger::Log(LogLevel::Info, "Service worker thread stopped");
 }
 
 void WinlogonService::SetLastError(ErrorCode error) {
-    m_lastError = error;
+    t_lastError = error;
 }
 
 void WinlogonService::SetLastError(DWORD win32Error) {
     switch (win32Error) {
-        case ERROR_ACCESS_DENIED: m_lastError = ErrorCode::AccessDenied; break;
-        case ERROR_INVALID_PARAMETER: m_lastError = ErrorCode::InvalidParameter; break;
-        case ERROR_SERVICE_DOES_NOT_EXIST: m_lastError = ErrorCode::ServiceNotFound; break;
-        case ERROR_PROCESS_NOT_FOUND: m_lastError = ErrorCode::ProcessNotFound; break;
-        default: m_lastError = ErrorCode::UnknownError; break;
+        case ERROR_ACCESS_DENIED: t_lastError = ErrorCode::AccessDenied; break;
+        case ERROR_INVALID_PARAMETER: t_lastError = ErrorCode::InvalidParameter; break;
+        case ERROR_SERVICE_DOES_NOT_EXIST: t_lastError = ErrorCode::ServiceNotFound; break;
+        case ERROR_PROCESS_NOT_FOUND: t_lastError = ErrorCode::ProcessNotFound; break;
+        default: t_lastError = ErrorCode::UnknownError; break;
     }
 }
 
@@ -450,4 +589,77 @@ void WinlogonService::UpdateServiceStatus(DWORD currentState, DWORD waitHint) {
     }
     
     SetServiceStatus(m_serviceStatusHandle, &m_serviceStatus);
+    
+    IPCEvent event(IPCEventType::ServiceStateChanged);
+    event.state = currentState;
+    event.name = L"WinlogonManagerService";
+    m_ipcManager->PublishEvent(event);
+}
+
+void WinlogonService::PublishCommandEvent(const IPCRequest& request) {
+    // 将执行成功的命令转换为订阅者可见的状态变化；进程退出由快照比较产生，这里不重复推送
+    IPCEvent event;
+    event.processId = request.processId;
+    event.name = request.processName;
+    
+    switch (request.opcode) {
+        case IPCOpcode::SuspendWinlogon:
+            event.type = IPCEventType::ProcessSuspended;
+            event.name = L"winlogon.exe";
+            break;
+        case IPCOpcode::ResumeWinlogon:
+            event.type = IPCEventType::ProcessResumed;
+            event.name = L"winlogon.exe";
+            break;
+        case IPCOpcode::SuspendProcess:
+            event.type = IPCEventType::ProcessSuspended;
+            break;
+        case IPCOpcode::ResumeProcess:
+            event.type = IPCEventType::ProcessResumed;
+            break;
+        case IPCOpcode::StartService:
+        case IPCOpcode::RestartService:
+            event.type = IPCEventType::ServiceStateChanged;
+            event.state = SERVICE_RUNNING;
+            event.name = L"WinlogonManagerService";
+            break;
+        case IPCOpcode::StopService:
+            event.type = IPCEventType::ServiceStateChanged;
+            event.state = SERVICE_STOPPED;
+            event.name = L"WinlogonManagerService";
+            break;
+        default:
+            return;
+    }
+    
+    m_ipcManager->PublishEvent(event);
+}
+
+void WinlogonService::PublishProcessChanges(const std::vector<ProcessChange>& changes) {
+    // 线程数变化只供进程内的监听者使用，不推送给IPC订阅者；
+    // 只有winlogon进程的启动和退出改变缓存的Winlogon状态
+    static const WString winlogonName = ProcessTable::FoldName(L"winlogon.exe");
+    bool winlogonChanged = false;
+    for (const ProcessChange& change : changes) {
+        IPCEvent event;
+        switch (change.type) {
+            case ProcessChangeType::Started:
+                event.type = IPCEventType::ProcessStarted;
+                break;
+            case ProcessChangeType::Exited:
+                event.type = IPCEventType::ProcessExited;
+                break;
+            default:
+                continue;
+        }
+        
+        event.processId = change.process.processId;
+        event.name = change.process.processName;
+        m_ipcManager->PublishEvent(event);
+        winlogonChanged = winlogonChanged || ProcessTable::FoldName(change.process.processName) == winlogonName;
+    }
+    
+    if (winlogonChanged) {
+        m_ipcManager->InvalidateResponseCache();
+    }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "ServiceManager.h"
 #include "ProcessManager.h"
 #include "IPCManager.h"
+#include "BinaryLogger.h"
 #include "Logger.h"
 #include "Utils.h"
 
@@ -20,8 +21,9 @@ public:
     int Run(int argc, char* argv[]);
     bool ParseCommandLine(int argc, char* argv[]);
     
-    // 命令处理
+    // 命令处理，文本命令转换为请求后由Execute统一执行
     bool HandleCommand(const String& command);
+    IPCResult Execute(const IPCRequest& request);
     void ShowHelp();
     
     // 服务管理命令
@@ -30,36 +32,42 @@ public:
     bool StartService();
     bool StopService();
     bool RestartService();
-    bool QueryServiceStatus();
+    bool QueryServiceStatus(String& status);
     
     // Winlogon进程管理命令
     bool SuspendWinlogon();
     bool ResumeWinlogon();
-    bool QueryWinlogonStatus();
+    bool QueryWinlogonStatus(String& status);
     
-    // 错误处理
-    ErrorCode GetLastError() const { return m_lastError; }
-    String GetLastErrorString() const;
+    // 任意进程管理命令，processId为0时按进程名查找
+    bool SuspendProcess(const IPCRequest& request);
+    bool ResumeProcess(const IPCRequest& request);
+    bool TerminateProcess(const IPCRequest& request);
     
+    // 错误处理，错误码按线程保存，IPC命令在线程池中并发执行时互不覆盖
+    ErrorCode GetLastError() const { return t_lastError; }
+    String GetLastErrorString() const;
+
 private:
     static WinlogonService* s_instance;
     static std::mutex s_instanceMutex;
+    static thread_local ErrorCode t_lastError;
     
     // 服务相关
     SERVICE_STATUS m_serviceStatus;
     SERVICE_STATUS_HANDLE m_serviceStatusHandle;
     HANDLE m_serviceStopEvent;
     std::atomic<bool> m_isRunningAsService;
-    std::atomic<bool> m_winlogonSuspended;
+    uint32_t m_processSubscription;
     
     // 管理器
     std::unique_ptr<ServiceManager> m_serviceManager;
     std::unique_ptr<ProcessManager> m_processManager;
     std::unique_ptr<IPCManager> m_ipcManager;
     
-    // 命令和错误
+    // 命令
     String m_currentCommand;
-    ErrorCode m_lastError;
+    String m_binaryLogPath;  // 非空时服务与控制台服务器模式写二进制日志
     
     // 静态服务函数
     static void WINAPI ServiceMain(DWORD argc, LPTSTR* argv);
@@ -67,10 +75,13 @@ private:
     
     // 内部方法
     void InitializeService();
+    void OpenBinaryLog();
     void CleanupService();
     void ServiceWorkerThread();
-    bool HandleIPCCommand(const String& command);
+    IPCResult HandleIPCRequest(const IPCRequest& request);
     void SetLastError(ErrorCode error);
     void SetLastError(DWORD win32Error);
     void UpdateServiceStatus(DWORD currentState, DWORD waitHint = 0);
+    void PublishCommandEvent(const IPCRequest& request);
+    void PublishProcessChanges(const std::vector<ProcessChange>& changes);
 };
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Common.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+// 基准测试公共工具：计时、分位数和多线程同时起跑
+namespace BenchUtil {
+
+inline uint64_t NowNanoseconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// p取0~100，会对样本排序
+inline uint64_t Percentile(std::vector<uint64_t>& samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t index = static_cast<size_t>(p / 100.0 * static_cast<double>(samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+// 所有线程就绪后同时开始执行body(线程序号)，返回从起跑到全部结束的纳秒数
+template <typename Body>
+uint64_t RunThreads(int threadCount, Body body) {
+    std::atomic<int> ready(0);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            ready++;
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            body(t);
+        });
+    }
+    
+    while (ready.load() < threadCount) {
+        std::this_thread::yield();
+    }
+    uint64_t begin = NowNanoseconds();
+    start.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return NowNanoseconds() - begin;
+}
+
+// 第一个命令行参数可覆盖默认的迭代次数，便于快速试跑
+inline int GetIterations(int argc, char* argv[], int defaultValue) {
+    if (argc > 1) {
+        int value = atoi(argv[1]);
+        if (value > 0) {
+            return value;
+        }
+    }
+    return defaultValue;
+}
+
+inline std::filesystem::path GetTempDir(const char* name) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() /
+        (String("wlm_bench_") + name + "_" + std::to_string(GetCurrentProcessId()));
+    std::error_code error;
+    std::filesystem::remove_all(dir, error);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+inline void RemoveTempDir(const std::filesystem::path& dir) {
+    std::error_code error;
+    std::filesystem::remove_all(dir, error);
+}
+
+inline double PerSecond(uint64_t count, uint64_t nanoseconds) {
+    return nanoseconds > 0 ? static_cast<double>(count) * 1e9 / static_cast<double>(nanoseconds) : 0.0;
+}
+
+} // namespace BenchUtil
\ No newline at end of file
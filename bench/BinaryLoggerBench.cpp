@@ -0,0 +1,97 @@
+// 二进制日志与文本日志的单次调用开销对比，参数为热路径上常见的整数、字符串和浮点数。
+// 文本日志分别测量同步写出和异步队列两种模式；每64KB落盘一次时fdatasync占了大部分开销，
+// on-error策略下不会主动落盘，用来单独比较格式化与编码本身的开销
+// 用法: BinaryLoggerBench [每种模式的调用次数]
+
+#include "BenchUtil.h"
+#include "BinaryLogger.h"
+
+namespace {
+
+enum class Mode {
+    TextSync,
+    TextAsync,
+    Binary,
+};
+
+struct Result {
+    uint64_t callNanoseconds;  // 全部调用返回所用时间
+    uint64_t totalNanoseconds; // 包括Flush落盘
+    uintmax_t fileBytes;
+};
+
+Result RunMode(Mode mode, const LogFlushPolicy& policy, int calls, const std::filesystem::path& path) {
+    if (mode == Mode::Binary) {
+        BinaryLogger::Open(path.string(), policy);
+    } else {
+        Logger::SetLogToFile(true, path.string(), policy);
+        if (mode == Mode::TextAsync) {
+            Logger::SetAsyncMode(true, 8192, LogOverflowPolicy::Block, LogQueueMode::Shared);
+        }
+    }
+    
+    const String pipeName = "\\\\.\\pipe\\WinlogonManagerService";
+    Result result;
+    uint64_t start = BenchUtil::NowNanoseconds();
+    for (int n = 0; n < calls; ++n) {
+        LOG_BINARY(LogLevel::Info, "request %d from %s took %.3f ms, status %u", n, pipeName.c_str(), n * 0.25, 200u);
+    }
+    result.callNanoseconds = BenchUtil::NowNanoseconds() - start;
+    
+    if (mode == Mode::Binary) {
+        BinaryLogger::Close();
+    } else {
+        Logger::Flush();
+        Logger::SetAsyncMode(false);
+        Logger::SetLogToFile(false);
+    }
+    result.totalNanoseconds = BenchUtil::NowNanoseconds() - start;
+    
+    std::error_code error;
+    result.fileBytes = std::filesystem::file_size(path, error);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int calls = BenchUtil::GetIterations(argc, argv, 200000);
+    std::filesystem::path dir = BenchUtil::GetTempDir("binlog");
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    
+    const struct {
+        const char* name;
+        Mode mode;
+    } modes[] = {
+        { "text-sync", Mode::TextSync },
+        { "text-async", Mode::TextAsync },
+        { "binary", Mode::Binary },
+    };
+    
+    const struct {
+        const char* name;
+        LogFlushPolicy policy;
+    } policies[] = {
+        { "bytes-64k", LogFlushPolicy::EveryBytes(64 * 1024) },
+        { "on-error", LogFlushPolicy::OnError() },
+    };
+    
+    printf("%-10s %-12s %10s %12s %14s %12s\n", "policy", "mode", "call ns", "total ns", "calls/sec", "bytes/call");
+    for (const auto& policy : policies) {
+        for (const auto& mode : modes) {
+            std::filesystem::path path = dir / (String(policy.name) + "_" + mode.name + ".log");
+            Result result = RunMode(mode.mode, policy.policy, calls, path);
+            printf("%-10s %-12s %10.1f %12.1f %14.0f %12.1f\n", policy.name, mode.name,
+                   static_cast<double>(result.callNanoseconds) / calls,
+                   static_cast<double>(result.totalNanoseconds) / calls,
+                   BenchUtil::PerSecond(calls, result.totalNanoseconds),
+                   static_cast<double>(result.fileBytes) / calls);
+        }
+    }
+    
+    Logger::Shutdown();
+    BenchUtil::RemoveTempDir(dir);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+// 被禁用的日志调用开销：运行时级别为Info时的一条Debug日志，参数需要一次宽字符串转换。
+//   log-call     直接调用Logger::Log，参数照常求值后才在Log内判断级别
+//   runtime-off  LOG_DEBUG，先判断级别，参数不求值
+//   compiled-out WLM_MIN_LOG_LEVEL高于Debug时LOG_DEBUG展开成的WLM_LOG_DISABLED
+// 用法: DisabledLogBench [迭代次数]
+
+#include "BenchUtil.h"
+#include "Logger.h"
+
+namespace {
+
+template <typename Body>
+void Measure(const char* name, int iterations, Body body) {
+    uint64_t start = BenchUtil::NowNanoseconds();
+    for (int n = 0; n < iterations; ++n) {
+        body(n);
+    }
+    uint64_t elapsed = BenchUtil::NowNanoseconds() - start;
+    printf("%-14s %10.2f\n", name, static_cast<double>(elapsed) / iterations);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = BenchUtil::GetIterations(argc, argv, 5000000);
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Info);
+    
+    // 与ProcessManager::FindProcesses中的调用相同的参数形式
+    const WString processName = L"winlogon.exe";
+    
+    printf("%-14s %10s\n", "mode", "ns/call");
+    Measure("log-call", iterations, [&processName](int n) {
+        Logger::Log(LogLevel::Debug, "Found process: %s (PID: %d)", Utils::WStringToString(processName).c_str(), n);
+    });
+    Measure("runtime-off", iterations, [&processName](int n) {
+        LOG_DEBUG("Found process: %s (PID: %d)", Utils::WStringToString(processName).c_str(), n);
+    });
+    Measure("compiled-out", iterations, [&processName](int n) {
+        WLM_LOG_DISABLED(LogLevel::Debug, "Found process: %s (PID: %d)", Utils::WStringToString(processName).c_str(), n);
+    });
+    
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
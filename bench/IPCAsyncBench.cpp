@@ -0,0 +1,84 @@
+// 异步客户端的并发在途请求：单个线程上的一个IPCAsyncClient始终保持N个二进制请求在途，
+// 每完成一个立即在回调中发起下一个，统计不同在途数下的请求速率和p50/p99完成延迟
+// 用法: IPCAsyncBench [每种在途数的请求数]
+
+#include "BenchUtil.h"
+#include "IPCManager.h"
+
+int main(int argc, char* argv[]) {
+    int requests = BenchUtil::GetIterations(argc, argv, 100000);
+    const WString pipeName = L"\\\\.\\pipe\\WlmIpcAsyncBench." + std::to_wstring(GetCurrentProcessId());
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    // 排队上限放宽到最大在途数，避免请求被以Busy拒绝
+    const int inflightCounts[] = { 1, 100, 1000, 10000 };
+    IPCServerConfig config;
+    config.clientRateLimit = IPCRateLimit();
+    config.responseCacheTtlMs = 0;
+    config.maxPendingPerClient = 16384;
+    config.maxQueuedCommands = 16384;
+    
+    IPCManager server;
+    server.SetPipeName(pipeName);
+    server.SetServerConfig(config);
+    if (!server.StartServer([](const IPCRequest&) { return IPCResult(IPCStatus::Ok, ErrorCode::Success); })) {
+        fprintf(stderr, "Failed to start IPC server\n");
+        return 1;
+    }
+    
+    printf("requests per row: %d\n", requests);
+    printf("%10s %14s %10s %10s %8s\n", "in-flight", "requests/sec", "p50 us", "p99 us", "errors");
+    
+    for (int inflight : inflightCounts) {
+        IPCAsyncClient client;
+        if (!client.Connect(pipeName)) {
+            fprintf(stderr, "Failed to connect to IPC server\n");
+            server.StopServer();
+            return 1;
+        }
+        
+        const IPCRequest request(IPCOpcode::QueryServiceStatus);
+        std::vector<uint64_t> samples;
+        samples.reserve(requests);
+        int issued = 0;
+        int finished = 0;
+        int errors = 0;
+        
+        // 回调在事件循环线程上调用，在其中补发请求使在途数保持不变
+        std::function<void()> issue = [&]() {
+            uint64_t start = BenchUtil::NowNanoseconds();
+            issued++;
+            client.CallAsync(request, 30000, [&, start](IPCAsyncStatus status, const IPCResult& result) {
+                finished++;
+                if (status != IPCAsyncStatus::Completed || result.status != IPCStatus::Ok) {
+                    errors++;
+                } else {
+                    samples.push_back(BenchUtil::NowNanoseconds() - start);
+                }
+                if (issued < requests) {
+                    issue();
+                }
+            });
+        };
+        
+        uint64_t begin = BenchUtil::NowNanoseconds();
+        for (int n = 0; n < inflight && issued < requests; ++n) {
+            issue();
+        }
+        while (finished < issued && client.RunOnce(1000)) {
+        }
+        uint64_t elapsed = BenchUtil::NowNanoseconds() - begin;
+        errors += issued - finished;
+        
+        printf("%10d %14.0f %10.1f %10.1f %8d\n", inflight, BenchUtil::PerSecond(samples.size(), elapsed),
+               BenchUtil::Percentile(samples, 50) / 1000.0, BenchUtil::Percentile(samples, 99) / 1000.0, errors);
+        client.Disconnect();
+    }
+    
+    server.StopServer();
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
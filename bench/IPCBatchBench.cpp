@@ -0,0 +1,78 @@
+// IPC批量命令延迟：1~1000条命令作为一个批量请求顺序或并行执行，与每条命令单独建立连接
+// （IPCManager::SendCommand）相比，统计整批完成的p50/p99耗时和折合每条命令的耗时。
+// Linux上经由Unix域套接字，Windows上为命名管道
+// 用法: IPCBatchBench [每种批量大小的重复次数]
+
+#include "BenchUtil.h"
+#include "IPCManager.h"
+
+int main(int argc, char* argv[]) {
+    int rounds = BenchUtil::GetIterations(argc, argv, 50);
+    const WString pipeName = L"\\\\.\\pipe\\WlmIpcBatchBench." + std::to_wstring(GetCurrentProcessId());
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    // 批量请求按命令数计入队列上限，放宽到能容纳最大的批量
+    IPCServerConfig config;
+    config.clientRateLimit = IPCRateLimit();
+    config.maxQueuedCommands = 4096;
+    config.responseCacheTtlMs = 0;
+    
+    IPCManager server;
+    server.SetPipeName(pipeName);
+    server.SetServerConfig(config);
+    if (!server.StartServer([](const IPCRequest&) { return IPCResult(IPCStatus::Ok, ErrorCode::Success, "Running"); })) {
+        fprintf(stderr, "Failed to start IPC server\n");
+        return 1;
+    }
+    
+    IPCManager client;
+    client.SetPipeName(pipeName);
+    
+    printf("rounds per size: %d\n", rounds);
+    printf("%8s %-12s %12s %12s %14s %8s\n", "commands", "mode", "p50 us", "p99 us", "us/command", "errors");
+    
+    const int batchSizes[] = { 1, 10, 100, 1000 };
+    for (int commands : batchSizes) {
+        const std::vector<String> batch(commands, "--help");
+        
+        for (int mode = 0; mode < 3; ++mode) {
+            const char* modeName = mode == 0 ? "per-command" : mode == 1 ? "sequential" : "parallel";
+            std::vector<uint64_t> samples;
+            uint64_t total = 0;
+            int errors = 0;
+            for (int r = 0; r < rounds; ++r) {
+                uint64_t start = BenchUtil::NowNanoseconds();
+                if (mode == 0) {
+                    // 每条命令一次连接
+                    for (const String& command : batch) {
+                        String response;
+                        if (!client.SendCommand(command, response)) {
+                            errors++;
+                        }
+                    }
+                } else {
+                    std::vector<IPCBatchResult> results;
+                    if (!client.SendBatch(batch, results, mode == 1 ? IPCBatchMode::Sequential : IPCBatchMode::Parallel) ||
+                        results.size() != batch.size()) {
+                        errors++;
+                    }
+                }
+                uint64_t elapsed = BenchUtil::NowNanoseconds() - start;
+                samples.push_back(elapsed);
+                total += elapsed;
+            }
+            
+            printf("%8d %-12s %12.1f %12.1f %14.2f %8d\n", commands, modeName,
+                   BenchUtil::Percentile(samples, 50) / 1000.0,
+                   BenchUtil::Percentile(samples, 99) / 1000.0,
+                   static_cast<double>(total) / rounds / commands / 1000.0, errors);
+        }
+    }
+    
+    server.StopServer();
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
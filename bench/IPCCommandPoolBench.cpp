@@ -0,0 +1,118 @@
+// 命令线程池的混合负载：持续提交进程操作（每个约5毫秒）和服务操作（每个50毫秒）使其积压，
+// 同时每毫秒提交一个状态查询，统计查询从提交到执行完成的延迟。与无负载时对比，
+// 并与不分类别、不限并发（全部作为查询提交，先到先执行）的同样负载对比
+// 用法: IPCCommandPoolBench [查询数]
+
+#include "BenchUtil.h"
+#include "IPCCommandPool.h"
+#include "Logger.h"
+#include <future>
+
+namespace {
+
+struct Workload {
+    const char* name;
+    bool load;
+    bool lanes;   // false时控制类任务也作为查询提交，且各类别不限并发
+};
+
+void Spin(uint64_t nanoseconds) {
+    uint64_t start = BenchUtil::NowNanoseconds();
+    while (BenchUtil::NowNanoseconds() - start < nanoseconds) {
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int queries = BenchUtil::GetIterations(argc, argv, 500);
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    // 默认配置的线程数：不少于CPU核数，且受限类别占满时仍有线程处理查询
+    DWORD threadCount = 0;
+    {
+        IPCCommandPool pool;
+        pool.Start(IPCCommandPoolConfig());
+        threadCount = static_cast<DWORD>(pool.GetThreadCount());
+    }
+    
+    printf("queries per row: %d, threads: %lu\n", queries, threadCount);
+    printf("%-22s %12s %12s %12s %14s %14s\n", "workload", "query p50 us", "query p99 us", "query max us",
+           "process tasks", "service tasks");
+    
+    const Workload workloads[] = {
+        { "idle", false, true },
+        { "control load", true, true },
+        { "control load, no lanes", true, false },
+    };
+    for (const Workload& workload : workloads) {
+        IPCCommandPoolConfig config;
+        config.threadCount = threadCount;
+        if (!workload.lanes) {
+            for (DWORD& limit : config.classLimits) {
+                limit = 0;
+            }
+        }
+        IPCCommandPool pool;
+        pool.Start(config);
+        
+        // 保持进程操作和服务操作各有积压，完成一个补充一个
+        std::atomic<bool> running(true);
+        std::atomic<int> pendingProcess(0);
+        std::atomic<int> pendingService(0);
+        std::atomic<int> processDone(0);
+        std::atomic<int> serviceDone(0);
+        IPCCommandClass processClass = workload.lanes ? IPCCommandClass::ProcessControl : IPCCommandClass::Query;
+        IPCCommandClass serviceClass = workload.lanes ? IPCCommandClass::ServiceControl : IPCCommandClass::Query;
+        std::thread feeder([&]() {
+            while (workload.load && running) {
+                while (pendingProcess < 32) {
+                    pendingProcess++;
+                    pool.Submit(processClass, [&]() {
+                        Spin(200000);
+                        Sleep(5);
+                        pendingProcess--;
+                        processDone++;
+                    });
+                }
+                while (pendingService < 8) {
+                    pendingService++;
+                    pool.Submit(serviceClass, [&]() {
+                        Sleep(50);
+                        pendingService--;
+                        serviceDone++;
+                    });
+                }
+                Sleep(1);
+            }
+        });
+        Sleep(workload.load ? 200 : 0);
+        
+        std::vector<uint64_t> latencies;
+        for (int i = 0; i < queries; ++i) {
+            std::promise<uint64_t> finished;
+            std::future<uint64_t> result = finished.get_future();
+            uint64_t start = BenchUtil::NowNanoseconds();
+            pool.Submit(IPCCommandClass::Query, [&finished]() { finished.set_value(BenchUtil::NowNanoseconds()); });
+            latencies.push_back(result.get() - start);
+            Sleep(1);
+        }
+        
+        running = false;
+        feeder.join();
+        int processCount = processDone;
+        int serviceCount = serviceDone;
+        pool.Stop();
+        
+        uint64_t p50 = BenchUtil::Percentile(latencies, 50);
+        uint64_t p99 = BenchUtil::Percentile(latencies, 99);
+        printf("%-22s %12.1f %12.1f %12.1f %14d %14d\n", workload.name, p50 / 1000.0, p99 / 1000.0,
+               latencies.back() / 1000.0, processCount, serviceCount);
+    }
+    
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
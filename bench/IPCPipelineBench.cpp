@@ -0,0 +1,107 @@
+// IPC一次性连接与持久会话对比：每个请求新建连接（IPCManager::SendRequest），
+// 持久会话上同步往返，以及持久会话上一次流水线发出8/64个请求，统计请求速率。
+// Linux上经由Unix域套接字，Windows上为命名管道
+// 用法: IPCPipelineBench [每个客户端的请求数]
+
+#include "BenchUtil.h"
+#include "IPCManager.h"
+
+namespace {
+
+WString g_pipeName;
+
+// 每个请求建立一次连接
+int RunOneShot(int requests) {
+    IPCManager client;
+    client.SetPipeName(g_pipeName);
+    int errors = 0;
+    for (int n = 0; n < requests; ++n) {
+        IPCResult result;
+        if (!client.SendRequest(IPCRequest(IPCOpcode::QueryServiceStatus), result) || !result.IsOk()) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+// 持久会话，每次先发出depth个请求再依次取回响应；depth为1即同步往返
+int RunSession(int requests, int depth) {
+    IPCClient client;
+    if (!client.Connect(g_pipeName)) {
+        return requests;
+    }
+    
+    int errors = 0;
+    IPCRequest request(IPCOpcode::QueryServiceStatus);
+    std::vector<uint32_t> ids;
+    for (int n = 0; n < requests; n += depth) {
+        ids.clear();
+        for (int i = 0; i < depth && n + i < requests; ++i) {
+            uint32_t id;
+            if (client.SendRequest(request, id)) {
+                ids.push_back(id);
+            } else {
+                errors++;
+            }
+        }
+        for (uint32_t id : ids) {
+            IPCResult result;
+            if (!client.ReceiveResult(id, result) || !result.IsOk()) {
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int requests = BenchUtil::GetIterations(argc, argv, 5000);
+    g_pipeName = L"\\\\.\\pipe\\WlmIpcPipelineBench." + std::to_wstring(GetCurrentProcessId());
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    IPCServerConfig config;
+    config.instanceCount = 64;
+    config.clientRateLimit = IPCRateLimit();
+    config.maxPendingPerClient = 256;
+    config.maxQueuedCommands = 4096;
+    config.responseCacheTtlMs = 0;
+    
+    IPCManager server;
+    server.SetPipeName(g_pipeName);
+    server.SetServerConfig(config);
+    if (!server.StartServer([](const IPCRequest&) { return IPCResult(IPCStatus::Ok, ErrorCode::Success, "Running"); })) {
+        fprintf(stderr, "Failed to start IPC server\n");
+        return 1;
+    }
+    
+    printf("requests per client: %d\n", requests);
+    printf("%-14s %8s %14s %8s\n", "mode", "clients", "requests/sec", "errors");
+    
+    struct Mode {
+        const char* name;
+        int depth;  // 0表示一次性连接
+    };
+    const Mode modes[] = { { "one-shot", 0 }, { "session", 1 }, { "pipelined x8", 8 }, { "pipelined x64", 64 } };
+    const int clientCounts[] = { 1, 4, 16 };
+    for (const Mode& mode : modes) {
+        for (int clients : clientCounts) {
+            // 一次性连接较慢，请求数减为十分之一
+            int perClient = mode.depth == 0 ? std::max(1, requests / 10) : requests;
+            std::atomic<int> errors(0);
+            uint64_t elapsed = BenchUtil::RunThreads(clients, [&](int) {
+                errors += mode.depth == 0 ? RunOneShot(perClient) : RunSession(perClient, mode.depth);
+            });
+            printf("%-14s %8d %14.0f %8d\n", mode.name, clients,
+                   BenchUtil::PerSecond(static_cast<uint64_t>(perClient) * clients, elapsed), errors.load());
+        }
+    }
+    
+    server.StopServer();
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+// IPC消息解析与分派开销：不经过传输，在单线程上重复服务器处理一条消息的CPU路径——
+// 帧解析、文本命令映射或二进制解码、调用处理函数、结果编码和分帧，统计每条消息的纳秒数
+// 用法: IPCProtocolBench [每种消息的迭代次数]
+
+#include "BenchUtil.h"
+#include "IPCManager.h"
+
+namespace {
+
+struct Stage {
+    const char* name;
+    std::function<void()> body;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = BenchUtil::GetIterations(argc, argv, 1000000);
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    RequestHandler handler = [](const IPCRequest& request) {
+        return IPCResult(IPCStatus::Ok, ErrorCode::Success, IPCProtocol::GetOpcodeName(request.opcode));
+    };
+    
+    IPCRequest binaryRequest(IPCOpcode::SuspendProcess);
+    binaryRequest.processName = L"winlogon.exe";
+    String binaryPayload;
+    IPCProtocol::EncodeRequest(binaryRequest, binaryPayload);
+    
+    String textFrame;
+    IPCFrame::AppendMessage(textFrame, 1, String("--status"));
+    String binaryFrame;
+    IPCFrame::AppendMessage(binaryFrame, 1, binaryPayload, IPCFrame::MessageBinary);
+    
+    IPCFrameReader reader;
+    uint32_t requestId;
+    uint16_t type;
+    String message;
+    String response;
+    String out;
+    size_t sink = 0;
+    
+    const Stage stages[] = {
+        { "frame parse", [&]() {
+            reader.Append(binaryFrame.c_str(), binaryFrame.length());
+            reader.NextMessage(requestId, type, message);
+            sink += message.length();
+        } },
+        { "text parse", [&]() {
+            IPCRequest request;
+            IPCProtocol::ParseTextCommand("--status", request);
+            sink += static_cast<size_t>(request.opcode);
+        } },
+        { "binary decode", [&]() {
+            IPCRequest request;
+            IPCProtocol::DecodeRequest(binaryPayload, request);
+            sink += request.processName.length();
+        } },
+        { "text dispatch", [&]() {
+            reader.Append(textFrame.c_str(), textFrame.length());
+            reader.NextMessage(requestId, type, message);
+            IPCRequest request;
+            IPCProtocol::ParseTextCommand(message, request);
+            IPCResult result = handler(request);
+            response = (result.IsOk() ? "Command executed successfully: " : "Command execution failed: ") + message;
+            out.clear();
+            IPCFrame::AppendMessage(out, requestId, response, type);
+            sink += out.length();
+        } },
+        { "binary dispatch", [&]() {
+            reader.Append(binaryFrame.c_str(), binaryFrame.length());
+            reader.NextMessage(requestId, type, message);
+            IPCRequest request;
+            IPCResult result;
+            IPCStatus status = IPCProtocol::DecodeRequest(message, request);
+            result = status == IPCStatus::Ok ? handler(request) : IPCResult(status, ErrorCode::InvalidParameter);
+            response.clear();
+            IPCProtocol::EncodeResult(result, response);
+            out.clear();
+            IPCFrame::AppendMessage(out, requestId, response, type);
+            sink += out.length();
+        } }
+    };
+    
+    printf("iterations: %d\n", iterations);
+    printf("%-16s %12s %16s\n", "stage", "ns/message", "messages/sec");
+    for (const Stage& stage : stages) {
+        // 预热后计时
+        for (int i = 0; i < iterations / 10; ++i) {
+            stage.body();
+        }
+        uint64_t start = BenchUtil::NowNanoseconds();
+        for (int i = 0; i < iterations; ++i) {
+            stage.body();
+        }
+        uint64_t elapsed = BenchUtil::NowNanoseconds() - start;
+        printf("%-16s %12.1f %16.0f\n", stage.name, static_cast<double>(elapsed) / iterations,
+               BenchUtil::PerSecond(iterations, elapsed));
+    }
+    
+    Logger::Shutdown();
+    return sink == 0 ? 1 : 0;
+}
\ No newline at end of file
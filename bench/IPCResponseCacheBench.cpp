@@ -0,0 +1,80 @@
+// 状态查询的惊群：1~32个客户端同时不断发送服务状态查询，处理函数模拟约2毫秒的后端查询
+// （如查询服务控制管理器），对比响应缓存关闭和开启（TTL 200毫秒）时的请求速率、
+// 实际后端查询速率和往返延迟。缓存开启时并发的相同查询合并为一次后端查询
+// 用法: IPCResponseCacheBench [每个客户端的请求数]
+
+#include "BenchUtil.h"
+#include "IPCManager.h"
+
+int main(int argc, char* argv[]) {
+    int requests = BenchUtil::GetIterations(argc, argv, 500);
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    printf("requests per client: %d\n", requests);
+    printf("%8s %8s %14s %14s %10s %10s %8s\n", "clients", "cache", "requests/sec", "backend/sec", "p50 us",
+           "p99 us", "errors");
+    
+    const DWORD ttls[] = { 0, 200 };
+    const int clientCounts[] = { 1, 8, 32 };
+    for (int clients : clientCounts) {
+        for (DWORD ttl : ttls) {
+            const WString pipeName = L"\\\\.\\pipe\\WlmIpcResponseCacheBench." +
+                std::to_wstring(GetCurrentProcessId()) + L"." + std::to_wstring(clients) + L"." + std::to_wstring(ttl);
+            IPCServerConfig config;
+            config.instanceCount = 64;
+            config.clientRateLimit = IPCRateLimit();
+            config.responseCacheTtlMs = ttl;
+            
+            std::atomic<uint64_t> backendCalls(0);
+            IPCManager server;
+            server.SetPipeName(pipeName);
+            server.SetServerConfig(config);
+            if (!server.StartServer([&backendCalls](const IPCRequest&) {
+                    backendCalls++;
+                    Sleep(2);
+                    return IPCResult(IPCStatus::Ok, ErrorCode::Success, "Running");
+                })) {
+                fprintf(stderr, "Failed to start IPC server\n");
+                return 1;
+            }
+            
+            std::vector<std::vector<uint64_t>> latencies(clients);
+            std::atomic<int> errors(0);
+            uint64_t elapsed = BenchUtil::RunThreads(clients, [&](int t) {
+                IPCClient client;
+                if (!client.Connect(pipeName)) {
+                    errors += requests;
+                    return;
+                }
+                
+                latencies[t].reserve(requests);
+                IPCRequest request(IPCOpcode::QueryServiceStatus);
+                for (int n = 0; n < requests; ++n) {
+                    uint64_t start = BenchUtil::NowNanoseconds();
+                    IPCResult result;
+                    if (!client.Call(request, result) || !result.IsOk()) {
+                        errors++;
+                        continue;
+                    }
+                    latencies[t].push_back(BenchUtil::NowNanoseconds() - start);
+                }
+            });
+            server.StopServer();
+            
+            std::vector<uint64_t> samples;
+            for (const auto& clientSamples : latencies) {
+                samples.insert(samples.end(), clientSamples.begin(), clientSamples.end());
+            }
+            printf("%8d %8s %14.0f %14.0f %10.1f %10.1f %8d\n", clients, ttl > 0 ? "on" : "off",
+                   BenchUtil::PerSecond(samples.size(), elapsed), BenchUtil::PerSecond(backendCalls.load(), elapsed),
+                   BenchUtil::Percentile(samples, 50) / 1000.0, BenchUtil::Percentile(samples, 99) / 1000.0,
+                   errors.load());
+        }
+    }
+    
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+// IPC服务器负载测试：1~32个客户端各自保持一个会话，同步发送二进制状态查询，
+// 统计总请求速率和单次往返延迟。Linux上为Unix域套接字加epoll，Windows上为命名管道加完成端口
+// 用法: IPCServerBench [每个客户端的请求数]
+
+#include "BenchUtil.h"
+#include "IPCManager.h"
+
+int main(int argc, char* argv[]) {
+    int requests = BenchUtil::GetIterations(argc, argv, 5000);
+    const WString pipeName = L"\\\\.\\pipe\\WlmIpcServerBench." + std::to_wstring(GetCurrentProcessId());
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    // 不限速、不缓存，每个请求都经过命令线程池和处理函数
+    IPCServerConfig config;
+    config.instanceCount = 64;
+    config.clientRateLimit = IPCRateLimit();
+    config.responseCacheTtlMs = 0;
+    
+    IPCManager server;
+    server.SetPipeName(pipeName);
+    server.SetServerConfig(config);
+    if (!server.StartServer([](const IPCRequest&) { return IPCResult(IPCStatus::Ok, ErrorCode::Success, "Running"); })) {
+        fprintf(stderr, "Failed to start IPC server\n");
+        return 1;
+    }
+    
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    printf("CPUs: %lu, requests per client: %d\n", systemInfo.dwNumberOfProcessors, requests);
+    printf("%8s %14s %10s %10s %8s\n", "clients", "requests/sec", "p50 us", "p99 us", "errors");
+    
+    const int clientCounts[] = { 1, 2, 4, 8, 16, 32 };
+    for (int clients : clientCounts) {
+        std::vector<std::vector<uint64_t>> latencies(clients);
+        std::atomic<int> errors(0);
+        
+        uint64_t elapsed = BenchUtil::RunThreads(clients, [&](int t) {
+            IPCClient client;
+            if (!client.Connect(pipeName)) {
+                errors += requests;
+                return;
+            }
+            
+            latencies[t].reserve(requests);
+            IPCRequest request(IPCOpcode::QueryServiceStatus);
+            for (int n = 0; n < requests; ++n) {
+                uint64_t start = BenchUtil::NowNanoseconds();
+                IPCResult result;
+                if (!client.Call(request, result) || !result.IsOk()) {
+                    errors++;
+                    continue;
+                }
+                latencies[t].push_back(BenchUtil::NowNanoseconds() - start);
+            }
+        });
+        
+        std::vector<uint64_t> samples;
+        for (const auto& clientSamples : latencies) {
+            samples.insert(samples.end(), clientSamples.begin(), clientSamples.end());
+        }
+        printf("%8d %14.0f %10.1f %10.1f %8d\n", clients,
+               BenchUtil::PerSecond(samples.size(), elapsed),
+               BenchUtil::Percentile(samples, 50) / 1000.0,
+               BenchUtil::Percentile(samples, 99) / 1000.0,
+               errors.load());
+    }
+    
+    server.StopServer();
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+// 共享内存通道与套接字（Windows上为命名管道）的往返延迟对比：单个会话同步发送二进制状态查询，
+// 分别统计两种传输在不同消息大小下的p50/p99往返时间和请求速率
+// 用法: IPCSharedMemoryBench [每种组合的请求数]
+
+#include "BenchUtil.h"
+#include "IPCManager.h"
+
+int main(int argc, char* argv[]) {
+    int requests = BenchUtil::GetIterations(argc, argv, 20000);
+    const WString pipeName = L"\\\\.\\pipe\\WlmIpcSharedMemoryBench." + std::to_wstring(GetCurrentProcessId());
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    // 结果消息的长度由请求中的processId指定
+    const String payload(64 * 1024, 'x');
+    IPCServerConfig config;
+    config.clientRateLimit = IPCRateLimit();
+    config.responseCacheTtlMs = 0;
+    
+    IPCManager server;
+    server.SetPipeName(pipeName);
+    server.SetServerConfig(config);
+    if (!server.StartServer([&payload](const IPCRequest& request) {
+            return IPCResult(IPCStatus::Ok, ErrorCode::Success, payload.substr(0, request.processId));
+        })) {
+        fprintf(stderr, "Failed to start IPC server\n");
+        return 1;
+    }
+    
+    printf("requests per row: %d\n", requests);
+    printf("%-8s %8s %14s %10s %10s %8s\n", "channel", "size", "requests/sec", "p50 us", "p99 us", "errors");
+    
+    const size_t sizes[] = { 0, 1024, 64 * 1024 };
+    for (int shared = 0; shared < 2; ++shared) {
+        IPCClient client;
+        if (!client.Connect(pipeName) || (shared && !client.EnableSharedMemory())) {
+            fprintf(stderr, "Failed to open %s channel\n", shared ? "shared memory" : "socket");
+            server.StopServer();
+            return 1;
+        }
+        
+        for (size_t size : sizes) {
+            IPCRequest request(IPCOpcode::QueryServiceStatus);
+            request.processId = static_cast<DWORD>(size);
+            std::vector<uint64_t> samples;
+            samples.reserve(requests);
+            int errors = 0;
+            
+            uint64_t begin = BenchUtil::NowNanoseconds();
+            for (int n = 0; n < requests; ++n) {
+                uint64_t start = BenchUtil::NowNanoseconds();
+                IPCResult result;
+                if (!client.Call(request, result) || result.message.length() != size) {
+                    errors++;
+                    continue;
+                }
+                samples.push_back(BenchUtil::NowNanoseconds() - start);
+            }
+            uint64_t elapsed = BenchUtil::NowNanoseconds() - begin;
+            
+            printf("%-8s %8zu %14.0f %10.1f %10.1f %8d\n", shared ? "shm" : "socket", size,
+                   BenchUtil::PerSecond(samples.size(), elapsed),
+                   BenchUtil::Percentile(samples, 50) / 1000.0,
+                   BenchUtil::Percentile(samples, 99) / 1000.0, errors);
+        }
+        client.Disconnect();
+    }
+    
+    server.StopServer();
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
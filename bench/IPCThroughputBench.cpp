@@ -0,0 +1,74 @@
+// IPC吞吐量与消息大小：单个会话同步请求64 B~64 MB的二进制结果，统计每秒传输的字节数和单次往返耗时，
+// 观察分帧、缓冲增长和大消息拷贝的开销。Linux上经由Unix域套接字，Windows上为命名管道
+// 用法: IPCThroughputBench [传输的总字节数(MB)]
+
+#include "BenchUtil.h"
+#include "IPCManager.h"
+
+int main(int argc, char* argv[]) {
+    const size_t totalBytes = static_cast<size_t>(BenchUtil::GetIterations(argc, argv, 512)) * 1024 * 1024;
+    const WString pipeName = L"\\\\.\\pipe\\WlmIpcThroughputBench." + std::to_wstring(GetCurrentProcessId());
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    // 结果消息的长度由请求中的processId指定，预先生成最大的消息避免把构造时间计入传输
+    const size_t kResultOverhead = 11;  // [版本 u8][状态 u16][错误码 u32][消息长度 u32]
+    const String payload(IPCFrame::kMaxMessageBytes - kResultOverhead, 'x');
+    
+    IPCServerConfig config;
+    config.clientRateLimit = IPCRateLimit();
+    config.responseCacheTtlMs = 0;
+    
+    IPCManager server;
+    server.SetPipeName(pipeName);
+    server.SetServerConfig(config);
+    if (!server.StartServer([&payload](const IPCRequest& request) {
+            return IPCResult(IPCStatus::Ok, ErrorCode::Success, payload.substr(0, request.processId));
+        })) {
+        fprintf(stderr, "Failed to start IPC server\n");
+        return 1;
+    }
+    
+    IPCClient client;
+    if (!client.Connect(pipeName)) {
+        fprintf(stderr, "Failed to connect to IPC server\n");
+        server.StopServer();
+        return 1;
+    }
+    
+    printf("total per size: %zu MB\n", totalBytes / (1024 * 1024));
+    printf("%10s %10s %12s %12s %8s\n", "size", "requests", "MB/s", "us/request", "errors");
+    
+    // 64 MB为单条消息的上限，扣除结果的编码开销
+    const size_t sizes[] = { 64, 1024, 4 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024, 4 * 1024 * 1024,
+                             16 * 1024 * 1024, IPCFrame::kMaxMessageBytes };
+    for (size_t size : sizes) {
+        size_t messageSize = size - std::min(size, kResultOverhead);
+        int requests = static_cast<int>(std::max<size_t>(4, std::min<size_t>(totalBytes / size, 100000)));
+        IPCRequest request(IPCOpcode::QueryWinlogonStatus);
+        request.processId = static_cast<DWORD>(messageSize);
+        
+        int errors = 0;
+        uint64_t start = BenchUtil::NowNanoseconds();
+        for (int n = 0; n < requests; ++n) {
+            IPCResult result;
+            if (!client.Call(request, result) || result.message.length() != messageSize) {
+                errors++;
+            }
+        }
+        uint64_t elapsed = BenchUtil::NowNanoseconds() - start;
+        
+        String label = size >= 1024 * 1024 ? std::to_string(size / (1024 * 1024)) + " MB"
+                     : size >= 1024 ? std::to_string(size / 1024) + " KB" : std::to_string(size) + " B";
+        printf("%10s %10d %12.1f %12.1f %8d\n", label.c_str(), requests,
+               BenchUtil::PerSecond(static_cast<uint64_t>(requests) * size, elapsed) / (1024 * 1024),
+               static_cast<double>(elapsed) / requests / 1000.0, errors);
+    }
+    
+    client.Disconnect();
+    server.StopServer();
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+// 落盘策略对比：每种策略在同步和异步模式下的吞吐（lines/sec）与单次调用延迟分位数
+// 用法: LogFlushBench [每种策略的行数]
+
+#include "BenchUtil.h"
+#include "Logger.h"
+
+namespace {
+
+struct Policy {
+    const char* name;
+    LogFlushPolicy policy;
+};
+
+void RunPolicy(const Policy& policy, bool async, int lines, const std::filesystem::path& dir) {
+    std::filesystem::path path = dir / (String(policy.name) + (async ? "_async.log" : "_sync.log"));
+    Logger::SetLogToFile(true, path.string(), policy.policy);
+    if (async) {
+        Logger::SetAsyncMode(true, 8192, LogOverflowPolicy::Block, LogQueueMode::Shared);
+    }
+    
+    std::vector<uint64_t> samples;
+    samples.reserve(lines);
+    uint64_t start = BenchUtil::NowNanoseconds();
+    for (int n = 0; n < lines; ++n) {
+        // 每100行一条Error日志，使OnError策略有落盘的机会
+        LogLevel level = n % 100 == 99 ? LogLevel::Error : LogLevel::Info;
+        uint64_t before = BenchUtil::NowNanoseconds();
+        Logger::Log(level, "flush bench line %d of %d", n, lines);
+        samples.push_back(BenchUtil::NowNanoseconds() - before);
+    }
+    Logger::Flush();
+    uint64_t elapsed = BenchUtil::NowNanoseconds() - start;
+    
+    Logger::SetAsyncMode(false);
+    Logger::SetLogToFile(false);
+    
+    uint64_t p50 = BenchUtil::Percentile(samples, 50);
+    uint64_t p99 = BenchUtil::Percentile(samples, 99);
+    uint64_t p999 = BenchUtil::Percentile(samples, 99.9);
+    printf("%-12s %-6s %12.0f %10llu %10llu %10llu\n", policy.name, async ? "async" : "sync",
+           BenchUtil::PerSecond(lines, elapsed), static_cast<unsigned long long>(p50),
+           static_cast<unsigned long long>(p99), static_cast<unsigned long long>(p999));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int lines = BenchUtil::GetIterations(argc, argv, 20000);
+    std::filesystem::path dir = BenchUtil::GetTempDir("flush");
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    
+    const Policy policies[] = {
+        { "every-line", LogFlushPolicy::EveryLine() },
+        { "bytes-64k", LogFlushPolicy::EveryBytes(64 * 1024) },
+        { "interval-1s", LogFlushPolicy::EveryInterval(1000) },
+        { "on-error", LogFlushPolicy::OnError() },
+    };
+    
+    printf("%-12s %-6s %12s %10s %10s %10s\n", "policy", "mode", "lines/sec", "p50 ns", "p99 ns", "p99.9 ns");
+    for (const Policy& policy : policies) {
+        RunPolicy(policy, false, lines, dir);
+        RunPolicy(policy, true, lines, dir);
+    }
+    
+    Logger::Shutdown();
+    BenchUtil::RemoveTempDir(dir);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+// 多线程日志吞吐：1~32个线程下，原有的单互斥锁同步写出（sync）与异步队列（共享队列、
+// 按线程队列合并写出、按线程分片文件）的扩展性对比。
+// lines/sec包括等待全部落盘，call ns为调用线程平均每次Log的耗时
+// 用法: LoggerThroughputBench [每线程行数]
+
+#include "BenchUtil.h"
+#include "Logger.h"
+
+namespace {
+
+struct Mode {
+    const char* name;
+    bool async;
+    LogQueueMode queueMode;
+    bool sharding;
+};
+
+struct Result {
+    uint64_t callNanoseconds;   // 生产线程全部返回所用时间，即调用方感受到的开销
+    uint64_t totalNanoseconds;  // 包括等待写线程落盘
+};
+
+Result RunMode(const Mode& mode, int threadCount, int linesPerThread, const std::filesystem::path& dir) {
+    std::filesystem::path path = dir / (String(mode.name) + "_" + std::to_string(threadCount) + ".log");
+    Logger::SetLogToFile(true, path.string(), LogFlushPolicy::EveryBytes(64 * 1024));
+    Logger::SetLogSharding(mode.sharding);
+    if (mode.async) {
+        Logger::SetAsyncMode(true, 8192, LogOverflowPolicy::Block, mode.queueMode);
+    }
+    
+    Result result;
+    result.callNanoseconds = BenchUtil::RunThreads(threadCount, [linesPerThread](int t) {
+        for (int n = 0; n < linesPerThread; ++n) {
+            Logger::Log(LogLevel::Info, "bench thread %d line %d value %f", t, n, n * 0.5);
+        }
+    });
+    
+    uint64_t flushStart = BenchUtil::NowNanoseconds();
+    Logger::Flush();
+    result.totalNanoseconds = result.callNanoseconds + BenchUtil::NowNanoseconds() - flushStart;
+    
+    Logger::SetAsyncMode(false);
+    Logger::SetLogSharding(false);
+    Logger::SetLogToFile(false);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int linesPerThread = BenchUtil::GetIterations(argc, argv, 50000);
+    std::filesystem::path dir = BenchUtil::GetTempDir("logger");
+    
+    // 只测量文件输出
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    
+    const Mode modes[] = {
+        { "sync", false, LogQueueMode::Shared, false },
+        { "async-shared", true, LogQueueMode::Shared, false },
+        { "async-perthread", true, LogQueueMode::PerThread, false },
+        { "async-sharded", true, LogQueueMode::PerThread, true },
+    };
+    
+    // 线程数超过CPU数后各模式的差异主要来自调度，结果需结合CPU数解读
+    printf("cpus: %u\n", std::thread::hardware_concurrency());
+    printf("%-16s %8s %14s %12s\n", "mode", "threads", "lines/sec", "call ns");
+    for (int threadCount : { 1, 2, 4, 8, 16, 32 }) {
+        for (const Mode& mode : modes) {
+            Result result = RunMode(mode, threadCount, linesPerThread, dir);
+            uint64_t lines = static_cast<uint64_t>(threadCount) * linesPerThread;
+            printf("%-16s %8d %14.0f %12.1f\n", mode.name, threadCount,
+                   BenchUtil::PerSecond(lines, result.totalNanoseconds),
+                   static_cast<double>(result.callNanoseconds) / linesPerThread);
+        }
+    }
+    
+    Logger::Shutdown();
+    BenchUtil::RemoveTempDir(dir);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+// 进程快照比较的耗时与进程数的关系：以合成快照交替刷新，每次约1%的进程退出、1%启动、1%线程数变化，
+// 比较首次获取（不比较）与后续刷新（线性比较并通知）的耗时，并与按PID两两比较的朴素做法对比；
+// Linux上另外测量真实/proc快照的刷新和比较耗时
+// 用法: ProcessDiffBench [每组刷新次数]
+
+#include "BenchUtil.h"
+#include "Logger.h"
+#include "ProcessTable.h"
+
+namespace {
+
+std::vector<ProcessInfo> MakeSnapshot(DWORD count, DWORD round) {
+    std::vector<ProcessInfo> snapshot;
+    snapshot.reserve(count);
+    for (DWORD i = 0; i < count; ++i) {
+        ProcessInfo info;
+        // 每轮替换1%的进程（新PID），另有1%的线程数随轮次变化
+        info.processId = (i % 100 == 0) ? 1000000 + round * count + i : 8 + i * 4;
+        info.processName = L"process" + std::to_wstring(i % 500) + L".exe";
+        info.threadCount = (i % 100 == 1) ? 4 + round % 2 : 4;
+        info.parentProcessId = 4;
+        snapshot.push_back(std::move(info));
+    }
+    return snapshot;
+}
+
+// 朴素做法：对新快照的每个进程在旧快照中逐个查找
+size_t NaiveDiff(const std::vector<ProcessInfo>& previous, const std::vector<ProcessInfo>& current) {
+    size_t changes = 0;
+    for (const ProcessInfo& process : current) {
+        bool found = false;
+        for (const ProcessInfo& old : previous) {
+            if (old.processId == process.processId) {
+                found = true;
+                changes += old.threadCount != process.threadCount;
+                break;
+            }
+        }
+        changes += !found;
+    }
+    for (const ProcessInfo& old : previous) {
+        bool found = false;
+        for (const ProcessInfo& process : current) {
+            if (old.processId == process.processId) {
+                found = true;
+                break;
+            }
+        }
+        changes += !found;
+    }
+    return changes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int refreshes = BenchUtil::GetIterations(argc, argv, 20);
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    printf("refreshes per row: %d\n", refreshes);
+    printf("%10s %12s %12s %12s %10s %12s %12s\n", "processes", "load us", "refresh us", "diff us",
+           "changes", "ns/process", "naive us");
+    
+    const DWORD counts[] = { 1000, 10000, 50000, 100000 };
+    for (DWORD count : counts) {
+        std::vector<std::vector<ProcessInfo>> rounds;
+        for (DWORD round = 0; round <= static_cast<DWORD>(refreshes); ++round) {
+            rounds.push_back(MakeSnapshot(count, round));
+        }
+        
+        DWORD next = 0;
+        auto source = [&](std::vector<ProcessInfo>& processes) {
+            processes = rounds[next];
+            return true;
+        };
+        
+        // 首次获取只复制快照和建立索引，取多个新表的中位数作为不比较时的基准
+        std::vector<uint64_t> loadSamples;
+        for (int n = 0; n < 5; ++n) {
+            ProcessTable fresh;
+            fresh.SetSnapshotSource(source);
+            uint64_t start = BenchUtil::NowNanoseconds();
+            fresh.Refresh();
+            loadSamples.push_back(BenchUtil::NowNanoseconds() - start);
+        }
+        uint64_t loadNs = BenchUtil::Percentile(loadSamples, 50);
+        
+        ProcessTable table;
+        table.SetSnapshotSource(source);
+        size_t changes = 0;
+        table.AddListener([&changes](const std::vector<ProcessChange>& batch) { changes += batch.size(); });
+        table.Refresh();
+        
+        // 之后每次刷新都与上一次比较
+        uint64_t start = BenchUtil::NowNanoseconds();
+        for (next = 1; next <= static_cast<DWORD>(refreshes); ++next) {
+            table.Refresh();
+        }
+        uint64_t refreshNs = (BenchUtil::NowNanoseconds() - start) / refreshes;
+        uint64_t diffNs = refreshNs > loadNs ? refreshNs - loadNs : 0;
+        
+        // 朴素做法为平方复杂度，只在进程数较少时测量
+        String naive = "-";
+        if (count <= 10000) {
+            start = BenchUtil::NowNanoseconds();
+            size_t naiveChanges = NaiveDiff(rounds[0], rounds[1]);
+            naive = std::to_string((BenchUtil::NowNanoseconds() - start) / 1000);
+            if (naiveChanges != changes / refreshes) {
+                fprintf(stderr, "Naive diff found %zu changes, expected %zu\n", naiveChanges, changes / refreshes);
+            }
+        }
+        
+        printf("%10lu %12.1f %12.1f %12.1f %10zu %12.1f %12s\n", count, loadNs / 1000.0, refreshNs / 1000.0,
+               diffNs / 1000.0, changes / refreshes, static_cast<double>(diffNs) / count, naive.c_str());
+    }
+
+#ifndef _WIN32
+    // 真实/proc快照：刷新耗时包含扫描、比较和通知
+    ProcessTable table;
+    size_t changes = 0;
+    table.AddListener([&changes](const std::vector<ProcessChange>& batch) { changes += batch.size(); });
+    uint64_t start = BenchUtil::NowNanoseconds();
+    table.Refresh();
+    uint64_t loadNs = BenchUtil::NowNanoseconds() - start;
+    std::vector<uint64_t> samples;
+    for (int n = 0; n < refreshes; ++n) {
+        start = BenchUtil::NowNanoseconds();
+        table.Refresh();
+        samples.push_back(BenchUtil::NowNanoseconds() - start);
+    }
+    std::vector<ProcessInfo> processes;
+    table.GetAll(processes);
+    printf("\n/proc with %zu processes: first load %.1f us, refresh p50 %.1f us, p99 %.1f us, %zu changes\n",
+           processes.size(), loadNs / 1000.0, BenchUtil::Percentile(samples, 50) / 1000.0,
+           BenchUtil::Percentile(samples, 99) / 1000.0, changes);
+#endif
+    
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
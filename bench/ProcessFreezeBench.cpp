@@ -0,0 +1,99 @@
+// 整进程挂起与逐个线程挂起的延迟对比：目标进程含T个空闲线程，Linux上分别经cgroup v2冻结
+// （内核一次冻结cgroup内全部线程，等待cgroup.events变为frozen）和SIGSTOP（等待/proc/<pid>/task下
+// 每个线程进入停止状态）挂起并恢复；cgroup v2不可用时整进程挂起一列回退为SIGSTOP，method列注明
+// 用法: ProcessFreezeBench [每种线程数的轮数]
+
+#include "BenchUtil.h"
+#include "ProcessManager.h"
+
+#ifndef _WIN32
+#include "ProcFs.h"
+#include <csignal>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+namespace {
+
+void* IdleThread(void*) {
+    while (true) {
+        pause();
+    }
+    return nullptr;
+}
+
+// 子进程含threadCount个线程（包括主线程），全部阻塞在pause中
+pid_t SpawnIdle(int threadCount) {
+    pid_t child = fork();
+    if (child == 0) {
+        prctl(PR_SET_NAME, "wlm-idle");
+        for (int i = 1; i < threadCount; ++i) {
+            pthread_t thread;
+            pthread_create(&thread, nullptr, IdleThread, nullptr);
+        }
+        IdleThread(nullptr);
+    }
+    
+    std::vector<DWORD> threadIds;
+    while (ProcFs::ListThreads(child, threadIds) && threadIds.size() < static_cast<size_t>(threadCount)) {
+        Sleep(1);
+    }
+    return child;
+}
+
+} // namespace
+#endif
+
+int main(int argc, char* argv[]) {
+    int rounds = BenchUtil::GetIterations(argc, argv, 50);
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+
+#ifdef _WIN32
+    printf("requires child processes created with fork, skipped on Windows\n");
+#else
+    printf("rounds per row: %d\n", rounds);
+    printf("%8s %8s %18s %18s %18s %18s %8s\n", "threads", "method", "native suspend us", "native resume us",
+           "signal suspend us", "signal resume us", "errors");
+    
+    const int counts[] = { 1, 16, 64, 256 };
+    for (int count : counts) {
+        pid_t child = SpawnIdle(count);
+        ProcessManager manager;
+        std::vector<uint64_t> samples[4];
+        int errors = 0;
+        bool native = false;
+        for (int round = 0; round < rounds; ++round) {
+            for (int mode = 0; mode < 2; ++mode) {
+                manager.SetNativeSuspendEnabled(mode == 0);
+                uint64_t start = BenchUtil::NowNanoseconds();
+                errors += !manager.SuspendProcess(child);
+                samples[mode * 2].push_back(BenchUtil::NowNanoseconds() - start);
+                
+                SuspendInfo info;
+                if (mode == 0 && manager.GetSuspendInfo(child, info)) {
+                    native = info.native;
+                }
+                
+                start = BenchUtil::NowNanoseconds();
+                errors += !manager.ResumeProcess(child);
+                samples[mode * 2 + 1].push_back(BenchUtil::NowNanoseconds() - start);
+            }
+        }
+        
+        printf("%8d %8s %18.1f %18.1f %18.1f %18.1f %8d\n", count, native ? "cgroup" : "signal",
+               BenchUtil::Percentile(samples[0], 50) / 1000.0, BenchUtil::Percentile(samples[1], 50) / 1000.0,
+               BenchUtil::Percentile(samples[2], 50) / 1000.0, BenchUtil::Percentile(samples[3], 50) / 1000.0,
+               errors);
+        
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+    }
+#endif
+    
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
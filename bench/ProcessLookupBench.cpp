@@ -0,0 +1,170 @@
+// 进程查询：缓存快照上按PID和进程名的哈希查询，与每次复制整个进程列表后线性扫描（原GetProcessList的做法）对比；
+// 先以合成快照测量不同进程数下的建索引和查询耗时，Linux上再派生子进程使系统进程数达到10000以上，
+// 测量/proc扫描的刷新耗时以及缓存命中和每次刷新的查询耗时
+// 用法: ProcessLookupBench [每组查询次数]
+
+#include "BenchUtil.h"
+#include "Logger.h"
+#include "ProcessTable.h"
+
+#ifndef _WIN32
+#include "ProcFs.h"
+#include <csignal>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#endif
+
+namespace {
+
+std::vector<ProcessInfo> MakeSnapshot(DWORD count) {
+    std::vector<ProcessInfo> snapshot(count);
+    for (DWORD i = 0; i < count; ++i) {
+        snapshot[i].processId = 8 + i * 4;
+        snapshot[i].processName = L"process" + std::to_wstring(i % 500) + L".exe";
+        snapshot[i].threadCount = 4;
+        snapshot[i].parentProcessId = 4;
+    }
+    return snapshot;
+}
+
+// 原有做法：复制整个列表后按PID或忽略大小写的名称逐个比较
+bool LinearFind(const std::vector<ProcessInfo>& snapshot, DWORD processId) {
+    std::vector<ProcessInfo> processes = snapshot;
+    for (const ProcessInfo& process : processes) {
+        if (process.processId == processId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t LinearFindByName(const std::vector<ProcessInfo>& snapshot, const WString& name) {
+    std::vector<ProcessInfo> processes = snapshot;
+    WString key = ProcessTable::FoldName(name);
+    size_t count = 0;
+    for (const ProcessInfo& process : processes) {
+        if (ProcessTable::FoldName(process.processName) == key) {
+            count++;
+        }
+    }
+    return count;
+}
+
+template <typename Body>
+double MeasureNanoseconds(int iterations, Body body) {
+    uint64_t start = BenchUtil::NowNanoseconds();
+    for (int n = 0; n < iterations; ++n) {
+        body(n);
+    }
+    return static_cast<double>(BenchUtil::NowNanoseconds() - start) / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int lookups = BenchUtil::GetIterations(argc, argv, 200000);
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+    
+    printf("lookups per row: %d (linear rows: %d)\n", lookups, lookups / 1000);
+    printf("%-10s %10s %12s %12s %12s %14s %14s\n", "snapshot", "processes", "index us", "pid ns",
+           "name ns", "linear pid ns", "linear name ns");
+    
+    const DWORD counts[] = { 1000, 10000, 50000 };
+    for (DWORD count : counts) {
+        const std::vector<ProcessInfo> snapshot = MakeSnapshot(count);
+        ProcessTable table;
+        table.SetMaxAge(INFINITE);
+        table.SetSnapshotSource([&snapshot](std::vector<ProcessInfo>& processes) {
+            processes = snapshot;
+            return true;
+        });
+        
+        double indexUs = MeasureNanoseconds(10, [&table](int) { table.Refresh(); }) / 1000.0;
+        
+        ProcessInfo info;
+        bool found = false;
+        std::vector<ProcessInfo> processes;
+        double pidNs = MeasureNanoseconds(lookups, [&](int n) {
+            table.Find(8 + (n % count) * 4, info, found);
+        });
+        double nameNs = MeasureNanoseconds(lookups, [&](int n) {
+            table.FindByName(L"PROCESS" + std::to_wstring(n % 500) + L".EXE", processes);
+        });
+        
+        // 线性扫描每次都复制整个列表，次数减少到千分之一
+        int linearLookups = std::max(lookups / 1000, 10);
+        double linearPidNs = MeasureNanoseconds(linearLookups, [&](int n) {
+            LinearFind(snapshot, 8 + (n % count) * 4);
+        });
+        double linearNameNs = MeasureNanoseconds(linearLookups, [&](int n) {
+            LinearFindByName(snapshot, L"PROCESS" + std::to_wstring(n % 500) + L".EXE");
+        });
+        
+        printf("%-10s %10lu %12.1f %12.1f %12.1f %14.0f %14.0f\n", "synthetic", count, indexUs, pidNs, nameNs,
+               linearPidNs, linearNameNs);
+    }
+
+#ifndef _WIN32
+    // 派生空闲的子进程，使系统进程数达到目标；子进程改名，按本进程名查询时只有一个匹配
+    const size_t kTargetProcesses = 10000;
+    std::vector<DWORD> processIds;
+    ProcFs::ListProcesses(processIds);
+    std::vector<pid_t> children;
+    for (size_t total = processIds.size(); total < kTargetProcesses; ++total) {
+        pid_t child = fork();
+        if (child == 0) {
+            prctl(PR_SET_NAME, "wlm-idle");
+            while (true) {
+                pause();
+            }
+        }
+        if (child < 0) {
+            break;
+        }
+        children.push_back(child);
+    }
+    
+    ProcessTable table;
+    table.SetMaxAge(INFINITE);
+    std::vector<uint64_t> refreshSamples;
+    for (int n = 0; n < 20; ++n) {
+        uint64_t start = BenchUtil::NowNanoseconds();
+        table.Refresh();
+        refreshSamples.push_back(BenchUtil::NowNanoseconds() - start);
+    }
+    
+    std::vector<ProcessInfo> processes;
+    table.GetAll(processes);
+    ProcessInfo info;
+    bool found = false;
+    DWORD self = GetCurrentProcessId();
+    double cachedNs = MeasureNanoseconds(lookups, [&](int) { table.Find(self, info, found); });
+    std::vector<ProcessInfo> byName;
+    double cachedNameNs = MeasureNanoseconds(lookups, [&](int) { table.FindByName(L"processlookupbe", byName); });
+    
+    // 最大时长为0时每次查询都重新扫描/proc
+    table.SetMaxAge(0);
+    double uncachedNs = MeasureNanoseconds(20, [&](int) { table.Find(self, info, found); });
+    
+    printf("\n/proc scan with %zu processes (%zu spawned)\n", processes.size(), children.size());
+    printf("%-28s %12.2f ms\n", "refresh p50", BenchUtil::Percentile(refreshSamples, 50) / 1e6);
+    printf("%-28s %12.2f ms\n", "refresh p99", BenchUtil::Percentile(refreshSamples, 99) / 1e6);
+    printf("%-28s %12.1f ns\n", "cached find by pid", cachedNs);
+    printf("%-28s %12.1f ns (%zu matches)\n", "cached find by name", cachedNameNs, byName.size());
+    printf("%-28s %12.2f ms\n", "uncached find by pid", uncachedNs / 1e6);
+    
+    for (pid_t child : children) {
+        kill(child, SIGKILL);
+    }
+    for (pid_t child : children) {
+        waitpid(child, nullptr, 0);
+    }
+#endif
+    
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
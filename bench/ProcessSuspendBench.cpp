@@ -0,0 +1,88 @@
+// 批量挂起/恢复K个进程的耗时：SuspendProcesses/ResumeProcesses一次处理全部进程，
+// 与逐个调用SuspendProcess/ResumeProcess对比。Windows上批量操作只获取一次系统线程快照，
+// 逐个调用为K次；Linux上每个进程只读取自己的/proc/<pid>/task，批量操作先向全部进程发送信号再统一等待停止
+// 用法: ProcessSuspendBench [每种K的轮数]
+
+#include "BenchUtil.h"
+#include "ProcessManager.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#endif
+
+int main(int argc, char* argv[]) {
+    int rounds = BenchUtil::GetIterations(argc, argv, 50);
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    Logger::SetLogLevel(LogLevel::Warning);
+
+#ifdef _WIN32
+    printf("requires child processes created with fork, skipped on Windows\n");
+#else
+    printf("rounds per row: %d\n", rounds);
+    printf("%6s %12s %16s %16s %16s %16s %8s\n", "K", "thread scans", "batch suspend us", "batch resume us",
+           "single suspend us", "single resume us", "errors");
+    
+    const int counts[] = { 1, 4, 16, 64 };
+    for (int count : counts) {
+        // 空闲的子进程，每个含一个线程
+        std::vector<pid_t> children;
+        for (int i = 0; i < count; ++i) {
+            pid_t child = fork();
+            if (child == 0) {
+                prctl(PR_SET_NAME, "wlm-idle");
+                while (true) {
+                    pause();
+                }
+            }
+            children.push_back(child);
+        }
+        std::vector<DWORD> pids(children.begin(), children.end());
+        
+        ProcessManager manager;
+        std::vector<uint64_t> batchSuspend, batchResume, singleSuspend, singleResume;
+        int errors = 0;
+        for (int round = 0; round < rounds; ++round) {
+            uint64_t start = BenchUtil::NowNanoseconds();
+            errors += !manager.SuspendProcesses(pids);
+            batchSuspend.push_back(BenchUtil::NowNanoseconds() - start);
+            
+            start = BenchUtil::NowNanoseconds();
+            errors += !manager.ResumeProcesses(pids);
+            batchResume.push_back(BenchUtil::NowNanoseconds() - start);
+            
+            start = BenchUtil::NowNanoseconds();
+            for (DWORD pid : pids) {
+                errors += !manager.SuspendProcess(pid);
+            }
+            singleSuspend.push_back(BenchUtil::NowNanoseconds() - start);
+            
+            start = BenchUtil::NowNanoseconds();
+            for (DWORD pid : pids) {
+                errors += !manager.ResumeProcess(pid);
+            }
+            singleResume.push_back(BenchUtil::NowNanoseconds() - start);
+        }
+        
+        // 每个进程读取一次自己的task目录，与批量与否无关
+        printf("%6d %12d %16.1f %16.1f %16.1f %16.1f %8d\n", count, count,
+               BenchUtil::Percentile(batchSuspend, 50) / 1000.0, BenchUtil::Percentile(batchResume, 50) / 1000.0,
+               BenchUtil::Percentile(singleSuspend, 50) / 1000.0, BenchUtil::Percentile(singleResume, 50) / 1000.0,
+               errors);
+        
+        for (pid_t child : children) {
+            kill(child, SIGKILL);
+        }
+        for (pid_t child : children) {
+            waitpid(child, nullptr, 0);
+        }
+    }
+#endif
+    
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
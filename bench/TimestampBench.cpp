@@ -0,0 +1,70 @@
+// 时间戳格式化开销：原先每行localtime_s加stringstream的实现，与每秒缓存一次前缀的
+// 本地时间模式和性能计数器单调时间模式对比，单位为每个时间戳的纳秒数
+// 用法: TimestampBench [迭代次数]
+
+#include "BenchUtil.h"
+#include "Logger.h"
+#include <iomanip>
+
+namespace {
+
+// 缓存前的实现，保留作对照
+String LegacyTimeString() {
+    auto time = std::chrono::system_clock::now();
+    auto seconds = std::chrono::system_clock::to_time_t(time);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()) % 1000;
+    
+    std::stringstream ss;
+    struct tm timeinfo;
+    localtime_s(&timeinfo, &seconds);
+    ss << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S");
+    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+    return ss.str();
+}
+
+// 防止编译器把结果优化掉
+volatile size_t g_sink = 0;
+
+template <typename Body>
+void Measure(const char* name, int iterations, Body body) {
+    // 先预热，让缓存和线程局部状态就绪
+    for (int n = 0; n < 1000; ++n) {
+        body();
+    }
+    
+    uint64_t start = BenchUtil::NowNanoseconds();
+    for (int n = 0; n < iterations; ++n) {
+        body();
+    }
+    uint64_t elapsed = BenchUtil::NowNanoseconds() - start;
+    printf("%-20s %10.1f\n", name, static_cast<double>(elapsed) / iterations);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = BenchUtil::GetIterations(argc, argv, 1000000);
+    
+    std::cout.setstate(std::ios::badbit);
+    Logger::Initialize();
+    
+    printf("%-20s %10s\n", "mode", "ns/stamp");
+    Measure("legacy-stringstream", iterations, []() {
+        g_sink = g_sink + LegacyTimeString().length();
+    });
+    
+    char buffer[64];
+    Logger::SetTimestampMode(LogTimestampMode::WallClock);
+    Measure("cached-wallclock", iterations, [&buffer]() {
+        g_sink = g_sink + Logger::GetCurrentTimeString(buffer, sizeof(buffer));
+    });
+    
+    Logger::SetTimestampMode(LogTimestampMode::Monotonic);
+    Measure("monotonic", iterations, [&buffer]() {
+        g_sink = g_sink + Logger::GetCurrentTimeString(buffer, sizeof(buffer));
+    });
+    
+    Logger::SetTimestampMode(LogTimestampMode::WallClock);
+    Logger::Shutdown();
+    return 0;
+}
\ No newline at end of file
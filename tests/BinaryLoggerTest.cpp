@@ -0,0 +1,139 @@
+// 二进制日志测试：LOG_BINARY写出的文件经logdecode解码后与printf格式化的结果一致
+// logdecode的路径由CMake通过WLM_LOGDECODE_PATH传入
+
+#include "TestUtil.h"
+#include "BinaryLogger.h"
+
+namespace {
+
+// 按printf格式化期望的消息
+String Expect(const char* format, ...) {
+    char buffer[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return buffer;
+}
+
+// 调用logdecode解码，返回每行 "[LEVEL] " 之后的消息
+std::vector<String> Decode(const std::filesystem::path& path) {
+    std::filesystem::path output = path.string() + ".txt";
+    String command = String("\"") + WLM_LOGDECODE_PATH + "\" \"" + path.string() + "\" \"" + output.string() + "\"";
+    if (std::system(command.c_str()) != 0) {
+        return std::vector<String>();
+    }
+    
+    std::vector<String> messages;
+    for (const auto& line : TestUtil::ReadLines(output)) {
+        size_t pos = line.find("] ");
+        if (pos != String::npos) {
+            messages.push_back(line.substr(pos + 2));
+        }
+    }
+    return messages;
+}
+
+// 同一调用点在多个会话中使用，验证格式定义按会话重新写出
+void LogCounter(int session) {
+    LOG_BINARY(LogLevel::Info, "session %d counter", session);
+}
+
+void TestRoundTripArguments() {
+    std::filesystem::path path = TestUtil::GetTempDir("binlog") / "args.blog";
+    CHECK(BinaryLogger::Open(path.string(), LogFlushPolicy::EveryLine()));
+    
+    int value = 0;
+    const WString wide = L"wide é";
+    LOG_BINARY(LogLevel::Info, "int %d unsigned %u negative %d", 42, 7u, -13);
+    LOG_BINARY(LogLevel::Warning, "wide int %lld hex %x padded [%5d] [%-4s]", -1234567890123LL, 0xBEEFu, 17, "ab");
+    LOG_BINARY(LogLevel::Error, "double %.3f exp %e", 3.14159, 1.5e10);
+    LOG_BINARY(LogLevel::Info, "string %s wide %s", String("text").c_str(), wide.c_str());
+    LOG_BINARY(LogLevel::Info, "pointer %p percent 100%%", static_cast<void*>(&value));
+    LOG_BINARY(LogLevel::Info, "no arguments");
+    BinaryLogger::Close();
+    
+    char pointer[32];
+    snprintf(pointer, sizeof(pointer), "0x%016llX",
+             static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(&value)));
+    
+    std::vector<String> messages = Decode(path);
+    CHECK(messages.size() == 6);
+    if (messages.size() != 6) {
+        return;
+    }
+    CHECK(messages[0] == Expect("int %d unsigned %u negative %d", 42, 7u, -13));
+    CHECK(messages[1] == Expect("wide int %lld hex %x padded [%5d] [%-4s]", -1234567890123LL, 0xBEEFu, 17, "ab"));
+    CHECK(messages[2] == Expect("double %.3f exp %e", 3.14159, 1.5e10));
+    CHECK(messages[3] == "string text wide wide \xc3\xa9");
+    CHECK(messages[4] == String("pointer ") + pointer + " percent 100%");
+    CHECK(messages[5] == "no arguments");
+}
+
+void TestFormatsRedefinedPerSession() {
+    // 两个会话追加到同一文件，第二个会话的解码不能依赖第一个会话的格式表
+    std::filesystem::path path = TestUtil::GetTempDir("binlog") / "sessions.blog";
+    for (int session = 1; session <= 2; ++session) {
+        CHECK(BinaryLogger::Open(path.string(), LogFlushPolicy::EveryLine()));
+        LogCounter(session);
+        LogCounter(session);
+        BinaryLogger::Close();
+    }
+    
+    std::vector<String> messages = Decode(path);
+    CHECK(messages.size() == 4);
+    if (messages.size() != 4) {
+        return;
+    }
+    CHECK(messages[0] == "session 1 counter");
+    CHECK(messages[1] == "session 1 counter");
+    CHECK(messages[2] == "session 2 counter");
+    CHECK(messages[3] == "session 2 counter");
+}
+
+void TestHashCollisionUsesDistinctIds() {
+    // 这两个格式字符串的FNV-1a哈希相同，第二个应顺延到其他ID
+    static_assert(BinaryLogFormat::HashFormat("collision %d #462789") ==
+                  BinaryLogFormat::HashFormat("collision %d #679192"), "expected colliding formats");
+    
+    std::filesystem::path path = TestUtil::GetTempDir("binlog") / "collision.blog";
+    CHECK(BinaryLogger::Open(path.string(), LogFlushPolicy::EveryLine()));
+    LOG_BINARY(LogLevel::Info, "collision %d #462789", 1);
+    LOG_BINARY(LogLevel::Info, "collision %d #679192", 2);
+    LOG_BINARY(LogLevel::Info, "collision %d #462789", 3);
+    BinaryLogger::Close();
+    
+    std::vector<String> messages = Decode(path);
+    CHECK(messages.size() == 3);
+    if (messages.size() != 3) {
+        return;
+    }
+    CHECK(messages[0] == "collision 1 #462789");
+    CHECK(messages[1] == "collision 2 #679192");
+    CHECK(messages[2] == "collision 3 #462789");
+}
+
+void TestFallsBackToTextLogWhenClosed() {
+    std::filesystem::path path = TestUtil::GetTempDir("binlog") / "fallback.log";
+    Logger::SetLogToFile(true, path.string(), LogFlushPolicy::EveryLine());
+    LOG_BINARY(LogLevel::Info, "fallback %d", 5);
+    Logger::SetLogToFile(false);
+    
+    String content = TestUtil::ReadFileContent(path);
+    CHECK(content.find("fallback 5") != String::npos);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestRoundTripArguments);
+    RUN_TEST(TestFormatsRedefinedPerSession);
+    RUN_TEST(TestHashCollisionUsesDistinctIds);
+    RUN_TEST(TestFallsBackToTextLogWhenClosed);
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
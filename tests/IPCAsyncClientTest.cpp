@@ -0,0 +1,154 @@
+// 异步IPC客户端测试：单个事件循环线程上数千个请求同时在途且各自按ID得到响应，
+// 截止时间到期和取消的请求以相应状态结束且之后到达的响应被丢弃，服务器停止后在途请求以Disconnected结束。
+// Linux上为非阻塞套接字加epoll，Windows上为重叠I/O的命名管道加完成端口
+
+#include "TestUtil.h"
+#include "IPCManager.h"
+
+namespace {
+
+WString GetTestPipeName() {
+    return L"\\\\.\\pipe\\WlmIpcAsyncTest." + std::to_wstring(GetCurrentProcessId());
+}
+
+// 结果消息为请求的processId，exitCode非0时先等待exitCode毫秒
+IPCResult HandleRequest(const IPCRequest& request) {
+    if (request.exitCode != 0) {
+        Sleep(request.exitCode);
+    }
+    return IPCResult(IPCStatus::Ok, ErrorCode::Success, std::to_string(request.processId));
+}
+
+bool StartServer(IPCManager& server) {
+    IPCServerConfig config;
+    config.clientRateLimit = IPCRateLimit();
+    config.responseCacheTtlMs = 0;
+    config.maxPendingPerClient = 16384;
+    config.maxQueuedCommands = 16384;
+    server.SetPipeName(GetTestPipeName());
+    server.SetServerConfig(config);
+    return server.StartServer(HandleRequest);
+}
+
+void TestManyInFlightOnOneThread() {
+    const int kRequests = 5000;
+    
+    IPCManager server;
+    CHECK(StartServer(server));
+    
+    IPCAsyncClient client;
+    CHECK(client.Connect(GetTestPipeName()));
+    
+    // 全部请求在事件循环运行前发起，发送缓冲写满后由事件循环分段写出
+    int completed = 0;
+    int mismatched = 0;
+    for (int n = 0; n < kRequests; ++n) {
+        IPCRequest request(IPCOpcode::QueryServiceStatus);
+        request.processId = static_cast<DWORD>(n);
+        uint32_t id = client.CallAsync(request, INFINITE, [&, n](IPCAsyncStatus status, const IPCResult& result) {
+            if (status == IPCAsyncStatus::Completed && result.status == IPCStatus::Ok &&
+                result.message == std::to_string(n)) {
+                completed++;
+            } else {
+                mismatched++;
+            }
+        });
+        CHECK(id != 0);
+    }
+    CHECK(client.GetPendingCount() == static_cast<size_t>(kRequests));
+    
+    ULONGLONG start = GetTickCount64();
+    while (completed + mismatched < kRequests && GetTickCount64() - start < 30000) {
+        CHECK(client.RunOnce(100));
+    }
+    CHECK(completed == kRequests);
+    CHECK(mismatched == 0);
+    CHECK(client.GetPendingCount() == 0);
+    
+    // 文本命令同样可以异步发送
+    std::thread loop([&client]() { client.Run(); });
+    IPCAsyncReply reply = client.Send("--help").get();
+    CHECK(reply.status == IPCAsyncStatus::Completed && reply.response == "Command executed successfully: --help");
+    client.Stop();
+    loop.join();
+    
+    client.Disconnect();
+    server.StopServer();
+}
+
+void TestDeadlineAndCancel() {
+    IPCManager server;
+    CHECK(StartServer(server));
+    
+    IPCAsyncClient client;
+    CHECK(client.Connect(GetTestPipeName()));
+    std::thread loop([&client]() { client.Run(); });
+    
+    IPCRequest slow(IPCOpcode::QueryServiceStatus);
+    slow.exitCode = 300;
+    
+    // 截止时间早于响应到达
+    ULONGLONG start = GetTickCount64();
+    IPCAsyncResult expired = client.Call(slow, 50).get();
+    CHECK(expired.status == IPCAsyncStatus::TimedOut);
+    CHECK(GetTickCount64() - start < 250);
+    
+    // 取消后回调以Cancelled调用一次，重复取消返回false
+    uint32_t requestId = 0;
+    std::future<IPCAsyncResult> cancelled = client.Call(slow, INFINITE, &requestId);
+    CHECK(requestId != 0);
+    CHECK(client.Cancel(requestId));
+    CHECK(!client.Cancel(requestId));
+    CHECK(cancelled.get().status == IPCAsyncStatus::Cancelled);
+    
+    // 被丢弃的响应到达后，同一连接上的后续请求不受影响
+    Sleep(400);
+    IPCRequest quick(IPCOpcode::QueryServiceStatus);
+    quick.processId = 7;
+    IPCAsyncResult reply = client.Call(quick, 5000).get();
+    CHECK(reply.status == IPCAsyncStatus::Completed && reply.result.message == "7");
+    CHECK(client.GetPendingCount() == 0);
+    
+    client.Stop();
+    loop.join();
+    client.Disconnect();
+    server.StopServer();
+}
+
+void TestServerStopFailsPending() {
+    IPCManager server;
+    CHECK(StartServer(server));
+    
+    IPCAsyncClient client;
+    CHECK(client.Connect(GetTestPipeName()));
+    std::thread loop([&client]() { client.Run(); });
+    
+    IPCRequest slow(IPCOpcode::QueryServiceStatus);
+    slow.exitCode = 500;
+    std::future<IPCAsyncResult> pending = client.Call(slow);
+    Sleep(50);
+    server.StopServer();
+    
+    // 事件循环随连接断开退出，在途请求不会挂起
+    CHECK(pending.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    CHECK(pending.get().status == IPCAsyncStatus::Disconnected);
+    loop.join();
+    
+    // 断开后不再接受新请求
+    CHECK(client.CallAsync(slow, INFINITE, [](IPCAsyncStatus, const IPCResult&) {}) == 0);
+    client.Disconnect();
+}
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestManyInFlightOnOneThread);
+    RUN_TEST(TestDeadlineAndCancel);
+    RUN_TEST(TestServerStopFailsPending);
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+// 命令线程池测试：查询任务越过排队中的进程和服务操作先执行；每类命令同时执行的任务数不超过上限，
+// 达到上限的任务暂存并在同类任务完成后放回队列执行；停止时执行完已提交的任务，之后不再接受新任务
+
+#include "TestUtil.h"
+#include "IPCCommandPool.h"
+#include "Logger.h"
+#include <condition_variable>
+
+namespace {
+
+// 阻塞任务直到Open被调用
+class Gate {
+public:
+    Gate() : m_open(false) {}
+    
+    void Wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_opened.wait(lock, [this]() { return m_open; });
+    }
+    
+    void Open() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_open = true;
+        m_opened.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_opened;
+    bool m_open;
+};
+
+// 按执行顺序记录任务名
+class Trace {
+public:
+    void Add(const String& name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_names.push_back(name);
+    }
+    
+    std::vector<String> Get() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_names;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<String> m_names;
+};
+
+template <typename Condition>
+bool WaitFor(Condition condition, DWORD timeoutMs) {
+    ULONGLONG start = GetTickCount64();
+    while (!condition()) {
+        if (GetTickCount64() - start > timeoutMs) {
+            return false;
+        }
+        Sleep(1);
+    }
+    return true;
+}
+
+void TestQueriesOvertakeControl() {
+    IPCCommandPoolConfig config;
+    config.threadCount = 1;
+    IPCCommandPool pool;
+    CHECK(pool.Start(config));
+    
+    // 唯一的线程被服务操作占用期间，先排入进程和服务操作，再排入查询
+    Gate gate;
+    Trace trace;
+    std::atomic<bool> blocking(false);
+    CHECK(pool.Submit(IPCCommandClass::ServiceControl, [&]() {
+        blocking = true;
+        gate.Wait();
+        trace.Add("service0");
+    }));
+    CHECK(WaitFor([&]() { return blocking.load(); }, 5000));
+    
+    for (int i = 1; i <= 2; ++i) {
+        CHECK(pool.Submit(IPCCommandClass::ServiceControl, [&trace, i]() {
+            trace.Add("service" + std::to_string(i));
+        }));
+    }
+    for (int i = 0; i < 3; ++i) {
+        CHECK(pool.Submit(IPCCommandClass::ProcessControl, [&trace, i]() {
+            trace.Add("process" + std::to_string(i));
+        }));
+    }
+    for (int i = 0; i < 3; ++i) {
+        CHECK(pool.Submit(IPCCommandClass::Query, [&trace, i]() { trace.Add("query" + std::to_string(i)); }));
+    }
+    
+    gate.Open();
+    pool.Stop();
+    
+    // 按类别优先级执行，同类按提交顺序
+    const char* expected[] = { "service0", "query0", "query1", "query2", "process0", "process1", "process2",
+                               "service1", "service2" };
+    std::vector<String> names = trace.Get();
+    CHECK(names.size() == sizeof(expected) / sizeof(expected[0]));
+    for (size_t i = 0; i < names.size() && i < sizeof(expected) / sizeof(expected[0]); ++i) {
+        CHECK(names[i] == expected[i]);
+    }
+}
+
+void TestClassLimits() {
+    // 默认上限：查询不限，进程操作4个，服务操作1个
+    IPCCommandPoolConfig config;
+    config.threadCount = 8;
+    IPCCommandPool pool;
+    CHECK(pool.Start(config));
+    
+    std::atomic<int> running[IPCCommandPoolConfig::kClassCount] = {};
+    std::atomic<int> peak[IPCCommandPoolConfig::kClassCount] = {};
+    std::atomic<int> done[IPCCommandPoolConfig::kClassCount] = {};
+    std::atomic<int> completed(0);
+    auto makeTask = [&](IPCCommandClass commandClass, DWORD durationMs) {
+        size_t index = static_cast<size_t>(commandClass);
+        return [&, index, durationMs]() {
+            int now = ++running[index];
+            int previous = peak[index];
+            while (now > previous && !peak[index].compare_exchange_weak(previous, now)) {
+            }
+            Sleep(durationMs);
+            running[index]--;
+            done[index]++;
+            completed++;
+        };
+    };
+    
+    const int kProcessTasks = 16;
+    const int kServiceTasks = 4;
+    const int kQueries = 32;
+    for (int i = 0; i < kServiceTasks; ++i) {
+        CHECK(pool.Submit(IPCCommandClass::ServiceControl, makeTask(IPCCommandClass::ServiceControl, 20)));
+    }
+    for (int i = 0; i < kProcessTasks; ++i) {
+        CHECK(pool.Submit(IPCCommandClass::ProcessControl, makeTask(IPCCommandClass::ProcessControl, 20)));
+    }
+    
+    // 受限类别占满时其余线程仍处理查询，查询在服务操作全部完成前结束
+    for (int i = 0; i < kQueries; ++i) {
+        CHECK(pool.Submit(IPCCommandClass::Query, makeTask(IPCCommandClass::Query, 1)));
+    }
+    std::atomic<int> queries(0);
+    CHECK(pool.Submit(IPCCommandClass::Query, [&queries]() { queries++; }));
+    CHECK(WaitFor([&]() { return queries == 1; }, 5000));
+    CHECK(done[static_cast<size_t>(IPCCommandClass::ServiceControl)] < kServiceTasks);
+    
+    // 暂存的任务在同类任务完成后放回队列，全部执行
+    CHECK(WaitFor([&]() { return completed == kServiceTasks + kProcessTasks + kQueries; }, 10000));
+    CHECK(peak[static_cast<size_t>(IPCCommandClass::ProcessControl)] == 4);
+    CHECK(peak[static_cast<size_t>(IPCCommandClass::ServiceControl)] == 1);
+    CHECK(peak[static_cast<size_t>(IPCCommandClass::Query)] >= 1);
+    pool.Stop();
+}
+
+void TestDeferredTasksRunAfterSlotRelease() {
+    // 服务操作上限为1：第二个服务操作暂存，第一个完成后才开始，期间其他线程照常执行查询
+    IPCCommandPoolConfig config;
+    config.threadCount = 3;
+    IPCCommandPool pool;
+    CHECK(pool.Start(config));
+    
+    Gate gate;
+    Trace trace;
+    std::atomic<bool> started(false);
+    CHECK(pool.Submit(IPCCommandClass::ServiceControl, [&]() {
+        trace.Add("service0 start");
+        started = true;
+        gate.Wait();
+        trace.Add("service0 end");
+    }));
+    CHECK(WaitFor([&]() { return started.load(); }, 5000));
+    CHECK(pool.Submit(IPCCommandClass::ServiceControl, [&trace]() { trace.Add("service1"); }));
+    
+    std::atomic<int> queries(0);
+    for (int i = 0; i < 10; ++i) {
+        CHECK(pool.Submit(IPCCommandClass::Query, [&queries]() { queries++; }));
+    }
+    CHECK(WaitFor([&]() { return queries == 10; }, 5000));
+    
+    Sleep(50);
+    CHECK(trace.Get().size() == 1);
+    gate.Open();
+    CHECK(WaitFor([&]() { return trace.Get().size() == 3; }, 5000));
+    std::vector<String> names = trace.Get();
+    CHECK(names.size() == 3 && names[1] == "service0 end" && names[2] == "service1");
+    pool.Stop();
+}
+
+void TestStopDrains() {
+    IPCCommandPoolConfig config;
+    config.threadCount = 2;
+    IPCCommandPool pool;
+    CHECK(pool.Start(config));
+    
+    // 停止时暂存和排队的任务都会执行
+    std::atomic<int> completed(0);
+    for (int i = 0; i < 20; ++i) {
+        IPCCommandClass commandClass = static_cast<IPCCommandClass>(i % IPCCommandPoolConfig::kClassCount);
+        CHECK(pool.Submit(commandClass, [&completed]() {
+            Sleep(2);
+            completed++;
+        }));
+    }
+    pool.Stop();
+    CHECK(completed == 20);
+    CHECK(!pool.Submit(IPCCommandClass::Query, []() {}));
+}
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestQueriesOvertakeControl);
+    RUN_TEST(TestClassLimits);
+    RUN_TEST(TestDeferredTasksRunAfterSlotRelease);
+    RUN_TEST(TestStopDrains);
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
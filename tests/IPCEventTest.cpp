@@ -0,0 +1,230 @@
+// IPC事件推送测试：数百个订阅者各自按序收到每个事件且没有丢弃，并统计从发布到各订阅者收到的扇出延迟；
+// 订阅掩码之外的事件不会推送；无关进程的启动和退出不会使缓存的状态查询失效。
+// Linux上经由Unix域套接字，Windows上为命名管道
+
+#include "TestUtil.h"
+#include "IPCManager.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+WString GetTestPipeName() {
+    return L"\\\\.\\pipe\\WlmIpcEventTest." + std::to_wstring(GetCurrentProcessId());
+}
+
+uint64_t NowMicroseconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t Percentile(std::vector<uint64_t>& samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[std::min(static_cast<size_t>(p / 100.0 * (samples.size() - 1) + 0.5), samples.size() - 1)];
+}
+
+// 等待条件成立，最多timeoutMs
+template <typename Condition>
+bool WaitFor(Condition condition, DWORD timeoutMs) {
+    ULONGLONG start = GetTickCount64();
+    while (!condition()) {
+        if (GetTickCount64() - start > timeoutMs) {
+            return false;
+        }
+        Sleep(1);
+    }
+    return true;
+}
+
+bool StartServer(IPCManager& server, DWORD instanceCount) {
+    IPCServerConfig config;
+    config.instanceCount = instanceCount;
+    config.clientRateLimit = IPCRateLimit();
+    config.responseCacheTtlMs = 0;
+    server.SetPipeName(GetTestPipeName());
+    server.SetServerConfig(config);
+    return server.StartServer([](const IPCRequest&) { return IPCResult(IPCStatus::Ok, ErrorCode::Success); });
+}
+
+void TestFanOutToManySubscribers() {
+    const int kSubscribers = 256;
+    const int kEvents = 50;
+    
+    IPCManager server;
+    CHECK(StartServer(server, kSubscribers + 4));
+    
+    // 每个订阅者记录每个事件从发布到收到的延迟，事件的processId为其序号
+    std::vector<std::atomic<uint64_t>> publishTimes(kEvents);
+    std::vector<std::vector<uint64_t>> latencies(kSubscribers);
+    std::atomic<int> subscribed(0);
+    std::atomic<int> received(0);
+    std::atomic<int> outOfOrder(0);
+    std::vector<std::thread> subscribers;
+    for (int s = 0; s < kSubscribers; ++s) {
+        subscribers.emplace_back([&, s]() {
+            IPCClient client;
+            if (!client.Connect(GetTestPipeName()) || !client.Subscribe(EventMaskProcessSuspended)) {
+                return;
+            }
+            subscribed++;
+            
+            uint64_t lastSequence = 0;
+            for (int n = 0; n < kEvents; ++n) {
+                IPCEvent event;
+                if (!client.WaitEvent(event)) {
+                    break;
+                }
+                latencies[s].push_back(NowMicroseconds() - publishTimes[event.processId % kEvents].load());
+                if (event.type != IPCEventType::ProcessSuspended || event.processId != static_cast<DWORD>(n) ||
+                    event.sequence <= lastSequence) {
+                    outOfOrder++;
+                }
+                lastSequence = event.sequence;
+                received++;
+            }
+        });
+    }
+    
+    CHECK(WaitFor([&]() { return subscribed == kSubscribers; }, 30000));
+    
+    // 逐个发布，等全部订阅者收到后再发布下一个，记录最后一个订阅者收到的时间即整次扇出的耗时
+    std::vector<uint64_t> fanOutTimes;
+    for (int n = 0; n < kEvents; ++n) {
+        IPCEvent event(IPCEventType::ProcessSuspended);
+        event.processId = static_cast<DWORD>(n);
+        event.name = L"winlogon.exe";
+        uint64_t start = NowMicroseconds();
+        publishTimes[n] = start;
+        server.PublishEvent(event);
+        if (!WaitFor([&]() { return received >= (n + 1) * kSubscribers; }, 10000)) {
+            break;
+        }
+        fanOutTimes.push_back(NowMicroseconds() - start);
+    }
+    
+    // 先停止服务器，出错时仍在等待事件的订阅者随断开返回
+    server.StopServer();
+    for (auto& thread : subscribers) {
+        thread.join();
+    }
+    
+    CHECK(received == kEvents * kSubscribers);
+    CHECK(outOfOrder == 0);
+    
+    std::vector<uint64_t> samples;
+    for (const auto& subscriberSamples : latencies) {
+        samples.insert(samples.end(), subscriberSamples.begin(), subscriberSamples.end());
+    }
+    uint64_t p99 = Percentile(samples, 99);
+    printf("  %d subscribers x %d events: delivery p50 %llu us, p99 %llu us; full fan-out p50 %llu us, p99 %llu us\n",
+           kSubscribers, kEvents, static_cast<unsigned long long>(Percentile(samples, 50)),
+           static_cast<unsigned long long>(p99), static_cast<unsigned long long>(Percentile(fanOutTimes, 50)),
+           static_cast<unsigned long long>(Percentile(fanOutTimes, 99)));
+    
+    // 宽松的上限，只用于发现扇出被串行化或卡住
+    CHECK(p99 < 2000000);
+}
+
+void TestEventMaskFiltering() {
+    IPCManager server;
+    CHECK(StartServer(server, 4));
+    
+    IPCClient client;
+    CHECK(client.Connect(GetTestPipeName()));
+    CHECK(client.Subscribe(EventMaskProcessExited | EventMaskServiceState));
+    
+    // 只有掩码内的事件被推送，顺序与发布一致
+    const IPCEventType published[] = { IPCEventType::ProcessStarted, IPCEventType::ProcessExited,
+                                       IPCEventType::ProcessSuspended, IPCEventType::ServiceStateChanged,
+                                       IPCEventType::ProcessResumed, IPCEventType::ProcessExited };
+    for (IPCEventType type : published) {
+        server.PublishEvent(IPCEvent(type));
+    }
+    
+    const IPCEventType expected[] = { IPCEventType::ProcessExited, IPCEventType::ServiceStateChanged,
+                                      IPCEventType::ProcessExited };
+    for (IPCEventType type : expected) {
+        IPCEvent event;
+        CHECK(client.WaitEvent(event) && event.type == type);
+    }
+    
+    // 取消订阅后不再收到事件，请求照常响应
+    CHECK(client.Subscribe(0));
+    server.PublishEvent(IPCEvent(IPCEventType::ProcessExited));
+    String response;
+    CHECK(client.Request("--help", response) && response == "Command executed successfully: --help");
+    
+    client.Disconnect();
+    server.StopServer();
+}
+
+void TestProcessChurnKeepsCache() {
+    IPCManager server;
+    IPCServerConfig config;
+    config.instanceCount = 4;
+    config.clientRateLimit = IPCRateLimit();
+    config.responseCacheTtlMs = 60000;
+    server.SetPipeName(GetTestPipeName());
+    server.SetServerConfig(config);
+    
+    // 查询函数刷新进程快照时同样会发布进程启动和退出事件
+    std::atomic<int> loads(0);
+    CHECK(server.StartServer([&server, &loads](const IPCRequest& request) {
+        if (request.opcode == IPCOpcode::QueryWinlogonStatus) {
+            loads++;
+            server.PublishEvent(IPCEvent(IPCEventType::ProcessStarted));
+            server.PublishEvent(IPCEvent(IPCEventType::ProcessExited));
+        }
+        return IPCResult(IPCStatus::Ok, ErrorCode::Success, "winlogon");
+    }));
+    
+    IPCClient client;
+    CHECK(client.Connect(GetTestPipeName()));
+    IPCResult result;
+    CHECK(client.Call(IPCRequest(IPCOpcode::QueryWinlogonStatus), result) && result.status == IPCStatus::Ok);
+    CHECK(client.Call(IPCRequest(IPCOpcode::QueryWinlogonStatus), result) && result.message == "winlogon");
+    CHECK(loads == 1);
+    
+    // 其他进程的启动和退出不影响缓存
+    for (int i = 0; i < 100; ++i) {
+        server.PublishEvent(IPCEvent(i % 2 ? IPCEventType::ProcessExited : IPCEventType::ProcessStarted));
+    }
+    CHECK(client.Call(IPCRequest(IPCOpcode::QueryWinlogonStatus), result));
+    CHECK(loads == 1);
+    CHECK(server.GetCacheStats().hits == 2);
+    
+    // 挂起、恢复和服务状态变化使缓存失效
+    const IPCEventType changes[] = { IPCEventType::ProcessSuspended, IPCEventType::ProcessResumed,
+                                     IPCEventType::ServiceStateChanged };
+    int expected = 1;
+    for (IPCEventType type : changes) {
+        server.PublishEvent(IPCEvent(type));
+        CHECK(client.Call(IPCRequest(IPCOpcode::QueryWinlogonStatus), result));
+        CHECK(loads == ++expected);
+    }
+    
+    // 调用方判断为与缓存有关的进程变化时显式失效
+    server.InvalidateResponseCache();
+    CHECK(client.Call(IPCRequest(IPCOpcode::QueryWinlogonStatus), result));
+    CHECK(loads == expected + 1);
+    
+    client.Disconnect();
+    server.StopServer();
+}
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestFanOutToManySubscribers);
+    RUN_TEST(TestEventMaskFiltering);
+    RUN_TEST(TestProcessChurnKeepsCache);
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+// IPC分帧测试：帧解析器对任意切分的字节流还原出完整消息，超出上限的帧被拒绝；
+// 经服务器收发超过单帧和原4096字节上限的消息，以及未分帧的旧版客户端（Linux上直接写套接字）
+
+#include "TestUtil.h"
+#include "IPCManager.h"
+
+#ifndef _WIN32
+#include "IPCSocket.h"
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+namespace {
+
+WString GetTestPipeName() {
+    return L"\\\\.\\pipe\\WlmIpcFrameTest." + std::to_wstring(GetCurrentProcessId());
+}
+
+String MakePayload(size_t size) {
+    String payload(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+    return payload;
+}
+
+void TestReaderReassemblesSplitStream() {
+    // 三条消息：小消息、跨多帧的大消息和空消息
+    const String large = MakePayload(3 * IPCFrame::kMaxFrameBytes + 123);
+    String stream;
+    IPCFrame::AppendMessage(stream, 1, String("--status"));
+    IPCFrame::AppendMessage(stream, 2, IPCFrame::MessageBinary, large.c_str(), large.length());
+    IPCFrame::AppendMessage(stream, 3, String());
+    
+    // 以不与帧边界对齐的小块依次送入
+    IPCFrameReader reader;
+    std::vector<std::pair<uint32_t, String>> messages;
+    std::vector<uint16_t> types;
+    for (size_t offset = 0; offset < stream.length(); offset += 7) {
+        reader.Append(stream.c_str() + offset, std::min<size_t>(7, stream.length() - offset));
+        
+        uint32_t requestId;
+        uint16_t type;
+        String message;
+        while (reader.NextMessage(requestId, type, message)) {
+            messages.emplace_back(requestId, message);
+            types.push_back(type);
+        }
+    }
+    
+    CHECK(!reader.HasError());
+    CHECK(messages.size() == 3);
+    if (messages.size() == 3) {
+        CHECK(messages[0].first == 1 && messages[0].second == "--status" && types[0] == IPCFrame::MessageCommand);
+        CHECK(messages[1].first == 2 && messages[1].second == large && types[1] == IPCFrame::MessageBinary);
+        CHECK(messages[2].first == 3 && messages[2].second.empty());
+    }
+}
+
+void TestReaderRejectsOversizedFrame() {
+    char header[IPCFrame::kHeaderSize] = {};
+    uint32_t length = IPCFrame::kMaxFrameBytes + 1;
+    memcpy(header, &length, sizeof(length));
+    
+    IPCFrameReader reader;
+    reader.Append(header, sizeof(header));
+    
+    uint32_t requestId;
+    uint16_t type;
+    String message;
+    CHECK(!reader.NextMessage(requestId, type, message));
+    CHECK(reader.HasError());
+}
+
+// 处理函数按请求中的processId生成相应大小的结果消息
+IPCResult HandleRequest(const IPCRequest& request) {
+    return IPCResult(IPCStatus::Ok, ErrorCode::Success, MakePayload(request.processId));
+}
+
+bool StartServer(IPCManager& server) {
+    IPCServerConfig config;
+    config.instanceCount = 4;
+    config.responseCacheTtlMs = 0;
+    server.SetPipeName(GetTestPipeName());
+    server.SetServerConfig(config);
+    return server.StartServer(HandleRequest);
+}
+
+void TestLargeMessagesOverServer() {
+    IPCManager server;
+    CHECK(StartServer(server));
+    
+    IPCClient client;
+    CHECK(client.Connect(GetTestPipeName()));
+    
+    // 帧边界、原4096字节上限两侧以及跨越多帧的大响应
+    const size_t sizes[] = { 0, 1, 4095, 4096, 4097, IPCFrame::kMaxFrameBytes, IPCFrame::kMaxFrameBytes + 1,
+                             1024 * 1024, 16 * 1024 * 1024 };
+    for (size_t size : sizes) {
+        IPCRequest request(IPCOpcode::QueryWinlogonStatus);
+        request.processId = static_cast<DWORD>(size);
+        IPCResult result;
+        CHECK(client.Call(request, result));
+        CHECK(result.IsOk() && result.message == MakePayload(size));
+    }
+    
+    // 大请求：未知的文本命令原样附在失败响应中
+    const String command = "--" + MakePayload(1024 * 1024);
+    String response;
+    CHECK(client.Request(command, response));
+    CHECK(response == "Command execution failed: " + command);
+    
+    // 同一会话上交错的大小请求按请求ID各自取回
+    uint32_t largeId;
+    uint32_t smallId;
+    IPCRequest largeRequest(IPCOpcode::QueryWinlogonStatus);
+    largeRequest.processId = 4 * 1024 * 1024;
+    CHECK(client.SendRequest(largeRequest, largeId));
+    CHECK(client.Send("--help", smallId));
+    CHECK(client.Receive(smallId, response) && response == "Command executed successfully: --help");
+    IPCResult largeResult;
+    CHECK(client.ReceiveResult(largeId, largeResult) && largeResult.message == MakePayload(4 * 1024 * 1024));
+    
+    client.Disconnect();
+    server.StopServer();
+}
+
+#ifndef _WIN32
+String ReadUntilClosed(int socket) {
+    String data;
+    char buffer[4096];
+    ssize_t received;
+    while ((received = recv(socket, buffer, sizeof(buffer), 0)) > 0) {
+        data.append(buffer, static_cast<size_t>(received));
+    }
+    return data;
+}
+
+void TestUnframedClient() {
+    IPCManager server;
+    CHECK(StartServer(server));
+    
+    // 旧版客户端写入以NUL结尾的命令，读取不带帧头的文本响应
+    int socket = IPCSocket::Connect(IPCSocket::GetSocketPath(GetTestPipeName()), 1000);
+    CHECK(socket >= 0);
+    const char command[] = "--help";
+    CHECK(IPCSocket::SendAll(socket, command, sizeof(command)));
+    
+    const String expected = "Command executed successfully: --help";
+    String response;
+    char buffer[4096];
+    while (response.length() < expected.length()) {
+        ssize_t received = recv(socket, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        response.append(buffer, static_cast<size_t>(received));
+    }
+    CHECK(response == expected);
+    close(socket);
+    
+    server.StopServer();
+}
+
+void TestInvalidFrameClosesConnection() {
+    IPCManager server;
+    CHECK(StartServer(server));
+    
+    // 帧长度超过上限，服务器不再读取并断开连接
+    int socket = IPCSocket::Connect(IPCSocket::GetSocketPath(GetTestPipeName()), 1000);
+    CHECK(socket >= 0);
+    char header[IPCFrame::kHeaderSize] = {};
+    uint32_t length = IPCFrame::kMaxFrameBytes + 1;
+    memcpy(header, &length, sizeof(length));
+    CHECK(IPCSocket::SendAll(socket, header, sizeof(header)));
+    CHECK(ReadUntilClosed(socket).empty());
+    close(socket);
+    
+    // 其他连接不受影响
+    IPCClient client;
+    String response;
+    CHECK(client.Connect(GetTestPipeName()) && client.Request("--help", response));
+    
+    client.Disconnect();
+    server.StopServer();
+}
+#endif
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestReaderReassemblesSplitStream);
+    RUN_TEST(TestReaderRejectsOversizedFrame);
+    RUN_TEST(TestLargeMessagesOverServer);
+#ifndef _WIN32
+    RUN_TEST(TestUnframedClient);
+    RUN_TEST(TestInvalidFrameClosesConnection);
+#endif
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
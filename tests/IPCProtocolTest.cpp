@@ -0,0 +1,285 @@
+// IPC协议测试：请求、结果和事件编码后能原样解码，截断、多余字节和错误版本被拒绝，
+// 随机字节和随机改动的合法消息解码时不会越界；Linux上把随机消息直接写入服务器套接字，
+// 每条消息都得到一个可解码的响应且服务器继续正常工作
+
+#include "TestUtil.h"
+#include "IPCManager.h"
+#include <random>
+
+#ifndef _WIN32
+#include "IPCSocket.h"
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+namespace {
+
+const int kFuzzIterations = 20000;
+
+WString RandomName(std::mt19937& random, size_t maxLength) {
+    WString name(random() % (maxLength + 1), L'\0');
+    for (wchar_t& c : name) {
+        c = static_cast<wchar_t>(random() % 0x10000);
+    }
+    return name;
+}
+
+String RandomBytes(std::mt19937& random, size_t maxLength) {
+    String bytes(random() % (maxLength + 1), '\0');
+    for (char& c : bytes) {
+        c = static_cast<char>(random());
+    }
+    return bytes;
+}
+
+IPCRequest RandomRequest(std::mt19937& random) {
+    IPCRequest request(static_cast<IPCOpcode>(random() % 0x10000));
+    request.processId = static_cast<DWORD>(random());
+    request.exitCode = static_cast<UINT>(random());
+    request.processName = RandomName(random, 64);
+    return request;
+}
+
+void TestRequestRoundTrip() {
+    std::mt19937 random(1);
+    for (int i = 0; i < kFuzzIterations; ++i) {
+        IPCRequest request = RandomRequest(random);
+        String data;
+        IPCProtocol::EncodeRequest(request, data);
+        
+        IPCRequest decoded;
+        CHECK(IPCProtocol::DecodeRequest(data, decoded) == IPCStatus::Ok);
+        CHECK(decoded.opcode == request.opcode && decoded.processId == request.processId &&
+              decoded.exitCode == request.exitCode && decoded.processName == request.processName);
+    }
+    
+    // 超长进程名截断到长度字段的上限
+    IPCRequest request(IPCOpcode::SuspendProcess);
+    request.processName.assign(0x10000 + 10, L'a');
+    String data;
+    IPCProtocol::EncodeRequest(request, data);
+    IPCRequest decoded;
+    CHECK(IPCProtocol::DecodeRequest(data, decoded) == IPCStatus::Ok);
+    CHECK(decoded.processName.length() == 0xFFFF);
+}
+
+void TestResultRoundTrip() {
+    std::mt19937 random(2);
+    for (int i = 0; i < kFuzzIterations; ++i) {
+        IPCResult result(static_cast<IPCStatus>(random() % 6), static_cast<ErrorCode>(random() % 32),
+                         RandomBytes(random, 256));
+        result.retryAfterMs = result.status == IPCStatus::Busy ? static_cast<DWORD>(random()) : 0;
+        String data;
+        IPCProtocol::EncodeResult(result, data);
+        
+        IPCResult decoded;
+        CHECK(IPCProtocol::DecodeResult(data, decoded));
+        CHECK(decoded.status == result.status && decoded.error == result.error &&
+              decoded.message == result.message && decoded.retryAfterMs == result.retryAfterMs);
+    }
+}
+
+void TestEventRoundTrip() {
+    std::mt19937 random(3);
+    for (int i = 0; i < kFuzzIterations; ++i) {
+        IPCEvent event(static_cast<IPCEventType>(random() % 0x10000));
+        event.sequence = (static_cast<uint64_t>(random()) << 32) | random();
+        event.timestamp = (static_cast<uint64_t>(random()) << 32) | random();
+        event.processId = static_cast<DWORD>(random());
+        event.state = static_cast<DWORD>(random());
+        event.count = static_cast<uint32_t>(random());
+        event.name = RandomName(random, 64);
+        String data;
+        IPCProtocol::EncodeEvent(event, data);
+        
+        IPCEvent decoded;
+        CHECK(IPCProtocol::DecodeEvent(data, decoded));
+        CHECK(decoded.type == event.type && decoded.sequence == event.sequence &&
+              decoded.timestamp == event.timestamp && decoded.processId == event.processId &&
+              decoded.state == event.state && decoded.count == event.count && decoded.name == event.name);
+    }
+}
+
+void TestMalformedInputRejected() {
+    IPCRequest request(IPCOpcode::TerminateProcess);
+    request.processName = L"notepad.exe";
+    String data;
+    IPCProtocol::EncodeRequest(request, data);
+    
+    // 任意截断和多出的字节都不是合法请求
+    IPCRequest decoded;
+    for (size_t length = 0; length < data.length(); ++length) {
+        CHECK(IPCProtocol::DecodeRequest(data.substr(0, length), decoded) == IPCStatus::InvalidRequest);
+    }
+    CHECK(IPCProtocol::DecodeRequest(data + '\0', decoded) == IPCStatus::InvalidRequest);
+    
+    String future = data;
+    future[0] = static_cast<char>(IPCProtocol::kVersion + 1);
+    CHECK(IPCProtocol::DecodeRequest(future, decoded) == IPCStatus::UnsupportedVersion);
+    
+    // 结果的可选尾部只能是完整的4字节
+    IPCResult result(IPCStatus::Ok, ErrorCode::Success, "Running");
+    String resultData;
+    IPCProtocol::EncodeResult(result, resultData);
+    IPCResult decodedResult;
+    for (size_t length = 0; length < resultData.length(); ++length) {
+        CHECK(!IPCProtocol::DecodeResult(resultData.substr(0, length), decodedResult));
+    }
+    CHECK(!IPCProtocol::DecodeResult(resultData + "ab", decodedResult));
+    CHECK(!IPCProtocol::DecodeResult(resultData + "abcde", decodedResult));
+    CHECK(IPCProtocol::DecodeResult(resultData + "abcd", decodedResult));
+}
+
+void TestFuzzDecode() {
+    // 随机字节，以及随机改动、截断或延长的合法请求。解码成功的请求重新编码后与输入完全相同
+    std::mt19937 random(4);
+    int accepted = 0;
+    for (int i = 0; i < kFuzzIterations; ++i) {
+        String data;
+        if (i % 2 == 0) {
+            data = RandomBytes(random, 48);
+        } else {
+            IPCProtocol::EncodeRequest(RandomRequest(random), data);
+            data[random() % data.length()] = static_cast<char>(random());
+            if (random() % 4 == 0) {
+                data.resize(random() % (data.length() + 8));
+            }
+        }
+        
+        IPCRequest request;
+        if (IPCProtocol::DecodeRequest(data, request) == IPCStatus::Ok) {
+            String encoded;
+            IPCProtocol::EncodeRequest(request, encoded);
+            CHECK(encoded == data);
+            accepted++;
+        }
+        
+        IPCResult result;
+        if (IPCProtocol::DecodeResult(data, result)) {
+            CHECK(result.message.length() < data.length());
+        }
+        
+        IPCEvent event;
+        if (IPCProtocol::DecodeEvent(data, event)) {
+            String encoded;
+            IPCProtocol::EncodeEvent(event, encoded);
+            CHECK(encoded == data);
+        }
+    }
+    CHECK(accepted > 0);
+}
+
+#ifndef _WIN32
+WString GetTestPipeName() {
+    return L"\\\\.\\pipe\\WlmIpcProtocolTest." + std::to_wstring(GetCurrentProcessId());
+}
+
+// 从套接字读取下一条完整消息
+bool ReadMessage(int socket, IPCFrameReader& reader, uint32_t& requestId, uint16_t& type, String& message) {
+    char buffer[4096];
+    while (!reader.NextMessage(requestId, type, message)) {
+        ssize_t received = recv(socket, buffer, sizeof(buffer), 0);
+        if (received <= 0 || reader.HasError()) {
+            return false;
+        }
+        reader.Append(buffer, static_cast<size_t>(received));
+    }
+    return true;
+}
+
+void TestFuzzServer() {
+    IPCServerConfig config;
+    config.clientRateLimit = IPCRateLimit();
+    config.responseCacheTtlMs = 0;
+    
+    std::atomic<int> handled(0);
+    IPCManager server;
+    server.SetPipeName(GetTestPipeName());
+    server.SetServerConfig(config);
+    CHECK(server.StartServer([&handled](const IPCRequest& request) {
+        handled++;
+        return IPCResult(IPCStatus::Ok, ErrorCode::Success, IPCProtocol::GetOpcodeName(request.opcode));
+    }));
+    
+    int socket = IPCSocket::Connect(IPCSocket::GetSocketPath(GetTestPipeName()), 1000);
+    CHECK(socket >= 0);
+    
+    // 文本、批量和二进制三种消息，内容为随机字节或改动过的合法请求，逐条等待响应
+    std::mt19937 random(5);
+    IPCFrameReader reader;
+    int answered = 0;
+    int binaryOk = 0;
+    const int kMessages = 2000;
+    for (uint32_t id = 1; id <= kMessages; ++id) {
+        uint16_t type = static_cast<uint16_t>(random() % 3);
+        String payload;
+        if (type == IPCFrame::MessageBinary && random() % 2 == 0) {
+            IPCProtocol::EncodeRequest(RandomRequest(random), payload);
+            if (random() % 2 == 0) {
+                payload[random() % payload.length()] = static_cast<char>(random());
+            }
+        } else {
+            payload = RandomBytes(random, 64);
+        }
+        
+        String frame;
+        IPCFrame::AppendMessage(frame, id, payload, type);
+        if (!IPCSocket::SendAll(socket, frame.c_str(), frame.length())) {
+            break;
+        }
+        
+        uint32_t requestId;
+        uint16_t responseType;
+        String response;
+        if (!ReadMessage(socket, reader, requestId, responseType, response)) {
+            break;
+        }
+        if (requestId == id && responseType == type) {
+            answered++;
+        }
+        
+        if (type == IPCFrame::MessageBinary) {
+            IPCResult result;
+            CHECK(IPCProtocol::DecodeResult(response, result));
+            if (result.IsOk()) {
+                binaryOk++;
+            }
+        } else if (type == IPCFrame::MessageBatch) {
+            std::vector<IPCBatchResult> results;
+            CHECK(IPCBatch::DecodeResponse(response, results));
+        }
+    }
+    close(socket);
+    
+    CHECK(answered == kMessages);
+    CHECK(binaryOk > 0 && handled >= binaryOk);
+    
+    // 服务器仍然正常响应
+    IPCClient client;
+    String response;
+    CHECK(client.Connect(GetTestPipeName()) && client.Request("--help", response));
+    CHECK(response == "Command executed successfully: --help");
+    
+    client.Disconnect();
+    server.StopServer();
+}
+#endif
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestRequestRoundTrip);
+    RUN_TEST(TestResultRoundTrip);
+    RUN_TEST(TestEventRoundTrip);
+    RUN_TEST(TestMalformedInputRejected);
+    RUN_TEST(TestFuzzDecode);
+#ifndef _WIN32
+    RUN_TEST(TestFuzzServer);
+#endif
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+// 限速测试：令牌桶按速率补充且不超过容量，各客户端的令牌桶互不影响，全局令牌不足时不消耗客户端令牌；
+// 服务器过载时持续请求的客户端收到“忙”和重试时间，同时正常速率的客户端不被拒绝且延迟有界。
+// 过载测试以本程序的另一个进程作为过快的客户端，经由Unix域套接字
+
+#include "TestUtil.h"
+#include "IPCManager.h"
+#include "IPCRateLimiter.h"
+#include <algorithm>
+#include <chrono>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+namespace {
+
+uint64_t NowMicroseconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void TestRefill() {
+    IPCRateLimiter limiter;
+    limiter.Configure(IPCRateLimit(100, 5), IPCRateLimit());
+    
+    // 初始为满桶，用完后拒绝，重试时间为补足一个令牌所需的时间
+    DWORD retryAfterMs = 0;
+    for (int i = 0; i < 5; ++i) {
+        CHECK(limiter.TryAcquire(1, retryAfterMs) && retryAfterMs == 0);
+    }
+    CHECK(!limiter.TryAcquire(1, retryAfterMs));
+    CHECK(retryAfterMs > 0 && retryAfterMs <= 10);
+    
+    // 等待期间按每秒100个补充，但不超过容量5
+    Sleep(200);
+    for (int i = 0; i < 5; ++i) {
+        CHECK(limiter.TryAcquire(1, retryAfterMs));
+    }
+    CHECK(!limiter.TryAcquire(1, retryAfterMs));
+    
+    // 批量请求按命令数消耗，超过容量的请求永远无法接受
+    Sleep(100);
+    CHECK(limiter.GetMaxTokens() == 5);
+    CHECK(limiter.TryAcquire(1, 5, retryAfterMs));
+    CHECK(!limiter.TryAcquire(1, 3, retryAfterMs) && retryAfterMs >= 20);
+    
+    // 不限速时总是接受
+    limiter.Configure(IPCRateLimit(), IPCRateLimit());
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(limiter.TryAcquire(1, retryAfterMs));
+    }
+}
+
+void TestClientIsolation() {
+    IPCRateLimiter limiter;
+    limiter.Configure(IPCRateLimit(1, 3), IPCRateLimit());
+    
+    DWORD retryAfterMs = 0;
+    while (limiter.TryAcquire(100, retryAfterMs)) {
+    }
+    
+    // 其他进程和按连接分配键的客户端各有独立的令牌桶，不受耗尽令牌的客户端影响
+    const uint64_t keys[] = { 200, (1ull << 32) | 1, (1ull << 32) | 2 };
+    for (uint64_t key : keys) {
+        for (int i = 0; i < 3; ++i) {
+            CHECK(limiter.TryAcquire(key, retryAfterMs));
+        }
+        CHECK(!limiter.TryAcquire(key, retryAfterMs));
+    }
+    CHECK(!limiter.TryAcquire(100, retryAfterMs) && retryAfterMs > 0);
+}
+
+void TestGlobalLimit() {
+    IPCRateLimiter limiter;
+    limiter.Configure(IPCRateLimit(1, 3), IPCRateLimit(1, 4));
+    
+    // 全局令牌被其他客户端用完后，被拒绝的请求不消耗客户端令牌
+    DWORD retryAfterMs = 0;
+    for (DWORD client = 1; client <= 4; ++client) {
+        CHECK(limiter.TryAcquire(client, retryAfterMs));
+    }
+    for (int i = 0; i < 10; ++i) {
+        CHECK(!limiter.TryAcquire(5, retryAfterMs) && retryAfterMs > 0);
+    }
+    
+    limiter.Configure(IPCRateLimit(1, 3), IPCRateLimit(1000, 100));
+    for (int i = 0; i < 3; ++i) {
+        CHECK(limiter.TryAcquire(5, retryAfterMs));
+    }
+    CHECK(!limiter.TryAcquire(5, retryAfterMs));
+}
+
+#ifndef _WIN32
+const int kFloodMs = 1500;
+
+WString GetTestPipeName(DWORD processId) {
+    return L"\\\\.\\pipe\\WlmIpcRateLimiterTest." + std::to_wstring(processId);
+}
+
+// 过快的客户端：在kFloodMs内不断发送请求，收到带重试时间的“忙”时退出码为0
+int RunFlooder(DWORD serverProcessId) {
+    IPCClient client;
+    if (!client.Connect(GetTestPipeName(serverProcessId))) {
+        return 2;
+    }
+    
+    int accepted = 0;
+    int busy = 0;
+    ULONGLONG start = GetTickCount64();
+    while (GetTickCount64() - start < kFloodMs) {
+        IPCResult result;
+        if (!client.Call(IPCRequest(IPCOpcode::QueryServiceStatus), result)) {
+            return 3;
+        }
+        if (result.status == IPCStatus::Busy && result.error == ErrorCode::ServerBusy && result.retryAfterMs > 0) {
+            busy++;
+        } else if (result.status == IPCStatus::Ok) {
+            accepted++;
+        }
+    }
+    
+    printf("    flooder: %d accepted, %d busy\n", accepted, busy);
+    return busy > 0 ? 0 : 1;
+}
+
+void TestFloodingClient() {
+    IPCManager server;
+    IPCServerConfig config;
+    config.instanceCount = 4;
+    config.clientRateLimit = IPCRateLimit(200, 50);
+    config.responseCacheTtlMs = 0;
+    server.SetPipeName(GetTestPipeName(GetCurrentProcessId()));
+    server.SetServerConfig(config);
+    CHECK(server.StartServer([](const IPCRequest&) { return IPCResult(IPCStatus::Ok, ErrorCode::Success); }));
+    
+    // 以另一个进程运行过快的客户端，与本进程的客户端使用不同的令牌桶
+    String serverId = std::to_string(GetCurrentProcessId());
+    pid_t flooder = fork();
+    if (flooder == 0) {
+        execl("/proc/self/exe", "IPCRateLimiterTest", "--flood", serverId.c_str(), static_cast<char*>(nullptr));
+        _exit(4);
+    }
+    CHECK(flooder > 0);
+    
+    // 正常客户端每10毫秒一个请求，低于限速，全部被接受
+    IPCClient client;
+    CHECK(client.Connect(GetTestPipeName(GetCurrentProcessId())));
+    std::vector<uint64_t> latencies;
+    int rejected = 0;
+    ULONGLONG start = GetTickCount64();
+    while (GetTickCount64() - start < kFloodMs) {
+        IPCResult result;
+        uint64_t begin = NowMicroseconds();
+        CHECK(client.Call(IPCRequest(IPCOpcode::QueryServiceStatus), result));
+        latencies.push_back(NowMicroseconds() - begin);
+        rejected += result.status != IPCStatus::Ok;
+        Sleep(10);
+    }
+    
+    int status = 0;
+    CHECK(waitpid(flooder, &status, 0) == flooder && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    CHECK(rejected == 0);
+    
+    std::sort(latencies.begin(), latencies.end());
+    uint64_t p50 = latencies[latencies.size() / 2];
+    uint64_t p99 = latencies[latencies.size() * 99 / 100];
+    printf("    normal client: %zu requests, p50 %llu us, p99 %llu us, max %llu us\n", latencies.size(),
+           static_cast<unsigned long long>(p50), static_cast<unsigned long long>(p99),
+           static_cast<unsigned long long>(latencies.back()));
+    
+    // 宽松的上限，只用于发现正常客户端被过快的客户端拖慢或拒绝
+    CHECK(p99 < 50000);
+    
+    client.Disconnect();
+    server.StopServer();
+}
+#endif
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+
+#ifndef _WIN32
+    if (argc > 2 && String(argv[1]) == "--flood") {
+        int code = RunFlooder(static_cast<DWORD>(strtoul(argv[2], nullptr, 10)));
+        Logger::Shutdown();
+        return code;
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+    
+    RUN_TEST(TestRefill);
+    RUN_TEST(TestClientIsolation);
+    RUN_TEST(TestGlobalLimit);
+#ifndef _WIN32
+    RUN_TEST(TestFloodingClient);
+#endif
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
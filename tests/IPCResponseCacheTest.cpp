@@ -0,0 +1,214 @@
+// 响应缓存测试：并发的相同查询只执行一次，其余调用共享结果；TTL过期后重新查询；
+// 查询期间调用Invalidate时结果不写入缓存，之后的调用重新查询；查询函数抛出异常时等待者收到失败结果
+
+#include "TestUtil.h"
+#include "IPCResponseCache.h"
+#include "Logger.h"
+#include <condition_variable>
+#include <stdexcept>
+
+namespace {
+
+const int kThreads = 16;
+
+template <typename Condition>
+bool WaitFor(Condition condition, DWORD timeoutMs) {
+    ULONGLONG start = GetTickCount64();
+    while (!condition()) {
+        if (GetTickCount64() - start > timeoutMs) {
+            return false;
+        }
+        Sleep(1);
+    }
+    return true;
+}
+
+// 阻塞查询直到Open被调用
+class Gate {
+public:
+    Gate() : m_open(false) {}
+    
+    void Wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_opened.wait(lock, [this]() { return m_open; });
+    }
+    
+    void Open() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_open = true;
+        m_opened.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_opened;
+    bool m_open;
+};
+
+void TestConcurrentQueriesCoalesce() {
+    IPCResponseCache cache;
+    cache.Configure(60000);
+    
+    // 查询函数等到其余线程都在等待它时才返回
+    std::atomic<int> loads(0);
+    auto loader = [&]() {
+        loads++;
+        WaitFor([&]() { return cache.GetStats().coalesced == kThreads - 1; }, 5000);
+        return IPCResult(IPCStatus::Ok, ErrorCode::Success, "Running");
+    };
+    
+    std::atomic<int> matched(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&]() {
+            IPCResult result = cache.Get(IPCOpcode::QueryServiceStatus, loader);
+            matched += result.IsOk() && result.message == "Running";
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    IPCCacheStats stats = cache.GetStats();
+    CHECK(loads == 1);
+    CHECK(matched == kThreads);
+    CHECK(stats.misses == 1);
+    CHECK(stats.coalesced == kThreads - 1);
+    CHECK(stats.hits == 0);
+    
+    // 结果已缓存，不同的操作码各自缓存
+    CHECK(cache.Get(IPCOpcode::QueryServiceStatus, loader).message == "Running");
+    CHECK(loads == 1 && cache.GetStats().hits == 1);
+    cache.Get(IPCOpcode::QueryWinlogonStatus, []() { return IPCResult(IPCStatus::Ok, ErrorCode::Success); });
+    CHECK(cache.GetStats().misses == 2);
+}
+
+void TestReloadAfterTtl() {
+    IPCResponseCache cache;
+    cache.Configure(50);
+    
+    std::atomic<int> loads(0);
+    auto loader = [&]() {
+        return IPCResult(IPCStatus::Ok, ErrorCode::Success, std::to_string(++loads));
+    };
+    
+    CHECK(cache.Get(IPCOpcode::QueryServiceStatus, loader).message == "1");
+    CHECK(cache.Get(IPCOpcode::QueryServiceStatus, loader).message == "1");
+    Sleep(80);
+    CHECK(cache.Get(IPCOpcode::QueryServiceStatus, loader).message == "2");
+    CHECK(loads == 2);
+    
+    // TTL为0时不缓存
+    cache.Configure(0);
+    CHECK(cache.Get(IPCOpcode::QueryServiceStatus, loader).message == "3");
+    CHECK(cache.Get(IPCOpcode::QueryServiceStatus, loader).message == "4");
+    IPCCacheStats stats = cache.GetStats();
+    CHECK(stats.hits == 0 && stats.misses == 2);
+}
+
+void TestInvalidateDuringLoad() {
+    IPCResponseCache cache;
+    cache.Configure(60000);
+    
+    // 第一个查询执行期间状态改变
+    Gate gate;
+    std::atomic<bool> loading(false);
+    std::atomic<int> loads(0);
+    IPCResult stale;
+    std::thread first([&]() {
+        stale = cache.Get(IPCOpcode::QueryServiceStatus, [&]() {
+            loads++;
+            loading = true;
+            gate.Wait();
+            return IPCResult(IPCStatus::Ok, ErrorCode::Success, "Stopped");
+        });
+    });
+    CHECK(WaitFor([&]() { return loading.load(); }, 5000));
+    cache.Invalidate();
+    
+    // 之后的调用不等待旧查询，而是重新查询，结果写入缓存
+    auto loader = [&]() {
+        loads++;
+        return IPCResult(IPCStatus::Ok, ErrorCode::Success, "Running");
+    };
+    CHECK(cache.Get(IPCOpcode::QueryServiceStatus, loader).message == "Running");
+    CHECK(loads == 2);
+    
+    // 旧查询的结果只返回给它的调用者，不覆盖缓存
+    gate.Open();
+    first.join();
+    CHECK(stale.message == "Stopped");
+    CHECK(cache.Get(IPCOpcode::QueryServiceStatus, loader).message == "Running");
+    CHECK(loads == 2);
+    
+    // 只有旧查询在执行时调用Invalidate，结果同样不写入缓存
+    Gate second;
+    loading = false;
+    std::thread third([&]() {
+        cache.Get(IPCOpcode::QueryWinlogonStatus, [&]() {
+            loading = true;
+            second.Wait();
+            return IPCResult(IPCStatus::Ok, ErrorCode::Success, "Stale");
+        });
+    });
+    CHECK(WaitFor([&]() { return loading.load(); }, 5000));
+    cache.Invalidate();
+    second.Open();
+    third.join();
+    CHECK(cache.Get(IPCOpcode::QueryWinlogonStatus, loader).message == "Running");
+    CHECK(cache.Get(IPCOpcode::QueryServiceStatus, loader).message == "Running");
+    CHECK(loads == 4);
+}
+
+void TestLoaderFailure() {
+    IPCResponseCache cache;
+    cache.Configure(60000);
+    
+    // 执行查询的线程收到异常，等待它的线程收到失败结果而不是永远阻塞
+    auto loader = [&]() -> IPCResult {
+        WaitFor([&]() { return cache.GetStats().coalesced == kThreads - 1; }, 5000);
+        throw std::runtime_error("backend unavailable");
+    };
+    
+    std::atomic<int> thrown(0);
+    std::atomic<int> failed(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&]() {
+            try {
+                IPCResult result = cache.Get(IPCOpcode::QueryServiceStatus, loader);
+                failed += result.status == IPCStatus::Failed && result.error == ErrorCode::UnknownError;
+            } catch (const std::runtime_error&) {
+                thrown++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(thrown == 1);
+    CHECK(failed == kThreads - 1);
+    
+    // 失败结果不写入缓存
+    int loads = 0;
+    IPCResult result = cache.Get(IPCOpcode::QueryServiceStatus, [&]() {
+        loads++;
+        return IPCResult(IPCStatus::Ok, ErrorCode::Success);
+    });
+    CHECK(result.IsOk() && loads == 1);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestConcurrentQueriesCoalesce);
+    RUN_TEST(TestReloadAfterTtl);
+    RUN_TEST(TestInvalidateDuringLoad);
+    RUN_TEST(TestLoaderFailure);
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+// IPC服务器测试：多个客户端同时连接时并行处理，客户端多于实例时排队等待，停止后可重新启动。
+// Linux上经由Unix域套接字和epoll传输，Windows上为命名管道和完成端口
+
+#include "TestUtil.h"
+#include "IPCManager.h"
+
+namespace {
+
+WString GetTestPipeName() {
+    return L"\\\\.\\pipe\\WlmIpcServerTest." + std::to_wstring(GetCurrentProcessId());
+}
+
+// 不限速，测试只关心传输
+IPCServerConfig GetTestConfig(DWORD instanceCount) {
+    IPCServerConfig config;
+    config.instanceCount = instanceCount;
+    config.workerCount = 4;
+    config.clientRateLimit = IPCRateLimit();
+    config.maxQueuedCommands = 4096;
+    config.responseCacheTtlMs = 0;
+    return config;
+}
+
+bool StartServer(IPCManager& server, DWORD instanceCount, std::atomic<int>& handled) {
+    server.SetPipeName(GetTestPipeName());
+    server.SetServerConfig(GetTestConfig(instanceCount));
+    return server.StartServer([&handled](const IPCRequest& request) {
+        handled++;
+        return IPCResult(IPCStatus::Ok, ErrorCode::Success, IPCProtocol::GetOpcodeName(request.opcode));
+    });
+}
+
+void TestConcurrentSessions() {
+    std::atomic<int> handled(0);
+    IPCManager server;
+    CHECK(StartServer(server, 8, handled));
+    
+    // 每个线程一个持久会话，每次流水线发出一组请求再逐个等待响应
+    const int kClients = 8;
+    const int kRequests = 200;
+    std::atomic<int> completed(0);
+    std::vector<std::thread> clients;
+    for (int c = 0; c < kClients; ++c) {
+        clients.emplace_back([&completed]() {
+            IPCClient client;
+            if (!client.Connect(GetTestPipeName())) {
+                return;
+            }
+            
+            for (int n = 0; n < kRequests; n += 10) {
+                std::vector<uint32_t> ids(10);
+                for (uint32_t& id : ids) {
+                    client.Send("--help", id);
+                }
+                for (uint32_t id : ids) {
+                    String response;
+                    if (client.Receive(id, response) && response == "Command executed successfully: --help") {
+                        completed++;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : clients) {
+        thread.join();
+    }
+    
+    CHECK(completed == kClients * kRequests);
+    CHECK(handled == kClients * kRequests);
+    server.StopServer();
+}
+
+void TestMoreClientsThanInstances() {
+    std::atomic<int> handled(0);
+    IPCManager server;
+    CHECK(StartServer(server, 2, handled));
+    
+    // 一次性请求在实例全忙时排队，等到前面的连接断开后得到服务
+    const int kClients = 16;
+    const int kRequests = 20;
+    std::atomic<int> completed(0);
+    std::vector<std::thread> clients;
+    for (int c = 0; c < kClients; ++c) {
+        clients.emplace_back([&completed]() {
+            IPCManager client;
+            client.SetPipeName(GetTestPipeName());
+            for (int n = 0; n < kRequests; ++n) {
+                IPCResult result;
+                if (client.SendRequest(IPCRequest(IPCOpcode::QueryServiceStatus), result) && result.IsOk() &&
+                    result.message == "QueryServiceStatus") {
+                    completed++;
+                }
+            }
+        });
+    }
+    for (auto& thread : clients) {
+        thread.join();
+    }
+    
+    CHECK(completed == kClients * kRequests);
+    server.StopServer();
+}
+
+void TestRestart() {
+    std::atomic<int> handled(0);
+    IPCManager server;
+    CHECK(StartServer(server, 4, handled));
+    
+    // 停止时已连接的客户端收到断开，重新启动后新连接正常
+    IPCClient client;
+    String response;
+    CHECK(client.Connect(GetTestPipeName()));
+    CHECK(client.Request("--help", response));
+    server.StopServer();
+    CHECK(!client.Request("--help", response));
+    
+    CHECK(StartServer(server, 4, handled));
+    CHECK(client.Connect(GetTestPipeName()));
+    CHECK(client.Request("--help", response));
+    CHECK(response == "Command executed successfully: --help");
+    client.Disconnect();
+    server.StopServer();
+    
+    // 服务器停止后连接立即失败
+    CHECK(!client.Connect(GetTestPipeName(), 100));
+}
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestConcurrentSessions);
+    RUN_TEST(TestMoreClientsThanInstances);
+    RUN_TEST(TestRestart);
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
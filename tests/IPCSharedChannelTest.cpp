@@ -0,0 +1,176 @@
+// 共享内存通道测试：超过环容量的数据分段传输，名称冲突和不存在的通道被拒绝，
+// 经服务器协商后请求和大响应走共享内存，服务器停止或对端进程退出时等待方不会挂起。
+// Linux上为shm_open加futex，Windows上为文件映射加命名事件
+
+#include "TestUtil.h"
+#include "IPCManager.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+namespace {
+
+String GetChannelName(const char* suffix) {
+#ifdef _WIN32
+    String name = "Local\\WlmIpcSharedTest.";
+#else
+    String name = "/WlmIpcSharedTest.";
+#endif
+    return name + std::to_string(GetCurrentProcessId()) + "." + suffix;
+}
+
+WString GetTestPipeName() {
+    return L"\\\\.\\pipe\\WlmIpcSharedTest." + std::to_wstring(GetCurrentProcessId());
+}
+
+String MakePayload(size_t size) {
+    String payload(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+    return payload;
+}
+
+void TestRingTransfersMoreThanCapacity() {
+    IPCSharedChannel server;
+    IPCSharedChannel client;
+    CHECK(server.Create(GetChannelName("ring"), IPCSharedChannel::kMinCapacity));
+    CHECK(client.Open(server.GetName()));
+    
+    // 写入方不断被环的容量阻塞，读取方腾出空间后继续
+    const String payload = MakePayload(4 * 1024 * 1024 + 17);
+    std::thread writer([&client, &payload]() {
+        client.GetRequestRing().Write(payload.c_str(), payload.length(), 5000);
+    });
+    
+    String received;
+    char buffer[10000];
+    while (received.length() < payload.length()) {
+        size_t size = server.GetRequestRing().Read(buffer, sizeof(buffer), 5000);
+        if (size == 0) {
+            break;
+        }
+        received.append(buffer, size);
+    }
+    writer.join();
+    CHECK(received == payload);
+    
+    // 关闭一端后另一端的读取立即返回
+    client.Close();
+    CHECK(server.IsClosed());
+    CHECK(server.GetRequestRing().Read(buffer, sizeof(buffer), INFINITE) == 0);
+}
+
+void TestInvalidChannelsRejected() {
+    IPCSharedChannel channel;
+    CHECK(!channel.Open(GetChannelName("missing")));
+    
+    // 同名通道已存在时创建失败，不会接管他人的映射
+    IPCSharedChannel first;
+    IPCSharedChannel second;
+    CHECK(first.Create(GetChannelName("taken"), IPCSharedChannel::kMinCapacity));
+    CHECK(!second.Create(GetChannelName("taken"), IPCSharedChannel::kMinCapacity));
+    
+    // 创建者关闭后名称不再可用
+    first.Close();
+    CHECK(!channel.Open(GetChannelName("taken")));
+}
+
+IPCResult HandleRequest(const IPCRequest& request) {
+    return IPCResult(IPCStatus::Ok, ErrorCode::Success, MakePayload(request.processId));
+}
+
+bool StartServer(IPCManager& server) {
+    IPCServerConfig config;
+    config.clientRateLimit = IPCRateLimit();
+    config.responseCacheTtlMs = 0;
+    server.SetPipeName(GetTestPipeName());
+    server.SetServerConfig(config);
+    return server.StartServer(HandleRequest);
+}
+
+void TestSessionOverServer() {
+    IPCManager server;
+    CHECK(StartServer(server));
+    
+    IPCClient client;
+    CHECK(client.Connect(GetTestPipeName()));
+    CHECK(client.EnableSharedMemory(IPCSharedChannel::kMinCapacity));
+    CHECK(client.IsSharedMemoryEnabled());
+    
+    int completed = 0;
+    for (int n = 0; n < 1000; ++n) {
+        IPCRequest request(IPCOpcode::QueryServiceStatus);
+        request.processId = static_cast<DWORD>(n);
+        IPCResult result;
+        if (client.Call(request, result) && result.message == MakePayload(n)) {
+            completed++;
+        }
+    }
+    CHECK(completed == 1000);
+    
+    // 响应远大于环容量时分段传输
+    IPCRequest large(IPCOpcode::QueryServiceStatus);
+    large.processId = 2 * 1024 * 1024;
+    IPCResult result;
+    CHECK(client.Call(large, result) && result.message == MakePayload(large.processId));
+    
+    String response;
+    CHECK(client.Request("--help", response) && response == "Command executed successfully: --help");
+    
+    // 断开后会话结束，新的客户端可以再次协商
+    client.Disconnect();
+    IPCClient another;
+    CHECK(another.Connect(GetTestPipeName()) && another.EnableSharedMemory());
+    CHECK(another.Request("--help", response));
+    
+    server.StopServer();
+    
+    // 服务器停止后等待响应的客户端立即失败，而不是挂起
+    CHECK(!another.Request("--help", response));
+}
+
+#ifndef _WIN32
+void TestPeerExitEndsWait() {
+    IPCSharedChannel channel;
+    CHECK(channel.Create(GetChannelName("peer"), IPCSharedChannel::kMinCapacity));
+    
+    pid_t child = fork();
+    if (child == 0) {
+        usleep(200 * 1000);
+        _exit(0);
+    }
+    CHECK(child > 0);
+    
+    // 没有任何写入，等待在对端进程退出后结束
+    IPCPeerProcess peer = IPCSharedChannel::OpenPeerProcess(static_cast<DWORD>(child));
+    CHECK(peer != kNoPeerProcess);
+    char buffer[64];
+    ULONGLONG start = GetTickCount64();
+    CHECK(channel.GetRequestRing().Read(buffer, sizeof(buffer), 10000, peer) == 0);
+    CHECK(GetTickCount64() - start < 5000);
+    
+    IPCSharedChannel::ClosePeerProcess(peer);
+    CHECK(peer == kNoPeerProcess);
+    waitpid(child, nullptr, 0);
+}
+#endif
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestRingTransfersMoreThanCapacity);
+    RUN_TEST(TestInvalidChannelsRejected);
+    RUN_TEST(TestSessionOverServer);
+#ifndef _WIN32
+    RUN_TEST(TestPeerExitEndsWait);
+#endif
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
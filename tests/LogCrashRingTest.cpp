@@ -0,0 +1,128 @@
+// 崩溃日志测试：写入进程被强制杀死后，logrecover能从映射文件中取出最后的记录
+// logrecover的路径由CMake通过WLM_LOGRECOVER_PATH传入
+
+#include "TestUtil.h"
+#include "Logger.h"
+#include "LogCrashRing.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 调用logrecover取出最近的记录，返回每行最后一个 "] " 之后的消息
+std::vector<String> Recover(const std::filesystem::path& path, size_t count) {
+    std::filesystem::path output = path.string() + ".txt";
+    String command = String("\"") + WLM_LOGRECOVER_PATH + "\" \"" + path.string() + "\" " +
+                     std::to_string(count) + " > \"" + output.string() + "\"";
+    if (std::system(command.c_str()) != 0) {
+        return std::vector<String>();
+    }
+    
+    std::vector<String> messages;
+    for (const auto& line : TestUtil::ReadLines(output)) {
+        size_t pos = line.rfind("] ");
+        if (pos != String::npos) {
+            messages.push_back(line.substr(pos + 2));
+        }
+    }
+    return messages;
+}
+
+// 检查消息依次为 "n<first>" ... "n<first + count - 1>"
+bool IsSequence(const std::vector<String>& messages, int first, int count) {
+    if (messages.size() != static_cast<size_t>(count)) {
+        return false;
+    }
+    for (int n = 0; n < count; ++n) {
+        if (messages[n] != "n" + std::to_string(first + n)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AppendLines(LogCrashRing& ring, int first, int count) {
+    for (int n = first; n < first + count; ++n) {
+        String message = "n" + std::to_string(n);
+        ring.Append(LogLevel::Info, message.c_str(), message.length(), "", 0);
+    }
+}
+
+void TestReopenKeepsRecords() {
+    std::filesystem::path path = TestUtil::GetTempDir("crashring") / "reopen.ring";
+    
+    LogCrashRing ring;
+    CHECK(ring.Open(path.string(), 64 * 1024));
+    AppendLines(ring, 0, 50);
+    ring.Close();
+    
+    // 容量相同时继续追加，上次运行的记录仍可取出
+    CHECK(ring.Open(path.string(), 64 * 1024));
+    AppendLines(ring, 50, 50);
+    ring.Flush();
+    ring.Close();
+    
+    CHECK(IsSequence(Recover(path, 1000), 0, 100));
+}
+
+void TestWrapKeepsNewestRecords() {
+    std::filesystem::path path = TestUtil::GetTempDir("crashring") / "wrap.ring";
+    
+    // 写入量远超64KB的数据区，只有最近一圈的记录保留
+    LogCrashRing ring;
+    CHECK(ring.Open(path.string(), 64 * 1024));
+    AppendLines(ring, 0, 20000);
+    ring.Close();
+    
+    std::vector<String> messages = Recover(path, 100000);
+    CHECK(messages.size() > 100 && messages.size() < 20000);
+    if (!messages.empty()) {
+        int first = 20000 - static_cast<int>(messages.size());
+        CHECK(IsSequence(messages, first, static_cast<int>(messages.size())));
+    }
+}
+
+#ifndef _WIN32
+void TestRecoverAfterKill() {
+    std::filesystem::path path = TestUtil::GetTempDir("crashring") / "killed.ring";
+    const int kLines = 500;
+    
+    pid_t child = fork();
+    if (child == 0) {
+        // 未写日志文件，队列中尚未输出的记录在进程被杀死后只存在于崩溃日志中
+        Logger::SetCrashLog(true, path.string(), 256 * 1024);
+        Logger::SetAsyncMode(true, 8192, LogOverflowPolicy::Block, LogQueueMode::Shared);
+        for (int n = 0; n < kLines; ++n) {
+            Logger::Log(LogLevel::Info, "n%d", n);
+        }
+        raise(SIGKILL);
+        _exit(0);
+    }
+    CHECK(child > 0);
+    
+    int status = 0;
+    CHECK(waitpid(child, &status, 0) == child);
+    CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL);
+    CHECK(IsSequence(Recover(path, 1000), 0, kLines));
+}
+#endif
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestReopenKeepsRecords);
+    RUN_TEST(TestWrapKeepsNewestRecords);
+#ifndef _WIN32
+    RUN_TEST(TestRecoverAfterKill);
+#endif
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
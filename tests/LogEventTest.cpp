@@ -0,0 +1,98 @@
+// 结构化日志测试：三种输出格式下事件行的内容，以及同步和异步模式的输出一致
+
+#include "TestUtil.h"
+#include "Logger.h"
+
+namespace {
+
+// 去掉时间戳后的行内容，时间戳在行首（文本格式）或ts字段中
+String StripTimestamp(const String& line, LogOutputFormat format) {
+    switch (format) {
+        case LogOutputFormat::JsonLines: {
+            size_t end = line.find("\",\"level\"");
+            return end == String::npos ? line : "{" + line.substr(end + 2);
+        }
+        case LogOutputFormat::Logfmt: {
+            size_t end = line.find(" level=");
+            return end == String::npos ? line : line.substr(end + 1);
+        }
+        default: {
+            size_t end = line.find(" [");
+            return end == String::npos ? line : line.substr(end + 1);
+        }
+    }
+}
+
+std::vector<String> LogEvents(LogOutputFormat format, bool async, const char* name) {
+    std::filesystem::path path = TestUtil::GetTempDir("event") / name;
+    Logger::SetOutputFormat(format);
+    Logger::SetLogToFile(true, path.string(), LogFlushPolicy::EveryBytes(64 * 1024));
+    if (async) {
+        CHECK(Logger::SetAsyncMode(true, 64, LogOverflowPolicy::Block, LogQueueMode::Shared));
+    }
+    
+    const WString processName = L"winlogon.exe";
+    Logger::Event("process.suspend").With("pid", 612).With("name", processName).With("ok", true);
+    Logger::Event(LogLevel::Warning, "ipc.busy").With("retryMs", 250u).With("load", 0.5)
+        .With("client", "a \"quoted\" value");
+    Logger::Event("empty");
+    Logger::Flush();
+    
+    Logger::SetAsyncMode(false);
+    Logger::SetLogToFile(false);
+    Logger::SetOutputFormat(LogOutputFormat::Text);
+    
+    std::vector<String> lines;
+    for (const auto& line : TestUtil::ReadLines(path)) {
+        lines.push_back(StripTimestamp(line, format));
+    }
+    return lines;
+}
+
+void TestJsonLines() {
+    std::vector<String> lines = LogEvents(LogOutputFormat::JsonLines, false, "json.log");
+    CHECK(lines.size() == 3);
+    if (lines.size() != 3) {
+        return;
+    }
+    CHECK(lines[0] == "{\"level\":\"INFO\",\"msg\":\"process.suspend\",\"pid\":612,\"name\":\"winlogon.exe\",\"ok\":true}");
+    CHECK(lines[1] == "{\"level\":\"WARN\",\"msg\":\"ipc.busy\",\"retryMs\":250,\"load\":0.5,"
+                      "\"client\":\"a \\\"quoted\\\" value\"}");
+    CHECK(lines[2] == "{\"level\":\"INFO\",\"msg\":\"empty\"}");
+}
+
+void TestLogfmt() {
+    std::vector<String> lines = LogEvents(LogOutputFormat::Logfmt, false, "logfmt.log");
+    CHECK(lines.size() == 3);
+    if (lines.size() != 3) {
+        return;
+    }
+    CHECK(lines[0] == "level=INFO msg=process.suspend pid=612 name=winlogon.exe ok=true");
+    CHECK(lines[1] == "level=WARN msg=ipc.busy retryMs=250 load=0.5 client=\"a \\\"quoted\\\" value\"");
+    CHECK(lines[2] == "level=INFO msg=empty");
+}
+
+void TestAsyncMatchesSync() {
+    // 同步模式直接从事件缓冲格式化，异步模式经队列中的记录格式化，两者输出须相同
+    const LogOutputFormat formats[] = { LogOutputFormat::Text, LogOutputFormat::JsonLines, LogOutputFormat::Logfmt };
+    for (LogOutputFormat format : formats) {
+        std::vector<String> sync = LogEvents(format, false, "sync.log");
+        std::vector<String> async = LogEvents(format, true, "async.log");
+        CHECK(sync.size() == 3);
+        CHECK(sync == async);
+    }
+}
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestJsonLines);
+    RUN_TEST(TestLogfmt);
+    RUN_TEST(TestAsyncMatchesSync);
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
@@ -0,0 +1,427 @@
+// 日志系统测试：同步与异步模式下的写出完整性、溢出策略（丢弃最新或最旧）和各线程内的顺序
+
+#include "TestUtil.h"
+#include "Logger.h"
+#include "LogFileSink.h"
+#include <fstream>
+#include <map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef WLM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+const int kThreads = 8;
+const int kLinesPerThread = 5000;
+
+struct ParsedLines {
+    size_t total;
+    bool ordered;  // 每个线程的序号在文件中严格递增
+    std::map<int, int> counts;
+    
+    ParsedLines() : total(0), ordered(true) {}
+};
+
+// 解析 "... [INFO] t<线程> n<序号>" 形式的行
+ParsedLines ParseLines(const std::filesystem::path& path) {
+    ParsedLines result;
+    std::map<int, int> last;
+    for (const auto& line : TestUtil::ReadLines(path)) {
+        size_t pos = line.find("] t");
+        int thread = 0;
+        int sequence = 0;
+        if (pos == String::npos || sscanf(line.c_str() + pos + 2, "t%d n%d", &thread, &sequence) != 2) {
+            continue;
+        }
+        
+        auto it = last.find(thread);
+        if (it != last.end() && sequence <= it->second) {
+            result.ordered = false;
+        }
+        last[thread] = sequence;
+        result.counts[thread]++;
+        result.total++;
+    }
+    return result;
+}
+
+void LogFromThreads(int threadCount, int linesPerThread) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([t, linesPerThread]() {
+            for (int n = 0; n < linesPerThread; ++n) {
+                Logger::Log(LogLevel::Info, "t%d n%d", t, n);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+std::filesystem::path StartFileLog(const char* name) {
+    std::filesystem::path path = TestUtil::GetTempDir("logger") / name;
+    Logger::SetLogToFile(true, path.string(), LogFlushPolicy::EveryBytes(64 * 1024));
+    return path;
+}
+
+void StopFileLog() {
+    Logger::SetAsyncMode(false);
+    Logger::SetLogToFile(false);
+}
+
+void TestSyncWritesEveryLine() {
+    std::filesystem::path path = TestUtil::GetTempDir("logger") / "sync.log";
+    Logger::SetLogToFile(true, path.string(), LogFlushPolicy::EveryLine());
+    
+    for (int n = 0; n < 100; ++n) {
+        Logger::Log(LogLevel::Info, "t0 n%d", n);
+    }
+    
+    // 每行落盘策略下无需Flush即可读到全部内容
+    ParsedLines lines = ParseLines(path);
+    CHECK(lines.total == 100);
+    CHECK(lines.ordered);
+    StopFileLog();
+}
+
+void TestSyncIntervalFlushWithoutFurtherWrites() {
+    std::filesystem::path path = TestUtil::GetTempDir("logger") / "interval.log";
+    Logger::SetLogToFile(true, path.string(), LogFlushPolicy::EveryInterval(50));
+    
+    for (int n = 0; n < 10; ++n) {
+        Logger::Log(LogLevel::Info, "t0 n%d", n);
+    }
+    
+    // 之后不再写日志，缓冲仍应在若干个间隔内由定时线程落盘
+    size_t total = 0;
+    for (int wait = 0; wait < 100 && total < 10; ++wait) {
+        Sleep(20);
+        total = ParseLines(path).total;
+    }
+    CHECK(total == 10);
+    StopFileLog();
+}
+
+void TestAsyncBlockKeepsEveryLine() {
+    std::filesystem::path path = StartFileLog("block.log");
+    uint64_t droppedBefore = Logger::GetDroppedCount();
+    
+    // 很小的队列让生产线程频繁因队列满而阻塞
+    CHECK(Logger::SetAsyncMode(true, 16, LogOverflowPolicy::Block, LogQueueMode::Shared));
+    LogFromThreads(kThreads, kLinesPerThread);
+    Logger::Flush();
+    StopFileLog();
+    
+    ParsedLines lines = ParseLines(path);
+    CHECK(lines.total == static_cast<size_t>(kThreads * kLinesPerThread));
+    CHECK(lines.ordered);
+    CHECK(Logger::GetDroppedCount() == droppedBefore);
+}
+
+void TestAsyncPerThreadKeepsOrder() {
+    std::filesystem::path path = StartFileLog("perthread.log");
+    
+    CHECK(Logger::SetAsyncMode(true, 64, LogOverflowPolicy::Block, LogQueueMode::PerThread));
+    LogFromThreads(kThreads, kLinesPerThread);
+    Logger::Flush();
+    StopFileLog();
+    
+    ParsedLines lines = ParseLines(path);
+    CHECK(lines.total == static_cast<size_t>(kThreads * kLinesPerThread));
+    CHECK(lines.ordered);
+    for (int t = 0; t < kThreads; ++t) {
+        CHECK(lines.counts[t] == kLinesPerThread);
+    }
+}
+
+void TestAsyncDropNewestCountsDrops() {
+    std::filesystem::path path = StartFileLog("drop.log");
+    uint64_t droppedBefore = Logger::GetDroppedCount();
+    
+    CHECK(Logger::SetAsyncMode(true, 16, LogOverflowPolicy::DropNewest, LogQueueMode::Shared));
+    LogFromThreads(kThreads, kLinesPerThread);
+    Logger::Flush();
+    StopFileLog();
+    
+    // 写出的行与丢弃计数之和等于提交的总数，保留下来的行仍按线程有序
+    ParsedLines lines = ParseLines(path);
+    uint64_t dropped = Logger::GetDroppedCount() - droppedBefore;
+    CHECK(lines.total + dropped == static_cast<uint64_t>(kThreads * kLinesPerThread));
+    CHECK(lines.ordered);
+}
+
+#ifndef _WIN32
+void TestAsyncDropOldestKeepsNewest() {
+    // 日志写入没有读端消费的命名管道，管道缓冲写满后写线程阻塞，队列随即写满
+    std::filesystem::path path = TestUtil::GetTempDir("logger") / "drop_oldest.fifo";
+    CHECK(mkfifo(path.c_str(), 0600) == 0);
+    int reader = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    CHECK(reader >= 0);
+    Logger::SetLogToFile(true, path.string(), LogFlushPolicy::EveryBytes(4 * 1024));
+    uint64_t droppedBefore = Logger::GetDroppedCount();
+    
+    const size_t kCapacity = 64;
+    const int kLines = 20000;
+    CHECK(Logger::SetAsyncMode(true, kCapacity, LogOverflowPolicy::DropOldest, LogQueueMode::Shared));
+    for (int n = 0; n < kLines; ++n) {
+        Logger::Log(LogLevel::Info, "t0 n%d", n);
+    }
+    
+    // 恢复读取，写线程继续写出队列中剩余的记录
+    String content;
+    fcntl(reader, F_SETFL, fcntl(reader, F_GETFL) & ~O_NONBLOCK);
+    std::thread drain([&content, reader]() {
+        char buffer[16 * 1024];
+        ssize_t bytesRead = 0;
+        while ((bytesRead = read(reader, buffer, sizeof(buffer))) > 0) {
+            content.append(buffer, static_cast<size_t>(bytesRead));
+        }
+    });
+    Logger::Flush();
+    StopFileLog();
+    drain.join();
+    close(reader);
+    
+    std::vector<int> sequences;
+    size_t pos = 0;
+    while ((pos = content.find("] t0 n", pos)) != String::npos) {
+        sequences.push_back(atoi(content.c_str() + pos + 6));
+        pos += 6;
+    }
+    
+    // 写出的行与丢弃计数之和等于提交的总数，写出的行保持顺序
+    uint64_t dropped = Logger::GetDroppedCount() - droppedBefore;
+    CHECK(dropped > 0);
+    CHECK(sequences.size() + dropped == static_cast<uint64_t>(kLines));
+    bool ordered = true;
+    for (size_t i = 1; i < sequences.size(); ++i) {
+        ordered = ordered && sequences[i] > sequences[i - 1];
+    }
+    CHECK(ordered);
+    
+    // 丢弃的都是较旧的记录：最后kCapacity条（阻塞结束时队列中的内容）全部保留
+    CHECK(sequences.size() >= kCapacity);
+    if (ordered && sequences.size() >= kCapacity) {
+        CHECK(sequences.back() == kLines - 1);
+        CHECK(sequences[sequences.size() - kCapacity] == kLines - static_cast<int>(kCapacity));
+    }
+}
+#endif
+
+void TestFlushWaitsForQueuedRecords() {
+    std::filesystem::path path = StartFileLog("flush.log");
+    
+    CHECK(Logger::SetAsyncMode(true, 8192, LogOverflowPolicy::Block, LogQueueMode::Shared));
+    for (int n = 0; n < 1000; ++n) {
+        Logger::Log(LogLevel::Info, "t0 n%d", n);
+    }
+    
+    // 仍处于异步模式时Flush返回即已落盘
+    Logger::Flush();
+    CHECK(ParseLines(path).total == 1000);
+    StopFileLog();
+}
+
+// 读取历史文件，已压缩为file.N.gz时读取解压后的内容
+bool ReadSegment(const std::filesystem::path& path, String& content) {
+#ifdef WLM_HAVE_ZLIB
+    std::filesystem::path compressed = path.string() + ".gz";
+    if (std::filesystem::exists(compressed)) {
+        gzFile file = gzopen(compressed.string().c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        content.clear();
+        char buffer[16 * 1024];
+        int bytesRead = 0;
+        while ((bytesRead = gzread(file, buffer, sizeof(buffer))) > 0) {
+            content.append(buffer, static_cast<size_t>(bytesRead));
+        }
+        return gzclose(file) == Z_OK && bytesRead == 0;
+    }
+#endif
+    if (!std::filesystem::exists(path)) {
+        return false;
+    }
+    content = TestUtil::ReadFileContent(path);
+    return true;
+}
+
+// 按从旧到新的顺序（file.N ... file.1, file）拼接全部轮转文件后解析。
+// 先停止后台压缩，未压缩完的文件保持原样
+ParsedLines ParseRotatedLines(const std::filesystem::path& path, unsigned retainCount, size_t& segments) {
+    LogCompressor::Shutdown();
+    
+    std::filesystem::path merged = path.string() + ".merged";
+    std::ofstream out(merged, std::ios::binary | std::ios::trunc);
+    segments = 0;
+    for (unsigned index = retainCount; index >= 1; --index) {
+        String content;
+        if (ReadSegment(path.string() + "." + std::to_string(index), content)) {
+            out << content;
+            segments++;
+        }
+    }
+    out << TestUtil::ReadFileContent(path);
+    out.close();
+    return ParseLines(merged);
+}
+
+void RunRotationUnderConcurrentWriters(const char* name, bool async) {
+    std::filesystem::path path = TestUtil::GetTempDir("logger") / name;
+    
+    // 保留数量足够大，测试期间不会删除任何历史文件
+    LogRotationPolicy rotation;
+    rotation.maxBytes = 16 * 1024;
+    rotation.retainCount = 1000;
+    rotation.compress = true;
+    Logger::SetLogRotation(rotation);
+    Logger::SetLogToFile(true, path.string(), LogFlushPolicy::EveryBytes(4 * 1024));
+    if (async) {
+        CHECK(Logger::SetAsyncMode(true, 256, LogOverflowPolicy::Block, LogQueueMode::Shared));
+    }
+    
+    LogFromThreads(kThreads, kLinesPerThread);
+    Logger::Flush();
+    StopFileLog();
+    Logger::SetLogRotation(LogRotationPolicy());
+    
+    // 轮转期间每一行都恰好落在某一个文件中，且各线程内的顺序跨文件保持不变
+    size_t segments = 0;
+    ParsedLines lines = ParseRotatedLines(path, rotation.retainCount, segments);
+    CHECK(segments > 10);
+    CHECK(lines.total == static_cast<size_t>(kThreads * kLinesPerThread));
+    CHECK(lines.ordered);
+    for (int t = 0; t < kThreads; ++t) {
+        CHECK(lines.counts[t] == kLinesPerThread);
+    }
+}
+
+void TestSyncRotationKeepsEveryLine() {
+    RunRotationUnderConcurrentWriters("rotate_sync.log", false);
+}
+
+void TestAsyncRotationKeepsEveryLine() {
+    RunRotationUnderConcurrentWriters("rotate_async.log", true);
+}
+
+#ifdef WLM_HAVE_ZLIB
+void TestRotatedSegmentsAreCompressed() {
+    std::filesystem::path path = TestUtil::GetTempDir("logger") / "compress.log";
+    
+    LogRotationPolicy rotation;
+    rotation.maxBytes = 4 * 1024;
+    rotation.retainCount = 3;
+    rotation.compress = true;
+    Logger::SetLogRotation(rotation);
+    Logger::SetLogToFile(true, path.string(), LogFlushPolicy::EveryLine());
+    
+    const int kLines = 2000;
+    for (int n = 0; n < kLines; ++n) {
+        Logger::Log(LogLevel::Info, "t0 n%d", n);
+    }
+    StopFileLog();
+    Logger::SetLogRotation(LogRotationPolicy());
+    
+    // 后台压缩完成后只剩file.1.gz ~ file.3.gz，原文件和临时文件都已删除
+    auto segmentPath = [&path](unsigned index) {
+        return std::filesystem::path(path.string() + "." + std::to_string(index));
+    };
+    ULONGLONG start = GetTickCount64();
+    bool compressed = false;
+    while (!compressed && GetTickCount64() - start < 5000) {
+        compressed = !std::filesystem::exists(path.string() + ".gz.tmp");
+        for (unsigned index = 1; index <= rotation.retainCount; ++index) {
+            compressed = compressed && !std::filesystem::exists(segmentPath(index)) &&
+                std::filesystem::exists(segmentPath(index).string() + ".gz");
+        }
+        Sleep(10);
+    }
+    CHECK(compressed);
+    CHECK(!std::filesystem::exists(segmentPath(4)) && !std::filesystem::exists(segmentPath(4).string() + ".gz"));
+    
+    // 解压后依次拼接，内容为最后若干行日志且逐行连续
+    String merged;
+    for (unsigned index = rotation.retainCount; index >= 1; --index) {
+        String gzip = TestUtil::ReadFileContent(segmentPath(index).string() + ".gz");
+        CHECK(gzip.size() > 2 && static_cast<unsigned char>(gzip[0]) == 0x1f &&
+              static_cast<unsigned char>(gzip[1]) == 0x8b);
+        
+        String content;
+        CHECK(ReadSegment(segmentPath(index), content));
+        CHECK(content.size() > gzip.size() && content.size() <= rotation.maxBytes);
+        merged += content;
+    }
+    merged += TestUtil::ReadFileContent(path);
+    
+    std::vector<int> sequences;
+    size_t pos = 0;
+    while ((pos = merged.find("] t0 n", pos)) != String::npos) {
+        sequences.push_back(atoi(merged.c_str() + pos + 6));
+        pos += 6;
+    }
+    CHECK(sequences.size() > 100 && sequences.back() == kLines - 1);
+    for (size_t i = 1; i < sequences.size(); ++i) {
+        CHECK(sequences[i] == sequences[i - 1] + 1);
+    }
+}
+#endif
+
+void TestTimestampFormats() {
+    char buffer[64];
+    Logger::SetTimestampMode(LogTimestampMode::WallClock);
+    size_t length = Logger::GetCurrentTimeString(buffer, sizeof(buffer));
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, ms = 0;
+    CHECK(length == 23);
+    CHECK(sscanf(buffer, "%4d-%2d-%2d %2d:%2d:%2d.%3d", &year, &month, &day, &hour, &minute, &second, &ms) == 7);
+    
+    // 单调时间为 +秒.微秒，且不随调用回退
+    Logger::SetTimestampMode(LogTimestampMode::Monotonic);
+    double previous = -1.0;
+    for (int n = 0; n < 1000; ++n) {
+        length = Logger::GetCurrentTimeString(buffer, sizeof(buffer));
+        const char* dot = strchr(buffer, '.');
+        CHECK(buffer[0] == '+' && dot != nullptr && strlen(dot) == 7 && strlen(buffer) == length);
+        double value = atof(buffer + 1);
+        CHECK(value >= previous);
+        previous = value;
+    }
+    Logger::SetTimestampMode(LogTimestampMode::WallClock);
+    
+    // 缓冲区不足时返回0
+    CHECK(Logger::GetCurrentTimeString(buffer, 8) == 0);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestSyncWritesEveryLine);
+    RUN_TEST(TestSyncIntervalFlushWithoutFurtherWrites);
+    RUN_TEST(TestAsyncBlockKeepsEveryLine);
+    RUN_TEST(TestAsyncPerThreadKeepsOrder);
+    RUN_TEST(TestAsyncDropNewestCountsDrops);
+#ifndef _WIN32
+    RUN_TEST(TestAsyncDropOldestKeepsNewest);
+#endif
+    RUN_TEST(TestFlushWaitsForQueuedRecords);
+    RUN_TEST(TestSyncRotationKeepsEveryLine);
+    RUN_TEST(TestAsyncRotationKeepsEveryLine);
+#ifdef WLM_HAVE_ZLIB
+    RUN_TEST(TestRotatedSegmentsAreCompressed);
+#endif
+    RUN_TEST(TestTimestampFormats);
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
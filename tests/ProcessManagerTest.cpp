@@ -0,0 +1,457 @@
+// 进程管理测试：批量挂起的进程全部停止运行、恢复后继续，挂起台账记录每个进程；
+// 不断新建线程的进程经cgroup冻结和SIGSTOP挂起后都完全停止；重复挂起不嵌套，被其他程序恢复后重新挂起，
+// 挂起前已被停止的进程恢复后保持停止，冻结cgroup无法删除时仍恢复并记录日志，多个线程并发挂起和恢复后状态一致；
+// 不存在的进程报告ProcessNotFound，按名称查询和终止进程。
+// 以fork出的子进程为目标，Linux上经cgroup v2冻结或SIGSTOP/SIGCONT和/proc实现
+
+#include "TestUtil.h"
+#include "ProcessManager.h"
+
+#ifndef _WIN32
+#include "ProcFs.h"
+#include <csignal>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+namespace {
+
+// 子进程改名后不断递增共享内存中的计数，计数停止增长说明进程已被挂起
+struct Workers {
+    std::vector<pid_t> pids;
+    volatile uint64_t* counters;
+    size_t count;
+    
+    explicit Workers(int workerCount) : counters(nullptr), count(workerCount) {
+        void* memory = mmap(nullptr, sizeof(uint64_t) * count, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        counters = static_cast<volatile uint64_t*>(memory);
+        for (size_t i = 0; i < count; ++i) {
+            counters[i] = 0;
+            pid_t pid = fork();
+            if (pid == 0) {
+                prctl(PR_SET_NAME, "wlm-worker");
+                while (true) {
+                    counters[i]++;
+                }
+            }
+            pids.push_back(pid);
+        }
+        
+        // 计数开始增长时子进程已完成改名
+        for (size_t i = 0; i < count; ++i) {
+            while (counters[i] == 0) {
+                Sleep(1);
+            }
+        }
+    }
+    
+    ~Workers() {
+        for (pid_t pid : pids) {
+            kill(pid, SIGKILL);
+        }
+        for (pid_t pid : pids) {
+            waitpid(pid, nullptr, 0);
+        }
+        munmap(const_cast<uint64_t*>(counters), sizeof(uint64_t) * count);
+    }
+    
+    std::vector<DWORD> GetProcessIds() const {
+        return std::vector<DWORD>(pids.begin(), pids.end());
+    }
+    
+    // 在periodMs内计数仍在增长的进程数
+    int CountRunning(DWORD periodMs) const {
+        std::vector<uint64_t> before(pids.size());
+        for (size_t i = 0; i < pids.size(); ++i) {
+            before[i] = counters[i];
+        }
+        Sleep(periodMs);
+        int running = 0;
+        for (size_t i = 0; i < pids.size(); ++i) {
+            running += counters[i] != before[i];
+        }
+        return running;
+    }
+};
+
+void TestBatchSuspendResume() {
+    const int kWorkers = 6;
+    Workers workers(kWorkers);
+    std::vector<DWORD> pids = workers.GetProcessIds();
+    CHECK(workers.CountRunning(200) == kWorkers);
+    
+    ProcessManager manager;
+    CHECK(manager.SuspendProcesses(pids));
+    CHECK(workers.CountRunning(100) == 0);
+    for (DWORD pid : pids) {
+        CHECK(manager.GetSuspendState(pid) == SuspendState::Suspended);
+        SuspendInfo info;
+        CHECK(manager.GetSuspendInfo(pid, info) && info.maxSuspendCount == 1);
+        CHECK(info.threadCount == (info.native ? 0u : 1u));
+    }
+    CHECK(manager.GetSuspendedProcesses().size() == static_cast<size_t>(kWorkers));
+    
+    CHECK(manager.ResumeProcesses(pids));
+    CHECK(workers.CountRunning(200) == kWorkers);
+    for (DWORD pid : pids) {
+        CHECK(manager.GetSuspendState(pid) == SuspendState::NotTracked);
+    }
+    
+    // 按名称挂起同名的全部进程
+    CHECK(manager.GetProcessIds(L"WLM-WORKER").size() == static_cast<size_t>(kWorkers));
+    CHECK(manager.SuspendProcess(L"wlm-worker"));
+    CHECK(workers.CountRunning(100) == 0);
+    CHECK(manager.ResumeProcess(L"wlm-worker"));
+    CHECK(workers.CountRunning(200) == kWorkers);
+}
+
+void* CountAndExit(void* counter) {
+    for (int i = 0; i < 100000; ++i) {
+        __atomic_fetch_add(static_cast<uint64_t*>(counter), 1, __ATOMIC_RELAXED);
+    }
+    return nullptr;
+}
+
+// 子进程循环新建一批线程，每个线程递增计数后退出；挂起期间若有线程遗漏，计数或线程会继续变化
+struct ThreadSpawner {
+    pid_t pid;
+    uint64_t* counter;
+    
+    ThreadSpawner() {
+        counter = static_cast<uint64_t*>(mmap(nullptr, sizeof(uint64_t), PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+        *counter = 0;
+        pid = fork();
+        if (pid == 0) {
+            prctl(PR_SET_NAME, "wlm-spawner");
+            while (true) {
+                pthread_t threads[8];
+                for (pthread_t& thread : threads) {
+                    pthread_create(&thread, nullptr, CountAndExit, counter);
+                }
+                for (pthread_t& thread : threads) {
+                    pthread_join(thread, nullptr);
+                }
+            }
+        }
+        while (__atomic_load_n(counter, __ATOMIC_RELAXED) == 0) {
+            Sleep(1);
+        }
+    }
+    
+    ~ThreadSpawner() {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        munmap(counter, sizeof(uint64_t));
+    }
+    
+    uint64_t Count() const { return __atomic_load_n(counter, __ATOMIC_RELAXED); }
+};
+
+void CheckFrozen(const ThreadSpawner& spawner) {
+    std::vector<DWORD> before;
+    std::vector<DWORD> after;
+    uint64_t count = spawner.Count();
+    CHECK(ProcFs::ListThreads(spawner.pid, before));
+    Sleep(200);
+    CHECK(ProcFs::ListThreads(spawner.pid, after));
+    CHECK(spawner.Count() == count);
+    CHECK(before == after);
+    
+    // 冻结的线程处于S状态，SIGSTOP停止的线程处于T状态，都不应可运行
+    for (DWORD threadId : after) {
+        ProcFs::Stat stat;
+        CHECK(!ProcFs::ReadThreadStat(spawner.pid, threadId, stat) || stat.state != 'R');
+    }
+}
+
+void TestSuspendSpawningProcess() {
+    // cgroup v2可写时应使用整进程冻结，否则两轮都是SIGSTOP
+    const String& mount = ProcFs::GetCgroupMount();
+    bool canFreeze = !mount.empty() && access(mount.c_str(), W_OK) == 0;
+    
+    for (bool native : { true, false }) {
+        ThreadSpawner spawner;
+        String original;
+        bool hasCgroup = ProcFs::GetCgroupPath(spawner.pid, original);
+        
+        ProcessManager manager;
+        manager.SetNativeSuspendEnabled(native);
+        uint64_t start = GetTickCount64();
+        CHECK(manager.SuspendProcess(spawner.pid));
+        printf("    %s suspend: %llu ms\n", native ? "native" : "signal",
+               static_cast<unsigned long long>(GetTickCount64() - start));
+        
+        SuspendInfo info;
+        CHECK(manager.GetSuspendInfo(spawner.pid, info));
+        CHECK(info.native == (native && canFreeze));
+        CHECK(manager.GetSuspendState(spawner.pid) == SuspendState::Suspended);
+        CheckFrozen(spawner);
+        
+        // 重复挂起不嵌套，一次恢复即可
+        CHECK(manager.SuspendProcess(spawner.pid));
+        CHECK(manager.ResumeProcess(spawner.pid));
+        CHECK(manager.GetSuspendState(spawner.pid) == SuspendState::NotTracked);
+        uint64_t count = spawner.Count();
+        Sleep(100);
+        CHECK(spawner.Count() > count);
+        
+        // 恢复后回到原cgroup
+        String current;
+        CHECK(!hasCgroup || (ProcFs::GetCgroupPath(spawner.pid, current) && current == original));
+    }
+}
+
+// 目录下本服务创建的冻结cgroup数，恢复或进程退出后应为0
+int CountFreezeCgroups(const String& path) {
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        return 0;
+    }
+    
+    int count = 0;
+    while (dirent* entry = readdir(dir)) {
+        count += strncmp(entry->d_name, "wlm-freeze.", 11) == 0;
+    }
+    closedir(dir);
+    return count;
+}
+
+// 模拟其他程序恢复进程：冻结的进程解冻其所在cgroup，以SIGSTOP停止的进程发送SIGCONT
+void ResumeExternally(DWORD pid, bool native) {
+    String path;
+    if (native && ProcFs::GetCgroupPath(pid, path)) {
+        ProcFs::WriteFile(path + "/cgroup.freeze", "0");
+    } else {
+        kill(static_cast<pid_t>(pid), SIGCONT);
+    }
+}
+
+char GetState(DWORD pid) {
+    ProcFs::Stat stat;
+    return ProcFs::ReadStat(pid, stat) ? stat.state : 0;
+}
+
+void TestRepeatedSuspendResume() {
+    for (bool native : { true, false }) {
+        Workers workers(1);
+        DWORD pid = static_cast<DWORD>(workers.pids[0]);
+        String original;
+        ProcFs::GetCgroupPath(pid, original);
+        
+        ProcessManager manager;
+        manager.SetNativeSuspendEnabled(native);
+        
+        // 重复挂起不嵌套，一次恢复即可继续运行
+        for (int i = 0; i < 3; ++i) {
+            CHECK(manager.SuspendProcess(pid));
+        }
+        SuspendInfo info;
+        CHECK(manager.GetSuspendInfo(pid, info) && info.maxSuspendCount == 1);
+        CHECK(manager.GetSuspendedProcesses().size() == 1);
+        CHECK(workers.CountRunning(100) == 0);
+        CHECK(manager.ResumeProcess(pid));
+        CHECK(workers.CountRunning(100) == 1);
+        CHECK(manager.GetSuspendState(pid) == SuspendState::NotTracked);
+        
+        // 未挂起时恢复不影响进程
+        CHECK(manager.ResumeProcess(pid));
+        CHECK(workers.CountRunning(100) == 1);
+        
+        // 被其他程序恢复后核实为部分挂起，再次挂起时重新挂起而不是跳过
+        CHECK(manager.SuspendProcess(pid));
+        CHECK(manager.GetSuspendInfo(pid, info));
+        ResumeExternally(pid, info.native);
+        CHECK(workers.CountRunning(100) == 1);
+        CHECK(manager.GetSuspendState(pid) == SuspendState::PartiallySuspended);
+        CHECK(manager.SuspendProcess(pid));
+        CHECK(manager.GetSuspendState(pid) == SuspendState::Suspended);
+        CHECK(workers.CountRunning(100) == 0);
+        CHECK(manager.ResumeProcess(pid));
+        CHECK(workers.CountRunning(100) == 1);
+        
+        // 重新冻结创建的cgroup也已删除，进程回到原cgroup
+        String current;
+        CHECK(!ProcFs::GetCgroupPath(pid, current) || current == original);
+        CHECK(original.empty() || CountFreezeCgroups(original) == 0);
+        
+        // 挂起前已被其他程序停止的进程，恢复后保持停止
+        kill(workers.pids[0], SIGSTOP);
+        while (GetState(pid) != 'T') {
+            Sleep(1);
+        }
+        CHECK(manager.SuspendProcess(pid));
+        CHECK(manager.ResumeProcess(pid));
+        CHECK(GetState(pid) == 'T');
+        CHECK(workers.CountRunning(100) == 0);
+        kill(workers.pids[0], SIGCONT);
+        CHECK(workers.CountRunning(100) == 1);
+    }
+}
+
+void TestExitedWhileSuspended() {
+    for (bool native : { true, false }) {
+        Workers workers(1);
+        DWORD pid = static_cast<DWORD>(workers.pids[0]);
+        String original;
+        ProcFs::GetCgroupPath(pid, original);
+        
+        ProcessManager manager;
+        manager.SetNativeSuspendEnabled(native);
+        CHECK(manager.SuspendProcess(pid));
+        kill(workers.pids[0], SIGKILL);
+        waitpid(workers.pids[0], nullptr, 0);
+        workers.pids.clear();
+        
+        // 进程退出后记录核实为已退出，恢复失败并删除冻结cgroup
+        CHECK(manager.GetSuspendState(pid) == SuspendState::Exited);
+        CHECK(!manager.ResumeProcess(pid));
+        CHECK(manager.GetLastError() == ErrorCode::ProcessNotFound);
+        CHECK(manager.GetSuspendState(pid) == SuspendState::NotTracked);
+        CHECK(original.empty() || CountFreezeCgroups(original) == 0);
+    }
+}
+
+void TestThawKeepsNonEmptyCgroup() {
+    const String& mount = ProcFs::GetCgroupMount();
+    if (mount.empty() || access(mount.c_str(), W_OK) != 0) {
+        printf("    cgroup v2 not writable, skipped\n");
+        return;
+    }
+    
+    std::filesystem::path logPath = TestUtil::GetTempDir("process_manager") / "thaw.log";
+    Logger::SetLogToFile(true, logPath.string(), LogFlushPolicy::EveryLine());
+    
+    Workers workers(1);
+    DWORD pid = static_cast<DWORD>(workers.pids[0]);
+    String original;
+    ProcFs::GetCgroupPath(pid, original);
+    
+    // 冻结cgroup中被其他程序建了子cgroup，无法删除；进程仍移回原cgroup并恢复运行，删除失败写入日志
+    ProcessManager manager;
+    String frozen;
+    CHECK(manager.SuspendProcess(pid) && ProcFs::GetCgroupPath(pid, frozen) && frozen != original);
+    String nested = frozen + "/nested";
+    CHECK(mkdir(nested.c_str(), 0755) == 0);
+    CHECK(manager.ResumeProcess(pid));
+    CHECK(workers.CountRunning(100) == 1);
+    String current;
+    CHECK(ProcFs::GetCgroupPath(pid, current) && current == original);
+    
+    Logger::SetLogToFile(false);
+    String log = TestUtil::ReadFileContent(logPath);
+    CHECK(log.find("Failed to remove cgroup " + frozen) != String::npos);
+    
+    rmdir(nested.c_str());
+    rmdir(frozen.c_str());
+    CHECK(CountFreezeCgroups(original) == 0);
+}
+
+void TestConcurrentSuspendResume() {
+    const int kWorkers = 4;
+    const int kRounds = 40;
+    for (bool native : { true, false }) {
+        Workers workers(kWorkers);
+        std::vector<DWORD> pids = workers.GetProcessIds();
+        String original;
+        ProcFs::GetCgroupPath(pids[0], original);
+        
+        ProcessManager manager;
+        manager.SetNativeSuspendEnabled(native);
+        
+        // 每个线程交替批量挂起全部进程、挂起和恢复自己的进程、核实状态，调用之间互相穿插
+        std::atomic<int> failures(0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kWorkers; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int round = 0; round < kRounds; ++round) {
+                    switch ((round + t) % 4) {
+                        case 0: failures += !manager.SuspendProcesses(pids); break;
+                        case 1: failures += !manager.SuspendProcess(pids[t]); break;
+                        case 2: failures += !manager.ResumeProcess(pids[t]); break;
+                        default: failures += manager.GetSuspendState(pids[t]) == SuspendState::Exited; break;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        CHECK(failures == 0);
+        
+        // 台账中的进程都仍处于挂起状态，全部恢复后继续运行，不留下冻结cgroup
+        for (const SuspendInfo& info : manager.GetSuspendedProcesses()) {
+            CHECK(manager.GetSuspendState(info.processId) == SuspendState::Suspended);
+        }
+        CHECK(manager.ResumeProcesses(pids));
+        CHECK(manager.GetSuspendedProcesses().empty());
+        CHECK(workers.CountRunning(200) == kWorkers);
+        CHECK(original.empty() || CountFreezeCgroups(original) == 0);
+    }
+}
+
+void TestMissingProcess() {
+    Workers workers(1);
+    DWORD pid = static_cast<DWORD>(workers.pids[0]);
+    kill(workers.pids[0], SIGKILL);
+    waitpid(workers.pids[0], nullptr, 0);
+    workers.pids.clear();
+    
+    // 已退出的进程不会被挂起，批量操作中其他进程不受影响
+    ProcessManager manager;
+    CHECK(!manager.SuspendProcess(pid));
+    CHECK(manager.GetLastError() == ErrorCode::ProcessNotFound);
+    CHECK(manager.GetSuspendState(pid) == SuspendState::NotTracked);
+    CHECK(!manager.IsProcessRunning(pid));
+    
+    Workers alive(1);
+    std::vector<DWORD> pids = alive.GetProcessIds();
+    pids.push_back(pid);
+    CHECK(!manager.SuspendProcesses(pids));
+    CHECK(manager.GetSuspendState(pids[0]) == SuspendState::Suspended);
+    CHECK(manager.ResumeProcess(pids[0]));
+}
+
+void TestTerminateProcess() {
+    Workers workers(1);
+    DWORD pid = static_cast<DWORD>(workers.pids[0]);
+    
+    ProcessManager manager;
+    CHECK(manager.IsProcessRunning(pid));
+    ProcessInfo info = manager.FindProcess(pid);
+    CHECK(info.processId == pid && info.processName == L"wlm-worker");
+    
+    CHECK(manager.TerminateProcess(pid));
+    int status = 0;
+    CHECK(waitpid(workers.pids[0], &status, 0) == workers.pids[0] && WIFSIGNALED(status));
+    workers.pids.clear();
+    CHECK(!manager.IsProcessRunning(pid));
+    CHECK(manager.FindProcess(pid).processId == 0);
+}
+
+} // namespace
+#endif
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+
+#ifndef _WIN32
+    RUN_TEST(TestBatchSuspendResume);
+    RUN_TEST(TestSuspendSpawningProcess);
+    RUN_TEST(TestRepeatedSuspendResume);
+    RUN_TEST(TestExitedWhileSuspended);
+    RUN_TEST(TestThawKeepsNonEmptyCgroup);
+    RUN_TEST(TestConcurrentSuspendResume);
+    RUN_TEST(TestMissingProcess);
+    RUN_TEST(TestTerminateProcess);
+#endif
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
@@ -0,0 +1,342 @@
+// 进程快照缓存测试：按PID和忽略大小写的进程名查询，快照在最大时长内只获取一次、
+// 失效或刷新后重新获取；相邻快照的启动、退出和线程数变化按序通知，PID复用时（包括同一父进程按同名重新启动，以启动时间区分）先报告退出。
+// Linux上经/proc找到本进程和新建的子进程，子进程的启动和退出出现在变化流中
+
+#include "TestUtil.h"
+#include "Logger.h"
+#include "ProcessTable.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+namespace {
+
+ProcessInfo MakeProcess(DWORD processId, const WString& name, DWORD parentProcessId = 1) {
+    ProcessInfo info;
+    info.processId = processId;
+    info.processName = name;
+    info.threadCount = 1;
+    info.parentProcessId = parentProcessId;
+    return info;
+}
+
+void TestFoldName() {
+    CHECK(ProcessTable::FoldName(L"WinLogon.EXE") == ProcessTable::FoldName(L"winlogon.exe"));
+    CHECK(ProcessTable::FoldName(L"winlogon.exe") == L"WINLOGON.EXE");
+    CHECK(ProcessTable::FoldName(L"") == L"");
+    CHECK(ProcessTable::FoldName(L"lsass.exe") != ProcessTable::FoldName(L"winlogon.exe"));
+}
+
+void TestIndexedLookups() {
+    const DWORD kProcesses = 10000;
+    std::vector<ProcessInfo> snapshot;
+    snapshot.push_back(MakeProcess(0, L"Idle"));
+    for (DWORD pid = 100; pid < 100 + kProcesses; ++pid) {
+        snapshot.push_back(MakeProcess(pid, pid % 100 == 0 ? L"WinLogon.exe" : L"svchost.exe"));
+    }
+    
+    int loads = 0;
+    ProcessTable table;
+    table.SetMaxAge(60000);
+    table.SetSnapshotSource([&](std::vector<ProcessInfo>& processes) {
+        loads++;
+        processes = snapshot;
+        return true;
+    });
+    
+    // PID为0的条目被过滤
+    int found = 0;
+    ProcessInfo info;
+    bool exists = false;
+    for (DWORD pid = 100; pid < 100 + kProcesses; ++pid) {
+        if (table.Find(pid, info, exists) && exists && info.processId == pid) {
+            found++;
+        }
+    }
+    CHECK(found == static_cast<int>(kProcesses));
+    CHECK(table.Find(0, info, exists) && !exists);
+    CHECK(table.Find(100 + kProcesses, info, exists) && !exists);
+    
+    std::vector<ProcessInfo> processes;
+    CHECK(table.FindByName(L"winlogon.EXE", processes) && processes.size() == kProcesses / 100);
+    CHECK(table.FindByName(L"missing.exe", processes) && processes.empty());
+    CHECK(table.GetAll(processes) && processes.size() == kProcesses);
+    CHECK(loads == 1);
+}
+
+void TestRefreshPolicy() {
+    std::vector<ProcessInfo> snapshot;
+    snapshot.push_back(MakeProcess(10, L"a.exe"));
+    
+    int loads = 0;
+    bool fail = false;
+    ProcessTable table;
+    table.SetMaxAge(60000);
+    table.SetSnapshotSource([&](std::vector<ProcessInfo>& processes) {
+        loads++;
+        processes = snapshot;
+        return !fail;
+    });
+    
+    // 最大时长内的查询不重新获取快照
+    std::vector<ProcessInfo> processes;
+    CHECK(table.FindByName(L"a.exe", processes) && processes.size() == 1);
+    snapshot.push_back(MakeProcess(11, L"A.EXE"));
+    CHECK(table.FindByName(L"a.exe", processes) && processes.size() == 1);
+    CHECK(loads == 1);
+    
+    // 失效后下一次查询重新获取
+    table.Invalidate();
+    CHECK(table.FindByName(L"a.exe", processes) && processes.size() == 2);
+    CHECK(loads == 2);
+    
+    // 刷新失败时保留原有内容
+    fail = true;
+    CHECK(!table.Refresh());
+    fail = false;
+    ProcessInfo info;
+    bool exists = false;
+    CHECK(table.Find(11, info, exists) && exists);
+    
+    // 最大时长为0时每次查询都重新获取
+    table.SetMaxAge(0);
+    int before = loads;
+    table.Find(10, info, exists);
+    table.Find(10, info, exists);
+    CHECK(loads == before + 2);
+}
+
+void TestChangeStream() {
+    std::vector<ProcessInfo> snapshot;
+    snapshot.push_back(MakeProcess(10, L"a.exe"));
+    snapshot.push_back(MakeProcess(11, L"b.exe"));
+    snapshot.push_back(MakeProcess(12, L"c.exe"));
+    
+    ProcessTable table;
+    table.SetSnapshotSource([&](std::vector<ProcessInfo>& processes) {
+        processes = snapshot;
+        return true;
+    });
+    
+    std::vector<std::vector<ProcessChange>> batches;
+    uint32_t listenerId = table.AddListener([&](const std::vector<ProcessChange>& changes) {
+        batches.push_back(changes);
+    });
+    
+    // 首次快照和没有变化的刷新都不通知
+    CHECK(table.Refresh());
+    CHECK(table.Refresh());
+    CHECK(batches.empty());
+    
+    // b退出，d启动，c的线程数变化，a的PID被同名但父进程不同的新进程复用
+    snapshot[0].parentProcessId = 2;
+    snapshot[2].threadCount = 8;
+    snapshot.erase(snapshot.begin() + 1);
+    snapshot.push_back(MakeProcess(13, L"d.exe"));
+    CHECK(table.Refresh());
+    CHECK(batches.size() == 1);
+    
+    const std::vector<ProcessChange>& changes = batches[0];
+    CHECK(changes.size() == 5);
+    if (changes.size() == 5) {
+        // 退出排在启动之前，同类变化按快照顺序
+        CHECK(changes[0].type == ProcessChangeType::Exited && changes[0].process.processId == 10 &&
+              changes[0].process.parentProcessId == 1);
+        CHECK(changes[1].type == ProcessChangeType::Exited && changes[1].process.processId == 11);
+        CHECK(changes[2].type == ProcessChangeType::Started && changes[2].process.processId == 10 &&
+              changes[2].process.parentProcessId == 2);
+        CHECK(changes[3].type == ProcessChangeType::ThreadCountChanged && changes[3].process.processId == 12 &&
+              changes[3].previousThreadCount == 1 && changes[3].process.threadCount == 8);
+        CHECK(changes[4].type == ProcessChangeType::Started && changes[4].process.processId == 13);
+    }
+    
+    // 查询触发的刷新同样通知；移除监听者后不再收到
+    snapshot.pop_back();
+    table.Invalidate();
+    std::vector<ProcessInfo> processes;
+    CHECK(table.GetAll(processes) && processes.size() == 2);
+    CHECK(batches.size() == 2 && batches[1].size() == 1 && batches[1][0].type == ProcessChangeType::Exited);
+    
+    table.RemoveListener(listenerId);
+    snapshot.clear();
+    CHECK(table.Refresh());
+    CHECK(batches.size() == 2);
+}
+
+void TestPidReuseBySameProgram() {
+    std::vector<ProcessInfo> snapshot;
+    snapshot.push_back(MakeProcess(10, L"a.exe"));
+    snapshot[0].startTime = 100;
+    
+    ProcessTable table;
+    table.SetSnapshotSource([&](std::vector<ProcessInfo>& processes) {
+        processes = snapshot;
+        return true;
+    });
+    std::vector<ProcessChange> received;
+    table.AddListener([&received](const std::vector<ProcessChange>& changes) {
+        received.insert(received.end(), changes.begin(), changes.end());
+    });
+    CHECK(table.Refresh());
+    
+    // 同一父进程重新启动同名程序并复用了PID，只有启动时间不同
+    snapshot[0].startTime = 200;
+    CHECK(table.Refresh());
+    CHECK(received.size() == 2);
+    if (received.size() == 2) {
+        CHECK(received[0].type == ProcessChangeType::Exited && received[0].process.startTime == 100);
+        CHECK(received[1].type == ProcessChangeType::Started && received[1].process.startTime == 200);
+    }
+    
+    // 启动时间未知时不视为新进程
+    received.clear();
+    snapshot[0].startTime = 0;
+    CHECK(table.Refresh());
+    snapshot[0].startTime = 300;
+    CHECK(table.Refresh());
+    CHECK(received.empty());
+}
+
+void TestChangeStreamOrdering() {
+    // 多个线程并发刷新，每一批变化都基于前一批之后的快照，监听者收到的启动和退出交替出现
+    std::atomic<int> generation(0);
+    ProcessTable table;
+    table.SetSnapshotSource([&](std::vector<ProcessInfo>& processes) {
+        int current = generation++;
+        if (current % 2 == 1) {
+            processes.push_back(MakeProcess(100, L"worker.exe"));
+        }
+        return true;
+    });
+    
+    std::mutex mutex;
+    std::vector<ProcessChangeType> received;
+    table.AddListener([&](const std::vector<ProcessChange>& changes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const ProcessChange& change : changes) {
+            received.push_back(change.type);
+        }
+    });
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&table]() {
+            for (int n = 0; n < 250; ++n) {
+                table.Refresh();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    int misordered = 0;
+    for (size_t i = 0; i < received.size(); ++i) {
+        ProcessChangeType expected = i % 2 == 0 ? ProcessChangeType::Started : ProcessChangeType::Exited;
+        if (received[i] != expected) {
+            misordered++;
+        }
+    }
+    CHECK(received.size() == 999);
+    CHECK(misordered == 0);
+}
+
+#ifndef _WIN32
+void TestSystemSnapshot() {
+    ProcessTable table;
+    table.SetMaxAge(0);
+    
+    // 本进程按PID和名称都能找到，名称为/proc中的comm
+    ProcessInfo self;
+    bool found = false;
+    CHECK(table.Find(GetCurrentProcessId(), self, found) && found);
+    CHECK(self.processName == L"ProcessTableTes");
+    CHECK(self.parentProcessId == static_cast<DWORD>(getppid()));
+    CHECK(self.threadCount >= 1);
+    CHECK(self.startTime > 0);
+    
+    std::vector<ProcessInfo> processes;
+    CHECK(table.FindByName(L"processtabletes", processes));
+    bool selfFound = false;
+    for (const ProcessInfo& process : processes) {
+        selfFound = selfFound || process.processId == GetCurrentProcessId();
+    }
+    CHECK(selfFound);
+    
+    // 子进程出现在快照中，退出后消失
+    pid_t child = fork();
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+    CHECK(child > 0);
+    ProcessInfo info;
+    CHECK(table.Find(static_cast<DWORD>(child), info, found) && found);
+    CHECK(info.parentProcessId == GetCurrentProcessId());
+    
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    CHECK(table.Find(static_cast<DWORD>(child), info, found) && !found);
+}
+
+void TestSystemChangeStream() {
+    ProcessTable table;
+    std::vector<ProcessChange> received;
+    table.AddListener([&received](const std::vector<ProcessChange>& changes) {
+        received.insert(received.end(), changes.begin(), changes.end());
+    });
+    CHECK(table.Refresh());
+    
+    pid_t child = fork();
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+    CHECK(child > 0);
+    
+    // 其他进程同时启动或退出不影响结果，只检查子进程的变化
+    auto countChanges = [&](ProcessChangeType type) {
+        int count = 0;
+        for (const ProcessChange& change : received) {
+            if (change.type == type && change.process.processId == static_cast<DWORD>(child)) {
+                CHECK(change.process.parentProcessId == GetCurrentProcessId());
+                count++;
+            }
+        }
+        return count;
+    };
+    
+    CHECK(table.Refresh());
+    CHECK(countChanges(ProcessChangeType::Started) == 1);
+    
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    CHECK(table.Refresh());
+    CHECK(countChanges(ProcessChangeType::Started) == 1);
+    CHECK(countChanges(ProcessChangeType::Exited) == 1);
+}
+#endif
+
+} // namespace
+
+int main() {
+    TestUtil::SilenceConsole();
+    Logger::Initialize();
+    
+    RUN_TEST(TestFoldName);
+    RUN_TEST(TestIndexedLookups);
+    RUN_TEST(TestRefreshPolicy);
+    RUN_TEST(TestChangeStream);
+    RUN_TEST(TestPidReuseBySameProgram);
+    RUN_TEST(TestChangeStreamOrdering);
+#ifndef _WIN32
+    RUN_TEST(TestSystemSnapshot);
+    RUN_TEST(TestSystemChangeStream);
+#endif
+    
+    Logger::Shutdown();
+    return TestUtil::Finish();
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Common.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+// 最小测试框架：CHECK失败时打印位置并计数，RUN_TEST逐个运行用例，main返回TestUtil::Finish()
+namespace TestUtil {
+
+inline int& Failures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline int Finish() {
+    if (Failures() > 0) {
+        printf("%d check(s) failed\n", Failures());
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
+
+// 每个测试进程独占的临时目录，进程开始时清空
+inline std::filesystem::path GetTempDir(const char* name) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() /
+        (String("wlm_") + name + "_" + std::to_string(GetCurrentProcessId()));
+    std::error_code error;
+    std::filesystem::remove_all(dir, error);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+inline String ReadFileContent(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return String(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+inline std::vector<String> ReadLines(const std::filesystem::path& path) {
+    std::vector<String> lines;
+    std::ifstream file(path, std::ios::binary);
+    String line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// 日志同时写到控制台，测试中关闭标准输出以免淹没结果
+inline void SilenceConsole() {
+    std::cout.setstate(std::ios::badbit);
+}
+
+} // namespace TestUtil
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #expr); \
+            TestUtil::Failures()++; \
+        } \
+    } while (0)
+
+#define RUN_TEST(test) \
+    do { \
+        int failuresBefore = TestUtil::Failures(); \
+        test(); \
+        printf("[%s] %s\n", TestUtil::Failures() == failuresBefore ? "  OK  " : "FAILED", #test); \
+        fflush(stdout); \
+    } while (0)
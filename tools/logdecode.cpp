@@ -0,0 +1,388 @@
+// 二进制日志解码工具：将BinaryLogger写出的文件还原为文本日志格式
+// 用法: logdecode <输入文件> [输出文件]
+
+#include "BinaryLogFormat.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Argument {
+    uint8_t type;
+    int64_t signedValue;
+    uint64_t unsignedValue;
+    double doubleValue;
+    std::string text;
+    
+    Argument() : type(0), signedValue(0), unsignedValue(0), doubleValue(0.0) {}
+};
+
+class Reader {
+public:
+    Reader(const char* data, size_t size) : m_data(data), m_size(size), m_offset(0) {}
+    
+    bool AtEnd() const { return m_offset >= m_size; }
+    size_t GetOffset() const { return m_offset; }
+    
+    template <typename T>
+    bool Read(T& value) {
+        if (m_size - m_offset < sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, m_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+    
+    bool ReadBytes(size_t size, const char*& bytes) {
+        if (m_size - m_offset < size) {
+            return false;
+        }
+        bytes = m_data + m_offset;
+        m_offset += size;
+        return true;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_offset;
+};
+
+const char* GetLevelString(uint8_t level) {
+    switch (level) {
+        case 0: return "DEBUG";
+        case 1: return "INFO";
+        case 2: return "WARN";
+        case 3: return "ERROR";
+        default: return "UNKNOWN";
+    }
+}
+
+void AppendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+std::string Utf16ToUtf8(const uint16_t* units, size_t count) {
+    std::string result;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t codePoint = units[i];
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 1 < count &&
+            units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (units[i + 1] - 0xDC00);
+            ++i;
+        }
+        AppendUtf8(result, codePoint);
+    }
+    return result;
+}
+
+bool ReadArguments(Reader& reader, std::vector<Argument>& args) {
+    while (!reader.AtEnd()) {
+        Argument arg;
+        if (!reader.Read(arg.type)) {
+            return false;
+        }
+        
+        switch (arg.type) {
+            case BinaryLogFormat::ArgInt64:
+                if (!reader.Read(arg.signedValue)) return false;
+                arg.unsignedValue = static_cast<uint64_t>(arg.signedValue);
+                arg.doubleValue = static_cast<double>(arg.signedValue);
+                break;
+            case BinaryLogFormat::ArgUInt64:
+            case BinaryLogFormat::ArgPointer:
+                if (!reader.Read(arg.unsignedValue)) return false;
+                arg.signedValue = static_cast<int64_t>(arg.unsignedValue);
+                arg.doubleValue = static_cast<double>(arg.unsignedValue);
+                break;
+            case BinaryLogFormat::ArgDouble:
+                if (!reader.Read(arg.doubleValue)) return false;
+                arg.signedValue = static_cast<int64_t>(arg.doubleValue);
+                arg.unsignedValue = static_cast<uint64_t>(arg.signedValue);
+                break;
+            case BinaryLogFormat::ArgString: {
+                uint16_t length;
+                const char* bytes;
+                if (!reader.Read(length) || !reader.ReadBytes(length, bytes)) return false;
+                arg.text.assign(bytes, length);
+                break;
+            }
+            case BinaryLogFormat::ArgWString: {
+                uint16_t length;
+                const char* bytes;
+                if (!reader.Read(length) || !reader.ReadBytes(length * sizeof(uint16_t), bytes)) return false;
+                std::vector<uint16_t> units(length);
+                if (length > 0) {
+                    memcpy(units.data(), bytes, length * sizeof(uint16_t));
+                }
+                arg.text = Utf16ToUtf8(units.data(), units.size());
+                break;
+            }
+            default:
+                return false;
+        }
+        
+        args.push_back(arg);
+    }
+    return true;
+}
+
+// 按printf规则渲染消息，整数长度修饰符统一按64位处理
+std::string RenderMessage(const std::string& format, const std::vector<Argument>& args) {
+    std::string out;
+    size_t argIndex = 0;
+    char buffer[512];
+    
+    for (size_t i = 0; i < format.size(); ++i) {
+        if (format[i] != '%') {
+            out += format[i];
+            continue;
+        }
+        
+        if (i + 1 < format.size() && format[i + 1] == '%') {
+            out += '%';
+            ++i;
+            continue;
+        }
+        
+        // 解析标志、宽度和精度
+        std::string spec = "%";
+        size_t pos = i + 1;
+        while (pos < format.size() && strchr("-+ #0", format[pos])) {
+            spec += format[pos++];
+        }
+        while (pos < format.size() && (isdigit(static_cast<unsigned char>(format[pos])) || format[pos] == '.' || format[pos] == '*')) {
+            if (format[pos] == '*') {
+                long long width = argIndex < args.size() ? args[argIndex++].signedValue : 0;
+                spec += std::to_string(width);
+                pos++;
+            } else {
+                spec += format[pos++];
+            }
+        }
+        
+        // 跳过长度修饰符（含MSVC的I64/I32/I）
+        while (pos < format.size()) {
+            if (strchr("hljztL", format[pos])) {
+                pos++;
+            } else if (format.compare(pos, 3, "I64") == 0 || format.compare(pos, 3, "I32") == 0) {
+                pos += 3;
+            } else if (format[pos] == 'I') {
+                pos++;
+            } else {
+                break;
+            }
+        }
+        
+        if (pos >= format.size()) {
+            out += format.substr(i);
+            break;
+        }
+        
+        char conversion = format[pos];
+        i = pos;
+        
+        if (argIndex >= args.size()) {
+            out += "<missing>";
+            continue;
+        }
+        
+        const Argument& arg = args[argIndex++];
+        switch (conversion) {
+            case 'd':
+            case 'i':
+                spec += "lld";
+                snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<long long>(arg.signedValue));
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                spec += "ll";
+                spec += conversion;
+                snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<unsigned long long>(arg.unsignedValue));
+                break;
+            case 'c':
+                spec += 'c';
+                snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(arg.signedValue));
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                spec += conversion;
+                snprintf(buffer, sizeof(buffer), spec.c_str(), arg.doubleValue);
+                break;
+            case 'p':
+                snprintf(buffer, sizeof(buffer), "0x%016llX", static_cast<unsigned long long>(arg.unsignedValue));
+                break;
+            case 's':
+            case 'S':
+                spec += 's';
+                if (arg.type == BinaryLogFormat::ArgString || arg.type == BinaryLogFormat::ArgWString) {
+                    // 字符串可能超过临时缓冲区，无格式修饰时直接追加
+                    if (spec == "%s") {
+                        out += arg.text;
+                        continue;
+                    }
+                    snprintf(buffer, sizeof(buffer), spec.c_str(), arg.text.c_str());
+                } else {
+                    snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(arg.signedValue));
+                }
+                break;
+            default:
+                snprintf(buffer, sizeof(buffer), "<%%%c?>", conversion);
+                break;
+        }
+        out += buffer;
+    }
+    
+    return out;
+}
+
+std::string FormatTimestamp(uint64_t fileTime, int32_t utcOffsetMinutes) {
+    if (fileTime < BinaryLogFormat::kUnixEpochInFileTime) {
+        return "0000-00-00 00:00:00.000";
+    }
+    
+    uint64_t unix100ns = fileTime - BinaryLogFormat::kUnixEpochInFileTime;
+    time_t seconds = static_cast<time_t>(unix100ns / 10000000ULL) + static_cast<time_t>(utcOffsetMinutes) * 60;
+    unsigned milliseconds = static_cast<unsigned>((unix100ns / 10000ULL) % 1000);
+    
+    // 会话头已记录时区偏移，此处按UTC换算即得到写入端的本地时间
+    struct tm timeinfo;
+#ifdef _WIN32
+    gmtime_s(&timeinfo, &seconds);
+#else
+    gmtime_r(&seconds, &timeinfo);
+#endif
+    
+    char buffer[32];
+    size_t length = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
+    snprintf(buffer + length, sizeof(buffer) - length, ".%03u", milliseconds);
+    return buffer;
+}
+
+bool Decode(const std::vector<char>& data, std::ostream& out) {
+    Reader reader(data.data(), data.size());
+    std::unordered_map<uint32_t, std::string> formats;
+    int32_t utcOffsetMinutes = 0;
+    bool sessionStarted = false;
+    
+    while (!reader.AtEnd()) {
+        size_t recordOffset = reader.GetOffset();
+        uint8_t type;
+        reader.Read(type);
+        
+        if (type == BinaryLogFormat::RecordSessionHeader) {
+            const char* magic;
+            uint32_t version;
+            if (!reader.ReadBytes(sizeof(BinaryLogFormat::kMagic), magic) ||
+                memcmp(magic, BinaryLogFormat::kMagic, sizeof(BinaryLogFormat::kMagic)) != 0 ||
+                !reader.Read(version) || !reader.Read(utcOffsetMinutes)) {
+                std::cerr << "Invalid session header at offset " << recordOffset << std::endl;
+                return false;
+            }
+            if (version < BinaryLogFormat::kMinVersion || version > BinaryLogFormat::kVersion) {
+                std::cerr << "Unsupported binary log version " << version << std::endl;
+                return false;
+            }
+            formats.clear();
+            sessionStarted = true;
+        } else if (type == BinaryLogFormat::RecordFormatDef && sessionStarted) {
+            uint32_t formatId;
+            uint16_t length;
+            const char* text;
+            if (!reader.Read(formatId) || !reader.Read(length) || !reader.ReadBytes(length, text)) {
+                std::cerr << "Truncated format record at offset " << recordOffset << std::endl;
+                return false;
+            }
+            formats[formatId].assign(text, length);
+        } else if (type == BinaryLogFormat::RecordEvent && sessionStarted) {
+            uint8_t level;
+            uint32_t formatId;
+            uint64_t timestamp;
+            uint16_t payloadLength;
+            const char* payload;
+            if (!reader.Read(level) || !reader.Read(formatId) || !reader.Read(timestamp) ||
+                !reader.Read(payloadLength) || !reader.ReadBytes(payloadLength, payload)) {
+                // 进程异常退出时最后一条记录可能不完整
+                std::cerr << "Truncated event record at offset " << recordOffset << std::endl;
+                return true;
+            }
+            
+            std::vector<Argument> args;
+            Reader payloadReader(payload, payloadLength);
+            ReadArguments(payloadReader, args);
+            
+            auto format = formats.find(formatId);
+            std::string message = format != formats.end()
+                ? RenderMessage(format->second, args)
+                : "<unknown format " + std::to_string(formatId) + ">";
+            
+            out << FormatTimestamp(timestamp, utcOffsetMinutes) << " [" << GetLevelString(level) << "] "
+                << message << "\n";
+        } else {
+            std::cerr << "Unexpected record type " << static_cast<int>(type)
+                      << " at offset " << recordOffset << std::endl;
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: logdecode <binary log file> [output file]" << std::endl;
+        return 1;
+    }
+    
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::cerr << "Failed to open input file: " << argv[1] << std::endl;
+        return 1;
+    }
+    
+    std::vector<char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    
+    if (argc > 2) {
+        std::ofstream output(argv[2], std::ios::binary);
+        if (!output) {
+            std::cerr << "Failed to open output file: " << argv[2] << std::endl;
+            return 1;
+        }
+        return Decode(data, output) ? 0 : 1;
+    }
+    
+    return Decode(data, std::cout) ? 0 : 1;
+}
\ No newline at end of file
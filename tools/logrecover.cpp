@@ -0,0 +1,164 @@
+// 崩溃日志恢复工具：从LogCrashRing写出的环形文件中取出最后的日志记录
+// 用法: logrecover <环形文件> [记录数]
+
+#include "LogCrashRingFormat.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace LogCrashRingFormat;
+
+// FILETIME纪元与Unix纪元之间的100ns计数差
+const uint64_t kUnixEpochInFileTime = 116444736000000000ULL;
+
+struct Record {
+    RecordHeader header;
+    std::string message;
+};
+
+const char* GetLevelString(uint8_t level) {
+    switch (level) {
+        case 0: return "DEBUG";
+        case 1: return "INFO";
+        case 2: return "WARN";
+        case 3: return "ERROR";
+        default: return "UNKNOWN";
+    }
+}
+
+std::string FormatTimestamp(uint64_t fileTime, int32_t utcOffsetMinutes) {
+    if (fileTime < kUnixEpochInFileTime) {
+        return "0000-00-00 00:00:00.000";
+    }
+    
+    uint64_t unix100ns = fileTime - kUnixEpochInFileTime;
+    time_t seconds = static_cast<time_t>(unix100ns / 10000000ULL) + static_cast<time_t>(utcOffsetMinutes) * 60;
+    unsigned milliseconds = static_cast<unsigned>((unix100ns / 10000ULL) % 1000);
+    
+    struct tm timeinfo;
+#ifdef _WIN32
+    gmtime_s(&timeinfo, &seconds);
+#else
+    gmtime_r(&seconds, &timeinfo);
+#endif
+    
+    char buffer[32];
+    size_t length = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
+    snprintf(buffer + length, sizeof(buffer) - length, ".%03u", milliseconds);
+    return buffer;
+}
+
+// 按环形寻址读取，可能跨越数据区末尾
+void ReadRing(const char* data, uint64_t capacity, uint64_t position, char* out, size_t size) {
+    size_t offset = static_cast<size_t>(position % capacity);
+    size_t first = static_cast<size_t>(std::min<uint64_t>(size, capacity - offset));
+    memcpy(out, data + offset, first);
+    if (first < size) {
+        memcpy(out + first, data, size - first);
+    }
+}
+
+bool TryReadRecord(const char* data, uint64_t capacity, uint64_t position, uint64_t end, Record& record) {
+    if (end - position < sizeof(RecordHeader)) {
+        return false;
+    }
+    
+    ReadRing(data, capacity, position, reinterpret_cast<char*>(&record.header), sizeof(RecordHeader));
+    const RecordHeader& header = record.header;
+    if (header.magic != kRecordMagic || header.position != position ||
+        header.length > kMaxMessageBytes || GetRecordSize(header.length) > end - position) {
+        return false;
+    }
+    
+    record.message.resize(header.length);
+    if (header.length > 0) {
+        ReadRing(data, capacity, position + sizeof(RecordHeader), &record.message[0], header.length);
+    }
+    
+    const size_t checkedOffset = offsetof(RecordHeader, position);
+    uint32_t checksum = Checksum(kChecksumSeed, reinterpret_cast<const char*>(&header) + checkedOffset,
+                                 sizeof(RecordHeader) - checkedOffset);
+    checksum = Checksum(checksum, record.message.data(), record.message.size());
+    return checksum == header.checksum;
+}
+
+bool Recover(const std::vector<char>& file, size_t maxRecords, std::ostream& out) {
+    FileHeader fileHeader;
+    if (file.size() < sizeof(FileHeader)) {
+        std::cerr << "File is too small to be a crash log ring" << std::endl;
+        return false;
+    }
+    
+    memcpy(&fileHeader, file.data(), sizeof(FileHeader));
+    if (memcmp(fileHeader.magic, kMagic, sizeof(kMagic)) != 0 || fileHeader.version != kVersion) {
+        std::cerr << "Not a crash log ring file or unsupported version" << std::endl;
+        return false;
+    }
+    
+    uint64_t capacity = fileHeader.capacity;
+    if (capacity == 0 || capacity % kAlignment != 0 ||
+        file.size() < fileHeader.headerSize || file.size() - fileHeader.headerSize < capacity) {
+        std::cerr << "Crash log ring file is truncated" << std::endl;
+        return false;
+    }
+    
+    // 只有最近一圈的数据仍在文件中；写到一半或已被覆盖的记录校验失败，按对齐单位跳过
+    const char* data = file.data() + fileHeader.headerSize;
+    uint64_t end = fileHeader.reserved;
+    uint64_t position = end > capacity ? end - capacity : 0;
+    size_t skipped = 0;
+    
+    std::vector<Record> records;
+    Record record;
+    while (position < end) {
+        if (TryReadRecord(data, capacity, position, end, record)) {
+            position += GetRecordSize(record.header.length);
+            records.push_back(record);
+        } else {
+            position += kAlignment;
+            skipped++;
+        }
+    }
+    
+    size_t first = records.size() > maxRecords ? records.size() - maxRecords : 0;
+    for (size_t i = first; i < records.size(); ++i) {
+        const RecordHeader& header = records[i].header;
+        out << FormatTimestamp(header.timestamp, fileHeader.utcOffsetMinutes)
+            << " [" << GetLevelString(header.level) << "] [" << header.threadId << "] "
+            << records[i].message << "\n";
+    }
+    
+    if (skipped > 0) {
+        std::cerr << "Skipped " << skipped * kAlignment << " bytes of incomplete or overwritten data" << std::endl;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: logrecover <crash log ring file> [record count]" << std::endl;
+        return 1;
+    }
+    
+    size_t maxRecords = argc > 2 ? static_cast<size_t>(strtoull(argv[2], nullptr, 10)) : 100;
+    
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::cerr << "Failed to open input file: " << argv[1] << std::endl;
+        return 1;
+    }
+    
+    std::vector<char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    return Recover(data, maxRecords, std::cout) ? 0 : 1;
+}
\ No newline at end of file